@@ -25,14 +25,19 @@ EXPLICIT_TARGET_MAPPING = {
         "dear_imgui::impl_sdl", "dear_imgui::impl_vulkan"
     ],
     # LLVM
+    "@llvm-project//llvm:analysis": ["LLVMAnalysis"],
     "@llvm-project//llvm:asm_parser": ["LLVMAsmParser"],
+    "@llvm-project//llvm:bit_reader": ["LLVMBitReader"],
+    "@llvm-project//llvm:bit_writer": ["LLVMBitWriter"],
     "@llvm-project//llvm:core": ["LLVMCore"],
     "@llvm-project//llvm:execution_engine": ["LLVMExecutionEngine"],
+    "@llvm-project//llvm:ir_reader": ["LLVMIRReader"],
     "@llvm-project//llvm:passes": ["LLVMPasses"],
     "@llvm-project//llvm:target": ["LLVMTarget"],
     "@llvm-project//llvm:support": ["LLVMSupport"],
     "@llvm-project//llvm:orc_jit": ["LLVMOrcJIT"],
     "@llvm-project//llvm:tablegen": ["LLVMTableGen"],
+    "@llvm-project//llvm:transform_utils": ["LLVMTransformUtils"],
     "@llvm-project//llvm:x86_code_gen": ["LLVMX86CodeGen"],
     # MLIR
     "@llvm-project//mlir:AllPassesAndDialects": ["MLIRAllDialects"],
@@ -46,6 +51,7 @@ EXPLICIT_TARGET_MAPPING = {
     "@llvm-project//mlir:GPUDialect": ["MLIRGPU"],
     "@llvm-project//mlir:GPUToSPIRVTransforms": ["MLIRGPUtoSPIRVTransforms"],
     "@llvm-project//mlir:GPUTransforms": ["MLIRGPU"],
+    "@llvm-project//mlir:LLVMDialect": ["MLIRLLVMIR"],
     "@llvm-project//mlir:LLVMTransforms": ["MLIRStandardToLLVM"],
     "@llvm-project//mlir:LoopsToGPUPass": ["MLIRLoopsToGPU"],
     "@llvm-project//mlir:SCFDialect": ["MLIRSCF"],
@@ -14,6 +14,10 @@
 
 #include "iree/base/wait_handle.h"
 
+#include "iree/base/target_platform.h"
+
+#if !defined(IREE_PLATFORM_WINDOWS)
+
 #include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
@@ -530,3 +534,5 @@ Status ManualResetEvent::Reset() { return ClearFd(fd_type_, fd_); }
 WaitHandle ManualResetEvent::OnSet() { return WaitHandle(add_ref(this)); }
 
 }  // namespace iree
+
+#endif  // !IREE_PLATFORM_WINDOWS
@@ -16,7 +16,8 @@
 //
 // Pass to convert from HLO to linalg on buffers. Currently only handles cases
 // where the dispatch region contains a single xla_hlo op that can be converted
-// to linalg on buffers.
+// to linalg on buffers, optionally followed by linalg ops on tensors that
+// consume its result through a temporary buffer.
 //
 //===----------------------------------------------------------------------===//
 
@@ -119,6 +120,9 @@ static MemRefType getTensorBackingBufferType(
 /// Returns the interface buffer for the given op `operand`. This assumes the
 /// given `operand` is a tensor loaded from a HAL inteface buffer.
 static Value getBufferForOpOperand(Value operand, OpBuilder &builder) {
+  // Results of ops that were already converted are buffers.
+  if (operand.getType().isa<MemRefType>()) return operand;
+
   Operation *def = operand.getDefiningOp();
 
   // There may exist dynamic shape annotation. Penetrate through.
@@ -179,6 +183,47 @@ static Value getBufferForOpResult(Value result, OpBuilder &builder) {
   return buffer;
 }
 
+/// Returns true if the given `result` is only used by other ops in the dispatch
+/// region and never stored to an interface tensor.
+static bool isOnlyUsedWithinDispatch(Value result) {
+  if (result.use_empty()) return false;
+  for (Operation *user : result.getUsers()) {
+    if (auto tieShapeOp = dyn_cast<Shape::TieShapeOp>(user)) {
+      if (!isOnlyUsedWithinDispatch(tieShapeOp.result())) return false;
+    } else if (isa<IREE::HAL::InterfaceStoreTensorOp>(user)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Returns a temporary buffer for the given op `result` that is only consumed
+/// by other ops in the dispatch region, such as the elementwise epilogue of a
+/// matmul. The buffer is deallocated at the end of the block. If
+/// `zeroInitialize` is true the buffer is filled with zeros, as required by
+/// Linalg ops accumulating into their output.
+static Value allocateTemporaryBufferForOpResult(Value result,
+                                                bool zeroInitialize,
+                                                OpBuilder &builder) {
+  auto tensorType = result.getType().cast<TensorType>();
+  if (!tensorType.hasStaticShape()) return nullptr;
+  Location loc = result.getDefiningOp()->getLoc();
+  Type elementType = tensorType.getElementType();
+  Value buffer = builder.create<AllocOp>(
+      loc, MemRefType::get(tensorType.getShape(), elementType));
+  if (zeroInitialize) {
+    Attribute zeroAttr = builder.getZeroAttr(elementType);
+    if (!zeroAttr) return nullptr;
+    Value zero = builder.create<ConstantOp>(loc, zeroAttr);
+    builder.create<linalg::FillOp>(loc, buffer, zero);
+  }
+
+  OpBuilder::InsertionGuard guard(builder);
+  builder.setInsertionPoint(result.getParentBlock()->getTerminator());
+  builder.create<DeallocOp>(loc, buffer);
+  return buffer;
+}
+
 /// Returns true if the given `operand` is a direct load from an interface
 /// tensor.
 static bool isDirectlyReadingFromInterfaceTensor(Value operand) {
@@ -250,7 +295,14 @@ struct ConvertToLinalgBufferOp : public OpConversionPattern<SrcOpTy> {
     SmallVector<Value, 1> resultBuffers;
     resultBuffers.reserve(op->getNumResults());
     for (auto result : llvm::enumerate(op->getResults())) {
-      Value resultBuffer = getBufferForOpResult(result.value(), rewriter);
+      Value resultBuffer =
+          isOnlyUsedWithinDispatch(result.value())
+              ? allocateTemporaryBufferForOpResult(
+                    result.value(),
+                    /*zeroInitialize=*/isa<xla_hlo::DotOp>(op) ||
+                        isa<xla_hlo::ConvOp>(op),
+                    rewriter)
+              : getBufferForOpResult(result.value(), rewriter);
       if (!resultBuffer) {
         return rewriter.notifyMatchFailure(op, [&](Diagnostic &diag) {
           diag << "failed to create buffer for result #" << result.index();
@@ -73,3 +73,43 @@ module {
     hal.interface.binding @ret0, set=0, binding=1, type="StorageBuffer", access="Write"
   }
 }
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+
+module {
+  // CHECK-LABEL: func @dot_epilogue
+  //   CHECK-DAG: %[[LHS:.+]] = iree.placeholder for "interface buffer" {binding = @legacy_io::@arg0} : memref<2x3xf32>
+  //   CHECK-DAG: %[[RHS:.+]] = iree.placeholder for "interface buffer" {binding = @legacy_io::@arg1} : memref<3x2xf32>
+  //   CHECK-DAG: %[[BIAS:.+]] = iree.placeholder for "interface buffer" {binding = @legacy_io::@arg2} : memref<2x2xf32>
+  //   CHECK-DAG: %[[RET:.+]] = iree.placeholder for "interface buffer" {binding = @legacy_io::@ret0} : memref<2x2xf32>
+  //       CHECK: %[[TEMP:.+]] = alloc() : memref<2x2xf32>
+  //       CHECK: %[[ZERO:.+]] = constant 0.000000e+00 : f32
+  //       CHECK: linalg.fill(%[[TEMP]], %[[ZERO]])
+  //       CHECK: linalg.matmul(%[[LHS]], %[[RHS]], %[[TEMP]])
+  //       CHECK: linalg.generic
+  //  CHECK-SAME: %[[TEMP]], %[[BIAS]], %[[RET]]
+  //       CHECK: dealloc %[[TEMP]]
+  //  CHECK-NEXT: return
+  func @dot_epilogue() {
+    %c0 = constant 0 : index
+    %0 = hal.interface.load.tensor @legacy_io::@arg0, offset = %c0 : tensor<2x3xf32>
+    %1 = hal.interface.load.tensor @legacy_io::@arg1, offset = %c0 : tensor<3x2xf32>
+    %2 = hal.interface.load.tensor @legacy_io::@arg2, offset = %c0 : tensor<2x2xf32>
+    %3 = "xla_hlo.dot"(%0, %1) : (tensor<2x3xf32>, tensor<3x2xf32>) -> tensor<2x2xf32>
+    %4 = linalg.generic {args_in = 2 : i64, args_out = 1 : i64, indexing_maps = [#map0, #map0, #map0], iterator_types = ["parallel", "parallel"]} %3, %2 {
+    ^bb0(%arg0: f32, %arg1: f32):       // no predecessors
+      %5 = addf %arg0, %arg1 : f32
+      linalg.yield %5 : f32
+    }: tensor<2x2xf32>, tensor<2x2xf32> -> tensor<2x2xf32>
+    hal.interface.store.tensor %4, @legacy_io::@ret0, offset = %c0 : tensor<2x2xf32>
+    return
+  }
+  hal.interface @legacy_io attributes {sym_visibility = "private"} {
+    hal.interface.binding @arg0, set=0, binding=0, type="StorageBuffer", access="Read"
+    hal.interface.binding @arg1, set=0, binding=1, type="StorageBuffer", access="Read"
+    hal.interface.binding @arg2, set=0, binding=2, type="StorageBuffer", access="Read"
+    hal.interface.binding @ret0, set=0, binding=3, type="StorageBuffer", access="Write"
+  }
+}
@@ -14,10 +14,12 @@
 
 #include <memory>
 
+#include "iree/compiler/Conversion/LinalgToLLVM/Passes.h"
 #include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/IREE/IR/IREEOps.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/StandardTypes.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Transforms/DialectConversion.h"
@@ -133,6 +135,16 @@ struct ProcessFuncInterfacePattern : public OpConversionPattern<FuncOp> {
     newFuncOp.setAttr("llvm.emit_c_interface",
                       mlir::UnitAttr::get(funcOp.getContext()));
 
+    // Record the static shapes of the bindings so that the invocation function
+    // can build the memref descriptors from the raw binding pointers.
+    SmallVector<Attribute, 8> bindingShapes;
+    for (Type type : signatureConverter.getConvertedTypes()) {
+      bindingShapes.push_back(
+          rewriter.getI64ArrayAttr(type.cast<MemRefType>().getShape()));
+    }
+    newFuncOp.setAttr(getBindingShapesAttrName(),
+                      rewriter.getArrayAttr(bindingShapes));
+
     // Move all ops in the old function's region to the new function.
     rewriter.inlineRegionBefore(funcOp.getBody(), newFuncOp.getBody(),
                                 newFuncOp.end());
@@ -0,0 +1,318 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- LinalgTileAndVectorizePass.cpp - Tile and vectorize Linalg on CPU --===//
+//
+// Implements the CPU codegen strategy for Linalg contractions on buffers:
+// contractions are first fused into the tiles of their elementwise consumers,
+// then tiled for the cache hierarchy, the innermost (register) tiles are
+// promoted into statically shaped buffers and then rewritten to vector dialect
+// ops that lower to SIMD instructions. Other Linalg ops are left to be lowered
+// to loops that LLVM vectorizes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Conversion/LinalgToLLVM/Passes.h"
+#include "llvm/ADT/SetVector.h"
+#include "mlir/Conversion/VectorToLoops/ConvertVectorToLoops.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Linalg/Analysis/DependenceAnalysis.h"
+#include "mlir/Dialect/Linalg/IR/LinalgOps.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Linalg/Utils/Utils.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/Dialect/Vector/VectorOps.h"
+#include "mlir/Dialect/Vector/VectorTransforms.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/FoldUtils.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+// Markers used to sequence the staged rewrites below. Ops without a marker are
+// the initial input.
+static constexpr const char kFusedMarker[] = "fused";
+static constexpr const char kCacheTiledMarker[] = "cache_tiled";
+static constexpr const char kRegisterTiledMarker[] = "register_tiled";
+static constexpr const char kVectorizeMarker[] = "vectorize";
+
+/// Tile sizes of the (M, N, K) cache blocks of matmuls, chosen so that the f32
+/// tiles of all three operands (~144KB) stay resident in a typical L2 cache.
+static constexpr int64_t kMatmulCacheTileSizes[] = {64, 64, 256};
+
+/// Tile sizes of the (M, N, K) register blocks of matmuls. These are vectorized
+/// into a single vector.contract and should fit in the vector register file of
+/// the target (16 registers of 8 x f32 for AVX2).
+static constexpr int64_t kMatmulRegisterTileSizes[] = {4, 16, 8};
+
+/// Tile sizes of the elementwise consumers of matmuls that the matmuls are
+/// fused into, matching the (M, N) cache blocks.
+static constexpr int64_t kMatmulEpilogueTileSizes[] = {
+    kMatmulCacheTileSizes[0], kMatmulCacheTileSizes[1]};
+
+/// Tile sizes of the (N, H, W, C) elementwise consumers of convolutions that
+/// the convolutions are fused into, with a result footprint similar to the
+/// matmul cache blocks.
+static constexpr int64_t kConvEpilogueTileSizes[] = {1, 8, 8, 64};
+
+namespace {
+
+/// Function pass that tiles Linalg contractions on buffers for the cache
+/// hierarchy and lowers their register tiles to the vector dialect.
+struct LinalgTileAndVectorizePass
+    : public PassWrapper<LinalgTileAndVectorizePass, FunctionPass> {
+  LinalgTileAndVectorizePass() = default;
+  LinalgTileAndVectorizePass(const LinalgTileAndVectorizePass &pass) {}
+
+  void runOnFunction() override;
+
+  /// This option is only for testing purposes: it leaves the vector ops
+  /// produced from the register tiles as is so their shapes can be checked.
+  Option<bool> lowerVectorOps{
+      *this, "lower-vector-ops",
+      llvm::cl::desc("Whether to lower vector.contract and n-D vector "
+                     "transfers (disable only for testing)"),
+      llvm::cl::init(true)};
+};
+
+}  // namespace
+
+/// Returns true if `op` is a contraction that can be fused into the tiles of
+/// its elementwise consumer.
+static bool isFusableContractionOp(Operation *op) {
+  return isa<linalg::MatmulOp>(op) || isa<linalg::ConvOp>(op);
+}
+
+/// Returns the contraction producing an input of the elementwise `consumer`
+/// if it is the only op depending on the contraction, or nullptr otherwise.
+static Operation *getFusableContractionProducer(
+    linalg::LinalgOp consumer, const linalg::LinalgDependenceGraph &graph) {
+  if (!isa<linalg::GenericOp>(consumer.getOperation()) ||
+      consumer.getNumParallelLoops() != consumer.getNumLoops()) {
+    return nullptr;
+  }
+  for (auto dependence : graph.getDependencesInto(
+           consumer, linalg::LinalgDependenceGraph::RAW)) {
+    Operation *producer = dependence.dependentOpView.op;
+    if (isFusableContractionOp(producer) &&
+        graph.getDependentOperations(cast<linalg::LinalgOp>(producer))
+                .size() == 1) {
+      return producer;
+    }
+  }
+  return nullptr;
+}
+
+/// Initializes the output tile of the fused contraction `fusedOp` with the
+/// value the whole output buffer is filled with, if any, and returns the fill
+/// op of the whole buffer.
+static Operation *fuseOutputFill(linalg::LinalgOp fusedOp, OpBuilder &builder) {
+  auto subViewOp =
+      dyn_cast_or_null<SubViewOp>(fusedOp.getOutputBuffer(0).getDefiningOp());
+  if (!subViewOp) return nullptr;
+  Value buffer = subViewOp.source();
+  for (Operation *user : buffer.getUsers()) {
+    auto fillOp = dyn_cast<linalg::FillOp>(user);
+    if (!fillOp || fillOp.output() != buffer) continue;
+    builder.setInsertionPoint(fusedOp);
+    builder.create<linalg::FillOp>(fillOp.getLoc(), subViewOp.getResult(),
+                                   fillOp.value());
+    return fillOp;
+  }
+  return nullptr;
+}
+
+/// Fuses matmuls and convolutions into the tiles of their elementwise consumers
+/// (bias add, activation, requantization, etc) so that each tile of the
+/// contraction result is consumed while it is still resident in cache instead
+/// of making a full round trip through memory. The fused matmul tiles are
+/// marked to be tiled further along the reduction dimension.
+static void fuseElementwiseEpilogues(FuncOp funcOp) {
+  MLIRContext *context = funcOp.getContext();
+  OpBuilder builder(context);
+
+  // Tile the elementwise consumers with tile sizes suitable for the producer.
+  SmallVector<linalg::LinalgOp, 4> tiledConsumers;
+  {
+    linalg::Aliases aliases;
+    auto graph =
+        linalg::LinalgDependenceGraph::buildDependenceGraph(aliases, funcOp);
+    SmallVector<std::pair<linalg::LinalgOp, Operation *>, 4> consumers;
+    funcOp.walk([&](linalg::LinalgOp consumer) {
+      if (auto *producer = getFusableContractionProducer(consumer, graph)) {
+        consumers.emplace_back(consumer, producer);
+      }
+    });
+    for (auto it : consumers) {
+      linalg::LinalgOp consumer = it.first;
+      ArrayRef<int64_t> tileSizes =
+          isa<linalg::MatmulOp>(it.second)
+              ? ArrayRef<int64_t>(kMatmulEpilogueTileSizes)
+              : ArrayRef<int64_t>(kConvEpilogueTileSizes);
+      if (consumer.getNumLoops() != tileSizes.size()) continue;
+      builder.setInsertionPoint(consumer);
+      auto tiledConsumer = linalg::tileLinalgOp(
+          builder, consumer,
+          linalg::LinalgTilingOptions().setTileSizes(tileSizes));
+      if (!tiledConsumer) continue;
+      tiledConsumers.push_back(tiledConsumer->op);
+      consumer.getOperation()->erase();
+    }
+  }
+  if (tiledConsumers.empty()) return;
+
+  // Fuse the producers into the tiled consumers.
+  linalg::Aliases aliases;
+  auto graph =
+      linalg::LinalgDependenceGraph::buildDependenceGraph(aliases, funcOp);
+  OperationFolder folder(context);
+  llvm::SetVector<Operation *> fusedProducers;
+  llvm::SetVector<Operation *> fusedFills;
+  for (auto consumer : tiledConsumers) {
+    for (auto dependence : graph.getDependencesInto(
+             consumer, linalg::LinalgDependenceGraph::RAW)) {
+      Operation *producer = dependence.dependentOpView.op;
+      if (!isFusableContractionOp(producer) || fusedProducers.count(producer)) {
+        continue;
+      }
+      for (unsigned i = 0, e = consumer.getNumInputs(); i < e; ++i) {
+        if (consumer.getInput(i) != dependence.indexingView) continue;
+        auto fusionInfo =
+            linalg::fuseProducerOf(builder, consumer, i, graph, &folder);
+        if (!fusionInfo) continue;
+        auto fusedProducer = fusionInfo->fusedProducer;
+        fusedProducer.getOperation()->setAttr(
+            linalg::LinalgTransforms::kLinalgTransformMarker,
+            StringAttr::get(kFusedMarker, context));
+        if (auto *fillOp = fuseOutputFill(fusedProducer, builder)) {
+          fusedFills.insert(fillOp);
+        }
+        fusedProducers.insert(producer);
+        break;
+      }
+    }
+  }
+
+  // The original producers have no other dependent ops and are now dead. The
+  // buffers they wrote to are only accessed through tiles and no longer need
+  // to be initialized as a whole.
+  for (auto *producer : fusedProducers) producer->erase();
+  for (auto *fillOp : fusedFills) {
+    Value buffer = cast<linalg::FillOp>(fillOp).output();
+    bool isOnlyAccessedByTiles =
+        llvm::all_of(buffer.getUsers(), [&](Operation *user) {
+          return user == fillOp || isa<SubViewOp>(user) ||
+                 isa<DeallocOp>(user);
+        });
+    if (isOnlyAccessedByTiles) fillOp->erase();
+  }
+}
+
+void LinalgTileAndVectorizePass::runOnFunction() {
+  MLIRContext *context = &getContext();
+  FuncOp funcOp = getFunction();
+
+  fuseElementwiseEpilogues(funcOp);
+
+  // Stage 1: tiling, promotion and vectorization. Each list of patterns is
+  // applied in order and consumes the marker set by the previous one.
+  SmallVector<OwningRewritePatternList, 4> stage1Patterns;
+
+  // Tile for the caches. Matmuls fused into the tiles of their consumers
+  // already match the (M, N) cache blocks.
+  stage1Patterns.emplace_back();
+  stage1Patterns.back().insert<linalg::LinalgTilingPattern<linalg::MatmulOp>>(
+      context,
+      linalg::LinalgTilingOptions().setTileSizes(kMatmulCacheTileSizes),
+      linalg::LinalgMarker({}, kCacheTiledMarker));
+  stage1Patterns.back().insert<linalg::LinalgTilingPattern<linalg::MatmulOp>>(
+      context,
+      linalg::LinalgTilingOptions().setTileSizes(
+          {0, 0, kMatmulCacheTileSizes[2]}),
+      linalg::LinalgMarker({kFusedMarker}, kCacheTiledMarker));
+
+  // Tile for registers.
+  stage1Patterns.emplace_back();
+  stage1Patterns.back().insert<linalg::LinalgTilingPattern<linalg::MatmulOp>>(
+      context,
+      linalg::LinalgTilingOptions().setTileSizes(kMatmulRegisterTileSizes),
+      linalg::LinalgMarker({kCacheTiledMarker}, kRegisterTiledMarker));
+
+  // Promote the register tiles into full, statically shaped buffers so that
+  // partial tiles at the boundaries can still be vectorized.
+  stage1Patterns.emplace_back();
+  stage1Patterns.back()
+      .insert<linalg::LinalgPromotionPattern<linalg::MatmulOp>>(
+          context,
+          linalg::LinalgPromotionOptions().setUseFullTileBuffersByDefault(true),
+          linalg::LinalgMarker({kRegisterTiledMarker}, kVectorizeMarker));
+
+  // Rewrite the promoted tiles to vector.contract and vector transfers.
+  stage1Patterns.emplace_back();
+  stage1Patterns.back()
+      .insert<linalg::LinalgVectorizationPattern<linalg::MatmulOp>>(
+          context, linalg::LinalgMarker({kVectorizeMarker}));
+  stage1Patterns.back()
+      .insert<linalg::LinalgVectorizationPattern<linalg::FillOp>,
+              linalg::LinalgVectorizationPattern<linalg::CopyOp>>(context);
+
+  // Stage 2: cleanup of the index computations created by tiling after each
+  // application of the stage 1 patterns.
+  OwningRewritePatternList stage2Patterns;
+  AffineApplyOp::getCanonicalizationPatterns(stage2Patterns, context);
+  AffineMinOp::getCanonicalizationPatterns(stage2Patterns, context);
+  SubViewOp::getCanonicalizationPatterns(stage2Patterns, context);
+  ViewOp::getCanonicalizationPatterns(stage2Patterns, context);
+
+  // Stage 3: lower vector.contract progressively into outer products and
+  // elementwise vector ops that map directly to SIMD instructions, and n-D
+  // vector transfers into loops of 1-D transfers.
+  auto stage3Lambda = [context, this](Operation *op) {
+    if (!lowerVectorOps) return success();
+    OwningRewritePatternList patterns;
+    vector::populateVectorToVectorCanonicalizationPatterns(patterns, context);
+    vector::populateVectorSlicesLoweringPatterns(patterns, context);
+    vector::populateVectorContractLoweringPatterns(
+        patterns, context, vector::VectorTransformsOptions());
+    populateVectorToAffineLoopsConversionPatterns(context, patterns);
+    applyPatternsAndFoldGreedily(op, patterns);
+    return success();
+  };
+
+  if (failed(linalg::applyStagedPatterns(funcOp, stage1Patterns,
+                                         stage2Patterns, stage3Lambda))) {
+    funcOp.emitError("failed to tile and vectorize Linalg ops");
+    return signalPassFailure();
+  }
+
+  // Remove the markers so they don't leak into later passes.
+  funcOp.walk([](linalg::LinalgOp linalgOp) {
+    linalgOp.getOperation()->removeAttr(
+        linalg::LinalgTransforms::kLinalgTransformMarker);
+  });
+}
+
+std::unique_ptr<OperationPass<FuncOp>> createLinalgTileAndVectorizePass() {
+  return std::make_unique<LinalgTileAndVectorizePass>();
+}
+
+static PassRegistration<LinalgTileAndVectorizePass> pass(
+    "iree-codegen-linalg-to-llvm-tile-and-vectorize",
+    "Tile Linalg ops for the cache hierarchy and vectorize register tiles",
+    [] { return std::make_unique<LinalgTileAndVectorizePass>(); });
+
+}  // namespace iree_compiler
+}  // namespace mlir
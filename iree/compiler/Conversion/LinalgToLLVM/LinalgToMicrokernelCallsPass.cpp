@@ -0,0 +1,182 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- LinalgToMicrokernelCallsPass.cpp - Call runtime microkernels -------===//
+//
+// Replaces Linalg contractions on buffers with calls into the microkernels
+// provided by the CPU runtime (backed by ruy). The microkernels are declared
+// with the MLIR C interface so that each memref is passed as a pointer to its
+// descriptor:
+//
+//   void _mlir_ciface_iree_ukernel_matmul_f32(
+//       memref2d* lhs, memref2d* rhs, memref2d* out, int32_t accumulate);
+//   void _mlir_ciface_iree_ukernel_batch_matmul_f32(
+//       memref3d* lhs, memref3d* rhs, memref3d* out, int32_t accumulate);
+//   void _mlir_ciface_iree_ukernel_conv2d_f32(
+//       memref4d* filter, memref4d* input, memref4d* out,
+//       int64_t stride_h, int64_t stride_w,
+//       int64_t dilation_h, int64_t dilation_w, int32_t accumulate);
+//
+// Linalg contractions accumulate into their output. When the output is zero
+// filled right before the contraction the fill is dropped and the microkernel
+// overwrites the output instead (accumulate = 0).
+//
+// NOTE: this must be kept in sync with iree/hal/llvmjit/llvmjit_microkernels.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Conversion/LinalgToLLVM/Passes.h"
+#include "mlir/Dialect/Linalg/IR/LinalgOps.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/Module.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+static constexpr const char kMatmulMicrokernel[] = "iree_ukernel_matmul_f32";
+static constexpr const char kBatchMatmulMicrokernel[] =
+    "iree_ukernel_batch_matmul_f32";
+static constexpr const char kConv2DMicrokernel[] = "iree_ukernel_conv2d_f32";
+
+/// Returns true if all operands of `linalgOp` are contiguous f32 buffers in the
+/// default memory space, which is what the microkernels support.
+static bool hasMicrokernelOperands(linalg::LinalgOp linalgOp) {
+  if (!linalgOp.hasBufferSemantics()) return false;
+  for (Value operand : linalgOp.getInputsAndOutputBuffers()) {
+    auto type = operand.getType().dyn_cast<MemRefType>();
+    if (!type || !type.getElementType().isF32() ||
+        !type.getAffineMaps().empty() || type.getMemorySpace() != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Returns true if `convOp` is a 2-D convolution without padding.
+static bool isMicrokernelConv2D(linalg::ConvOp convOp) {
+  if (convOp.getOutputBufferType(0).getRank() != 4) return false;
+  if (auto padding = convOp.padding()) {
+    for (APInt value : padding->getIntValues()) {
+      if (!value.isNullValue()) return false;
+    }
+  }
+  return true;
+}
+
+/// Returns the declaration of the microkernel `name` in `moduleOp`, adding it
+/// if needed.
+static FuncOp getOrInsertMicrokernelDecl(ModuleOp moduleOp, StringRef name,
+                                         FunctionType type) {
+  if (auto funcOp = moduleOp.lookupSymbol<FuncOp>(name)) return funcOp;
+  auto builder = OpBuilder::atBlockBegin(moduleOp.getBody());
+  auto funcOp = builder.create<FuncOp>(moduleOp.getLoc(), name, type,
+                                       ArrayRef<NamedAttribute>{});
+  funcOp.setAttr("llvm.emit_c_interface", builder.getUnitAttr());
+  SymbolTable::setSymbolVisibility(funcOp, SymbolTable::Visibility::Private);
+  return funcOp;
+}
+
+/// Returns true if `output` is filled with zeros by the op right before
+/// `linalgOp`, and if so erases the fill.
+static bool eraseZeroFillOfOutput(linalg::LinalgOp linalgOp, Value output) {
+  auto fillOp = dyn_cast_or_null<linalg::FillOp>(
+      linalgOp.getOperation()->getPrevNode());
+  if (!fillOp || fillOp.output() != output) return false;
+  if (!matchPattern(fillOp.value(), m_AnyZeroFloat())) return false;
+  fillOp.erase();
+  return true;
+}
+
+/// Replaces `linalgOp` with a call to the microkernel `name` taking the
+/// operands of `linalgOp` followed by `extraOperands` and the accumulate flag.
+static void replaceWithMicrokernelCall(linalg::LinalgOp linalgOp,
+                                       StringRef name,
+                                       ArrayRef<int64_t> extraOperands) {
+  auto moduleOp = linalgOp.getOperation()->getParentOfType<ModuleOp>();
+  Location loc = linalgOp.getLoc();
+  Value output = linalgOp.getOutputBuffer(0);
+  bool accumulate = !eraseZeroFillOfOutput(linalgOp, output);
+
+  // Erase the static shapes so that all calls match a single declaration. The
+  // microkernels read the sizes from the memref descriptors.
+  OpBuilder builder(linalgOp.getOperation());
+  SmallVector<Value, 8> operands;
+  for (Value operand : linalgOp.getInputsAndOutputBuffers()) {
+    auto type = operand.getType().cast<MemRefType>();
+    SmallVector<int64_t, 4> dynamicShape(type.getRank(),
+                                         ShapedType::kDynamicSize);
+    operands.push_back(builder.create<MemRefCastOp>(
+        loc, operand, MemRefType::get(dynamicShape, type.getElementType())));
+  }
+  for (int64_t value : extraOperands) {
+    operands.push_back(builder.create<ConstantIntOp>(loc, value, 64));
+  }
+  operands.push_back(builder.create<ConstantIntOp>(loc, accumulate, 32));
+
+  auto funcOp = getOrInsertMicrokernelDecl(
+      moduleOp, name,
+      builder.getFunctionType(ValueRange(operands).getTypes(), llvm::None));
+  builder.create<CallOp>(loc, funcOp, operands);
+  linalgOp.getOperation()->erase();
+}
+
+namespace {
+
+/// Module pass that replaces Linalg contractions with calls to microkernels.
+struct LinalgToMicrokernelCallsPass
+    : public PassWrapper<LinalgToMicrokernelCallsPass,
+                         OperationPass<ModuleOp>> {
+  void runOnOperation() override;
+};
+
+}  // namespace
+
+void LinalgToMicrokernelCallsPass::runOnOperation() {
+  SmallVector<linalg::LinalgOp, 4> linalgOps;
+  getOperation().walk([&](linalg::LinalgOp linalgOp) {
+    if (hasMicrokernelOperands(linalgOp)) linalgOps.push_back(linalgOp);
+  });
+
+  for (auto linalgOp : linalgOps) {
+    Operation *op = linalgOp.getOperation();
+    if (isa<linalg::MatmulOp>(op)) {
+      replaceWithMicrokernelCall(linalgOp, kMatmulMicrokernel, {});
+    } else if (isa<linalg::BatchMatmulOp>(op)) {
+      replaceWithMicrokernelCall(linalgOp, kBatchMatmulMicrokernel, {});
+    } else if (auto convOp = dyn_cast<linalg::ConvOp>(op)) {
+      if (!isMicrokernelConv2D(convOp)) continue;
+      replaceWithMicrokernelCall(
+          linalgOp, kConv2DMicrokernel,
+          {convOp.getStride(0), convOp.getStride(1), convOp.getDilation(0),
+           convOp.getDilation(1)});
+    }
+  }
+}
+
+std::unique_ptr<OperationPass<ModuleOp>> createLinalgToMicrokernelCallsPass() {
+  return std::make_unique<LinalgToMicrokernelCallsPass>();
+}
+
+static PassRegistration<LinalgToMicrokernelCallsPass> pass(
+    "iree-codegen-linalg-to-llvm-microkernel-calls",
+    "Replace Linalg contractions with calls to runtime microkernels",
+    [] { return std::make_unique<LinalgToMicrokernelCallsPass>(); });
+
+}  // namespace iree_compiler
+}  // namespace mlir
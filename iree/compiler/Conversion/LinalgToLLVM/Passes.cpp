@@ -24,13 +24,24 @@
 namespace mlir {
 namespace iree_compiler {
 
-void buildLLVMTransformPassPipeline(OpPassManager &passManager) {
+void buildLLVMTransformPassPipeline(OpPassManager &passManager,
+                                    const LLVMCodegenOptions &options) {
   passManager.addPass(createInlinerPass());
 
   // HLO -> Linalg on buffers.
   passManager.addPass(createDecomposeHLOClampPass());
   addHLOToLinalgOnBuffersPasses(passManager);
 
+  // Linalg -> Microkernel calls
+  if (options.useMicrokernels) {
+    passManager.addPass(createLinalgToMicrokernelCallsPass());
+  }
+
+  // Linalg -> Vector
+  passManager.addNestedPass<FuncOp>(createLinalgTileAndVectorizePass());
+  passManager.addPass(createCanonicalizerPass());
+  passManager.addPass(createCSEPass());
+
   // Linalg -> Loops
   passManager.addPass(createConvertLinalgToLoopsPass());
   passManager.addPass(createCanonicalizerPass());
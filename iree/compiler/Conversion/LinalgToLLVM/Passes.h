@@ -20,15 +20,39 @@
 namespace mlir {
 namespace iree_compiler {
 
+/// Returns the name of the attribute on entry functions holding the shapes of
+/// their memref arguments, with dynamic dimensions as
+/// ShapedType::kDynamicSize. The LLVM HAL target uses them to build the memref
+/// descriptors passed to entry functions from the raw binding pointers.
+inline llvm::StringRef getBindingShapesAttrName() {
+  return "iree.binding_shapes";
+}
+
 /// Converts function signture type from hal interface op annotation to memref
 /// argument.
 std::unique_ptr<OperationPass<ModuleOp>>
 createHALInterfaceToMemrefArgumentsPass();
 
+/// Tiles Linalg contractions on buffers for the CPU cache hierarchy and lowers
+/// the innermost tiles to vector dialect ops.
+std::unique_ptr<OperationPass<FuncOp>> createLinalgTileAndVectorizePass();
+
+/// Replaces Linalg contractions on buffers with calls to the microkernels
+/// provided by the CPU runtime.
+std::unique_ptr<OperationPass<ModuleOp>> createLinalgToMicrokernelCallsPass();
+
+/// Options controlling the lowering of XLA HLO to LLVM dialect.
+struct LLVMCodegenOptions {
+  /// Calls runtime-provided microkernels for contractions instead of
+  /// generating code for them.
+  bool useMicrokernels = false;
+};
+
 /// Populates passes needed to lower a XLA HLO op to LLVM dialect via the
 /// structured ops path. The pass manager `pm` in here should operate on the
 /// module within the IREE::HAL::ExecutableOp.
-void buildLLVMTransformPassPipeline(OpPassManager &passManager);
+void buildLLVMTransformPassPipeline(OpPassManager &passManager,
+                                    const LLVMCodegenOptions &options = {});
 
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -0,0 +1,21 @@
+// RUN: iree-opt -iree-codegen-hal-interface-to-memref-arguments-pass %s | IreeFileCheck %s
+
+// CHECK-LABEL: func @matmul
+// CHECK-SAME: (%[[LHS:.+]]: memref<4x8xf32>, %[[RHS:.+]]: memref<8x16xf32>, %[[RESULT:.+]]: memref<4x16xf32>)
+// CHECK-SAME: iree.binding_shapes = {{\[}}[4, 8], [8, 16], [4, 16]]
+// CHECK-SAME: llvm.emit_c_interface
+// CHECK: linalg.matmul(%[[LHS]], %[[RHS]], %[[RESULT]])
+module {
+  func @matmul() {
+    %0 = iree.placeholder for "interface buffer" {binding = @legacy_io::@ret0} : memref<4x16xf32>
+    %1 = iree.placeholder for "interface buffer" {binding = @legacy_io::@arg0} : memref<4x8xf32>
+    %2 = iree.placeholder for "interface buffer" {binding = @legacy_io::@arg1} : memref<8x16xf32>
+    linalg.matmul(%1, %2, %0) : memref<4x8xf32>, memref<8x16xf32>, memref<4x16xf32>
+    return
+  }
+  hal.interface @legacy_io attributes {sym_visibility = "private"} {
+    hal.interface.binding @arg0, set=0, binding=0, type="StorageBuffer", access="Read"
+    hal.interface.binding @arg1, set=0, binding=1, type="StorageBuffer", access="Read"
+    hal.interface.binding @ret0, set=0, binding=2, type="StorageBuffer", access="Write"
+  }
+}
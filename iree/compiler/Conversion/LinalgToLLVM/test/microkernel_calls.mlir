@@ -0,0 +1,61 @@
+// RUN: iree-opt -split-input-file -iree-codegen-linalg-to-llvm-microkernel-calls %s | IreeFileCheck %s
+
+// CHECK: func @iree_ukernel_matmul_f32(memref<?x?xf32>, memref<?x?xf32>, memref<?x?xf32>, i32)
+// CHECK-SAME: attributes {llvm.emit_c_interface, sym_visibility = "private"}
+// CHECK-LABEL: func @matmul
+func @matmul(%lhs: memref<128x512xf32>, %rhs: memref<512x256xf32>,
+             %result: memref<128x256xf32>) {
+  //  CHECK-DAG: %[[LHS:.+]] = memref_cast %{{.+}} : memref<128x512xf32> to memref<?x?xf32>
+  //  CHECK-DAG: %[[RHS:.+]] = memref_cast %{{.+}} : memref<512x256xf32> to memref<?x?xf32>
+  //  CHECK-DAG: %[[RESULT:.+]] = memref_cast %{{.+}} : memref<128x256xf32> to memref<?x?xf32>
+  //  CHECK-DAG: %[[ACCUMULATE:.+]] = constant 1 : i32
+  //      CHECK: call @iree_ukernel_matmul_f32(%[[LHS]], %[[RHS]], %[[RESULT]], %[[ACCUMULATE]])
+  //  CHECK-NOT: linalg.matmul
+  linalg.matmul(%lhs, %rhs, %result) :
+    memref<128x512xf32>, memref<512x256xf32>, memref<128x256xf32>
+  return
+}
+
+// -----
+
+// Zero filled outputs are overwritten instead.
+
+// CHECK-LABEL: func @matmul_zero_filled
+func @matmul_zero_filled(%lhs: memref<4x8xf32>, %rhs: memref<8x16xf32>,
+                         %result: memref<4x16xf32>) {
+  %zero = constant 0.0 : f32
+  //  CHECK-NOT: linalg.fill
+  //  CHECK-DAG: %[[ACCUMULATE:.+]] = constant 0 : i32
+  //      CHECK: call @iree_ukernel_matmul_f32(%{{.+}}, %{{.+}}, %{{.+}}, %[[ACCUMULATE]])
+  linalg.fill(%result, %zero) : memref<4x16xf32>, f32
+  linalg.matmul(%lhs, %rhs, %result) :
+    memref<4x8xf32>, memref<8x16xf32>, memref<4x16xf32>
+  return
+}
+
+// -----
+
+// CHECK: func @iree_ukernel_conv2d_f32(memref<?x?x?x?xf32>, memref<?x?x?x?xf32>, memref<?x?x?x?xf32>, i64, i64, i64, i64, i32)
+// CHECK-LABEL: func @conv
+func @conv(%filter: memref<3x3x4x16xf32>, %input: memref<1x17x17x4xf32>,
+           %result: memref<1x8x8x16xf32>) {
+  //      CHECK: %[[STRIDE_H:.+]] = constant 2 : i64
+  //      CHECK: %[[STRIDE_W:.+]] = constant 2 : i64
+  //      CHECK: %[[DILATION_H:.+]] = constant 1 : i64
+  //      CHECK: %[[DILATION_W:.+]] = constant 1 : i64
+  //      CHECK: call @iree_ukernel_conv2d_f32(%{{.+}}, %{{.+}}, %{{.+}}, %[[STRIDE_H]], %[[STRIDE_W]], %[[DILATION_H]], %[[DILATION_W]], %{{.+}})
+  linalg.conv(%filter, %input, %result) {strides = [2, 2], dilations = [1, 1]} :
+    memref<3x3x4x16xf32>, memref<1x17x17x4xf32>, memref<1x8x8x16xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @unsupported
+func @unsupported(%lhs: memref<4x8xi32>, %rhs: memref<8x16xi32>,
+                  %result: memref<4x16xi32>) {
+  // CHECK: linalg.matmul
+  linalg.matmul(%lhs, %rhs, %result) :
+    memref<4x8xi32>, memref<8x16xi32>, memref<4x16xi32>
+  return
+}
@@ -0,0 +1,99 @@
+// RUN: iree-opt -split-input-file -iree-codegen-linalg-to-llvm-tile-and-vectorize %s | IreeFileCheck %s
+// RUN: iree-opt -split-input-file -iree-codegen-linalg-to-llvm-tile-and-vectorize='lower-vector-ops=false' %s | IreeFileCheck %s -check-prefix=VECTOR
+
+// CHECK-LABEL: func @matmul_static
+// VECTOR-LABEL: func @matmul_static
+func @matmul_static(%lhs: memref<128x512xf32>, %rhs: memref<512x256xf32>,
+                    %result: memref<128x256xf32>) {
+  //  CHECK-DAG: %[[C4:.+]] = constant 4 : index
+  //  CHECK-DAG: %[[C8:.+]] = constant 8 : index
+  //  CHECK-DAG: %[[C16:.+]] = constant 16 : index
+  //  CHECK-DAG: %[[C64:.+]] = constant 64 : index
+  //  CHECK-DAG: %[[C128:.+]] = constant 128 : index
+  //  CHECK-DAG: %[[C256:.+]] = constant 256 : index
+  //  CHECK-DAG: %[[C512:.+]] = constant 512 : index
+  //  CHECK-NOT: linalg.matmul
+  //      CHECK: scf.for %{{.+}} = %{{.+}} to %[[C128]] step %[[C64]]
+  //      CHECK:   scf.for %{{.+}} = %{{.+}} to %[[C256]] step %[[C64]]
+  //      CHECK:     scf.for %{{.+}} = %{{.+}} to %[[C512]] step %[[C256]]
+  //      CHECK:       scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C4]]
+  //      CHECK:         scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C16]]
+  //      CHECK:           scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C8]]
+  //  CHECK-NOT: vector.contract
+  //      CHECK:             vector.
+  //  CHECK-NOT: linalg.matmul
+  //  CHECK-NOT: vector.contract
+  //  CHECK-NOT: __internal_linalg_transform__
+
+  // The register tiles are promoted into full 4x8, 8x16 and 4x16 buffers and
+  // contracted as a whole.
+  //      VECTOR: scf.for
+  //      VECTOR:   scf.for
+  //      VECTOR:     scf.for
+  //      VECTOR:       scf.for
+  //      VECTOR:         scf.for
+  //      VECTOR:           scf.for
+  //  VECTOR-DAG:             view {{.+}} to memref<4x8xf32>
+  //  VECTOR-DAG:             view {{.+}} to memref<8x16xf32>
+  //  VECTOR-DAG:             view {{.+}} to memref<4x16xf32>
+  //      VECTOR:             %[[LHS:.+]] = vector.transfer_read {{.+}} : memref<4x8xf32>, vector<4x8xf32>
+  //      VECTOR:             %[[RHS:.+]] = vector.transfer_read {{.+}} : memref<8x16xf32>, vector<8x16xf32>
+  //      VECTOR:             %[[ACC:.+]] = vector.transfer_read {{.+}} : memref<4x16xf32>, vector<4x16xf32>
+  //      VECTOR:             %[[RES:.+]] = vector.contract {{.+}} %[[LHS]], %[[RHS]], %[[ACC]]
+  // VECTOR-SAME:               vector<4x8xf32>, vector<8x16xf32> into vector<4x16xf32>
+  //      VECTOR:             vector.transfer_write %[[RES]], {{.+}} : vector<4x16xf32>, memref<4x16xf32>
+  //  VECTOR-NOT: linalg.matmul
+  linalg.matmul(%lhs, %rhs, %result) :
+    memref<128x512xf32>, memref<512x256xf32>, memref<128x256xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @elementwise_untouched
+func @elementwise_untouched(%arg0: memref<4x8xf32>, %arg1: memref<4x8xf32>) {
+  // CHECK: linalg.generic
+  linalg.generic
+    {args_in = 1 : i64, args_out = 1 : i64,
+     indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                      affine_map<(d0, d1) -> (d0, d1)>],
+     iterator_types = ["parallel", "parallel"]} %arg0, %arg1 {
+  ^bb0(%arg2: f32, %arg3: f32):
+    %0 = addf %arg2, %arg2 : f32
+    linalg.yield %0 : f32
+  }: memref<4x8xf32>, memref<4x8xf32>
+  return
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+
+// CHECK-LABEL: func @matmul_bias_add
+func @matmul_bias_add(%lhs: memref<128x512xf32>, %rhs: memref<512x256xf32>,
+                      %bias: memref<128x256xf32>,
+                      %result: memref<128x256xf32>) {
+  %zero = constant 0.0 : f32
+  %temp = alloc() : memref<128x256xf32>
+  //  CHECK-NOT: linalg.fill(%{{.+}}, %{{.+}}) : memref<128x256xf32>
+  //  CHECK-NOT: linalg.matmul
+  //      CHECK: scf.for
+  //      CHECK:   scf.for
+  //      CHECK:     linalg.fill
+  //      CHECK:     vector.
+  //      CHECK:     linalg.generic
+  //  CHECK-NOT: __internal_linalg_transform__
+  linalg.fill(%temp, %zero) : memref<128x256xf32>, f32
+  linalg.matmul(%lhs, %rhs, %temp) :
+    memref<128x512xf32>, memref<512x256xf32>, memref<128x256xf32>
+  linalg.generic
+    {args_in = 2 : i64, args_out = 1 : i64,
+     indexing_maps = [#map0, #map0, #map0],
+     iterator_types = ["parallel", "parallel"]} %temp, %bias, %result {
+  ^bb0(%arg0: f32, %arg1: f32, %arg2: f32):
+    %0 = addf %arg0, %arg1 : f32
+    linalg.yield %0 : f32
+  }: memref<128x256xf32>, memref<128x256xf32>, memref<128x256xf32>
+  dealloc %temp : memref<128x256xf32>
+  return
+}
@@ -27,6 +27,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/Attributes.h"
@@ -49,6 +50,13 @@ namespace iree_compiler {
 namespace IREE {
 namespace Flow {
 
+static llvm::cl::opt<bool> fuseElementwiseEpiloguesFlag{
+    "iree-flow-fuse-elementwise-epilogues",
+    llvm::cl::desc("Fuses elementwise consumers (bias add, activations, etc) "
+                   "of matmuls and convolutions into their dispatch regions"),
+    llvm::cl::init(false),
+};
+
 namespace {
 
 // Returns true if the given |op| can be dispatched in all cases.
@@ -162,11 +170,53 @@ bool isFusableOp(Operation *op) {
   return true;
 }
 
+// Returns true if |op| is a matmul or convolution that is lowered by backends
+// as a standalone tiled kernel.
+bool isContractionOp(Operation *op) {
+  // TODO(b/144530470): replace with tablegen attributes/interfaces.
+  return isa<xla_hlo::DotOp>(op) || isa<xla_hlo::ConvOp>(op);
+}
+
+// Returns true if the given |op| is elementwise, i.e. each element of the
+// result only depends on the elements of the operands at the same index.
+bool isElementwiseOp(Operation *op) {
+  if (op->getNumResults() != 1 || op->getNumRegions() != 0) return false;
+  return op->hasTrait<OpTrait::SameOperandsAndResultShape>() ||
+         op->hasTrait<OpTrait::SameOperandsAndResultType>();
+}
+
+// Returns true if the contraction |producerOp| can be fused into the dispatch
+// region of its elementwise |consumerOp| as a prologue. This allows backends
+// to apply the epilogue (bias add, activation, requantization, etc) to each
+// tile of the contraction result while it is still resident in cache instead
+// of making a full round trip through memory in a separate dispatch.
+//
+// Only a single contraction is fused into each region and nothing producing
+// the contraction inputs is, keeping the contraction the first op executed.
+//
+// Preconditions: isDispatchableOp(producerOp) == true.
+bool isFusableEpilogueProducerOp(Operation *producerOp, Operation *consumerOp,
+                                 const llvm::SetVector<Operation *> &subgraph) {
+  if (!fuseElementwiseEpiloguesFlag) return false;
+  if (!isContractionOp(producerOp) || !isElementwiseOp(consumerOp)) {
+    return false;
+  }
+  if (llvm::any_of(subgraph, isContractionOp)) return false;
+  // The workload of the region is derived from the root op so the epilogue
+  // must cover the contraction result exactly.
+  auto producerType = producerOp->getResult(0).getType().dyn_cast<ShapedType>();
+  auto consumerType = consumerOp->getResult(0).getType().dyn_cast<ShapedType>();
+  return producerType && consumerType && producerType.hasStaticShape() &&
+         producerType.getShape() == consumerType.getShape();
+}
+
 // Recursively traverses the IR DAG along the operand edges to find ops we are
-// able to fuse and appends them to |subgraph|.
+// able to fuse and appends them to |subgraph|. When |gatherOperands| is false
+// only |op| (and its |metadataOps|) are added.
 void gatherFusionOps(Operation *op, Dispatchability &dispatchability,
                      llvm::ArrayRef<Operation *> metadataOps,
-                     llvm::SetVector<Operation *> *subgraph) {
+                     llvm::SetVector<Operation *> *subgraph,
+                     bool gatherOperands = true) {
   // Skip ops that are used outside of the subgraph we are building.
   for (auto result : op->getResults()) {
     if (result.use_empty() || result.hasOneUse()) continue;
@@ -181,26 +231,33 @@ void gatherFusionOps(Operation *op, Dispatchability &dispatchability,
   }
 
   // Walk backward up to ops providing our input operands.
-  for (auto operand : op->getOperands()) {
-    auto *sourceOp = operand.getDefiningOp();
-
-    // Scan any intermediate "metadata" ops which should be included iff they
-    // are between the starting op and a viable target op.
-    llvm::SmallVector<Operation *, 1> nextMetadataOps;
-    while (sourceOp) {
-      if (auto tieShapeOp = llvm::dyn_cast<Shape::TieShapeOp>(sourceOp)) {
-        nextMetadataOps.push_back(tieShapeOp);
-        sourceOp = tieShapeOp.operand().getDefiningOp();
-        continue;
+  if (gatherOperands) {
+    for (auto operand : op->getOperands()) {
+      auto *sourceOp = operand.getDefiningOp();
+
+      // Scan any intermediate "metadata" ops which should be included iff they
+      // are between the starting op and a viable target op.
+      llvm::SmallVector<Operation *, 1> nextMetadataOps;
+      while (sourceOp) {
+        if (auto tieShapeOp = llvm::dyn_cast<Shape::TieShapeOp>(sourceOp)) {
+          nextMetadataOps.push_back(tieShapeOp);
+          sourceOp = tieShapeOp.operand().getDefiningOp();
+          continue;
+        }
+        break;
       }
-      break;
-    }
-    if (!sourceOp) continue;
-
-    if (subgraph->count(sourceOp) == 0) {
-      if (isDispatchableOp(sourceOp, dispatchability) &&
-          isFusableOp(sourceOp)) {
-        gatherFusionOps(sourceOp, dispatchability, nextMetadataOps, subgraph);
+      if (!sourceOp) continue;
+
+      if (subgraph->count(sourceOp) == 0 &&
+          isDispatchableOp(sourceOp, dispatchability)) {
+        if (isFusableOp(sourceOp)) {
+          gatherFusionOps(sourceOp, dispatchability, nextMetadataOps, subgraph);
+        } else if (isFusableEpilogueProducerOp(sourceOp, op, *subgraph)) {
+          LLVM_DEBUG(llvm::dbgs() << "  : Fuse epilogue into producer: "
+                                  << sourceOp->getName() << "\n");
+          gatherFusionOps(sourceOp, dispatchability, nextMetadataOps, subgraph,
+                          /*gatherOperands=*/false);
+        }
       }
     }
   }
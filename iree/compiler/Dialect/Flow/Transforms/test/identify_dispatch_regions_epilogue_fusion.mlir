@@ -0,0 +1,76 @@
+// RUN: iree-opt -split-input-file -iree-flow-dispatchability-analysis -iree-flow-identify-dispatch-regions -iree-flow-fuse-elementwise-epilogues %s | IreeFileCheck %s
+
+// CHECK-LABEL: @dotBiasRelu
+func @dotBiasRelu(%arg0 : tensor<4x8xf32>, %arg1 : tensor<8x16xf32>,
+                  %arg2 : tensor<4x16xf32>, %arg3 : tensor<4x16xf32>) -> tensor<4x16xf32> {
+  // CHECK: %[[WORKLOAD:.+]] = constant 64 : index
+  // CHECK: %[[R0:.+]] = flow.dispatch.region
+  // CHECK-SAME: [%[[WORKLOAD]] : index]
+  // CHECK-SAME: (%arg4 = %arg0 : tensor<4x8xf32>, %arg5 = %arg1 : tensor<8x16xf32>, %arg6 = %arg2 : tensor<4x16xf32>, %arg7 = %arg3 : tensor<4x16xf32>) -> tensor<4x16xf32> {
+  // CHECK-NEXT:   %1 = "xla_hlo.dot"(%arg4, %arg5)
+  %0 = "xla_hlo.dot"(%arg0, %arg1) : (tensor<4x8xf32>, tensor<8x16xf32>) -> tensor<4x16xf32>
+  // CHECK-NEXT:   %2 = xla_hlo.add %1, %arg6 : tensor<4x16xf32>
+  %1 = xla_hlo.add %0, %arg2 : tensor<4x16xf32>
+  // CHECK-NEXT:   %3 = xla_hlo.maximum %2, %arg7 : tensor<4x16xf32>
+  %2 = xla_hlo.maximum %1, %arg3 : tensor<4x16xf32>
+  // CHECK-NEXT:   flow.return %3 : tensor<4x16xf32>
+  // CHECK-NEXT: }
+  // CHECK-NEXT: return %[[R0]] : tensor<4x16xf32>
+  return %2 : tensor<4x16xf32>
+}
+
+// -----
+
+// Producers of the contraction inputs are not fused.
+
+// CHECK-LABEL: @dotPrologueNotFused
+func @dotPrologueNotFused(%arg0 : tensor<4x4xf32>) -> tensor<4x4xf32> {
+  // CHECK: %[[R0:.+]] = flow.dispatch.region
+  // CHECK-NEXT:   xla_hlo.add
+  // CHECK-NEXT:   flow.return
+  %0 = xla_hlo.add %arg0, %arg0 : tensor<4x4xf32>
+  // CHECK: %[[R1:.+]] = flow.dispatch.region
+  // CHECK-SAME: (%arg1 = %[[R0]] : tensor<4x4xf32>, %arg2 = %arg0 : tensor<4x4xf32>)
+  // CHECK-NEXT:   "xla_hlo.dot"
+  %1 = "xla_hlo.dot"(%0, %arg0) : (tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+  // CHECK-NEXT:   xla_hlo.multiply
+  %2 = xla_hlo.multiply %1, %arg0 : tensor<4x4xf32>
+  // CHECK-NEXT:   flow.return
+  // CHECK-NEXT: }
+  // CHECK-NEXT: return %[[R1]] : tensor<4x4xf32>
+  return %2 : tensor<4x4xf32>
+}
+
+// -----
+
+// Contraction results with multiple uses stay in their own dispatch region.
+
+// CHECK-LABEL: @dotMultipleUses
+func @dotMultipleUses(%arg0 : tensor<4x4xf32>) -> (tensor<4x4xf32>, tensor<4x4xf32>) {
+  // CHECK: %[[R0:.+]] = flow.dispatch.region
+  // CHECK-NEXT:   "xla_hlo.dot"
+  // CHECK-NEXT:   flow.return
+  %0 = "xla_hlo.dot"(%arg0, %arg0) : (tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+  // CHECK: flow.dispatch.region
+  // CHECK-SAME: %[[R0]]
+  // CHECK-NEXT:   xla_hlo.add
+  %1 = xla_hlo.add %0, %arg0 : tensor<4x4xf32>
+  return %0, %1 : tensor<4x4xf32>, tensor<4x4xf32>
+}
+
+// -----
+
+// Consumers that change the shape are not fused.
+
+// CHECK-LABEL: @dotReshapeNotFused
+func @dotReshapeNotFused(%arg0 : tensor<4x4xf32>) -> tensor<16xf32> {
+  // CHECK: %[[R0:.+]] = flow.dispatch.region
+  // CHECK-NEXT:   "xla_hlo.dot"
+  // CHECK-NEXT:   flow.return
+  %0 = "xla_hlo.dot"(%arg0, %arg0) : (tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+  // CHECK: flow.dispatch.region
+  // CHECK-SAME: %[[R0]]
+  // CHECK-NEXT:   xla_hlo.reshape
+  %1 = "xla_hlo.reshape"(%0) : (tensor<4x4xf32>) -> tensor<16xf32>
+  return %1 : tensor<16xf32>
+}
@@ -23,7 +23,9 @@
 #include "iree/compiler/Dialect/IREE/IR/IREETypes.h"
 #include "iree/compiler/Dialect/Shape/IR/ShapeOps.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
@@ -67,6 +69,54 @@ static bool isNoOp(Operation *op) { return isa<Shape::MakeRankedShapeOp>(op); }
 // identity.
 static bool isIdentityOp(Operation *op) { return isa<Shape::TieShapeOp>(op); }
 
+// Execution order of the commands within a stream.
+//
+// Commands are assigned to levels such that each command only depends on
+// commands in earlier levels. Commands within a level are independent and may
+// execute concurrently, so barriers are only required between levels.
+struct StreamSchedule {
+  // Level of each command op.
+  DenseMap<Operation *, int64_t> commandLevels;
+  // Commands grouped by level, each in stream order.
+  SmallVector<SmallVector<Operation *, 4>, 4> levels;
+};
+
+// Builds the |schedule| for the commands in |streamBlock| from the SSA use-def
+// chains of the tensors they read and write. Each command is placed in the
+// level after the latest command producing any of its operands.
+static LogicalResult buildStreamSchedule(Block &streamBlock,
+                                         StreamSchedule &schedule) {
+  // Level of the command producing each value; identity ops forward the level
+  // of their operand and values from outside of the stream are not present.
+  DenseMap<Value, int64_t> valueLevels;
+  for (auto &op : streamBlock) {
+    if (isIdentityOp(&op)) {
+      auto it = valueLevels.find(op.getOperand(0));
+      if (it != valueLevels.end()) valueLevels[op.getResult(0)] = it->second;
+      continue;
+    } else if (isNoOp(&op) || isa<IREE::Flow::ReturnOp>(op)) {
+      continue;
+    } else if (!isa<IREE::Flow::DispatchOp>(op) &&
+               !isa<IREE::Flow::TensorUpdateOp>(op)) {
+      return op.emitOpError() << "unexpected in stream";
+    }
+    int64_t level = 0;
+    for (auto operand : op.getOperands()) {
+      auto it = valueLevels.find(operand);
+      if (it != valueLevels.end()) level = std::max(level, it->second + 1);
+    }
+    for (auto result : op.getResults()) {
+      valueLevels[result] = level;
+    }
+    schedule.commandLevels[&op] = level;
+    if (static_cast<int64_t>(schedule.levels.size()) <= level) {
+      schedule.levels.resize(level + 1);
+    }
+    schedule.levels[level].push_back(&op);
+  }
+  return success();
+}
+
 // Allocates a buffer for the given stream output value.
 // |streamValue| is the Value used within the stream region and
 // |externalValue| is the returned value from the stream region in the parent
@@ -128,10 +178,29 @@ static void allocateOutputBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
   }
 }
 
-// Allocates a transient buffer for use entirely within the command buffer.
-static Value allocateTransientBuffer(Value streamValue, Value allocator,
-                                     ConversionPatternRewriter &rewriter) {
-  Location loc = streamValue.getLoc();
+// Alignment of each transient value within the stream transient slab. This is
+// the largest minStorageBufferOffsetAlignment permitted by Vulkan and as such
+// allows binding subranges of the slab on all backends.
+constexpr int64_t kTransientBufferAlignment = 256;
+
+// A transient value with a static size that is planned into the stream
+// transient slab.
+struct TransientValue {
+  Value value;
+  int64_t byteLength = 0;
+  // Live range as levels of the stream schedule, inclusive. Values are live
+  // across the entire level of their last use as commands within a level may
+  // execute concurrently.
+  int64_t start = 0;
+  int64_t end = 0;
+  int64_t byteOffset = 0;
+};
+
+// Allocates device-local storage for transients used entirely within the
+// command buffer.
+static Value allocateTransientStorage(Location loc, Value allocator,
+                                      Value allocationSize,
+                                      ConversionPatternRewriter &rewriter) {
   // TODO(benvanik): compute from SSA use-def chain uses.
   IREE::HAL::MemoryTypeBitfield memoryTypes =
       IREE::HAL::MemoryTypeBitfield::DeviceLocal;
@@ -139,6 +208,23 @@ static Value allocateTransientBuffer(Value streamValue, Value allocator,
       IREE::HAL::BufferUsageBitfield::Dispatch |
       IREE::HAL::BufferUsageBitfield::Transfer;
 
+  auto buffer =
+      rewriter
+          .create<IREE::HAL::AllocatorAllocateOp>(loc, allocator, memoryTypes,
+                                                  bufferUsage, allocationSize)
+          .getResult();
+
+  // TODO(benvanik): implement resource sets.
+  rewriter.create<IREE::HAL::ExDeferReleaseOp>(loc, buffer);
+
+  return buffer;
+}
+
+// Allocates a transient buffer for use entirely within the command buffer.
+static Value allocateTransientBuffer(Value streamValue, Value allocator,
+                                     ConversionPatternRewriter &rewriter) {
+  Location loc = streamValue.getLoc();
+
   // Compute the allocation size for the value.
   auto elementType = IREE::HAL::getElementTypeValue(
       streamValue.getType().cast<ShapedType>().getElementType());
@@ -154,25 +240,116 @@ static Value allocateTransientBuffer(Value streamValue, Value allocator,
                                 loc, allocator, *shape, elementType.getValue())
                             .getResult();
 
-  auto buffer =
-      rewriter
-          .create<IREE::HAL::AllocatorAllocateOp>(loc, allocator, memoryTypes,
-                                                  bufferUsage, allocationSize)
-          .getResult();
+  return allocateTransientStorage(loc, allocator, allocationSize, rewriter);
+}
 
-  // TODO(benvanik): implement resource sets.
-  rewriter.create<IREE::HAL::ExDeferReleaseOp>(loc, buffer);
+// Returns the byte length of |value| if its shape is static. This matches the
+// dense layout computed by hal.allocator.compute_size.
+static Optional<int64_t> computeStaticByteLength(Value value) {
+  auto shapedType = value.getType().cast<ShapedType>();
+  if (!shapedType.hasStaticShape() ||
+      !shapedType.getElementType().isIntOrFloat()) {
+    return llvm::None;
+  }
+  return shapedType.getNumElements() *
+         IREE::HAL::getRoundedElementByteWidth(shapedType.getElementType());
+}
 
-  return buffer;
+// Returns the level of the last command within the stream that uses |value|,
+// including through any identity ops that alias it.
+static int64_t computeLastUse(Value value, const StreamSchedule &schedule) {
+  int64_t lastUse = schedule.commandLevels.lookup(value.getDefiningOp());
+  SmallVector<Value, 4> worklist{value};
+  while (!worklist.empty()) {
+    Value aliasValue = worklist.pop_back_val();
+    for (auto *user : aliasValue.getUsers()) {
+      if (isIdentityOp(user)) {
+        worklist.push_back(user->getResult(0));
+      } else {
+        lastUse = std::max(lastUse, schedule.commandLevels.lookup(user));
+      }
+    }
+  }
+  return lastUse;
+}
+
+// Assigns offsets to |values| and returns the total slab size required.
+// Values are placed largest first at the lowest offset that does not overlap
+// any already-placed value with an intersecting live range.
+static int64_t assignTransientOffsets(MutableArrayRef<TransientValue> values) {
+  SmallVector<TransientValue *, 8> order;
+  for (auto &value : values) order.push_back(&value);
+  llvm::stable_sort(order, [](TransientValue *lhs, TransientValue *rhs) {
+    return lhs->byteLength > rhs->byteLength;
+  });
+
+  int64_t totalLength = 0;
+  SmallVector<TransientValue *, 8> placed;
+  for (auto *value : order) {
+    // Gather the conflicting values sorted by offset and take the first gap
+    // large enough to fit.
+    SmallVector<TransientValue *, 8> conflicts;
+    for (auto *other : placed) {
+      if (other->start <= value->end && value->start <= other->end) {
+        conflicts.push_back(other);
+      }
+    }
+    llvm::sort(conflicts, [](TransientValue *lhs, TransientValue *rhs) {
+      return lhs->byteOffset < rhs->byteOffset;
+    });
+    int64_t offset = 0;
+    for (auto *other : conflicts) {
+      if (offset + value->byteLength <= other->byteOffset) break;
+      offset = std::max(offset, static_cast<int64_t>(llvm::alignTo(
+                                    other->byteOffset + other->byteLength,
+                                    kTransientBufferAlignment)));
+    }
+    value->byteOffset = offset;
+    totalLength = std::max(totalLength, offset + value->byteLength);
+    placed.push_back(value);
+  }
+  return totalLength;
+}
+
+// Allocates a single slab for all of the statically-sized |values| and maps
+// each value to a subspan of it. Values with disjoint lifetimes share memory.
+static void allocateTransientSlab(MutableArrayRef<TransientValue> values,
+                                  Location loc, BufferSet &bufferSet,
+                                  ConversionPatternRewriter &rewriter) {
+  if (values.empty()) return;
+  int64_t slabLength = assignTransientOffsets(values);
+  auto slab = allocateTransientStorage(
+      loc, bufferSet.allocator,
+      rewriter.createOrFold<mlir::ConstantIndexOp>(loc, slabLength), rewriter);
+  for (auto &value : values) {
+    Location valueLoc = value.value.getLoc();
+    auto buffer = rewriter.createOrFold<IREE::HAL::BufferSubspanOp>(
+        valueLoc, slab.getType(), slab,
+        rewriter.createOrFold<mlir::ConstantIndexOp>(valueLoc,
+                                                     value.byteOffset),
+        rewriter.createOrFold<mlir::ConstantIndexOp>(valueLoc,
+                                                     value.byteLength));
+    bufferSet.rangeMap[value.value] = BufferRange{buffer};
+  }
 }
 
 // Allocates transient buffers to store the intra-stream results and populates
 // the |bufferSet| with the new mappings.
+//
+// Transients with static shapes are packed into a single slab based on their
+// lifetimes within the stream |schedule| such that values that are never live
+// at the same time reuse the same memory. As all commands reading a value
+// complete before the barrier preceding the next level this introduces no
+// additional dependencies. Dynamically-shaped transients are allocated
+// individually.
 static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
+                                     const StreamSchedule &schedule,
                                      BufferSet &bufferSet,
                                      ConversionPatternRewriter &rewriter) {
+  auto &block = streamOp.body().front();
+
   // Pull outputs that terminate on identities to operands.
-  for (auto &op : llvm::reverse(streamOp.body().front())) {
+  for (auto &op : llvm::reverse(block)) {
     if (isIdentityOp(&op)) {
       auto result = op.getResult(0);
       auto operand = op.getOperand(0);
@@ -183,8 +360,33 @@ static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
     }
   }
 
-  // Push inputs that originate on identities to results.
-  for (auto &op : streamOp.body().front()) {
+  // Allocate any remaining transients on "active" ops.
+  SmallVector<TransientValue, 8> slabValues;
+  for (auto &op : block) {
+    if (isNoOp(&op) || isIdentityOp(&op)) continue;
+    for (auto result : op.getResults()) {
+      // If the result is an output buffer we can just use that directly.
+      if (bufferSet.rangeMap[result].buffer) continue;
+
+      auto byteLength = computeStaticByteLength(result);
+      if (!byteLength) {
+        auto buffer =
+            allocateTransientBuffer(result, bufferSet.allocator, rewriter);
+        bufferSet.rangeMap[result] = BufferRange{buffer};
+        continue;
+      }
+      TransientValue value;
+      value.value = result;
+      value.byteLength = *byteLength;
+      value.start = schedule.commandLevels.lookup(&op);
+      value.end = computeLastUse(result, schedule);
+      slabValues.push_back(value);
+    }
+  }
+  allocateTransientSlab(slabValues, streamOp.getLoc(), bufferSet, rewriter);
+
+  // Push inputs and transients that originate on identities to results.
+  for (auto &op : block) {
     if (isIdentityOp(&op)) {
       auto operand = op.getOperand(0);
       auto result = op.getResult(0);
@@ -194,19 +396,6 @@ static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
       }
     }
   }
-
-  // Allocate any remaining transients on "active" ops.
-  for (auto &op : streamOp.body().front()) {
-    if (isNoOp(&op) || isIdentityOp(&op)) continue;
-    for (auto result : op.getResults()) {
-      // If the result is an output buffer we can just use that directly.
-      if (bufferSet.rangeMap[result].buffer) continue;
-
-      auto buffer =
-          allocateTransientBuffer(result, bufferSet.allocator, rewriter);
-      bufferSet.rangeMap[result] = BufferRange{buffer};
-    }
-  }
 }
 
 // Records a full execution barrier that forces visibility of all buffers.
@@ -416,11 +605,6 @@ static LogicalResult recordDispatch(Value device, Value commandBuffer,
     }
   }
   switchBuilder.build();
-
-  // Full barriers for now as we aren't scheduling things.
-  // TODO(benvanik): don't add at the end of the command buffer (we could
-  // also do a canonicalization step that removed trailing barriers).
-  recordFullExecutionBarrier(commandBuffer, dispatchOp.getLoc(), rewriter);
   return success();
 }
 
@@ -478,36 +662,33 @@ static LogicalResult recordTensorUpdate(Value device, Value commandBuffer,
                                                update->getBuffer());
   rewriter.create<IREE::HAL::ExDeferReleaseOp>(updateOp.getLoc(),
                                                result->getBuffer());
-
-  // Full barriers for now as we aren't scheduling things.
-  // TODO(benvanik): don't add at the end of the command buffer (we could
-  // also do a canonicalization step that removed trailing barriers).
-  recordFullExecutionBarrier(commandBuffer, updateOp.getLoc(), rewriter);
   return success();
 }
 
+// Records the stream commands in |schedule| order. Execution barriers are
+// only recorded between levels, allowing the independent commands within a
+// level to execute concurrently.
 static LogicalResult recordStreamCommands(Value device, Value commandBuffer,
-                                          Block &streamBlock,
+                                          const StreamSchedule &schedule,
                                           BufferSet &bufferSet,
                                           ConversionPatternRewriter &rewriter) {
-  for (auto &op : streamBlock) {
-    if (auto dispatchOp = dyn_cast<IREE::Flow::DispatchOp>(op)) {
-      if (failed(recordDispatch(device, commandBuffer, dispatchOp, bufferSet,
-                                rewriter))) {
-        return failure();
-      }
-    } else if (auto updateOp = dyn_cast<IREE::Flow::TensorUpdateOp>(op)) {
-      if (failed(recordTensorUpdate(device, commandBuffer, updateOp, bufferSet,
-                                    rewriter))) {
-        return failure();
+  for (auto level : llvm::enumerate(schedule.levels)) {
+    if (level.index() > 0) {
+      recordFullExecutionBarrier(commandBuffer, level.value().front()->getLoc(),
+                                 rewriter);
+    }
+    for (auto *op : level.value()) {
+      if (auto dispatchOp = dyn_cast<IREE::Flow::DispatchOp>(op)) {
+        if (failed(recordDispatch(device, commandBuffer, dispatchOp, bufferSet,
+                                  rewriter))) {
+          return failure();
+        }
+      } else if (auto updateOp = dyn_cast<IREE::Flow::TensorUpdateOp>(op)) {
+        if (failed(recordTensorUpdate(device, commandBuffer, updateOp,
+                                      bufferSet, rewriter))) {
+          return failure();
+        }
       }
-    } else if (auto returnOp = dyn_cast<IREE::Flow::ReturnOp>(op)) {
-      // No-op; handled by the buffer allocation.
-    } else if (isNoOp(&op) || isIdentityOp(&op)) {
-      // No work to perform. For identity ops, all buffers have been pushed
-      // to "real" ops.
-    } else {
-      return op.emitOpError() << "unexpected in stream";
     }
   }
   return success();
@@ -526,9 +707,16 @@ class ExStreamFragmentOpConversion
     auto category = IREE::HAL::CommandCategoryBitfield::Dispatch |
                     IREE::HAL::CommandCategoryBitfield::Transfer;
 
+    // Order the commands by their dependencies. Both buffer allocation and
+    // barrier placement are derived from the schedule.
+    auto &entryBlock = streamOp.body().front();
+    StreamSchedule schedule;
+    if (failed(buildStreamSchedule(entryBlock, schedule))) {
+      return failure();
+    }
+
     // We'll use this buffer set to track the original and converted tensors
-    // and buffers during conversion. Ideally we'd run some fancy allocation
-    // analysis first to produce it.
+    // and buffers during conversion.
     auto device =
         rewriter.createOrFold<IREE::HAL::ExSharedDeviceOp>(streamOp.getLoc());
     auto allocator =
@@ -537,7 +725,6 @@ class ExStreamFragmentOpConversion
     BufferSet bufferSet{allocator};
 
     // Remap non-tensor operands (such as workloads).
-    auto &entryBlock = streamOp.body().front();
     for (int i = 0; i < operands.size(); ++i) {
       if (streamOp.getOperand(i).getType().isa<TensorType>()) {
         bufferSet.rangeMap[entryBlock.getArgument(i)] =
@@ -550,7 +737,7 @@ class ExStreamFragmentOpConversion
 
     // Allocate buffers for outputs and transient buffers.
     allocateOutputBuffers(streamOp, bufferSet, rewriter);
-    allocateTransientBuffers(streamOp, bufferSet, rewriter);
+    allocateTransientBuffers(streamOp, schedule, bufferSet, rewriter);
 
     // Allocate and begin the command buffer.
     // In a real version we would want to pick the device based on the placement
@@ -562,18 +749,18 @@ class ExStreamFragmentOpConversion
                                                      commandBuffer);
 
     // Record all of the commands into the command buffer.
-    if (failed(recordStreamCommands(device, commandBuffer, entryBlock,
-                                    bufferSet, rewriter))) {
+    if (failed(recordStreamCommands(device, commandBuffer, schedule, bufferSet,
+                                    rewriter))) {
       return failure();
     }
 
-    // End and submit the command buffer.
-    // In a real version we'd want to setup a semaphore chain instead of
-    // submitting and waiting.
+    // End and submit the command buffer without waiting for it to complete.
+    // Waits are inserted by -iree-hal-insert-stream-waits prior to any host
+    // access of the results.
     rewriter.create<IREE::HAL::CommandBufferEndOp>(streamOp.getLoc(),
                                                    commandBuffer);
-    rewriter.create<IREE::HAL::ExSubmitAndWaitOp>(streamOp.getLoc(), device,
-                                                  commandBuffer);
+    rewriter.create<IREE::HAL::ExSubmitOp>(streamOp.getLoc(), device,
+                                           commandBuffer);
 
     // It's annoying, but we need to do this replacement at the very end as
     // otherwise we lose access to the original values (which we need for
@@ -22,31 +22,127 @@ func @multipleDispatches(%arg0: tensor<128xf32>) -> tensor<128xf32> {
   %cst = constant 128 : index
   // CHECK: %[[RET_BUF:.+]] = hal.allocator.allocate {{.+}}, "HostVisible|DeviceVisible|DeviceLocal", "Constant|Transfer|Mapping|Dispatch"
   // CHECK-NEXT: hal.ex.defer_release %[[RET_BUF]]
-  // CHECK: %[[TMP_BUF:.+]] = hal.allocator.allocate {{.+}}, "DeviceVisible|DeviceLocal", "Transfer|Dispatch"
-  // CHECK-NEXT: hal.ex.defer_release %[[TMP_BUF]]
+  // CHECK: %[[SLAB:.+]] = hal.allocator.allocate {{.+}}, "DeviceVisible|DeviceLocal", "Transfer|Dispatch", %c512
+  // CHECK-NEXT: hal.ex.defer_release %[[SLAB]]
+  // CHECK-NEXT: %[[TMP_BUF:.+]] = hal.buffer.subspan %[[SLAB]], %[[C0]], %c512
   // CHECK: %[[CMD:.+]] = hal.command_buffer.create {{.+}}, "OneShot", "Transfer|Dispatch"
   // CHECK-NEXT: hal.command_buffer.begin %[[CMD]]
   %0 = flow.ex.stream.fragment(%arg1 = %cst : index, %arg2 = %arg0 : tensor<128xf32>) -> tensor<128xf32> {
     //  CHECK-DAG: %[[EXE:.+]] = hal.executable.lookup {{.+}}, @ex0 : !hal.executable
     //  CHECK-DAG: %[[EXE_LAYOUT:.+]] = hal.executable_layout.lookup
-    //      CHECK: hal.command_buffer.push_descriptor_set %[[CMD]], %[[EXE_LAYOUT]], set=0, bindings=[0 = (%arg0, %c0, %sz_3), 1 = (%buffer_1, %c0, %sz_4)]
+    //      CHECK: hal.command_buffer.push_descriptor_set %[[CMD]], %[[EXE_LAYOUT]], set=0, bindings=[0 = (%arg0, %[[C0]], %{{.+}}), 1 = (%[[TMP_BUF]], %[[C0]], %{{.+}})]
     //      CHECK: hal.command_buffer.dispatch {{.+}}, entry_point = 0, workgroup_xyz
     //      CHECK: hal.command_buffer.execution_barrier
     %1 = flow.dispatch @ex0::@entry0[%arg1 : index](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
     //      CHECK: hal.command_buffer.push_descriptor_set
     //      CHECK: hal.command_buffer.dispatch {{.+}}, entry_point = 0, workgroup_xyz
-    //      CHECK: hal.command_buffer.execution_barrier
+    //  CHECK-NOT: hal.command_buffer.execution_barrier
     %2 = flow.dispatch @ex0::@entry0[%arg1 : index](%1) : (tensor<128xf32>) -> tensor<128xf32>
     flow.return %2 : tensor<128xf32>
   }
   // CHECK: hal.command_buffer.end %[[CMD]]
-  // CHECK-NEXT: hal.ex.submit_and_wait {{.+}}, %[[CMD]]
+  // CHECK-NEXT: hal.ex.submit {{.+}}, %[[CMD]]
   // CHECK-NEXT: return %[[RET_BUF]]
   return %0 : tensor<128xf32>
 }
 
 // -----
 
+hal.executable @ex0 {
+  hal.interface @interface {
+    hal.interface.binding @s0b0, set=0, binding=0, type="StorageBuffer", access="Read"
+    hal.interface.binding @s0b1, set=0, binding=1, type="StorageBuffer", access="Read|Write"
+  }
+  hal.executable.entry_point @entry0 attributes {
+    interface = @interface,
+    ordinal = 0 : i32,
+    signature = (tensor<128xf32>) -> tensor<128xf32>
+  }
+  hal.executable.target "vmla" {
+    module {}
+  }
+}
+
+// Transients with disjoint lifetimes share memory within a single slab: %2
+// overlaps both %1 and %3 but %3 can reuse the memory of %1.
+// CHECK-LABEL: func @transientSlab
+func @transientSlab(%arg0: tensor<128xf32>) -> tensor<128xf32> {
+  // CHECK-DAG: %[[C0:.+]] = constant 0 : index
+  // CHECK-DAG: %[[C512:.+]] = constant 512 : index
+  // CHECK-DAG: %[[C1024:.+]] = constant 1024 : index
+  %cst = constant 128 : index
+  // CHECK: %[[SLAB:.+]] = hal.allocator.allocate {{.+}}, "DeviceVisible|DeviceLocal", "Transfer|Dispatch", %[[C1024]]
+  // CHECK-NEXT: hal.ex.defer_release %[[SLAB]]
+  // CHECK-NEXT: %[[BUF1:.+]] = hal.buffer.subspan %[[SLAB]], %[[C0]], %[[C512]]
+  // CHECK-NEXT: %[[BUF2:.+]] = hal.buffer.subspan %[[SLAB]], %[[C512]], %[[C512]]
+  // CHECK-NEXT: %[[BUF3:.+]] = hal.buffer.subspan %[[SLAB]], %[[C0]], %[[C512]]
+  // CHECK-NOT: hal.allocator.allocate
+  %0 = flow.ex.stream.fragment(%arg1 = %cst : index, %arg2 = %arg0 : tensor<128xf32>) -> tensor<128xf32> {
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%arg0, %[[C0]], %{{.+}}), 1 = (%[[BUF1]], %[[C0]], %{{.+}})]
+    %1 = flow.dispatch @ex0::@entry0[%arg1 : index](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[BUF1]], %[[C0]], %{{.+}}), 1 = (%[[BUF2]], %[[C0]], %{{.+}})]
+    %2 = flow.dispatch @ex0::@entry0[%arg1 : index](%1) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[BUF2]], %[[C0]], %{{.+}}), 1 = (%[[BUF3]], %[[C0]], %{{.+}})]
+    %3 = flow.dispatch @ex0::@entry0[%arg1 : index](%2) : (tensor<128xf32>) -> tensor<128xf32>
+    %4 = flow.dispatch @ex0::@entry0[%arg1 : index](%3) : (tensor<128xf32>) -> tensor<128xf32>
+    flow.return %4 : tensor<128xf32>
+  }
+  return %0 : tensor<128xf32>
+}
+
+// -----
+
+hal.executable @ex0 {
+  hal.interface @interface {
+    hal.interface.binding @s0b0, set=0, binding=0, type="StorageBuffer", access="Read"
+    hal.interface.binding @s0b1, set=0, binding=1, type="StorageBuffer", access="Read|Write"
+  }
+  hal.executable.entry_point @entry0 attributes {
+    interface = @interface,
+    ordinal = 0 : i32,
+    signature = (tensor<128xf32>) -> tensor<128xf32>
+  }
+  hal.executable.target "vmla" {
+    module {}
+  }
+}
+
+// Independent dispatches are recorded together without barriers between them
+// and barriers are only recorded where a dispatch depends on a prior one.
+// CHECK-LABEL: func @independentDispatches
+func @independentDispatches(%arg0: tensor<128xf32>) -> (tensor<128xf32>, tensor<128xf32>) {
+  // CHECK-DAG: %[[C0:.+]] = constant 0 : index
+  // CHECK-DAG: %[[C512:.+]] = constant 512 : index
+  %cst = constant 128 : index
+  // CHECK-DAG: %[[RET_BUF0:.+]] = hal.allocator.allocate {{.+}}, "HostVisible|DeviceVisible|DeviceLocal"
+  // CHECK-DAG: %[[RET_BUF1:.+]] = hal.allocator.allocate {{.+}}, "HostVisible|DeviceVisible|DeviceLocal"
+  // CHECK: %[[BUF1:.+]] = hal.buffer.subspan %{{.+}}, %[[C0]], %[[C512]]
+  // CHECK-NEXT: %[[BUF3:.+]] = hal.buffer.subspan %{{.+}}, %[[C512]], %[[C512]]
+  %0:2 = flow.ex.stream.fragment(%arg1 = %cst : index, %arg2 = %arg0 : tensor<128xf32>) -> (tensor<128xf32>, tensor<128xf32>) {
+    //      CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%arg0, %[[C0]], %{{.+}}), 1 = (%[[BUF1]], %[[C0]], %{{.+}})]
+    //      CHECK: hal.command_buffer.dispatch
+    //  CHECK-NOT: hal.command_buffer.execution_barrier
+    //      CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%arg0, %[[C0]], %{{.+}}), 1 = (%[[BUF3]], %[[C0]], %{{.+}})]
+    //      CHECK: hal.command_buffer.dispatch
+    //      CHECK: hal.command_buffer.execution_barrier
+    //      CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[BUF1]], %[[C0]], %{{.+}}), 1 = (%[[RET_BUF0]], %[[C0]], %{{.+}})]
+    //      CHECK: hal.command_buffer.dispatch
+    //  CHECK-NOT: hal.command_buffer.execution_barrier
+    //      CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[BUF3]], %[[C0]], %{{.+}}), 1 = (%[[RET_BUF1]], %[[C0]], %{{.+}})]
+    //      CHECK: hal.command_buffer.dispatch
+    //  CHECK-NOT: hal.command_buffer.execution_barrier
+    //      CHECK: hal.command_buffer.end
+    %1 = flow.dispatch @ex0::@entry0[%arg1 : index](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    %2 = flow.dispatch @ex0::@entry0[%arg1 : index](%1) : (tensor<128xf32>) -> tensor<128xf32>
+    %3 = flow.dispatch @ex0::@entry0[%arg1 : index](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    %4 = flow.dispatch @ex0::@entry0[%arg1 : index](%3) : (tensor<128xf32>) -> tensor<128xf32>
+    flow.return %2, %4 : tensor<128xf32>, tensor<128xf32>
+  }
+  return %0#0, %0#1 : tensor<128xf32>, tensor<128xf32>
+}
+
+// -----
+
 // CHECK-LABEL: @tensorUpdate
 // CHECK-SAME: (%[[UBUF:.+]]:{{.+}}, %[[TBUF:.+]]:{{.+}})
 func @tensorUpdate(%arg0 : tensor<1x1x10xf32>, %arg1 : tensor<5x1x10xf32>) -> tensor<5x1x10xf32> {
@@ -177,6 +177,10 @@ void populateHALCommandBufferToVMPatterns(MLIRContext *context,
       context, importSymbols, typeConverter, "hal.command_buffer.begin");
   patterns.insert<VMImportOpConversion<IREE::HAL::CommandBufferEndOp>>(
       context, importSymbols, typeConverter, "hal.command_buffer.end");
+  patterns.insert<
+      VMImportOpConversion<IREE::HAL::CommandBufferUpdateBindingTableOp>>(
+      context, importSymbols, typeConverter,
+      "hal.command_buffer.update_binding_table");
   patterns.insert<CommandBufferExecutionBarrierOpConversion>(
       context, importSymbols, typeConverter,
       "hal.command_buffer.execution_barrier");
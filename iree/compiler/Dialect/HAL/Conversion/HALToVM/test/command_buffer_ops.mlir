@@ -20,6 +20,15 @@ func @command_buffer_begin_end(%arg0 : !hal.command_buffer) {
 
 // -----
 
+// CHECK-LABEL: @command_buffer_update_binding_table
+func @command_buffer_update_binding_table(%arg0 : !hal.command_buffer, %arg1 : !hal.buffer, %arg2 : !hal.buffer) -> i1 {
+  // CHECK: %0 = vm.call.variadic @hal.command_buffer.update_binding_table(%arg0, [%arg1, %arg2]) : (!vm.ref<!hal.command_buffer>, !vm.ref<!hal.buffer>...) -> i32
+  %0 = hal.command_buffer.update_binding_table %arg0, buffers = [%arg1, %arg2] : i1
+  return %0 : i1
+}
+
+// -----
+
 // CHECK-LABEL: @command_buffer_execution_barrier
 func @command_buffer_execution_barrier(%arg0 : !hal.command_buffer, %arg1 : !hal.buffer) {
   %c100 = constant 100 : index
@@ -42,6 +42,15 @@ func @command_buffer_begin_end(%arg0 : !hal.command_buffer) {
 
 // -----
 
+// CHECK-LABEL: @command_buffer_update_binding_table
+func @command_buffer_update_binding_table(%arg0 : !hal.command_buffer, %arg1 : !hal.buffer, %arg2 : !hal.buffer) -> i1 {
+  // CHECK: %0 = hal.command_buffer.update_binding_table %arg0, buffers = [%arg1, %arg2] : i1
+  %0 = hal.command_buffer.update_binding_table %arg0, buffers = [%arg1, %arg2] : i1
+  return %0 : i1
+}
+
+// -----
+
 // CHECK-LABEL: @command_buffer_execution_barrier
 func @command_buffer_execution_barrier(%arg0 : !hal.command_buffer) {
   %0 = "test_hal.buffer"() : () -> !hal.buffer
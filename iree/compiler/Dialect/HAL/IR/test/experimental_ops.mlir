@@ -19,3 +19,24 @@ func @submit_and_wait() {
   hal.ex.submit_and_wait %0, %1
   return
 }
+
+// -----
+
+// CHECK-LABEL: @submit
+func @submit() {
+  %0 = "test_hal.device"() : () -> !hal.device
+  %1 = "test_hal.command_buffer"() : () -> !hal.command_buffer
+  // CHECK: hal.ex.submit %0, %1
+  hal.ex.submit %0, %1
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @wait_idle
+func @wait_idle() {
+  %0 = "test_hal.device"() : () -> !hal.device
+  // CHECK: hal.ex.wait_idle %0
+  hal.ex.wait_idle %0
+  return
+}
@@ -14,6 +14,8 @@
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMIRPasses.h"
 
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Verifier.h"
@@ -35,10 +37,12 @@ std::unique_ptr<llvm::TargetMachine> createTargetMachine(
   auto target =
       llvm::TargetRegistry::lookupTarget(options.targetTriple, errorMessage);
   if (!target) return nullptr;
-  // TODO(ataei): Once we have an AOT backend pass cpu and cpu-features
+  // Always generate position-independent code so that the output can be
+  // linked into shared libraries for ahead-of-time targets.
   std::unique_ptr<llvm::TargetMachine> machine(target->createTargetMachine(
-      options.targetTriple, "generic" /* cpu e.g k8*/,
-      "" /* cpu features e.g avx512fma*/, {}, {}));
+      options.targetTriple, options.targetCPU /* cpu e.g k8*/,
+      options.targetCPUFeatures /* cpu features e.g avx512fma*/, {},
+      llvm::Reloc::Model::PIC_));
   return machine;
 }
 
@@ -65,16 +69,38 @@ LogicalResult runLLVMIRPasses(const LLVMTargetOptions& options,
   passBuilder.registerLoopAnalyses(loopAnalysisManager);
   passBuilder.crossRegisterProxies(loopAnalysisManager, functionAnalysisManager,
                                    cGSCCAnalysisManager, moduleAnalysisManager);
-  llvm::ModulePassManager modulePassManager;
-  modulePassManager =
-      passBuilder.buildPerModuleDefaultPipeline(options.optLevel);
-  modulePassManager.run(*module, moduleAnalysisManager);
+  // The default pipelines require optimizations to be enabled.
+  if (options.optLevel != llvm::PassBuilder::OptimizationLevel::O0) {
+    llvm::ModulePassManager modulePassManager;
+    modulePassManager =
+        passBuilder.buildPerModuleDefaultPipeline(options.optLevel);
+    modulePassManager.run(*module, moduleAnalysisManager);
+  }
 
   if (llvm::verifyModule(*module)) return failure();
 
   return success();
 }
 
+LogicalResult runEmitObjFilePasses(llvm::TargetMachine* machine,
+                                   llvm::Module* module,
+                                   std::vector<uint8_t>* objData) {
+  // Code generation is only exposed through the legacy pass manager.
+  llvm::SmallVector<char, 0> streamBuffer;
+  llvm::legacy::PassManager passManager;
+  passManager.add(
+      new llvm::TargetLibraryInfoWrapperPass(machine->getTargetTriple()));
+  llvm::raw_svector_ostream ostream(streamBuffer);
+  if (machine->addPassesToEmitFile(passManager, ostream,
+                                   /*DwoOut=*/nullptr,
+                                   llvm::CGFT_ObjectFile)) {
+    return failure();
+  }
+  passManager.run(*module);
+  objData->assign(streamBuffer.begin(), streamBuffer.end());
+  return success();
+}
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
@@ -16,6 +16,7 @@
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMIRPASSES_H_
 
 #include <memory>
+#include <vector>
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMTargetOptions.h"
 #include "llvm/IR/Module.h"
@@ -36,6 +37,11 @@ LogicalResult runLLVMIRPasses(const LLVMTargetOptions& options,
                               std::unique_ptr<llvm::TargetMachine> machine,
                               llvm::Module* module);
 
+// Emits a relocatable object file for |module| into |objData|.
+LogicalResult runEmitObjFilePasses(llvm::TargetMachine* machine,
+                                   llvm::Module* module,
+                                   std::vector<uint8_t>* objData);
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
@@ -17,12 +17,21 @@
 #include "iree/compiler/Conversion/LinalgToLLVM/Passes.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMIRPasses.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "iree/schemas/dylib_executable_def_generated.h"
 #include "iree/schemas/llvmir_executable_def_generated.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/StandardTypes.h"
 #include "mlir/Target/LLVMIR.h"
 
 namespace mlir {
@@ -30,14 +39,44 @@ namespace iree_compiler {
 namespace IREE {
 namespace HAL {
 
+// Returns the static shapes of the memref arguments of the entry function
+// |funcName| in |moduleOp| as recorded by the HAL interface to memref arguments
+// conversion, or an empty list if they are unknown.
+static SmallVector<SmallVector<int64_t, 4>, 4> getBindingShapes(
+    ModuleOp moduleOp, StringRef funcName) {
+  SmallVector<SmallVector<int64_t, 4>, 4> bindingShapes;
+  auto funcOp = moduleOp.lookupSymbol<LLVM::LLVMFuncOp>(funcName);
+  if (!funcOp) return bindingShapes;
+  auto shapesAttr = funcOp.getAttrOfType<ArrayAttr>(getBindingShapesAttrName());
+  if (!shapesAttr) return bindingShapes;
+  for (auto shapeAttr : shapesAttr.getAsRange<ArrayAttr>()) {
+    bindingShapes.emplace_back(llvm::map_range(
+        shapeAttr.getAsRange<IntegerAttr>(),
+        [](IntegerAttr dimAttr) { return dimAttr.getInt(); }));
+  }
+  return bindingShapes;
+}
+
+// Creates the invocation function `invoke_<name>` called by the runtime.
+//
+// The runtime passes a flat array with the base pointer of each binding:
+//   void invoke_<name>(void** bindings);
+// and the invocation function builds the memref descriptors expected by the C
+// interface function |name| on its own stack. The descriptor sizes and strides
+// are filled from |bindingShapes| when static, so that after inlining the
+// descriptors fold away and dispatches need no allocations in the runtime.
+//
 // TODO(ataei): This is written as a stub in LLVM IR. It would be easier to have
 // this using MLIR and lower it to LLVM like the dispatch function
 // implementation is.
-static void createInvocationFunc(const std::string& name,
-                                 llvm::Module* module) {
+static void createInvocationFunc(
+    const std::string& name,
+    ArrayRef<SmallVector<int64_t, 4>> bindingShapes, llvm::Module* module) {
   auto& ctx = module->getContext();
   llvm::IRBuilder<> builder(ctx);
   auto var_func = module->getFunction(name);
+  // The C interface wrapper only unpacks the descriptors.
+  var_func->addFnAttr(llvm::Attribute::AlwaysInline);
 
   auto new_type = llvm::FunctionType::get(
       builder.getVoidTy(), builder.getInt8PtrTy()->getPointerTo(),
@@ -55,19 +94,162 @@ static void createInvocationFunc(const std::string& name,
   llvm::SmallVector<llvm::Value*, 8> args;
   args.reserve(llvm::size(var_func->args()));
   for (auto& indexedArg : llvm::enumerate(var_func->args())) {
-    llvm::Value* arg_index = llvm::Constant::getIntegerValue(
-        builder.getInt64Ty(), llvm::APInt(64, indexedArg.index()));
-    llvm::Value* arg_ptr_ptr = builder.CreateGEP(argList, arg_index);
-    llvm::Value* arg_ptr = builder.CreateLoad(arg_ptr_ptr);
-    arg_ptr = builder.CreateBitCast(
-        arg_ptr, indexedArg.value().getType()->getPointerTo());
-    llvm::Value* arg = builder.CreateLoad(arg_ptr);
-    args.push_back(arg);
+    unsigned index = indexedArg.index();
+    auto descriptor_type = llvm::cast<llvm::StructType>(
+        llvm::cast<llvm::PointerType>(indexedArg.value().getType())
+            ->getElementType());
+    llvm::Value* descriptor = builder.CreateAlloca(descriptor_type);
+
+    // { T* allocated, T* aligned, i64 offset, [N x i64] sizes,
+    //   [N x i64] strides }
+    llvm::Value* base_ptr =
+        builder.CreateLoad(builder.CreateConstGEP1_64(argList, index));
+    base_ptr = builder.CreateBitCast(base_ptr,
+                                     descriptor_type->getElementType(0));
+    builder.CreateStore(base_ptr, builder.CreateStructGEP(descriptor, 0));
+    builder.CreateStore(base_ptr, builder.CreateStructGEP(descriptor, 1));
+    auto index_type = descriptor_type->getElementType(2);
+    builder.CreateStore(llvm::ConstantInt::get(index_type, 0),
+                        builder.CreateStructGEP(descriptor, 2));
+
+    // Dynamic shapes aren't passed by the runtime (yet) and leave the sizes
+    // and strides undefined, as unused by the generated code.
+    if (index >= bindingShapes.size() ||
+        llvm::any_of(bindingShapes[index], ShapedType::isDynamic)) {
+      args.push_back(descriptor);
+      continue;
+    }
+    ArrayRef<int64_t> shape = bindingShapes[index];
+    int64_t stride = 1;
+    for (int dim = static_cast<int>(shape.size()) - 1; dim >= 0; --dim) {
+      auto store_dim = [&](unsigned field, int64_t value) {
+        builder.CreateStore(
+            llvm::ConstantInt::get(index_type, value),
+            builder.CreateInBoundsGEP(
+                descriptor, {builder.getInt32(0), builder.getInt32(field),
+                             builder.getInt32(dim)}));
+      };
+      store_dim(3, shape[dim]);
+      store_dim(4, stride);
+      stride *= shape[dim];
+    }
+    args.push_back(descriptor);
   }
   builder.CreateCall(var_func, args);
   builder.CreateRetVoid();
 }
 
+// Links the relocatable object |objData| into a shared library using the
+// system linker and returns the library contents in |libraryData|.
+// Only ELF targets are currently supported.
+static LogicalResult linkSharedLibrary(Location loc,
+                                       const LLVMTargetOptions& options,
+                                       const std::vector<uint8_t>& objData,
+                                       std::vector<uint8_t>* libraryData) {
+  std::string linkerPath = options.linkerPath;
+  if (linkerPath.empty()) {
+    for (auto name : {"ld.lld", "ld"}) {
+      auto programOr = llvm::sys::findProgramByName(name);
+      if (programOr) {
+        linkerPath = programOr.get();
+        break;
+      }
+    }
+    if (linkerPath.empty()) {
+      return emitError(loc)
+             << "unable to find a linker; specify one with "
+                "-iree-llvm-linker-path";
+    }
+  }
+
+  llvm::SmallString<128> objPath;
+  llvm::SmallString<128> libraryPath;
+  if (llvm::sys::fs::createTemporaryFile("iree-dylib", "o", objPath) ||
+      llvm::sys::fs::createTemporaryFile("iree-dylib", "so", libraryPath)) {
+    return emitError(loc) << "unable to create temporary files for linking";
+  }
+  llvm::FileRemover objRemover(objPath);
+  llvm::FileRemover libraryRemover(libraryPath);
+
+  {
+    std::error_code error;
+    llvm::raw_fd_ostream objStream(objPath, error, llvm::sys::fs::OF_None);
+    if (error) {
+      return emitError(loc) << "unable to write object file " << objPath
+                            << ": " << error.message();
+    }
+    objStream.write(reinterpret_cast<const char*>(objData.data()),
+                    objData.size());
+  }
+
+  llvm::SmallVector<llvm::StringRef, 8> args = {
+      linkerPath, "-shared", "-o", libraryPath, objPath,
+  };
+  std::string errorMessage;
+  int result = llvm::sys::ExecuteAndWait(linkerPath, args, /*Env=*/llvm::None,
+                                         /*Redirects=*/{}, /*SecondsToWait=*/0,
+                                         /*MemoryLimit=*/0, &errorMessage);
+  if (result != 0) {
+    return emitError(loc) << "linker '" << linkerPath << "' failed ("
+                          << result << "): " << errorMessage;
+  }
+
+  auto libraryOr =
+      llvm::MemoryBuffer::getFile(libraryPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!libraryOr) {
+    return emitError(loc) << "unable to read linked library " << libraryPath
+                          << ": " << libraryOr.getError().message();
+  }
+  auto& libraryBuffer = libraryOr.get();
+  libraryData->assign(libraryBuffer->getBufferStart(),
+                      libraryBuffer->getBufferEnd());
+  return success();
+}
+
+// Optimizes |module| for the target described by |options| and serializes it
+// as bitcode into |bitcode|.
+static LogicalResult optimizeAndSerializeModule(
+    IREE::HAL::ExecutableTargetOp targetOp, const LLVMTargetOptions& options,
+    llvm::Module* module, std::vector<int8_t>* bitcode) {
+  auto targetMachine = createTargetMachine(options);
+  if (!targetMachine) {
+    return targetOp.emitError(
+        "Can't create target machine for target triple: " +
+        options.targetTriple);
+  }
+  module->setDataLayout(targetMachine->createDataLayout());
+  module->setTargetTriple(targetMachine->getTargetTriple().str());
+
+  // Record the target on each function so that the JIT generates code for it
+  // instead of the host defaults. Without an explicit target the runtime
+  // compiles for the host CPU.
+  for (auto& func : *module) {
+    if (func.isDeclaration()) continue;
+    if (options.targetCPU != "generic" && !options.targetCPU.empty()) {
+      func.addFnAttr("target-cpu", options.targetCPU);
+    }
+    if (!options.targetCPUFeatures.empty()) {
+      func.addFnAttr("target-features", options.targetCPUFeatures);
+    }
+  }
+
+  // LLVMIR opt passes.
+  if (failed(runLLVMIRPasses(options, std::move(targetMachine), module))) {
+    return targetOp.emitError(
+        "Can't build LLVMIR opt passes for ExecutableOp module");
+  }
+
+  // Serialize LLVM module as bitcode, which the runtime can load without
+  // reparsing textual IR.
+  std::string bufferString;
+  llvm::raw_string_ostream ostream(bufferString);
+  llvm::WriteBitcodeToFile(*module, ostream);
+  ostream.flush();
+  bitcode->assign(bufferString.begin(), bufferString.end());
+  return success();
+}
+
 class LLVMIRTargetBackend final : public TargetBackend {
  public:
   LLVMIRTargetBackend(LLVMTargetOptions options)
@@ -80,7 +262,9 @@ class LLVMIRTargetBackend final : public TargetBackend {
   // from HLO to LLVM throught linalg dialect.
   void buildTranslationPassPipeline(IREE::HAL::ExecutableTargetOp targetOp,
                                     OpPassManager& passManager) override {
-    buildLLVMTransformPassPipeline(passManager);
+    LLVMCodegenOptions codegenOptions;
+    codegenOptions.useMicrokernels = options_.useMicrokernels;
+    buildLLVMTransformPassPipeline(passManager, codegenOptions);
   }
 
   LogicalResult serializeExecutable(IREE::HAL::ExecutableTargetOp targetOp,
@@ -106,36 +290,131 @@ class LLVMIRTargetBackend final : public TargetBackend {
           addCInterface ? "_mlir_ciface_" + std::string(entryPointOp.sym_name())
                         : std::string(entryPointOp.sym_name());
       llvmIrExecutableDef.entry_points.push_back(funcName);
-      createInvocationFunc(funcName, llvmModule.get());
+      createInvocationFunc(funcName,
+                           getBindingShapes(targetOp.getInnerModule(),
+                                            entryPointOp.sym_name()),
+                           llvmModule.get());
     }
 
-    // LLVMIR opt passes.
+    // Emit variants specialized for additional CPU feature sets. These are
+    // cloned before the baseline module is optimized.
+    for (const auto& features : options_.targetCPUFeatureVariants) {
+      auto variantModule = llvm::CloneModule(*llvmModule);
+      auto variantOptions = options_;
+      variantOptions.targetCPUFeatures = features;
+      auto variantDef = std::make_unique<iree::LLVMIRExecutableVariantDefT>();
+      variantDef->target_features = features;
+      if (failed(optimizeAndSerializeModule(
+              targetOp, variantOptions, variantModule.get(),
+              &variantDef->llvmir_module))) {
+        return failure();
+      }
+      llvmIrExecutableDef.variants.push_back(std::move(variantDef));
+    }
+
+    if (failed(optimizeAndSerializeModule(
+            targetOp, options_, llvmModule.get(),
+            &llvmIrExecutableDef.llvmir_module))) {
+      return failure();
+    }
+
+    ::flatbuffers::FlatBufferBuilder fbb;
+    auto executableOffset =
+        iree::LLVMIRExecutableDef::Pack(fbb, &llvmIrExecutableDef);
+    iree::FinishLLVMIRExecutableDefBuffer(fbb, executableOffset);
+    std::vector<uint8_t> bytes;
+    bytes.resize(fbb.GetSize());
+    std::memcpy(bytes.data(), fbb.GetBufferPointer(), bytes.size());
+
+    // Add the binary data to the target executable.
+    executableBuilder.create<IREE::HAL::ExecutableBinaryOp>(
+        targetOp.getLoc(),
+        static_cast<uint32_t>(IREE::HAL::ExecutableFormat::LLVM),
+        std::move(bytes));
+
+    return success();
+  }
+
+ private:
+  LLVMTargetOptions options_;
+};
+
+// Compiles executables ahead-of-time into native shared libraries that can be
+// loaded by the runtime without requiring LLVM.
+class LLVMAOTTargetBackend final : public TargetBackend {
+ public:
+  LLVMAOTTargetBackend(LLVMTargetOptions options)
+      : options_(std::move(options)) {}
+
+  std::string name() const override { return "dylib*"; }
+
+  // NOTE: microkernels are only provided by the JIT runtime and shared
+  // libraries cannot resolve them, so they are never used here.
+  void buildTranslationPassPipeline(IREE::HAL::ExecutableTargetOp targetOp,
+                                    OpPassManager& passManager) override {
+    buildLLVMTransformPassPipeline(passManager);
+  }
+
+  LogicalResult serializeExecutable(IREE::HAL::ExecutableTargetOp targetOp,
+                                    OpBuilder& executableBuilder) override {
+    // LLVM is not thread safe and currently translation shares an LLVMContext.
+    static llvm::sys::SmartMutex<true> mutex;
+    llvm::sys::SmartScopedLock<true> lock(mutex);
+
+    auto llvmModule = mlir::translateModuleToLLVMIR(targetOp.getInnerModule());
+    if (!llvmModule) {
+      return targetOp.emitError("Failed to translate executable to LLVMIR");
+    }
+
+    // Create invocation functions and populate entry_points.
+    iree::DyLibExecutableDefT dyLibExecutableDef;
+    auto executableOp = cast<IREE::HAL::ExecutableOp>(targetOp.getParentOp());
+    auto entryPointOps =
+        executableOp.getBlock().getOps<IREE::HAL::ExecutableEntryPointOp>();
+    for (auto entryPointOp : entryPointOps) {
+      std::string funcName =
+          "_mlir_ciface_" + std::string(entryPointOp.sym_name());
+      dyLibExecutableDef.entry_points.push_back(funcName);
+      createInvocationFunc(funcName,
+                           getBindingShapes(targetOp.getInnerModule(),
+                                            entryPointOp.sym_name()),
+                           llvmModule.get());
+    }
+
+    // The module must match the target machine used for code generation.
     auto targetMachine = createTargetMachine(options_);
     if (!targetMachine) {
-      targetOp.emitError("Can't create target machine for target triple: " +
-                         options_.targetTriple);
-      return failure();
+      return targetOp.emitError(
+          "Can't create target machine for target triple: " +
+          options_.targetTriple);
     }
-    if (failed(runLLVMIRPasses(options_, std::move(targetMachine),
+    llvmModule->setDataLayout(targetMachine->createDataLayout());
+    llvmModule->setTargetTriple(targetMachine->getTargetTriple().str());
+
+    // LLVMIR opt passes.
+    if (failed(runLLVMIRPasses(options_, createTargetMachine(options_),
                                llvmModule.get()))) {
       return targetOp.emitError(
           "Can't build LLVMIR opt passes for ExecutableOp module");
     }
 
-    // Serialize LLVM module.
-    std::string bufferString;
-    llvm::raw_string_ostream ostream(bufferString);
-    llvmModule->print(ostream, nullptr);
-    ostream.flush();
-
-    // Creates executable bytes.
-    llvmIrExecutableDef.llvmir_module = {bufferString.begin(),
-                                         bufferString.end()};
+    // Emit the object file and link it into a shared library.
+    std::vector<uint8_t> objData;
+    if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
+                                    &objData))) {
+      return targetOp.emitError("Can't emit object file for target triple: " +
+                                options_.targetTriple);
+    }
+    if (failed(linkSharedLibrary(targetOp.getLoc(), options_, objData,
+                                 &dyLibExecutableDef.library_embedded))) {
+      return failure();
+    }
+    dyLibExecutableDef.target_triple = options_.targetTriple;
 
     ::flatbuffers::FlatBufferBuilder fbb;
     auto executableOffset =
-        iree::LLVMIRExecutableDef::Pack(fbb, &llvmIrExecutableDef);
-    iree::FinishLLVMIRExecutableDefBuffer(fbb, executableOffset);
+        iree::DyLibExecutableDef::Pack(fbb, &dyLibExecutableDef);
+    iree::FinishDyLibExecutableDefBuffer(fbb, executableOffset);
     std::vector<uint8_t> bytes;
     bytes.resize(fbb.GetSize());
     std::memcpy(bytes.data(), fbb.GetBufferPointer(), bytes.size());
@@ -143,7 +422,7 @@ class LLVMIRTargetBackend final : public TargetBackend {
     // Add the binary data to the target executable.
     executableBuilder.create<IREE::HAL::ExecutableBinaryOp>(
         targetOp.getLoc(),
-        static_cast<uint32_t>(IREE::HAL::ExecutableFormat::LLVM),
+        static_cast<uint32_t>(IREE::HAL::ExecutableFormat::DyLib),
         std::move(bytes));
 
     return success();
@@ -162,6 +441,11 @@ void registerLLVMTargetBackends(
     llvm::InitializeNativeTargetAsmPrinter();
     return std::make_unique<LLVMIRTargetBackend>(queryOptions());
   });
+  static TargetBackendRegistration dylibRegistration("dylib-llvm-aot", [=]() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    return std::make_unique<LLVMAOTTargetBackend>(queryOptions());
+  });
 }
 
 }  // namespace HAL
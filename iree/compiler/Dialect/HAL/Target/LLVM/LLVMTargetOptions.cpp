@@ -14,6 +14,7 @@
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMTargetOptions.h"
 
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Host.h"
 
 namespace mlir {
@@ -25,6 +26,7 @@ LLVMTargetOptions getDefaultLLVMTargetOptions() {
   LLVMTargetOptions targetOptions;
   // Host target triple.
   targetOptions.targetTriple = llvm::sys::getDefaultTargetTriple();
+  targetOptions.targetCPU = "generic";
   // LLVM loop optimization options.
   targetOptions.pipelineTuningOptions.LoopInterleaving = true;
   targetOptions.pipelineTuningOptions.LoopVectorization = true;
@@ -37,8 +39,63 @@ LLVMTargetOptions getDefaultLLVMTargetOptions() {
 }
 
 LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
-  // TODO(ataei): Add flags and construct options.
-  return getDefaultLLVMTargetOptions();
+  static llvm::cl::opt<std::string> clTargetTriple(
+      "iree-llvm-target-triple",
+      llvm::cl::desc("Target triple for LLVM codegen (defaults to the host)"),
+      llvm::cl::init(""));
+  static llvm::cl::opt<std::string> clTargetCPU(
+      "iree-llvm-target-cpu",
+      llvm::cl::desc("Target CPU for LLVM codegen (such as 'skylake')"),
+      llvm::cl::init("generic"));
+  static llvm::cl::opt<std::string> clTargetCPUFeatures(
+      "iree-llvm-target-cpu-features",
+      llvm::cl::desc("Target CPU features for LLVM codegen (such as '+avx2')"),
+      llvm::cl::init(""));
+  static llvm::cl::list<std::string> clTargetCPUFeatureVariants(
+      "iree-llvm-target-cpu-feature-variants",
+      llvm::cl::desc("Additional CPU feature strings to emit specialized "
+                     "executable variants for (such as '+avx2,+fma'); may "
+                     "be repeated"));
+  static llvm::cl::opt<unsigned> clOptLevel(
+      "iree-llvm-opt-level",
+      llvm::cl::desc("LLVM optimization level (0-3) for generated code"),
+      llvm::cl::init(3));
+  static llvm::cl::opt<std::string> clLinkerPath(
+      "iree-llvm-linker-path",
+      llvm::cl::desc("Linker used to produce shared libraries for the "
+                     "dylib-llvm-aot target (defaults to ld.lld or ld)"),
+      llvm::cl::init(""));
+  static llvm::cl::opt<bool> clUseMicrokernels(
+      "iree-llvm-use-microkernels",
+      llvm::cl::desc("Lowers matmuls and convolutions to calls into the "
+                     "microkernels provided by the llvm-ir JIT runtime"),
+      llvm::cl::init(false));
+
+  auto targetOptions = getDefaultLLVMTargetOptions();
+  if (!clTargetTriple.empty()) {
+    targetOptions.targetTriple = clTargetTriple;
+  }
+  targetOptions.targetCPU = clTargetCPU;
+  targetOptions.targetCPUFeatures = clTargetCPUFeatures;
+  targetOptions.targetCPUFeatureVariants.assign(
+      clTargetCPUFeatureVariants.begin(), clTargetCPUFeatureVariants.end());
+  switch (clOptLevel) {
+    case 0:
+      targetOptions.optLevel = llvm::PassBuilder::OptimizationLevel::O0;
+      break;
+    case 1:
+      targetOptions.optLevel = llvm::PassBuilder::OptimizationLevel::O1;
+      break;
+    case 2:
+      targetOptions.optLevel = llvm::PassBuilder::OptimizationLevel::O2;
+      break;
+    default:
+      targetOptions.optLevel = llvm::PassBuilder::OptimizationLevel::O3;
+      break;
+  }
+  targetOptions.linkerPath = clLinkerPath;
+  targetOptions.useMicrokernels = clUseMicrokernels;
+  return targetOptions;
 }
 
 }  // namespace HAL
@@ -15,6 +15,9 @@
 #ifndef IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 
+#include <string>
+#include <vector>
+
 #include "llvm/Passes/PassBuilder.h"
 
 namespace mlir {
@@ -26,6 +29,17 @@ struct LLVMTargetOptions {
   llvm::PipelineTuningOptions pipelineTuningOptions;
   llvm::PassBuilder::OptimizationLevel optLevel;
   std::string targetTriple;
+  // Target CPU name and feature string (such as "skylake" and "+avx2,+fma").
+  std::string targetCPU;
+  std::string targetCPUFeatures;
+  // Additional feature strings to emit specialized executable variants for.
+  // The runtime selects the best variant supported by the host.
+  std::vector<std::string> targetCPUFeatureVariants;
+  // Linker used to produce shared libraries for ahead-of-time targets.
+  std::string linkerPath;
+  // Calls the microkernels provided by the JIT runtime for contractions
+  // instead of generating code for them.
+  bool useMicrokernels = false;
 };
 
 // Returns LLVMTargetOptions struct intialized with the
@@ -0,0 +1,250 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <set>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Returns true if |op| may access the contents of buffers on the host or hand
+// them off to code that may. Submissions must complete before such ops run.
+static bool requiresCompletedSubmissions(Operation *op) {
+  if (isa<BufferFillOp>(op) || isa<BufferReadDataOp>(op) ||
+      isa<BufferWriteDataOp>(op) || isa<BufferCopyDataOp>(op) ||
+      isa<BufferLoadOp>(op) || isa<BufferStoreOp>(op)) {
+    return true;
+  }
+  // Callees and callers are not analyzed and may read any buffer.
+  return isa<CallOp>(op) || isa<CallIndirectOp>(op) || isa<ReturnOp>(op);
+}
+
+// Returns true if |op| or any op nested within it matches |predicate|.
+template <typename PredicateT>
+static bool anyNestedOp(Operation *op, PredicateT predicate) {
+  bool found = false;
+  op->walk([&](Operation *nestedOp) {
+    if (predicate(nestedOp)) found = true;
+  });
+  return found;
+}
+
+// Adds the variables that may hold the command buffer |value| to |variables|.
+// Command buffers created within the function are only included if
+// |includeStores| is set, in which case the variables they are stored into
+// are added. Returns false if |value| may be a command buffer from elsewhere.
+static bool collectCommandBufferVariables(
+    Value value, bool includeStores, llvm::DenseSet<Value> &visited,
+    std::set<StringRef> &variables) {
+  if (!visited.insert(value).second) return true;
+  if (auto *definingOp = value.getDefiningOp()) {
+    if (auto loadOp = dyn_cast<VariableLoadOp>(definingOp)) {
+      variables.insert(loadOp.variable());
+      return true;
+    } else if (isa<CommandBufferCreateOp>(definingOp)) {
+      if (!includeStores) return true;
+      for (auto *user : value.getUsers()) {
+        if (auto storeOp = dyn_cast<VariableStoreOp>(user)) {
+          variables.insert(storeOp.variable());
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Block arguments may be any of the values passed by predecessors.
+  auto blockArg = value.cast<BlockArgument>();
+  auto *block = blockArg.getOwner();
+  if (block->isEntryBlock()) return false;
+  for (auto it = block->pred_begin(); it != block->pred_end(); ++it) {
+    auto branchOp = dyn_cast<BranchOpInterface>((*it)->getTerminator());
+    if (!branchOp) return false;
+    auto operands = branchOp.getSuccessorOperands(it.getSuccessorIndex());
+    if (!operands) return false;
+    if (!collectCommandBufferVariables((*operands)[blockArg.getArgNumber()],
+                                       includeStores, visited, variables)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Submissions that may still be executing at a point in a function.
+struct PendingSubmissions {
+  // True if any submission may be pending.
+  bool any = false;
+  // True if a submitted command buffer may be one cached in any variable.
+  bool anyVariable = false;
+  // Variables holding reusable command buffers that may still be executing.
+  std::set<StringRef> variables;
+
+  bool operator==(const PendingSubmissions &other) const {
+    return any == other.any && anyVariable == other.anyVariable &&
+           variables == other.variables;
+  }
+  bool operator!=(const PendingSubmissions &other) const {
+    return !(*this == other);
+  }
+
+  void merge(const PendingSubmissions &other) {
+    any |= other.any;
+    anyVariable |= other.anyVariable;
+    variables.insert(other.variables.begin(), other.variables.end());
+  }
+
+  void clear() { *this = PendingSubmissions(); }
+
+  // Records a submission of |commandBuffer|.
+  void addSubmission(Value commandBuffer) {
+    any = true;
+    llvm::DenseSet<Value> visited;
+    if (!collectCommandBufferVariables(commandBuffer, /*includeStores=*/true,
+                                       visited, variables)) {
+      anyVariable = true;
+    }
+  }
+
+  // Returns true if |commandBuffer| may be one that is still executing.
+  // Reusable command buffers cannot be rebound while they are executing but
+  // others, such as those recording new streams, can be.
+  bool mayBeExecuting(Value commandBuffer) const {
+    if (!any) return false;
+    llvm::DenseSet<Value> visited;
+    std::set<StringRef> commandBufferVariables;
+    if (!collectCommandBufferVariables(commandBuffer, /*includeStores=*/false,
+                                       visited, commandBufferVariables)) {
+      return true;
+    }
+    for (auto variable : commandBufferVariables) {
+      if (anyVariable || variables.count(variable)) return true;
+    }
+    return false;
+  }
+};
+
+// Returns true if |op| must wait for the |pending| submissions to complete.
+static bool requiresWait(Operation *op, const PendingSubmissions &pending) {
+  if (!pending.any) return false;
+  return anyNestedOp(op, [&](Operation *nestedOp) {
+    if (auto updateOp = dyn_cast<CommandBufferUpdateBindingTableOp>(nestedOp)) {
+      return pending.mayBeExecuting(updateOp.command_buffer());
+    }
+    return requiresCompletedSubmissions(nestedOp);
+  });
+}
+
+// Updates |pending| to the submissions pending after |op|, ignoring any wait
+// that may be inserted before |op| itself.
+static void transferPendingSubmissions(Operation *op,
+                                       PendingSubmissions &pending) {
+  if (isa<ExWaitIdleOp>(op) || isa<ExSubmitAndWaitOp>(op)) {
+    pending.clear();
+    return;
+  }
+  op->walk([&](ExSubmitOp submitOp) {
+    pending.addSubmission(submitOp.command_buffer());
+  });
+}
+
+// Inserts hal.ex.wait_idle ops such that submissions made by hal.ex.submit
+// complete before the host accesses any buffer they may use and before
+// command buffers they may be executing are rebound.
+//
+// Submissions are tracked with a forward dataflow analysis over the CFG of each
+// function: a wait is inserted before the first op requiring completed
+// submissions along any path on which a submission may be pending. Functions
+// are assumed to be entered with no submissions pending as calls and returns
+// are themselves waited on.
+//
+// Reusable command buffers are tracked by the variables caching them so that
+// consecutive memoized streams each using their own command buffer do not wait
+// on each other.
+class InsertStreamWaitsPass
+    : public PassWrapper<InsertStreamWaitsPass, OperationPass<FuncOp>> {
+ public:
+  void runOnOperation() override {
+    auto funcOp = getOperation();
+    if (funcOp.empty()) return;
+
+    // Propagate the pending submissions at block exits to a fixed point.
+    DenseMap<Block *, PendingSubmissions> pendingOnExit;
+    llvm::SetVector<Block *> worklist;
+    for (auto &block : funcOp) worklist.insert(&block);
+    while (!worklist.empty()) {
+      auto *block = worklist.pop_back_val();
+      auto pending = getPendingOnEntry(block, pendingOnExit);
+      for (auto &op : *block) {
+        if (requiresWait(&op, pending)) pending.clear();
+        transferPendingSubmissions(&op, pending);
+      }
+      auto &exitPending = pendingOnExit[block];
+      if (exitPending == pending) continue;
+      exitPending = std::move(pending);
+      for (auto *successor : block->getSuccessors()) {
+        worklist.insert(successor);
+      }
+    }
+
+    // Insert waits where submissions may be pending.
+    for (auto &block : funcOp) {
+      auto pending = getPendingOnEntry(&block, pendingOnExit);
+      for (auto &op : block) {
+        if (requiresWait(&op, pending)) {
+          OpBuilder builder(&op);
+          auto device = builder.create<ExSharedDeviceOp>(op.getLoc());
+          builder.create<ExWaitIdleOp>(op.getLoc(), device);
+          pending.clear();
+        }
+        transferPendingSubmissions(&op, pending);
+      }
+    }
+  }
+
+ private:
+  static PendingSubmissions getPendingOnEntry(
+      Block *block,
+      const DenseMap<Block *, PendingSubmissions> &pendingOnExit) {
+    PendingSubmissions pending;
+    for (auto *predecessor : block->getPredecessors()) {
+      auto it = pendingOnExit.find(predecessor);
+      if (it != pendingOnExit.end()) pending.merge(it->second);
+    }
+    return pending;
+  }
+};
+
+std::unique_ptr<OperationPass<FuncOp>> createInsertStreamWaitsPass() {
+  return std::make_unique<InsertStreamWaitsPass>();
+}
+
+static PassRegistration<InsertStreamWaitsPass> pass(
+    "iree-hal-insert-stream-waits",
+    "Waits on asynchronous stream submissions before host buffer accesses");
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,264 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <utility>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+namespace {
+
+// A one-shot command buffer recorded and submitted within a single block:
+//   %cmd = hal.command_buffer.create %device, "OneShot", ...
+//   hal.command_buffer.begin %cmd
+//   ... recording ...
+//   hal.command_buffer.end %cmd
+//   hal.ex.submit %device, %cmd
+struct RecordingRange {
+  CommandBufferCreateOp createOp;
+  CommandBufferBeginOp beginOp;
+  CommandBufferEndOp endOp;
+  ExSubmitOp submitOp;
+
+  // All top-level ops in the block from createOp to endOp (inclusive).
+  llvm::SmallPtrSet<Operation *, 32> ops;
+
+  // Buffers defined outside of the range that the recorded commands reference.
+  // These become the binding table of the memoized command buffer.
+  llvm::SetVector<Value> buffers;
+
+  // hal.ex.defer_release ops within the range that release values defined
+  // outside of it. These must run on every invocation and get hoisted out.
+  SmallVector<ExDeferReleaseOp, 4> hoistedReleaseOps;
+};
+
+}  // namespace
+
+// Returns true if |value| is defined by an op within |range| (or a region
+// nested within one).
+static bool isDefinedInRange(Value value, Block *block,
+                             const RecordingRange &range) {
+  Operation *definingOp = value.getDefiningOp();
+  if (!definingOp) {
+    auto *ownerBlock = value.cast<BlockArgument>().getOwner();
+    if (ownerBlock == block) return false;
+    definingOp = ownerBlock->getParentOp();
+  }
+  auto *ancestorOp = block->findAncestorOpInBlock(*definingOp);
+  return ancestorOp && range.ops.count(ancestorOp);
+}
+
+// Analyzes the uses of the command buffer produced by |createOp| and returns
+// the range that can be memoized, if any. Ranges that capture dynamic values
+// (such as push constants or shape dimensions) are skipped as they would need
+// to be re-recorded on each invocation anyway.
+static Optional<RecordingRange> analyzeRecordingRange(
+    CommandBufferCreateOp createOp) {
+  if (!(static_cast<uint32_t>(createOp.modes()) &
+        static_cast<uint32_t>(CommandBufferModeBitfield::OneShot))) {
+    return llvm::None;
+  }
+
+  RecordingRange range;
+  range.createOp = createOp;
+  auto *block = createOp.getOperation()->getBlock();
+  for (auto *user : createOp.result().getUsers()) {
+    if (user->getBlock() != block) continue;
+    if (auto beginOp = dyn_cast<CommandBufferBeginOp>(user)) {
+      if (range.beginOp) return llvm::None;
+      range.beginOp = beginOp;
+    } else if (auto endOp = dyn_cast<CommandBufferEndOp>(user)) {
+      if (range.endOp) return llvm::None;
+      range.endOp = endOp;
+    } else if (auto submitOp = dyn_cast<ExSubmitOp>(user)) {
+      if (range.submitOp) return llvm::None;
+      range.submitOp = submitOp;
+    }
+  }
+  if (!range.beginOp || !range.endOp || !range.submitOp ||
+      !range.endOp.getOperation()->isBeforeInBlock(
+          range.submitOp.getOperation())) {
+    return llvm::None;
+  }
+  for (auto it = Block::iterator(createOp.getOperation());
+       it != std::next(Block::iterator(range.endOp.getOperation())); ++it) {
+    range.ops.insert(&*it);
+  }
+
+  for (auto *op : range.ops) {
+    // Nothing recorded may escape the range except the command buffer itself,
+    // which is only allowed to be consumed by the submission.
+    for (auto result : op->getResults()) {
+      for (auto &use : result.getUses()) {
+        if (use.getOwner() == range.submitOp.getOperation()) continue;
+        auto *ancestorOp = block->findAncestorOpInBlock(*use.getOwner());
+        if (!ancestorOp || !range.ops.count(ancestorOp)) return llvm::None;
+      }
+    }
+
+    // Allocations must happen on every invocation.
+    if (isa<AllocatorAllocateOp>(op) || isa<AllocatorAllocateConstOp>(op)) {
+      return llvm::None;
+    }
+
+    // Descriptor sets capture their buffers when created and are not rebound
+    // with the binding table.
+    if (isa<CommandBufferBindDescriptorSetOp>(op)) return llvm::None;
+
+    if (auto releaseOp = dyn_cast<ExDeferReleaseOp>(op)) {
+      if (isDefinedInRange(releaseOp.operand(), block, range)) {
+        return llvm::None;
+      }
+      range.hoistedReleaseOps.push_back(releaseOp);
+      continue;
+    }
+
+    // Gather captured values. Buffers are rebound on each invocation while
+    // device handles and constants are invariant.
+    bool isInvariant = true;
+    op->walk([&](Operation *nestedOp) {
+      for (auto operand : nestedOp->getOperands()) {
+        if (isDefinedInRange(operand, block, range)) continue;
+        auto type = operand.getType();
+        if (type.isa<BufferType>()) {
+          range.buffers.insert(operand);
+        } else if (type.isa<DeviceType>() || type.isa<AllocatorType>() ||
+                   matchPattern(operand, m_Constant())) {
+          // Invariant across invocations.
+        } else {
+          isInvariant = false;
+        }
+      }
+    });
+    if (!isInvariant) return llvm::None;
+  }
+
+  return range;
+}
+
+// Rewrites |range| to reuse a command buffer stored in |variableOp|:
+//   %cached = hal.variable.load @var
+//   %ok = hal.command_buffer.update_binding_table %cached, buffers = [...]
+//   cond_br %ok, ^submit(%cached), ^record
+// ^record:
+//   %cmd = hal.command_buffer.create %device, None, ...
+//   hal.command_buffer.begin %cmd
+//   hal.command_buffer.update_binding_table %cmd, buffers = [...]
+//   ... recording ...
+//   hal.command_buffer.end %cmd
+//   hal.variable.store %cmd, @var
+//   br ^submit(%cmd)
+// ^submit(%submit_cmd):
+//   hal.ex.submit %device, %submit_cmd
+static void memoizeRecordingRange(RecordingRange &range,
+                                  VariableOp variableOp) {
+  auto createOp = range.createOp;
+  auto loc = createOp.getLoc();
+  auto commandBufferType = createOp.result().getType();
+  SmallVector<Value, 8> buffers(range.buffers.begin(), range.buffers.end());
+
+  OpBuilder builder(createOp);
+  for (auto releaseOp : range.hoistedReleaseOps) {
+    releaseOp.getOperation()->moveBefore(createOp);
+  }
+  auto cachedCommandBuffer = builder.create<VariableLoadOp>(
+      loc, commandBufferType, variableOp.sym_name());
+  auto isReusable = builder.create<CommandBufferUpdateBindingTableOp>(
+      loc, builder.getI1Type(), cachedCommandBuffer, buffers);
+
+  // Split out the recording and submission into their own blocks.
+  auto *entryBlock = createOp.getOperation()->getBlock();
+  auto *recordBlock = entryBlock->splitBlock(createOp);
+  auto *submitBlock = recordBlock->splitBlock(
+      std::next(Block::iterator(range.endOp.getOperation())));
+  auto submitCommandBuffer = submitBlock->addArgument(commandBufferType);
+  range.submitOp.getOperation()->replaceUsesOfWith(createOp.result(),
+                                                   submitCommandBuffer);
+
+  builder.setInsertionPointToEnd(entryBlock);
+  builder.create<CondBranchOp>(loc, isReusable, submitBlock,
+                               ValueRange{cachedCommandBuffer}, recordBlock,
+                               ValueRange{});
+
+  // Record a reusable command buffer with the binding table declared up-front
+  // so that the buffers can be swapped out on subsequent invocations.
+  createOp.setAttr("modes",
+                   builder.getI32IntegerAttr(static_cast<int32_t>(
+                       CommandBufferModeBitfield::None)));
+  builder.setInsertionPointAfter(range.beginOp);
+  builder.create<CommandBufferUpdateBindingTableOp>(
+      loc, builder.getI1Type(), createOp.result(), buffers);
+  builder.setInsertionPointToEnd(recordBlock);
+  builder.create<VariableStoreOp>(loc, createOp.result(),
+                                  variableOp.sym_name());
+  builder.create<BranchOp>(loc, submitBlock, ValueRange{createOp.result()});
+}
+
+// Caches command buffers that record the same commands on every invocation
+// and rebinds their buffers instead of re-recording them.
+//
+// NOTE: this assumes invocations of the module are not concurrent, as is the
+// case for all other hal.variable-based caches.
+class MemoizeCommandBuffersPass
+    : public PassWrapper<MemoizeCommandBuffersPass, OperationPass<ModuleOp>> {
+ public:
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SmallVector<RecordingRange, 4> ranges;
+    for (auto funcOp : moduleOp.getOps<FuncOp>()) {
+      funcOp.walk([&](CommandBufferCreateOp createOp) {
+        auto range = analyzeRecordingRange(createOp);
+        if (range.hasValue()) ranges.push_back(std::move(range.getValue()));
+      });
+    }
+
+    auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp.getBody());
+    for (auto range : llvm::enumerate(ranges)) {
+      auto loc = range.value().createOp.getLoc();
+      auto variableOp = moduleBuilder.create<VariableOp>(
+          loc, "_command_buffer_" + std::to_string(range.index()),
+          /*isMutable=*/true, CommandBufferType::get(loc.getContext()));
+      SymbolTable::setSymbolVisibility(variableOp,
+                                       SymbolTable::Visibility::Private);
+      memoizeRecordingRange(range.value(), variableOp);
+    }
+  }
+};
+
+std::unique_ptr<OperationPass<ModuleOp>> createMemoizeCommandBuffersPass() {
+  return std::make_unique<MemoizeCommandBuffersPass>();
+}
+
+static PassRegistration<MemoizeCommandBuffersPass> pass(
+    "iree-hal-memoize-command-buffers",
+    "Reuses command buffers with invariant commands across invocations");
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
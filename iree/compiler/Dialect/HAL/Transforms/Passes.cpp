@@ -59,6 +59,15 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
 
   passManager.addPass(createConvertFlowToHALPass());
 
+  // Reuse command buffers that record the same commands on every invocation.
+  // Phase ordering note: this must run before canonicalization/CSE so that each
+  // recording sequence is still self-contained.
+  passManager.addPass(createMemoizeCommandBuffersPass());
+
+  // Streams are submitted asynchronously; wait for them only where the host
+  // may observe their results so that host work overlaps device execution.
+  passManager.addNestedPass<FuncOp>(createInsertStreamWaitsPass());
+
   // Phase ordering note: Before this pass, functions signatures will be based
   // on explicit shape types (such as ranked_shape). After this pass, these
   // composite types will be expanded to primitives (i.e. one 'index' for each
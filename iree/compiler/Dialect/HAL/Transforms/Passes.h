@@ -59,6 +59,14 @@ std::unique_ptr<OperationPass<FuncOp>> createInlineDeviceSwitchesPass();
 // Finds hal.device.query ops and creates variables initialized on startup.
 std::unique_ptr<OperationPass<ModuleOp>> createMemoizeDeviceQueriesPass();
 
+// Caches one-shot command buffers whose commands do not change across
+// invocations and rebinds their buffers instead of re-recording them.
+std::unique_ptr<OperationPass<ModuleOp>> createMemoizeCommandBuffersPass();
+
+// Inserts waits for asynchronous stream submissions prior to host accesses of
+// buffers they may use and prior to returning from functions.
+std::unique_ptr<OperationPass<FuncOp>> createInsertStreamWaitsPass();
+
 //===----------------------------------------------------------------------===//
 // Executable translation and optimization
 //===----------------------------------------------------------------------===//
@@ -108,6 +116,8 @@ inline void registerHALPasses() {
   auto executableOptions = getTargetOptionsFromFlags();
   createInlineDeviceSwitchesPass();
   createMemoizeDeviceQueriesPass();
+  createMemoizeCommandBuffersPass();
+  createInsertStreamWaitsPass();
   createMaterializeInterfacesPass(executableOptions);
   createTranslateExecutablesPass(executableOptions);
   createLinkExecutablesPass(executableOptions);
@@ -0,0 +1,157 @@
+// RUN: iree-opt -split-input-file -iree-hal-insert-stream-waits %s | IreeFileCheck %s
+
+// CHECK-LABEL: @waitBeforeReturn
+func @waitBeforeReturn(%arg0 : !hal.command_buffer, %arg1 : !hal.command_buffer) {
+  %dev = hal.ex.shared_device : !hal.device
+  // CHECK: hal.ex.submit %{{.+}}, %arg0
+  // CHECK-NEXT: hal.ex.submit %{{.+}}, %arg1
+  hal.ex.submit %dev, %arg0
+  hal.ex.submit %dev, %arg1
+  // CHECK-NEXT: %[[DEV:.+]] = hal.ex.shared_device
+  // CHECK-NEXT: hal.ex.wait_idle %[[DEV]]
+  // CHECK-NEXT: return
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @waitBeforeHostAccess
+func @waitBeforeHostAccess(%arg0 : !hal.command_buffer, %arg1 : !hal.buffer) -> i32 {
+  %c0 = constant 0 : index
+  %dev = hal.ex.shared_device : !hal.device
+  // CHECK: hal.ex.submit %{{.+}}, %arg0
+  hal.ex.submit %dev, %arg0
+  // CHECK-NEXT: %[[DEV:.+]] = hal.ex.shared_device
+  // CHECK-NEXT: hal.ex.wait_idle %[[DEV]]
+  // CHECK-NEXT: hal.buffer.load
+  %0 = hal.buffer.load %arg1[%c0] : i32
+  // CHECK-NOT: hal.ex.wait_idle
+  // CHECK: hal.buffer.load
+  %1 = hal.buffer.load %arg1[%c0] : i32
+  %2 = addi %0, %1 : i32
+  // CHECK-NOT: hal.ex.wait_idle
+  // CHECK: return
+  return %2 : i32
+}
+
+// -----
+
+// CHECK-LABEL: @noPendingSubmissions
+func @noPendingSubmissions(%arg0 : !hal.buffer) -> i32 {
+  %c0 = constant 0 : index
+  // CHECK-NOT: hal.ex.wait_idle
+  %0 = hal.buffer.load %arg0[%c0] : i32
+  return %0 : i32
+}
+
+// -----
+
+// CHECK-LABEL: @waitAcrossBlocks
+func @waitAcrossBlocks(%arg0 : !hal.command_buffer, %arg1 : i1) {
+  %dev = hal.ex.shared_device : !hal.device
+  // CHECK: cond_br %arg1, ^bb1, ^bb2
+  cond_br %arg1, ^bb1, ^bb2
+// CHECK-NEXT: ^bb1:
+^bb1:
+  // CHECK-NEXT: hal.ex.submit %{{.+}}, %arg0
+  // CHECK-NEXT: br ^bb2
+  hal.ex.submit %dev, %arg0
+  br ^bb2
+// CHECK-NEXT: ^bb2:
+^bb2:
+  // CHECK-NEXT: %[[DEV:.+]] = hal.ex.shared_device
+  // CHECK-NEXT: hal.ex.wait_idle %[[DEV]]
+  // CHECK-NEXT: return
+  return
+}
+
+// -----
+
+hal.variable @_command_buffer_0 mutable : !hal.command_buffer
+hal.variable @_command_buffer_1 mutable : !hal.command_buffer
+
+// Memoized streams each reuse their own command buffer and need not wait on
+// each other before rebinding it.
+
+// CHECK-LABEL: @noWaitBetweenMemoizedStreams
+func @noWaitBetweenMemoizedStreams(%arg0 : !hal.buffer, %arg1 : !hal.buffer) {
+  %dev = hal.ex.shared_device : !hal.device
+  %cached0 = hal.variable.load @_command_buffer_0 : !hal.command_buffer
+  // CHECK-NOT: hal.ex.wait_idle
+  %ok0 = hal.command_buffer.update_binding_table %cached0, buffers = [%arg0, %arg1] : i1
+  cond_br %ok0, ^bb2(%cached0 : !hal.command_buffer), ^bb1
+^bb1:
+  %cmd0 = hal.command_buffer.create %dev, "None", "Transfer|Dispatch" : !hal.command_buffer
+  hal.command_buffer.begin %cmd0
+  %ok1 = hal.command_buffer.update_binding_table %cmd0, buffers = [%arg0, %arg1] : i1
+  hal.command_buffer.end %cmd0
+  hal.variable.store %cmd0, @_command_buffer_0 : !hal.command_buffer
+  br ^bb2(%cmd0 : !hal.command_buffer)
+^bb2(%submit0 : !hal.command_buffer):
+  // CHECK: hal.ex.submit
+  hal.ex.submit %dev, %submit0
+  %cached1 = hal.variable.load @_command_buffer_1 : !hal.command_buffer
+  // CHECK-NOT: hal.ex.wait_idle
+  // CHECK: hal.command_buffer.update_binding_table
+  %ok2 = hal.command_buffer.update_binding_table %cached1, buffers = [%arg1, %arg0] : i1
+  cond_br %ok2, ^bb4(%cached1 : !hal.command_buffer), ^bb3
+^bb3:
+  // CHECK-NOT: hal.ex.wait_idle
+  %cmd1 = hal.command_buffer.create %dev, "None", "Transfer|Dispatch" : !hal.command_buffer
+  hal.command_buffer.begin %cmd1
+  // CHECK: hal.command_buffer.update_binding_table
+  %ok3 = hal.command_buffer.update_binding_table %cmd1, buffers = [%arg1, %arg0] : i1
+  hal.command_buffer.end %cmd1
+  hal.variable.store %cmd1, @_command_buffer_1 : !hal.command_buffer
+  br ^bb4(%cmd1 : !hal.command_buffer)
+^bb4(%submit1 : !hal.command_buffer):
+  // CHECK-NOT: hal.ex.wait_idle
+  // CHECK: hal.ex.submit
+  hal.ex.submit %dev, %submit1
+  // CHECK-NEXT: %[[DEV:.+]] = hal.ex.shared_device
+  // CHECK-NEXT: hal.ex.wait_idle %[[DEV]]
+  // CHECK-NEXT: return
+  return
+}
+
+// -----
+
+hal.variable @_command_buffer_0 mutable : !hal.command_buffer
+
+// Rebinding a command buffer that may still be executing must wait for it.
+
+// CHECK-LABEL: @waitBeforeRebindingInFlight
+func @waitBeforeRebindingInFlight(%arg0 : !hal.buffer, %arg1 : !hal.buffer) {
+  %dev = hal.ex.shared_device : !hal.device
+  %cached0 = hal.variable.load @_command_buffer_0 : !hal.command_buffer
+  // CHECK-NOT: hal.ex.wait_idle
+  %ok0 = hal.command_buffer.update_binding_table %cached0, buffers = [%arg0, %arg1] : i1
+  cond_br %ok0, ^bb2(%cached0 : !hal.command_buffer), ^bb1
+^bb1:
+  %cmd0 = hal.command_buffer.create %dev, "None", "Transfer|Dispatch" : !hal.command_buffer
+  hal.command_buffer.begin %cmd0
+  %ok1 = hal.command_buffer.update_binding_table %cmd0, buffers = [%arg0, %arg1] : i1
+  hal.command_buffer.end %cmd0
+  hal.variable.store %cmd0, @_command_buffer_0 : !hal.command_buffer
+  br ^bb2(%cmd0 : !hal.command_buffer)
+^bb2(%submit0 : !hal.command_buffer):
+  // CHECK: hal.ex.submit
+  hal.ex.submit %dev, %submit0
+  // CHECK-NEXT: %[[CACHED:.+]] = hal.variable.load @_command_buffer_0
+  // CHECK-NEXT: %[[DEV:.+]] = hal.ex.shared_device
+  // CHECK-NEXT: hal.ex.wait_idle %[[DEV]]
+  // CHECK-NEXT: hal.command_buffer.update_binding_table %[[CACHED]]
+  %cached1 = hal.variable.load @_command_buffer_0 : !hal.command_buffer
+  %ok2 = hal.command_buffer.update_binding_table %cached1, buffers = [%arg1, %arg0] : i1
+  cond_br %ok2, ^bb4(%cached1 : !hal.command_buffer), ^bb3
+^bb3:
+  %cmd1 = hal.command_buffer.create %dev, "None", "Transfer|Dispatch" : !hal.command_buffer
+  hal.command_buffer.begin %cmd1
+  %ok3 = hal.command_buffer.update_binding_table %cmd1, buffers = [%arg1, %arg0] : i1
+  hal.command_buffer.end %cmd1
+  hal.variable.store %cmd1, @_command_buffer_0 : !hal.command_buffer
+  br ^bb4(%cmd1 : !hal.command_buffer)
+^bb4(%submit1 : !hal.command_buffer):
+  hal.ex.submit %dev, %submit1
+  return
+}
@@ -0,0 +1,68 @@
+// RUN: iree-opt -split-input-file -iree-hal-memoize-command-buffers %s | IreeFileCheck %s
+
+// CHECK: hal.variable @_command_buffer_0 mutable : !hal.command_buffer
+
+// CHECK-LABEL: @static_stream
+func @static_stream(%arg0 : !hal.buffer, %arg1 : !hal.buffer) {
+  %c0 = constant 0 : index
+  %c16 = constant 16 : index
+  %dev = hal.ex.shared_device : !hal.device
+  //      CHECK: %[[CACHED:.+]] = hal.variable.load @_command_buffer_0 : !hal.command_buffer
+  // CHECK-NEXT: %[[OK:.+]] = hal.command_buffer.update_binding_table %[[CACHED]], buffers = [%arg0, %arg1] : i1
+  // CHECK-NEXT: cond_br %[[OK]], ^bb2(%[[CACHED]] : !hal.command_buffer), ^bb1
+  // CHECK-NEXT: ^bb1:
+  // CHECK-NEXT: %[[CMD:.+]] = hal.command_buffer.create %{{.+}}, "None", "Transfer|Dispatch" : !hal.command_buffer
+  // CHECK-NEXT: hal.command_buffer.begin %[[CMD]]
+  // CHECK-NEXT: hal.command_buffer.update_binding_table %[[CMD]], buffers = [%arg0, %arg1] : i1
+  // CHECK-NEXT: hal.command_buffer.copy_buffer %[[CMD]], %arg0, %c0, %arg1, %c0, %c16
+  // CHECK-NEXT: hal.command_buffer.end %[[CMD]]
+  // CHECK-NEXT: hal.variable.store %[[CMD]], @_command_buffer_0 : !hal.command_buffer
+  // CHECK-NEXT: br ^bb2(%[[CMD]] : !hal.command_buffer)
+  // CHECK-NEXT: ^bb2(%[[SUBMIT_CMD:.+]]: !hal.command_buffer):
+  // CHECK-NEXT: hal.ex.submit %{{.+}}, %[[SUBMIT_CMD]]
+  %cmd = hal.command_buffer.create %dev, "OneShot", "Transfer|Dispatch" : !hal.command_buffer
+  hal.command_buffer.begin %cmd
+  hal.command_buffer.copy_buffer %cmd, %arg0, %c0, %arg1, %c0, %c16
+  hal.command_buffer.end %cmd
+  hal.ex.submit %dev, %cmd
+  return
+}
+
+// -----
+
+// CHECK-NOT: hal.variable
+// CHECK-LABEL: @dynamic_stream
+func @dynamic_stream(%arg0 : !hal.buffer, %arg1 : !hal.buffer, %arg2 : index) {
+  %c0 = constant 0 : index
+  %dev = hal.ex.shared_device : !hal.device
+  // CHECK: hal.command_buffer.create %{{.+}}, "OneShot"
+  %cmd = hal.command_buffer.create %dev, "OneShot", "Transfer|Dispatch" : !hal.command_buffer
+  hal.command_buffer.begin %cmd
+  hal.command_buffer.copy_buffer %cmd, %arg0, %c0, %arg1, %c0, %arg2
+  hal.command_buffer.end %cmd
+  hal.ex.submit %dev, %cmd
+  return
+}
+
+// -----
+
+hal.variable @executable_layout : !hal.executable_layout
+hal.variable @descriptor_set : !hal.descriptor_set
+
+// CHECK-NOT: hal.variable @_command_buffer
+// CHECK-LABEL: @bound_descriptor_set_stream
+func @bound_descriptor_set_stream(%arg0 : !hal.buffer, %arg1 : !hal.buffer) {
+  %c0 = constant 0 : index
+  %c16 = constant 16 : index
+  %dev = hal.ex.shared_device : !hal.device
+  // CHECK: hal.command_buffer.create %{{.+}}, "OneShot"
+  %cmd = hal.command_buffer.create %dev, "OneShot", "Transfer|Dispatch" : !hal.command_buffer
+  hal.command_buffer.begin %cmd
+  %layout = hal.variable.load @executable_layout : !hal.executable_layout
+  %set = hal.variable.load @descriptor_set : !hal.descriptor_set
+  hal.command_buffer.bind_descriptor_set %cmd, %layout, set = 0, %set
+  hal.command_buffer.copy_buffer %cmd, %arg0, %c0, %arg1, %c0, %c16
+  hal.command_buffer.end %cmd
+  hal.ex.submit %dev, %cmd
+  return
+}
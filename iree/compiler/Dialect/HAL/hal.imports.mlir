@@ -20,6 +20,15 @@ vm.import @ex.submit_and_wait(
   %command_buffer : !vm.ref<!hal.command_buffer>
 )
 
+vm.import @ex.submit(
+  %device : !vm.ref<!hal.device>,
+  %command_buffer : !vm.ref<!hal.command_buffer>
+)
+
+vm.import @ex.wait_idle(
+  %device : !vm.ref<!hal.device>
+)
+
 //===----------------------------------------------------------------------===//
 // iree::hal::Allocator
 //===----------------------------------------------------------------------===//
@@ -236,6 +245,14 @@ vm.import @command_buffer.end(
   %command_buffer : !vm.ref<!hal.command_buffer>
 )
 
+// Replaces the buffers referenced by a reusable command buffer. Returns 1 if the
+// command buffer may be resubmitted and 0 if it must be re-recorded. A null
+// command buffer always returns 0.
+vm.import @command_buffer.update_binding_table(
+  %command_buffer : !vm.ref<!hal.command_buffer>,
+  %buffers : !vm.ref<!hal.buffer>...
+) -> i32
+
 // Defines a memory dependency between commands recorded before and after the
 // barrier.
 vm.import @command_buffer.execution_barrier(
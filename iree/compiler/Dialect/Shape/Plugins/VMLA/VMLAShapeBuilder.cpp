@@ -55,11 +55,19 @@ Value rewriteBatchMatMulPseudoOp(RankedShapeType resultShape,
                                            onlyDynamicExtents);
 }
 
+// All operands of the pseudo op have the same shape as its result so the
+// shape is forwarded from the first one.
+Value rewriteElementwisePseudoOp(RankedShapeType resultShape,
+                                 ElementwisePseudoOp op, OpBuilder &builder) {
+  return builder.create<GetRankedShapeOp>(op.getLoc(), op.srcs().front());
+}
+
 }  // namespace
 
 void populateVMLACustomOpShapeBuilder(CustomOpShapeBuilderList &builders) {
   auto &b = builders.make<CallbackCustomOpShapeBuilder>();
   b.insertOpRankedShapeBuilder<BatchMatMulPseudoOp>(rewriteBatchMatMulPseudoOp);
+  b.insertOpRankedShapeBuilder<ElementwisePseudoOp>(rewriteElementwisePseudoOp);
 }
 
 }  // namespace VMLA
@@ -17,4 +17,10 @@ vm.module @constants {
 
   // CHECK: data: [ 0, 0, 128, 63, 0, 0, 128, 63, 0, 0, 128, 63 ]
   vm.rodata @splat_float32s dense<1.000000e+00> : tensor<3xf32>
+
+  // CHECK: data: [ 0, 60, 0, 64, 0, 66 ]
+  vm.rodata @dense_float16s dense<[1.000000e+00, 2.000000e+00, 3.000000e+00]> : tensor<3xf16>
+
+  // CHECK: data: [ 128, 63, 0, 64, 64, 64 ]
+  vm.rodata @dense_bfloat16s dense<[1.000000e+00, 2.000000e+00, 3.000000e+00]> : tensor<3xbf16>
 }
@@ -44,6 +44,9 @@ VMLAConversionTarget::VMLAConversionTarget(MLIRContext *context,
   // Pseudo-ops are illegal.
   // If we end up with a lot of these, consider using an "is pseudo" trait.
   addIllegalOp<IREE::VMLA::BatchMatMulPseudoOp>();
+  addIllegalOp<IREE::VMLA::ElementwisePseudoOp>();
+  addIllegalOp<IREE::VMLA::SortPseudoOp>();
+  addIllegalOp<IREE::VMLA::TopKPseudoOp>();
 
   // Allow other ops to pass through so long as their type is valid (not a
   // tensor, basically).
@@ -117,7 +117,9 @@ struct VMLAConvOpConverter : public OpConversionPattern<xla_hlo::ConvOp> {
     auto lhsType =
         TypeAttr::get(op.lhs().getType().cast<ShapedType>().getElementType());
     auto rhsType =
-        TypeAttr::get(op.lhs().getType().cast<ShapedType>().getElementType());
+        TypeAttr::get(op.rhs().getType().cast<ShapedType>().getElementType());
+    auto dstType =
+        TypeAttr::get(op.getType().cast<ShapedType>().getElementType());
 
     SmallVector<int32_t, 4> windowStrides{1, 1};
     SmallVector<int32_t, 4> padding{0, 0, 0, 0};
@@ -158,7 +160,7 @@ struct VMLAConvOpConverter : public OpConversionPattern<xla_hlo::ConvOp> {
         rewriter.getI32VectorAttr(lhsDilation),
         rewriter.getI32VectorAttr(rhsDilation),
         rewriter.getI32IntegerAttr(featureGroupCount),
-        rewriter.getI32IntegerAttr(batchGroupCount), lhsType, rhsType, rhsType);
+        rewriter.getI32IntegerAttr(batchGroupCount), lhsType, rhsType, dstType);
 
     rewriter.replaceOp(op, dst);
 
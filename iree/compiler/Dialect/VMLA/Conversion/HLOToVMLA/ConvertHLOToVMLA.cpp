@@ -469,6 +469,19 @@ void populateHLOToVMLAPatterns(MLIRContext *context,
                                    IREE::VMLA::BatchMatMulOp>>(context,
                                                                typeConverter);
 
+  // vmla.elementwise.pseudo
+  patterns.insert<VMLAOpConversion<IREE::VMLA::ElementwisePseudoOp,
+                                   IREE::VMLA::ElementwiseOp>>(context,
+                                                               typeConverter);
+
+  // vmla.sort.pseudo and vmla.topk.pseudo
+  patterns.insert<
+      VMLAOpConversion<IREE::VMLA::SortPseudoOp, IREE::VMLA::SortOp>>(
+      context, typeConverter);
+  patterns.insert<
+      VMLAOpConversion<IREE::VMLA::TopKPseudoOp, IREE::VMLA::TopKOp>>(
+      context, typeConverter);
+
   // Simple 1:1 conversion patterns using the automated trait-based converter.
   // Used for HLO ops that have equivalent VMLA ops such as most arithmetic ops.
   patterns.insert<VMLAOpConversion<xla_hlo::AddOp, IREE::VMLA::AddOp>>(
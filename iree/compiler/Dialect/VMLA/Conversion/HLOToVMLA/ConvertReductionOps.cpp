@@ -40,9 +40,6 @@ namespace {
 // computations into a set of xla_hlo.reduce ops. This is an intermediate
 // conversion that may make it possible to use the much faster builtin VMLA
 // reduction ops.
-//
-// Only supports single dimensional reductions and assumes that unrolling has
-// been performed prior to conversion.
 struct SplitIndependentReductionOpConversion
     : public OpConversionPattern<xla_hlo::ReduceOp> {
   SplitIndependentReductionOpConversion(MLIRContext *context,
@@ -52,10 +49,7 @@ struct SplitIndependentReductionOpConversion
   LogicalResult matchAndRewrite(
       xla_hlo::ReduceOp srcOp, ArrayRef<Value> operands,
       ConversionPatternRewriter &rewriter) const override {
-    if (srcOp.dimensions().getNumElements() > 1) {
-      srcOp.emitOpError() << "multi-dimensional reductions must be unrolled";
-      return failure();
-    } else if (srcOp.body().getBlocks().size() > 1) {
+    if (srcOp.body().getBlocks().size() > 1) {
       // Control flow within the computation is not supported; bail to fallback.
       return failure();
     }
@@ -134,8 +128,8 @@ struct SplitIndependentReductionOpConversion
 // fallback path will be used and a VM loop will be emitted (slower, but can
 // perform any reduction).
 //
-// Only supports single dimensional reductions and assumes that unrolling has
-// been performed prior to conversion.
+// Multi-dimensional reductions are performed by a single builtin op that
+// reduces all of the dimensions in one pass over the source.
 struct BuiltinReduceOpConversion
     : public OpConversionPattern<xla_hlo::ReduceOp> {
   BuiltinReduceOpConversion(MLIRContext *context, TypeConverter &typeConverter)
@@ -145,10 +139,7 @@ struct BuiltinReduceOpConversion
   LogicalResult matchAndRewrite(
       xla_hlo::ReduceOp srcOp, ArrayRef<Value> operands,
       ConversionPatternRewriter &rewriter) const override {
-    if (srcOp.dimensions().getNumElements() > 1) {
-      srcOp.emitOpError() << "multi-dimensional reductions must be unrolled";
-      return failure();
-    } else if (srcOp.body().getBlocks().size() > 1) {
+    if (srcOp.body().getBlocks().size() > 1) {
       // Control flow within the computation is not supported; bail to fallback.
       return failure();
     } else if (srcOp.body().front().getOperations().size() > 2) {
@@ -162,7 +153,10 @@ struct BuiltinReduceOpConversion
     auto initValue = operands[1];
     auto initValueShape = VMLAConversionTarget::getTensorShape(
         srcOp.getLoc(), srcOp.init_values()[0], typeConverter, rewriter);
-    int dimension = srcOp.dimensions().getValue<IntegerAttr>({0}).getInt();
+    SmallVector<int32_t, 4> dimensions;
+    for (const auto &value : srcOp.dimensions().getIntValues()) {
+      dimensions.push_back(value.getSExtValue());
+    }
     auto dst = VMLAConversionTarget::allocateOutputBuffer(
         srcOp.getLoc(), srcOp.getResults()[0], typeConverter, rewriter);
     auto dstShape = VMLAConversionTarget::getTensorShape(
@@ -175,17 +169,17 @@ struct BuiltinReduceOpConversion
         isa<xla_hlo::AddOp>(computeOp)) {
       rewriter.create<IREE::VMLA::ReduceSumOp>(
           srcOp.getLoc(), operand, operandShape, initValue, initValueShape,
-          rewriter.getI32IntegerAttr(dimension), dst, dstShape,
+          rewriter.getI32VectorAttr(dimensions), dst, dstShape,
           TypeAttr::get(elementType));
     } else if (isa<xla_hlo::MinOp>(computeOp)) {
       rewriter.create<IREE::VMLA::ReduceMinOp>(
           srcOp.getLoc(), operand, operandShape, initValue, initValueShape,
-          rewriter.getI32IntegerAttr(dimension), dst, dstShape,
+          rewriter.getI32VectorAttr(dimensions), dst, dstShape,
           TypeAttr::get(elementType));
     } else if (isa<xla_hlo::MaxOp>(computeOp)) {
       rewriter.create<IREE::VMLA::ReduceMaxOp>(
           srcOp.getLoc(), operand, operandShape, initValue, initValueShape,
-          rewriter.getI32IntegerAttr(dimension), dst, dstShape,
+          rewriter.getI32VectorAttr(dimensions), dst, dstShape,
           TypeAttr::get(elementType));
     } else {
       computeOp.emitRemark() << "unsupported builtin reduction operation";
@@ -200,9 +194,6 @@ struct BuiltinReduceOpConversion
 };
 
 // Converts a generic xla_hlo.reduce to a VM loop.
-//
-// Only supports single dimensional reductions and assumes that unrolling has
-// been performed prior to conversion.
 struct GenericReduceOpConversion
     : public OpConversionPattern<xla_hlo::ReduceOp> {
   GenericReduceOpConversion(MLIRContext *context, TypeConverter &typeConverter)
@@ -211,11 +202,6 @@ struct GenericReduceOpConversion
   LogicalResult matchAndRewrite(
       xla_hlo::ReduceOp srcOp, ArrayRef<Value> operands,
       ConversionPatternRewriter &rewriter) const override {
-    if (srcOp.dimensions().getNumElements() > 1) {
-      srcOp.emitOpError() << "multi-dimensional reductions must be unrolled";
-      return failure();
-    }
-
     // TODO(benvanik): emit VM loop around computation.
     srcOp.emitOpError() << "generic reduction lowering not yet implemented";
     return failure();
@@ -0,0 +1,26 @@
+// RUN: iree-opt -split-input-file -iree-vmla-conversion -canonicalize %s | IreeFileCheck %s
+
+// CHECK-LABEL: @sort
+func @sort(%arg0 : tensor<4x8xi32>) -> tensor<4x8xi32> attributes { sym_visibility = "private" } {
+  // CHECK-DAG: %[[SHAPE:.+]] = shapex.const_ranked_shape : !shapex.ranked_shape<[4,8]>
+  // CHECK-DAG: %[[DST:.+]] = vmla.buffer.alloc byte_length = %c128 : !vmla.buffer
+  // CHECK:      vmla.sort "LT", %arg0(%[[SHAPE]] : !shapex.ranked_shape<[4,8]>),
+  // CHECK-SAME: out %[[DST]](%[[SHAPE]] : !shapex.ranked_shape<[4,8]>) : i32
+  %0 = vmla.sort.pseudo "LT", %arg0 : (tensor<4x8xi32>) -> tensor<4x8xi32>
+  // CHECK-NEXT: return %[[DST]]
+  return %0 : tensor<4x8xi32>
+}
+
+// -----
+
+// CHECK-LABEL: @topk
+func @topk(%arg0 : tensor<4x8xf32>) -> tensor<4x2xi32> attributes { sym_visibility = "private" } {
+  // CHECK-DAG: %[[SRC_SHAPE:.+]] = shapex.const_ranked_shape : !shapex.ranked_shape<[4,8]>
+  // CHECK-DAG: %[[DST_SHAPE:.+]] = shapex.const_ranked_shape : !shapex.ranked_shape<[4,2]>
+  // CHECK-DAG: %[[DST:.+]] = vmla.buffer.alloc byte_length = %c32 : !vmla.buffer
+  // CHECK:      vmla.topk "GT", %arg0(%[[SRC_SHAPE]] : !shapex.ranked_shape<[4,8]>),
+  // CHECK-SAME: out %[[DST]](%[[DST_SHAPE]] : !shapex.ranked_shape<[4,2]>) : f32
+  %0 = vmla.topk.pseudo "GT", %arg0 : (tensor<4x8xf32>) -> tensor<4x2xi32>
+  // CHECK-NEXT: return %[[DST]]
+  return %0 : tensor<4x2xi32>
+}
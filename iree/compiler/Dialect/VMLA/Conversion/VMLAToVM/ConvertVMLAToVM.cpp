@@ -115,7 +115,9 @@ class VMLAImportOpConversion : public OpConversionPattern<T> {
     }
 
     std::string typePrefix = "x";
-    if (elementType.isa<FloatType>()) {
+    if (elementType.isBF16()) {
+      typePrefix = "bf";
+    } else if (elementType.isa<FloatType>()) {
       typePrefix = "f";
     } else if (elementType.isSignlessInteger()) {
       typePrefix = forceUnsigned ? "u" : "i";
@@ -267,6 +269,7 @@ void populateVMLAToVMPatterns(MLIRContext *context, SymbolTable &importSymbols,
 
   VMLA_IMPORT_OP(IREE::VMLA::BufferConstOp, "vmla.buffer.const");
   VMLA_IMPORT_OP(IREE::VMLA::BufferAllocOp, "vmla.buffer.alloc");
+  VMLA_IMPORT_OP(IREE::VMLA::BufferScratchOp, "vmla.buffer.scratch");
   VMLA_IMPORT_OP(IREE::VMLA::BufferCloneOp, "vmla.buffer.clone");
   VMLA_IMPORT_OP(IREE::VMLA::BufferByteLengthOp, "vmla.buffer.byte_length");
   VMLA_IMPORT_OP(IREE::VMLA::BufferViewOp, "vmla.buffer.view");
@@ -314,6 +317,7 @@ void populateVMLAToVMPatterns(MLIRContext *context, SymbolTable &importSymbols,
   VMLA_TYPED_IMPORT_OP(IREE::VMLA::ClampOp, "vmla.clamp");
   VMLA_TYPED_IMPORT_OP(IREE::VMLA::FloorOp, "vmla.floor");
   VMLA_TYPED_IMPORT_OP(IREE::VMLA::CeilOp, "vmla.ceil");
+  VMLA_TYPED_IMPORT_OP(IREE::VMLA::ElementwiseOp, "vmla.elementwise");
 
   patterns.insert<VMLAConvertImportOpConversion>(context, importSymbols,
                                                  typeConverter, "vmla.convert");
@@ -330,6 +334,9 @@ void populateVMLAToVMPatterns(MLIRContext *context, SymbolTable &importSymbols,
   VMLA_TYPED_IMPORT_OP(IREE::VMLA::PoolingMinOp, "vmla.pooling.min");
   VMLA_TYPED_IMPORT_OP(IREE::VMLA::PoolingMaxOp, "vmla.pooling.max");
 
+  VMLA_TYPED_IMPORT_OP(IREE::VMLA::SortOp, "vmla.sort");
+  VMLA_TYPED_IMPORT_OP(IREE::VMLA::TopKOp, "vmla.topk");
+
   VMLA_IMPORT_OP(IREE::VMLA::InterfaceConstOp, "vmla.interface.const");
   VMLA_IMPORT_OP(IREE::VMLA::InterfaceBindingOp, "vmla.interface.binding");
 }
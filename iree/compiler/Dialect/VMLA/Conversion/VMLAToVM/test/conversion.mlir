@@ -22,6 +22,16 @@ func @bufferImport() -> !vmla.buffer {
 
 // -----
 
+// CHECK-LABEL: vm.func @scratchBufferImport
+func @scratchBufferImport() -> !vmla.buffer {
+  %c64 = std.constant 64 : index
+  // CHECK: = vm.call @vmla.buffer.scratch(%c64) : (i32) -> !vm.ref<!vmla.buffer>
+  %0 = vmla.buffer.scratch byte_length = %c64 : !vmla.buffer
+  return %0 : !vmla.buffer
+}
+
+// -----
+
 // CHECK-LABEL: vm.func @typedImport
 func @typedImport(%arg0 : !vmla.buffer, %arg1 : !vmla.buffer) {
   // CHECK-NEXT: %c1 = vm.const.i32 1 : i32
@@ -32,6 +42,19 @@ func @typedImport(%arg0 : !vmla.buffer, %arg1 : !vmla.buffer) {
 
 // -----
 
+// CHECK-LABEL: vm.func @halfTypedImport
+func @halfTypedImport(%arg0 : !vmla.buffer, %arg1 : !vmla.buffer) {
+  // CHECK-NEXT: vm.call @vmla.add.f16(%arg0, %arg0, %arg1)
+  vmla.add %arg0, %arg0, out %arg1 : f16
+  // CHECK-NEXT: vm.call @vmla.add.bf16(%arg0, %arg0, %arg1)
+  vmla.add %arg0, %arg0, out %arg1 : bf16
+  // CHECK-NEXT: vm.call @vmla.convert.bf16.f32(%arg0, %arg1)
+  vmla.convert %arg0, out %arg1 : bf16 -> f32
+  return
+}
+
+// -----
+
 // CHECK-LABEL: vm.func @sizedImport
 func @sizedImport(%arg0 : !vmla.buffer, %arg1 : !vmla.buffer) {
   // CHECK-NEXT: vm.call @vmla.select.x32(%arg0, %arg0, %arg0, %arg1)
@@ -83,3 +106,41 @@ func @batch_matmul(
                     out %dst(%dst_shape : !shapex.ranked_shape<[3,4,4]>) : f32
   return
 }
+
+// -----
+
+// CHECK-LABEL: vm.func @batch_matmul_i8
+func @batch_matmul_i8(%lhs : !vmla.buffer, %rhs : !vmla.buffer, %dst : !vmla.buffer) {
+  %lhs_shape = shapex.const_ranked_shape : !shapex.ranked_shape<[1,4,8]>
+  %rhs_shape = shapex.const_ranked_shape : !shapex.ranked_shape<[1,2,8]>
+  %dst_shape = shapex.const_ranked_shape : !shapex.ranked_shape<[1,2,4]>
+  // CHECK: vm.call.variadic @vmla.batch.matmul.i8i8.i32(
+  vmla.batch.matmul %lhs(%lhs_shape : !shapex.ranked_shape<[1,4,8]>) : i8,
+                    %rhs(%rhs_shape : !shapex.ranked_shape<[1,2,8]>) : i8,
+                    out %dst(%dst_shape : !shapex.ranked_shape<[1,2,4]>) : i32
+  return
+}
+
+// -----
+
+// CHECK-LABEL: vm.func @elementwise
+func @elementwise(%arg0 : !vmla.buffer, %arg1 : !vmla.buffer, %arg2 : !vmla.buffer) {
+  // CHECK: vm.call.variadic @vmla.elementwise.f32([%arg0, %arg1], %arg2, [{{.+}}]) : (!vm.ref<!vmla.buffer>..., !vm.ref<!vmla.buffer>, i32...)
+  vmla.elementwise(%arg0, %arg1), out %arg2 {program = dense<[1, 0, 1, 0, 14, 2, 0, 0]> : vector<8xi32>} : f32
+  return
+}
+
+// -----
+
+// CHECK-LABEL: vm.func @sort
+func @sort(%src : !vmla.buffer, %dst : !vmla.buffer) {
+  %src_shape = shapex.const_ranked_shape : !shapex.ranked_shape<[4,8]>
+  %dst_shape = shapex.const_ranked_shape : !shapex.ranked_shape<[4,2]>
+  // CHECK: vm.call.variadic @vmla.sort.f32(
+  vmla.sort "LT", %src(%src_shape : !shapex.ranked_shape<[4,8]>),
+                  out %dst(%src_shape : !shapex.ranked_shape<[4,8]>) : f32
+  // CHECK: vm.call.variadic @vmla.topk.i32(
+  vmla.topk "GT", %src(%src_shape : !shapex.ranked_shape<[4,8]>),
+                  out %dst(%dst_shape : !shapex.ranked_shape<[4,2]>) : i32
+  return
+}
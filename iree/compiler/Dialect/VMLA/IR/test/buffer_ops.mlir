@@ -22,6 +22,16 @@ func @vmla_buffer_alloc(%byte_length : index) {
 
 // -----
 
+// CHECK-LABEL: vmla_buffer_scratch
+// CHECK-SAME: %[[LENGTH:[a-zA-Z0-9$._-]+]]
+func @vmla_buffer_scratch(%byte_length : index) {
+  // CHECK: vmla.buffer.scratch byte_length = %[[LENGTH]] : !vmla.buffer
+  %result = vmla.buffer.scratch byte_length = %byte_length : !vmla.buffer
+  return
+}
+
+// -----
+
 // CHECK-LABEL: vmla_buffer_clone
 // CHECK-SAME: %[[SRC:[a-zA-Z0-9$._-]+]]
 func @vmla_buffer_clone(%src : !vmla.buffer) {
@@ -57,11 +57,11 @@ func @vmla_reduce(%src : !vmla.buffer,
   // CEHCK-SAME: %[[SRC]](%[[SRC_SHAPE]] : !shapex.ranked_shape<[4,8]>),
   // CHECK-SAME: %[[INIT]](%[[INIT_SHAPE]] : !shapex.ranked_shape<[]>),
   // CHECK-SAME: out %[[DST]](%[[DST_SHAPE]] : !shapex.ranked_shape<[4]>)
-  // CHECK-SaME: {dimension = 1 : i32} : f16
+  // CHECK-SAME: {dimensions = dense<1> : tensor<1xi32>} : f16
   vmla.reduce.sum %src(%src_shape : !shapex.ranked_shape<[4,8]>),
                   %init(%init_shape : !shapex.ranked_shape<[]>),
                   out %dst(%dst_shape : !shapex.ranked_shape<[4]>)
-                  {dimension = 1 : i32} : f16
+                  {dimensions = dense<1> : tensor<1xi32>} : f16
   return
 }
 
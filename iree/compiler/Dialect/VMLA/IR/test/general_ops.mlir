@@ -140,3 +140,17 @@ func @vmla_interface_binding(%interface : !vmla.interface) {
                          {binding = 0 : i32, set = 0 : i32} : !vmla.buffer
   return
 }
+
+// -----
+
+// CHECK-LABEL: @elementwiseOp
+// CHECK-SAME: %[[A:[a-zA-Z0-9$._-]+]]
+// CHECK-SAME: %[[B:[a-zA-Z0-9$._-]+]]
+// CHECK-SAME: %[[DST:[a-zA-Z0-9$._-]+]]
+func @elementwiseOp(%a : !vmla.buffer, %b : !vmla.buffer, %dst : !vmla.buffer) {
+  // CHECK: vmla.elementwise(%[[A]], %[[B]]), out %[[DST]]
+  // CHECK-SAME: {program = dense<[1, 0, 1, 0, 14, 2, 0, 0]> : vector<8xi32>} : f32
+  vmla.elementwise(%a, %b), out %dst
+      {program = dense<[1, 0, 1, 0, 14, 2, 0, 0]> : vector<8xi32>} : f32
+  return
+}
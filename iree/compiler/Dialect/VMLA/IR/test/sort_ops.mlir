@@ -0,0 +1,50 @@
+// Tests the printing/parsing of the VMLA dialect sorting ops.
+
+// RUN: iree-opt -split-input-file %s | iree-opt -split-input-file | IreeFileCheck %s
+
+// CHECK-LABEL: @vmla_sort
+// CHECK-SAME: %[[SRC:[a-zA-Z0-9$._-]+]]
+// CHECK-SAME: %[[SRC_SHAPE:[a-zA-Z0-9$._-]+]]
+// CHECK-SAME: %[[DST:[a-zA-Z0-9$._-]+]]
+func @vmla_sort(%src : !vmla.buffer,
+                %src_shape : !shapex.ranked_shape<[4,8]>,
+                %dst : !vmla.buffer) {
+  // CHECK:      vmla.sort "GT", %[[SRC]](%[[SRC_SHAPE]] :
+  // CHECK-SAME: !shapex.ranked_shape<[4,8]>),
+  // CHECK-SAME: out %[[DST]](%[[SRC_SHAPE]] :
+  // CHECK-SAME: !shapex.ranked_shape<[4,8]>) : f32
+  vmla.sort "GT", %src(%src_shape : !shapex.ranked_shape<[4,8]>),
+                  out %dst(%src_shape : !shapex.ranked_shape<[4,8]>) : f32
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @vmla_topk
+// CHECK-SAME: %[[SRC:[a-zA-Z0-9$._-]+]]
+// CHECK-SAME: %[[SRC_SHAPE:[a-zA-Z0-9$._-]+]]
+// CHECK-SAME: %[[DST:[a-zA-Z0-9$._-]+]]
+// CHECK-SAME: %[[DST_SHAPE:[a-zA-Z0-9$._-]+]]
+func @vmla_topk(%src : !vmla.buffer,
+                %src_shape : !shapex.ranked_shape<[4,8]>,
+                %dst : !vmla.buffer,
+                %dst_shape : !shapex.ranked_shape<[4,2]>) {
+  // CHECK:      vmla.topk "LT", %[[SRC]](%[[SRC_SHAPE]] :
+  // CHECK-SAME: !shapex.ranked_shape<[4,8]>),
+  // CHECK-SAME: out %[[DST]](%[[DST_SHAPE]] :
+  // CHECK-SAME: !shapex.ranked_shape<[4,2]>) : i32
+  vmla.topk "LT", %src(%src_shape : !shapex.ranked_shape<[4,8]>),
+                  out %dst(%dst_shape : !shapex.ranked_shape<[4,2]>) : i32
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @vmla_sort_pseudo
+func @vmla_sort_pseudo(%src : tensor<4x8xf32>) -> tensor<4x2xi32> {
+  // CHECK: vmla.sort.pseudo "LT", %arg0 : (tensor<4x8xf32>) -> tensor<4x8xi32>
+  %0 = vmla.sort.pseudo "LT", %src : (tensor<4x8xf32>) -> tensor<4x8xi32>
+  // CHECK: vmla.topk.pseudo "GT", %arg0 : (tensor<4x8xf32>) -> tensor<4x2xi32>
+  %1 = vmla.topk.pseudo "GT", %src : (tensor<4x8xf32>) -> tensor<4x2xi32>
+  return %1 : tensor<4x2xi32>
+}
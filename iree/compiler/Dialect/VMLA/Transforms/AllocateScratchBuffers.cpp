@@ -0,0 +1,191 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- AllocateScratchBuffers.cpp - Pack intermediates into scratch -------===//
+//
+// Packs statically-sized intermediate vmla.buffer.alloc ops into a single
+// vmla.buffer.scratch block. Each buffer is assigned an offset such that
+// buffers with overlapping lifetimes never overlap in memory, allowing
+// buffers that are dead to be reused by later ones. The scratch block is
+// retained by the executable across invocations so that steady-state
+// dispatches perform no allocations for their intermediates.
+//
+// Only buffers that are allocated and used entirely within the entry block and
+// never escape the function (through returns, calls, or branches) are packed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/VMLA/IR/VMLADialect.h"
+#include "iree/compiler/Dialect/VMLA/IR/VMLAOps.h"
+#include "iree/compiler/Dialect/VMLA/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VMLA {
+
+namespace {
+
+// Alignment of each buffer within the scratch block. Matches the alignment of
+// the allocator so that kernels see the same alignment as with buffer.alloc.
+constexpr int64_t kScratchBufferAlignment = 16;
+
+struct ScratchBuffer {
+  BufferAllocOp allocOp;
+  int64_t byteLength = 0;
+  // Live range as op indices within the entry block, inclusive.
+  int64_t start = 0;
+  int64_t end = 0;
+  int64_t byteOffset = 0;
+};
+
+// Returns the index of the last op within |block| that uses |buffer| or any
+// view of it, or None if the buffer may escape the block.
+Optional<int64_t> computeLastUse(
+    Value buffer, Block *block,
+    const llvm::DenseMap<Operation *, int64_t> &opIndices) {
+  int64_t lastUse = opIndices.lookup(buffer.getDefiningOp());
+  SmallVector<Value, 4> worklist{buffer};
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    for (auto *user : value.getUsers()) {
+      if (user->getBlock() != block || user->isKnownTerminator() ||
+          user->getName().getDialect() !=
+              VMLADialect::getDialectNamespace()) {
+        return llvm::None;
+      }
+      lastUse = std::max(lastUse, opIndices.lookup(user));
+      if (auto viewOp = dyn_cast<BufferViewOp>(user)) {
+        worklist.push_back(viewOp.result());
+      }
+    }
+  }
+  return lastUse;
+}
+
+// Assigns offsets to |buffers| and returns the total scratch size required.
+// Buffers are placed largest first at the lowest offset that does not overlap
+// any already-placed buffer with an intersecting live range.
+int64_t assignOffsets(MutableArrayRef<ScratchBuffer> buffers) {
+  SmallVector<ScratchBuffer *, 8> order;
+  for (auto &buffer : buffers) order.push_back(&buffer);
+  llvm::stable_sort(order, [](ScratchBuffer *lhs, ScratchBuffer *rhs) {
+    return lhs->byteLength > rhs->byteLength;
+  });
+
+  int64_t totalLength = 0;
+  SmallVector<ScratchBuffer *, 8> placed;
+  for (auto *buffer : order) {
+    // Gather the conflicting buffers sorted by offset and take the first gap
+    // large enough to fit.
+    SmallVector<ScratchBuffer *, 8> conflicts;
+    for (auto *other : placed) {
+      if (other->start <= buffer->end && buffer->start <= other->end) {
+        conflicts.push_back(other);
+      }
+    }
+    llvm::sort(conflicts, [](ScratchBuffer *lhs, ScratchBuffer *rhs) {
+      return lhs->byteOffset < rhs->byteOffset;
+    });
+    int64_t offset = 0;
+    for (auto *other : conflicts) {
+      if (offset + buffer->byteLength <= other->byteOffset) break;
+      offset = std::max(
+          offset, static_cast<int64_t>(llvm::alignTo(
+                      other->byteOffset + other->byteLength,
+                      kScratchBufferAlignment)));
+    }
+    buffer->byteOffset = offset;
+    totalLength = std::max(totalLength, offset + buffer->byteLength);
+    placed.push_back(buffer);
+  }
+  return totalLength;
+}
+
+class AllocateScratchBuffersPass
+    : public PassWrapper<AllocateScratchBuffersPass, OperationPass<FuncOp>> {
+ public:
+  void runOnOperation() override {
+    auto funcOp = getOperation();
+    if (funcOp.empty()) return;
+    auto &block = funcOp.front();
+
+    llvm::DenseMap<Operation *, int64_t> opIndices;
+    for (auto &op : llvm::enumerate(block)) {
+      opIndices[&op.value()] = op.index();
+    }
+
+    SmallVector<ScratchBuffer, 8> buffers;
+    for (auto allocOp : block.getOps<BufferAllocOp>()) {
+      APInt byteLength;
+      if (!matchPattern(allocOp.byte_length(), m_ConstantInt(&byteLength)) ||
+          byteLength.isNullValue()) {
+        continue;
+      }
+      auto lastUse = computeLastUse(allocOp.result(), &block, opIndices);
+      if (!lastUse) continue;
+      ScratchBuffer buffer;
+      buffer.allocOp = allocOp;
+      buffer.byteLength = byteLength.getSExtValue();
+      buffer.start = opIndices[allocOp.getOperation()];
+      buffer.end = *lastUse;
+      buffers.push_back(buffer);
+    }
+    if (buffers.empty()) return;
+
+    int64_t totalLength = assignOffsets(buffers);
+
+    // Buffers were gathered in block order so the first one dominates all of
+    // the others.
+    OpBuilder builder(buffers.front().allocOp);
+    auto loc = funcOp.getLoc();
+    auto scratchOp = builder.create<BufferScratchOp>(
+        loc, buffers.front().allocOp.getType(),
+        builder.create<ConstantIndexOp>(loc, totalLength));
+    for (auto &buffer : buffers) {
+      builder.setInsertionPoint(buffer.allocOp);
+      auto viewOp = builder.create<BufferViewOp>(
+          buffer.allocOp.getLoc(), buffer.allocOp.getType(),
+          scratchOp.result(),
+          builder.create<ConstantIndexOp>(loc, buffer.byteOffset),
+          buffer.allocOp.byte_length());
+      buffer.allocOp.replaceAllUsesWith(viewOp.result());
+      buffer.allocOp.erase();
+    }
+  }
+};
+
+static PassRegistration<AllocateScratchBuffersPass> pass(
+    "iree-vmla-allocate-scratch-buffers",
+    "Packs intermediate buffers with disjoint lifetimes into a shared scratch "
+    "block.");
+
+}  // namespace
+
+std::unique_ptr<OperationPass<FuncOp>> createAllocateScratchBuffersPass() {
+  return std::make_unique<AllocateScratchBuffersPass>();
+}
+
+}  // namespace VMLA
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,266 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- FuseElementwiseOps.cpp - Fuse chains of elementwise ops ------------===//
+//
+// Fuses chains of f32 elementwise ops on tensors of the same shape into
+// vmla.elementwise.pseudo ops carrying a small register program. The runtime
+// evaluates the whole chain one tile at a time instead of streaming each
+// intermediate tensor through memory, and only the result of the chain needs
+// a buffer.
+//
+// Splat constants (including broadcasts of scalar constants) are folded into
+// the program. All other values the chain reads become operands.
+//
+// NOTE: the program encoding must be kept in sync with
+// iree/hal/vmla/op_kernels.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Shape/IR/ShapeOps.h"
+#include "iree/compiler/Dialect/VMLA/IR/VMLAOps.h"
+#include "iree/compiler/Dialect/VMLA/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/bit.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "tensorflow/compiler/mlir/xla/ir/hlo_ops.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VMLA {
+
+namespace {
+
+// Opcodes of the vmla.elementwise program. Each instruction is encoded as
+// kInstructionWords i32 values: [opcode, a, b, c].
+enum class ElementwiseOpcode : int32_t {
+  kConstant = 0,
+  kAdd = 1,
+  kSub = 2,
+  kMul = 3,
+  kDiv = 4,
+  kMin = 5,
+  kMax = 6,
+  kPow = 7,
+  kNeg = 8,
+  kAbs = 9,
+  kExp = 10,
+  kLog = 11,
+  kSqrt = 12,
+  kRsqrt = 13,
+  kTanh = 14,
+  kClamp = 15,
+};
+constexpr int kInstructionWords = 4;
+
+// Returns the program opcode computing |op| or None if |op| has no equivalent.
+Optional<ElementwiseOpcode> getElementwiseOpcode(Operation *op) {
+  if (isa<xla_hlo::AddOp>(op) || isa<AddFOp>(op)) {
+    return ElementwiseOpcode::kAdd;
+  } else if (isa<xla_hlo::SubOp>(op) || isa<SubFOp>(op)) {
+    return ElementwiseOpcode::kSub;
+  } else if (isa<xla_hlo::MulOp>(op) || isa<MulFOp>(op)) {
+    return ElementwiseOpcode::kMul;
+  } else if (isa<xla_hlo::DivOp>(op) || isa<DivFOp>(op)) {
+    return ElementwiseOpcode::kDiv;
+  } else if (isa<xla_hlo::MinOp>(op)) {
+    return ElementwiseOpcode::kMin;
+  } else if (isa<xla_hlo::MaxOp>(op)) {
+    return ElementwiseOpcode::kMax;
+  } else if (isa<xla_hlo::PowOp>(op)) {
+    return ElementwiseOpcode::kPow;
+  } else if (isa<xla_hlo::NegOp>(op)) {
+    return ElementwiseOpcode::kNeg;
+  } else if (isa<xla_hlo::AbsOp>(op)) {
+    return ElementwiseOpcode::kAbs;
+  } else if (isa<xla_hlo::ExpOp>(op)) {
+    return ElementwiseOpcode::kExp;
+  } else if (isa<xla_hlo::LogOp>(op)) {
+    return ElementwiseOpcode::kLog;
+  } else if (isa<xla_hlo::SqrtOp>(op)) {
+    return ElementwiseOpcode::kSqrt;
+  } else if (isa<xla_hlo::RsqrtOp>(op)) {
+    return ElementwiseOpcode::kRsqrt;
+  } else if (isa<xla_hlo::TanhOp>(op)) {
+    return ElementwiseOpcode::kTanh;
+  } else if (isa<xla_hlo::ClampOp>(op)) {
+    return ElementwiseOpcode::kClamp;
+  }
+  return llvm::None;
+}
+
+// Returns true if |op| can be evaluated by a program: a supported f32 op whose
+// operands all have the same type as its result (no implicit broadcasting).
+bool isFusibleOp(Operation *op) {
+  if (op->getNumResults() != 1 || !getElementwiseOpcode(op)) return false;
+  auto resultType = op->getResult(0).getType().dyn_cast<RankedTensorType>();
+  if (!resultType || !resultType.getElementType().isF32()) return false;
+  return llvm::all_of(op->getOperandTypes(),
+                      [&](Type type) { return type == resultType; });
+}
+
+// Returns the value of |value| if it is a splat f32 constant, looking through
+// broadcasts of scalar constants.
+Optional<float> getSplatConstant(Value value) {
+  if (auto broadcastOp = dyn_cast_or_null<Shape::RankedBroadcastInDimOp>(
+          value.getDefiningOp())) {
+    value = broadcastOp.operand();
+  }
+  DenseElementsAttr attr;
+  if (!matchPattern(value, m_Constant(&attr)) || !attr.isSplat() ||
+      !attr.getType().getElementType().isF32()) {
+    return llvm::None;
+  }
+  return attr.getSplatValue<FloatAttr>().getValueAsDouble();
+}
+
+// Gathers the fusible producers of |root| whose results are only used within
+// the group. Returns the group ops in block order with |root| last.
+SmallVector<Operation *, 8> buildFusionGroup(
+    Operation *root, const llvm::SmallPtrSetImpl<Operation *> &fused) {
+  llvm::SetVector<Operation *> group;
+  group.insert(root);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 0; i < group.size(); ++i) {
+      for (Value operand : group[i]->getOperands()) {
+        auto *producer = operand.getDefiningOp();
+        if (!producer || group.count(producer) || fused.count(producer) ||
+            producer->getBlock() != root->getBlock() ||
+            !isFusibleOp(producer)) {
+          continue;
+        }
+        if (!llvm::all_of(producer->getUsers(), [&](Operation *user) {
+              return group.count(user) != 0;
+            })) {
+          continue;
+        }
+        group.insert(producer);
+        changed = true;
+      }
+    }
+  }
+  auto ops = llvm::to_vector<8>(group);
+  llvm::sort(ops, [](Operation *lhs, Operation *rhs) {
+    return lhs->isBeforeInBlock(rhs);
+  });
+  return ops;
+}
+
+// Replaces the |group| of ops with a single vmla.elementwise.pseudo op.
+void fuseGroup(ArrayRef<Operation *> group) {
+  Operation *root = group.back();
+  llvm::SmallPtrSet<Operation *, 8> groupSet(group.begin(), group.end());
+
+  // Values defined outside of the group become the source registers.
+  llvm::SetVector<Value> srcs;
+  for (auto *op : group) {
+    for (Value operand : op->getOperands()) {
+      if (groupSet.count(operand.getDefiningOp()) ||
+          getSplatConstant(operand)) {
+        continue;
+      }
+      srcs.insert(operand);
+    }
+  }
+  if (srcs.empty()) return;
+
+  SmallVector<int32_t, 32> program;
+  llvm::DenseMap<Value, int32_t> registers;
+  llvm::DenseMap<uint32_t, int32_t> constantRegisters;
+  for (auto src : llvm::enumerate(srcs)) {
+    registers[src.value()] = src.index();
+  }
+  int32_t nextRegister = srcs.size();
+  auto getRegister = [&](Value value) -> int32_t {
+    auto it = registers.find(value);
+    if (it != registers.end()) return it->second;
+    float constant = *getSplatConstant(value);
+    uint32_t bits = llvm::bit_cast<uint32_t>(constant);
+    auto constantIt = constantRegisters.find(bits);
+    if (constantIt != constantRegisters.end()) return constantIt->second;
+    program.append({static_cast<int32_t>(ElementwiseOpcode::kConstant),
+                    static_cast<int32_t>(bits), 0, 0});
+    constantRegisters[bits] = nextRegister;
+    return nextRegister++;
+  };
+  for (auto *op : group) {
+    SmallVector<int32_t, kInstructionWords> instruction;
+    instruction.push_back(static_cast<int32_t>(*getElementwiseOpcode(op)));
+    for (Value operand : op->getOperands()) {
+      instruction.push_back(getRegister(operand));
+    }
+    instruction.resize(kInstructionWords, 0);
+    program.append(instruction.begin(), instruction.end());
+    registers[op->getResult(0)] = nextRegister++;
+  }
+
+  OpBuilder builder(root);
+  auto fusedOp = builder.create<ElementwisePseudoOp>(
+      root->getLoc(), root->getResult(0).getType(), srcs.getArrayRef(),
+      builder.getI32VectorAttr(program));
+  root->getResult(0).replaceAllUsesWith(fusedOp.getResult());
+  for (auto *op : llvm::reverse(group)) {
+    op->erase();
+  }
+}
+
+class FuseElementwiseOpsPass
+    : public PassWrapper<FuseElementwiseOpsPass, OperationPass<FuncOp>> {
+ public:
+  void runOnOperation() override {
+    for (auto &block : getOperation()) {
+      // Walk backwards so that each group is rooted at the last op of a chain.
+      llvm::SmallPtrSet<Operation *, 16> fused;
+      SmallVector<SmallVector<Operation *, 8>, 4> groups;
+      for (auto &op : llvm::reverse(block)) {
+        if (fused.count(&op) || !isFusibleOp(&op)) continue;
+        auto group = buildFusionGroup(&op, fused);
+        // Single ops are already handled well by their builtin.
+        if (group.size() < 2) continue;
+        fused.insert(group.begin(), group.end());
+        groups.push_back(std::move(group));
+      }
+      for (auto &group : groups) {
+        fuseGroup(group);
+      }
+    }
+  }
+};
+
+static PassRegistration<FuseElementwiseOpsPass> pass(
+    "iree-vmla-fuse-elementwise-ops",
+    "Fuses chains of elementwise ops into vmla.elementwise.pseudo ops.");
+
+}  // namespace
+
+std::unique_ptr<OperationPass<FuncOp>> createFuseElementwiseOpsPass() {
+  return std::make_unique<FuseElementwiseOpsPass>();
+}
+
+}  // namespace VMLA
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
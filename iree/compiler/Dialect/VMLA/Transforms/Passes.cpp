@@ -55,15 +55,15 @@ void buildVMLATransformPassPipeline(OpPassManager &passManager) {
   // TODO(benvanik): preserve these hints during conversion.
   passManager.addNestedPass<FuncOp>(createDropCompilerHintsPass());
 
-  // Unroll multi-dimensional reductions to one reduction per dimension.
-  passManager.addNestedPass<FuncOp>(createUnrollReductionsPass());
-
   // Tensor-level pattern-based lowerings. Thrown into one pass for simplicity.
   passManager.addNestedPass<FuncOp>(createPreConversionLoweringPass());
 
   // Clean up the IR before going into shape-materialized IR.
   passManager.addNestedPass<FuncOp>(createCanonicalizerPass());
 
+  // Fuse chains of elementwise ops so they are evaluated in a single pass.
+  passManager.addNestedPass<FuncOp>(createFuseElementwiseOpsPass());
+
   // ---------------------------------------------------------------------------
   // Shape calculation.
   // Pre-conditions:
@@ -99,6 +99,12 @@ void buildVMLATransformPassPipeline(OpPassManager &passManager) {
   passManager.addNestedPass<FuncOp>(createCSEPass());
   passManager.addPass(createConversionPass());
 
+  // ---------------------------------------------------------------------------
+  // Pack intermediate buffers with disjoint lifetimes into a shared scratch
+  // block that is reused across invocations.
+  // ---------------------------------------------------------------------------
+  passManager.addNestedPass<FuncOp>(createAllocateScratchBuffersPass());
+
   // ---------------------------------------------------------------------------
   // Cleanup identity ops that clutter up the IR and canonicalize.
   // ---------------------------------------------------------------------------
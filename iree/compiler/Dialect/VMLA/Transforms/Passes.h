@@ -50,13 +50,13 @@ void createVMLATransformPassPipeline();
 // Input canonicalization and legalization
 //===----------------------------------------------------------------------===//
 
-// Unrolls multi-dimensional reduction operations into reductions along each
-// dimension, from innermost to outermost.
-std::unique_ptr<OperationPass<FuncOp>> createUnrollReductionsPass();
-
 // Tensor-level pattern-based lowerings. Thrown into one pass for simplicity.
 std::unique_ptr<OperationPass<FuncOp>> createPreConversionLoweringPass();
 
+// Fuses chains of elementwise ops into vmla.elementwise.pseudo ops that are
+// evaluated in a single pass over their operands.
+std::unique_ptr<OperationPass<FuncOp>> createFuseElementwiseOpsPass();
+
 //===----------------------------------------------------------------------===//
 // Dialect conversion
 //===----------------------------------------------------------------------===//
@@ -64,15 +64,24 @@ std::unique_ptr<OperationPass<FuncOp>> createPreConversionLoweringPass();
 // Converts from various dialects (standard, HLO, etc) to the VMLA dialect.
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createConversionPass();
 
+//===----------------------------------------------------------------------===//
+// Buffer planning
+//===----------------------------------------------------------------------===//
+
+// Packs statically-sized intermediate buffers into a reusable scratch block,
+// sharing memory between buffers whose lifetimes do not overlap.
+std::unique_ptr<OperationPass<FuncOp>> createAllocateScratchBuffersPass();
+
 //===----------------------------------------------------------------------===//
 // Register all Passes
 //===----------------------------------------------------------------------===//
 
 inline void registerVMLAPasses() {
   createVMLATransformPassPipeline();
-  createUnrollReductionsPass();
   createConversionPass();
   createPreConversionLoweringPass();
+  createFuseElementwiseOpsPass();
+  createAllocateScratchBuffersPass();
 }
 
 }  // namespace VMLA
@@ -21,6 +21,8 @@
 #include "iree/compiler/Dialect/VMLA/IR/VMLATypes.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BlockAndValueMapping.h"
@@ -42,6 +44,48 @@ namespace VMLA {
 
 namespace {
 
+// Returns the i8 source of |value| if it is an xla_hlo.convert from i8 to i32.
+// Symmetrically quantized int8 models express their dots and convolutions as
+// ops on i32 tensors widened from i8 in this way.
+Value getInt8Source(Value value) {
+  auto convertOp = dyn_cast_or_null<xla_hlo::ConvertOp>(value.getDefiningOp());
+  if (!convertOp) return nullptr;
+  Value source = convertOp.getOperand();
+  if (!getElementTypeOrSelf(source.getType()).isInteger(8) ||
+      !getElementTypeOrSelf(value.getType()).isInteger(32)) {
+    return nullptr;
+  }
+  return source;
+}
+
+// Matches an i8 x i8 -> i32 dot or convolution written in terms of widened i8
+// operands, returning the i8 operands. The runtime computes these natively
+// with i32 accumulators and no widening copies.
+bool matchInt8Operands(Operation *op, Value &lhs, Value &rhs) {
+  if (!getElementTypeOrSelf(op->getResult(0).getType()).isInteger(32)) {
+    return false;
+  }
+  lhs = getInt8Source(op->getOperand(0));
+  rhs = getInt8Source(op->getOperand(1));
+  return lhs && rhs;
+}
+
+// Replaces the operands of an int8 quantized convolution with their i8
+// sources.
+struct LowerInt8ConvOp : public OpRewritePattern<xla_hlo::ConvOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(xla_hlo::ConvOp op,
+                                PatternRewriter &rewriter) const override {
+    Value lhs, rhs;
+    if (!matchInt8Operands(op, lhs, rhs)) {
+      return rewriter.notifyMatchFailure(op, "not an int8 convolution");
+    }
+    rewriter.replaceOpWithNewOp<xla_hlo::ConvOp>(
+        op, op.getType(), ValueRange{lhs, rhs}, op.getAttrs());
+    return success();
+  }
+};
+
 // Convert instances of `xla_hlo.dot` to `xla_hlo.dot_general`.
 //
 // TODO(silvasean): This logically is part of a future HLO client -> HLO server
@@ -101,12 +145,18 @@ struct LowerDotGeneralOp : public OpRewritePattern<xla_hlo::DotGeneralOp> {
                                 PatternRewriter &rewriter) const override {
     Value lhs = op.lhs();
     Value rhs = op.rhs();
+    Value int8Lhs, int8Rhs;
+    if (matchInt8Operands(op, int8Lhs, int8Rhs)) {
+      lhs = int8Lhs;
+      rhs = int8Rhs;
+    }
     RankedTensorType lhsType = lhs.getType().dyn_cast<RankedTensorType>();
     RankedTensorType rhsType = rhs.getType().dyn_cast<RankedTensorType>();
-    Type elementType = lhsType.getElementType();
     if (!lhsType || !rhsType) {
       return rewriter.notifyMatchFailure(op, "requires ranked types");
     }
+    Type elementType = lhsType.getElementType();
+    Type dstElementType = getElementTypeOrSelf(op.getType());
     xla_hlo::DotDimensionNumbers dimNumbers = op.dot_dimension_numbers();
     auto extract1DVector = [](DenseIntElementsAttr elements) {
       SmallVector<int64_t, 6> ret;
@@ -215,11 +265,12 @@ struct LowerDotGeneralOp : public OpRewritePattern<xla_hlo::DotGeneralOp> {
     auto dstStaticShape = llvm::to_vector<6>(
         llvm::makeArrayRef({static_cast<int64_t>(-1), static_cast<int64_t>(-1),
                             static_cast<int64_t>(-1)}));
-    auto dstType = RankedTensorType::get(dstStaticShape, elementType);
+    auto dstType = RankedTensorType::get(dstStaticShape, dstElementType);
     Value dst = rewriter.create<IREE::VMLA::BatchMatMulPseudoOp>(
         op.getLoc(), dstType, lhs, rhs);
     RankedTensorType transposeType = RankedTensorType::get(
-        {dstStaticShape[0], dstStaticShape[2], dstStaticShape[1]}, elementType);
+        {dstStaticShape[0], dstStaticShape[2], dstStaticShape[1]},
+        dstElementType);
     auto transpose = rewriter.create<xla_hlo::TransposeOp>(
         op.getLoc(), transposeType, dst, make1DElementsAttr({0, 2, 1}));
     auto reshapeShape = batchingDimExtents;
@@ -277,6 +328,179 @@ class LowerBroadcastOp : public OpRewritePattern<xla_hlo::BroadcastOp> {
   }
 };
 
+// Returns the index of the operand whose elements the comparator of |op|
+// orders and whether that order is descending, or None if the comparator is
+// not a single LT/GT comparison of the two elements of one operand.
+Optional<std::pair<int, bool>> matchSortComparator(xla_hlo::SortOp op) {
+  Block &block = op.comparator().front();
+  if (block.getOperations().size() != 2) return llvm::None;
+  auto compareOp = dyn_cast<xla_hlo::CompareOp>(block.front());
+  auto returnOp = dyn_cast<xla_hlo::ReturnOp>(block.back());
+  if (!compareOp || !returnOp || returnOp.getNumOperands() != 1 ||
+      returnOp.getOperand(0) != compareOp.getResult()) {
+    return llvm::None;
+  }
+  auto lhs = compareOp.lhs().dyn_cast<BlockArgument>();
+  auto rhs = compareOp.rhs().dyn_cast<BlockArgument>();
+  if (!lhs || !rhs || lhs.getArgNumber() / 2 != rhs.getArgNumber() / 2 ||
+      lhs.getArgNumber() == rhs.getArgNumber()) {
+    return llvm::None;
+  }
+  bool descending;
+  if (compareOp.comparison_direction() == "LT") {
+    descending = false;
+  } else if (compareOp.comparison_direction() == "GT") {
+    descending = true;
+  } else {
+    return llvm::None;
+  }
+  // Comparing (rhs, lhs) reverses the order.
+  if (lhs.getArgNumber() % 2 == 1) descending = !descending;
+  return std::make_pair(static_cast<int>(lhs.getArgNumber() / 2), descending);
+}
+
+// Returns K if every result of |op| is only used by slices of the first K
+// elements along the innermost dimension, or None if any use needs more.
+Optional<int64_t> matchTopKSlices(xla_hlo::SortOp op) {
+  int64_t k = 0;
+  for (Value result : op.getResults()) {
+    auto resultType = result.getType().cast<RankedTensorType>();
+    for (Operation *user : result.getUsers()) {
+      auto sliceOp = dyn_cast<xla_hlo::SliceOp>(user);
+      if (!sliceOp) return llvm::None;
+      auto starts = sliceOp.start_indices().getValues<int64_t>();
+      auto limits = llvm::to_vector<4>(
+          sliceOp.limit_indices().getValues<int64_t>());
+      auto strides = sliceOp.strides().getValues<int64_t>();
+      if (llvm::any_of(starts, [](int64_t start) { return start != 0; }) ||
+          llvm::any_of(strides, [](int64_t stride) { return stride != 1; })) {
+        return llvm::None;
+      }
+      for (int64_t i = 0; i < resultType.getRank() - 1; ++i) {
+        if (limits[i] != resultType.getDimSize(i)) return llvm::None;
+      }
+      k = std::max(k, limits.back());
+    }
+  }
+  if (k == 0) return llvm::None;
+  return k;
+}
+
+// Lowers xla_hlo.sort with a simple comparator to a vmla.sort.pseudo op
+// computing the sorted order of the keys and a gather of each operand in that
+// order. Sorts whose results are only sliced down to their first K elements
+// (as produced by top-k) use vmla.topk.pseudo and gather only K elements.
+//
+// Sorts along other dimensions are transposed to sort the innermost one.
+struct LowerSortOp : public OpRewritePattern<xla_hlo::SortOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(xla_hlo::SortOp op,
+                                PatternRewriter &rewriter) const override {
+    auto comparator = matchSortComparator(op);
+    if (!comparator) {
+      return rewriter.notifyMatchFailure(op, "unsupported comparator");
+    }
+    Value key = op.getOperand(comparator->first);
+    auto keyType = key.getType().dyn_cast<RankedTensorType>();
+    if (!keyType || !keyType.hasStaticShape()) {
+      return rewriter.notifyMatchFailure(op, "requires static shapes");
+    }
+    Type keyElementType = keyType.getElementType();
+    if (!keyElementType.isF32() && !keyElementType.isSignlessInteger(8) &&
+        !keyElementType.isSignlessInteger(16) &&
+        !keyElementType.isSignlessInteger(32)) {
+      return rewriter.notifyMatchFailure(op, "unsupported key type");
+    }
+    int64_t rank = keyType.getRank();
+    if (rank == 0) {
+      rewriter.replaceOp(op, op.getOperands());
+      return success();
+    }
+    auto predicate = rewriter.getI32IntegerAttr(static_cast<int32_t>(
+        comparator->second ? CmpPredicate::GT : CmpPredicate::LT));
+    auto loc = op.getLoc();
+    int64_t dimension = op.dimension().getSExtValue();
+    if (dimension < 0) dimension += rank;
+
+    // Gathers each operand along the innermost dimension with |indices|.
+    auto gatherOperands = [&](ValueRange operands, Value indices) {
+      auto indicesType = indices.getType().cast<RankedTensorType>();
+      SmallVector<Value, 4> results;
+      for (Value operand : operands) {
+        auto resultType = RankedTensorType::get(
+            indicesType.getShape(), getElementTypeOrSelf(operand.getType()));
+        results.push_back(rewriter.create<xla_hlo::TorchIndexSelectOp>(
+            loc, resultType, operand, indices,
+            rewriter.getI64IntegerAttr(rank - 1),
+            rewriter.getI64IntegerAttr(rank - 1)));
+      }
+      return results;
+    };
+
+    if (dimension == rank - 1) {
+      if (auto k = matchTopKSlices(op)) {
+        if (*k < keyType.getDimSize(rank - 1)) {
+          auto shape = llvm::to_vector<4>(keyType.getShape());
+          shape.back() = *k;
+          Value indices = rewriter.create<IREE::VMLA::TopKPseudoOp>(
+              loc, RankedTensorType::get(shape, rewriter.getIntegerType(32)),
+              predicate, key);
+          auto topK = gatherOperands(op.getOperands(), indices);
+          for (auto result : llvm::enumerate(op.getResults())) {
+            for (Operation *user : llvm::make_early_inc_range(
+                     result.value().getUsers())) {
+              auto sliceOp = cast<xla_hlo::SliceOp>(user);
+              if (sliceOp.getType() == topK[result.index()].getType()) {
+                rewriter.replaceOp(sliceOp, topK[result.index()]);
+              } else {
+                rewriter.replaceOpWithNewOp<xla_hlo::SliceOp>(
+                    sliceOp, sliceOp.getType(), topK[result.index()],
+                    sliceOp.start_indices(), sliceOp.limit_indices(),
+                    sliceOp.strides());
+              }
+            }
+          }
+          rewriter.eraseOp(op);
+          return success();
+        }
+      }
+    }
+
+    // Swap the sorted dimension with the innermost one. The permutation is
+    // its own inverse.
+    SmallVector<int64_t, 4> permutation;
+    for (int64_t i = 0; i < rank; ++i) permutation.push_back(i);
+    std::swap(permutation[dimension], permutation.back());
+    auto transpose = [&](Value value) -> Value {
+      if (dimension == rank - 1) return value;
+      auto type = value.getType().cast<RankedTensorType>();
+      SmallVector<int64_t, 4> shape;
+      for (int64_t i : permutation) shape.push_back(type.getDimSize(i));
+      return rewriter.create<xla_hlo::TransposeOp>(
+          loc, RankedTensorType::get(shape, type.getElementType()), value,
+          rewriter.getI64TensorAttr(permutation));
+    };
+
+    SmallVector<Value, 4> operands;
+    for (Value operand : op.getOperands()) {
+      operands.push_back(transpose(operand));
+    }
+    Value sortedKey = operands[comparator->first];
+    Value indices = rewriter.create<IREE::VMLA::SortPseudoOp>(
+        loc,
+        RankedTensorType::get(
+            sortedKey.getType().cast<RankedTensorType>().getShape(),
+            rewriter.getIntegerType(32)),
+        predicate, sortedKey);
+    SmallVector<Value, 4> results;
+    for (Value result : gatherOperands(operands, indices)) {
+      results.push_back(transpose(result));
+    }
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+};
+
 class PreConversionLoweringPass
     : public PassWrapper<PreConversionLoweringPass, OperationPass<FuncOp>> {
  public:
@@ -297,6 +521,13 @@ class PreConversionLoweringPass
     patterns.insert<LowerBroadcastInDimOp>(context);
     target.addIllegalOp<xla_hlo::BroadcastOp>();
     patterns.insert<LowerBroadcastOp>(context);
+    target.addDynamicallyLegalOp<xla_hlo::ConvOp>([](xla_hlo::ConvOp op) {
+      Value lhs, rhs;
+      return !matchInt8Operands(op, lhs, rhs);
+    });
+    patterns.insert<LowerInt8ConvOp>(context);
+    target.addIllegalOp<xla_hlo::SortOp>();
+    patterns.insert<LowerSortOp>(context);
 
     if (failed(applyPartialConversion(getOperation(), target, patterns))) {
       return signalPassFailure();
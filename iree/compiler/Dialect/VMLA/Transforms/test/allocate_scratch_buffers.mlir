@@ -0,0 +1,51 @@
+// RUN: iree-opt -split-input-file -iree-vmla-allocate-scratch-buffers %s | IreeFileCheck %s
+
+// CHECK-LABEL: func @reuseDisjointLifetimes
+func @reuseDisjointLifetimes(%arg0: !vmla.interface) {
+  %c0 = constant 0 : index
+  %c16 = constant 16 : index
+  %0 = vmla.interface.binding %arg0 {binding = 0 : i32, set = 0 : i32} : !vmla.buffer
+  //      CHECK: %[[SIZE:.+]] = constant 32 : index
+  // CHECK-NEXT: %[[SCRATCH:.+]] = vmla.buffer.scratch byte_length = %[[SIZE]] : !vmla.buffer
+  // CHECK-NEXT: %[[OFFSET_A:.+]] = constant 0 : index
+  // CHECK-NEXT: %[[A:.+]] = vmla.buffer.view %[[SCRATCH]][%[[OFFSET_A]]], byte_length = %c16 : !vmla.buffer
+  // CHECK-NEXT: vmla.add %0, %0, out %[[A]] : f32
+  %1 = vmla.buffer.alloc byte_length = %c16 : !vmla.buffer
+  vmla.add %0, %0, out %1 : f32
+  // The lifetime of %2 overlaps that of %1 and it must be placed after it.
+  // CHECK-NEXT: %[[OFFSET_B:.+]] = constant 16 : index
+  // CHECK-NEXT: %[[B:.+]] = vmla.buffer.view %[[SCRATCH]][%[[OFFSET_B]]], byte_length = %c16 : !vmla.buffer
+  // CHECK-NEXT: vmla.add %[[A]], %[[A]], out %[[B]] : f32
+  %2 = vmla.buffer.alloc byte_length = %c16 : !vmla.buffer
+  vmla.add %1, %1, out %2 : f32
+  // %1 is dead by the time %3 is allocated so %3 reuses its memory.
+  // CHECK-NEXT: %[[OFFSET_C:.+]] = constant 0 : index
+  // CHECK-NEXT: %[[C:.+]] = vmla.buffer.view %[[SCRATCH]][%[[OFFSET_C]]], byte_length = %c16 : !vmla.buffer
+  // CHECK-NEXT: vmla.add %[[B]], %[[B]], out %[[C]] : f32
+  %3 = vmla.buffer.alloc byte_length = %c16 : !vmla.buffer
+  vmla.add %2, %2, out %3 : f32
+  %4 = vmla.interface.binding %arg0 {binding = 1 : i32, set = 0 : i32} : !vmla.buffer
+  // CHECK: vmla.buffer.copy %[[C]][%c0]
+  vmla.buffer.copy %3[%c0], out %4[%c0], byte_length = %c16
+  return
+}
+
+// -----
+
+// Buffers escaping the function and dynamically-sized buffers are left as-is.
+
+// CHECK-LABEL: func @unplannedBuffers
+func @unplannedBuffers(%arg0: index) -> !vmla.buffer {
+  %c0 = constant 0 : index
+  %c16 = constant 16 : index
+  // CHECK-NOT: vmla.buffer.scratch
+  // CHECK: %[[ESCAPING:.+]] = vmla.buffer.alloc byte_length = %c16 : !vmla.buffer
+  %0 = vmla.buffer.alloc byte_length = %c16 : !vmla.buffer
+  // CHECK: %[[VIEW:.+]] = vmla.buffer.view %[[ESCAPING]]
+  %1 = vmla.buffer.view %0[%c0], byte_length = %c16 : !vmla.buffer
+  // CHECK: %[[DYNAMIC:.+]] = vmla.buffer.alloc byte_length = %arg0 : !vmla.buffer
+  %2 = vmla.buffer.alloc byte_length = %arg0 : !vmla.buffer
+  vmla.add %2, %2, out %1 : f32
+  // CHECK: return %[[VIEW]]
+  return %1 : !vmla.buffer
+}
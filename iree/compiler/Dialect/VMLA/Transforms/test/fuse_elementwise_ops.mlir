@@ -0,0 +1,46 @@
+// RUN: iree-opt -split-input-file -iree-vmla-fuse-elementwise-ops %s | IreeFileCheck %s
+
+// CHECK-LABEL: func @chain
+func @chain(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+  %cst = constant dense<5.000000e-01> : tensor<f32>
+  %rs = shapex.const_ranked_shape : !shapex.ranked_shape<[4]>
+  %half = "shapex.ranked_broadcast_in_dim"(%cst, %rs) {broadcast_dimensions = dense<[]> : tensor<0xi64>} : (tensor<f32>, !shapex.ranked_shape<[4]>) -> tensor<4xf32>
+  //  CHECK-NOT: xla_hlo
+  //      CHECK: %[[FUSED:.+]] = vmla.elementwise.pseudo(%arg0, %arg1)
+  // CHECK-SAME: {program = dense<[0, 1056964608, 0, 0, 3, 0, 2, 0, 1, 3, 1, 0, 14, 4, 0, 0]> : vector<16xi32>}
+  // CHECK-SAME: : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %0 = xla_hlo.multiply %arg0, %half : tensor<4xf32>
+  %1 = xla_hlo.add %0, %arg1 : tensor<4xf32>
+  %2 = "xla_hlo.tanh"(%1) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK-NEXT: return %[[FUSED]]
+  return %2 : tensor<4xf32>
+}
+
+// -----
+
+// Values used outside of the chain are materialized.
+
+// CHECK-LABEL: func @external_use
+func @external_use(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  // CHECK: %[[ADD:.+]] = xla_hlo.add %arg0, %arg1
+  %0 = xla_hlo.add %arg0, %arg1 : tensor<4xf32>
+  //      CHECK: %[[FUSED:.+]] = vmla.elementwise.pseudo(%[[ADD]])
+  // CHECK-SAME: {program = dense<[10, 0, 0, 0, 3, 1, 1, 0]> : vector<8xi32>}
+  %1 = "xla_hlo.exponential"(%0) : (tensor<4xf32>) -> tensor<4xf32>
+  %2 = xla_hlo.multiply %1, %1 : tensor<4xf32>
+  // CHECK: return %[[ADD]], %[[FUSED]]
+  return %0, %2 : tensor<4xf32>, tensor<4xf32>
+}
+
+// -----
+
+// Single ops and non-f32 chains are left to the builtin ops.
+
+// CHECK-LABEL: func @unfused
+func @unfused(%arg0: tensor<4xf32>, %arg1: tensor<4xi32>) -> (tensor<4xf32>, tensor<4xi32>) {
+  // CHECK-NOT: vmla.elementwise.pseudo
+  %0 = xla_hlo.add %arg0, %arg0 : tensor<4xf32>
+  %1 = xla_hlo.add %arg1, %arg1 : tensor<4xi32>
+  %2 = xla_hlo.multiply %1, %1 : tensor<4xi32>
+  return %0, %2 : tensor<4xf32>, tensor<4xi32>
+}
@@ -16,6 +16,20 @@ func @f(%arg0: tensor<3x4xf32>, %arg1: tensor<4x5xf32>) -> tensor<3x5xf32> {
 
 // -----
 
+// Widened int8 operands are consumed directly by the i8 x i8 -> i32 matmul.
+// CHECK-LABEL: func @dotInt8
+func @dotInt8(%arg0: tensor<3x4xi8>, %arg1: tensor<4x5xi8>) -> tensor<3x5xi32> {
+  // CHECK: "xla_hlo.transpose"(%arg0)
+  // CHECK: "xla_hlo.transpose"(%arg1)
+  // CHECK: vmla.batch.matmul.pseudo %{{.+}}, %{{.+}} : (tensor<?x?x?xi8>, tensor<?x?x?xi8>) -> tensor<?x?x?xi32>
+  %0 = "xla_hlo.convert"(%arg0) : (tensor<3x4xi8>) -> tensor<3x4xi32>
+  %1 = "xla_hlo.convert"(%arg1) : (tensor<4x5xi8>) -> tensor<4x5xi32>
+  %2 = "xla_hlo.dot"(%0, %1) : (tensor<3x4xi32>, tensor<4x5xi32>) -> tensor<3x5xi32>
+  return %2 : tensor<3x5xi32>
+}
+
+// -----
+
 // CHECK-LABEL: func @f
 func @f(%arg0: tensor<3xf32>) -> tensor<4x3xf32> {
   // CHECK: "shapex.ranked_broadcast_in_dim"(%arg0, %rs4_3)
@@ -31,3 +45,59 @@ func @f(%arg0: tensor<3xf32>) -> tensor<5x6x3xf32> {
   %0 = "xla_hlo.broadcast"(%arg0) {broadcast_sizes = dense<[5, 6]> : tensor<2xi64>} : (tensor<3xf32>) -> tensor<5x6x3xf32>
   return %0 : tensor<5x6x3xf32>
 }
+
+// -----
+
+// CHECK-LABEL: func @sortKeyValue
+func @sortKeyValue(%arg0: tensor<4x8xf32>, %arg1: tensor<4x8xi32>) -> (tensor<4x8xf32>, tensor<4x8xi32>) {
+  // CHECK: %[[INDICES:.+]] = vmla.sort.pseudo "LT", %arg0 : (tensor<4x8xf32>) -> tensor<4x8xi32>
+  // CHECK: %[[KEYS:.+]] = "xla_hlo.torch_index_select"(%arg0, %[[INDICES]]) {batch_dims = 1 : i64, dim = 1 : i64} : (tensor<4x8xf32>, tensor<4x8xi32>) -> tensor<4x8xf32>
+  // CHECK: %[[VALUES:.+]] = "xla_hlo.torch_index_select"(%arg1, %[[INDICES]]) {batch_dims = 1 : i64, dim = 1 : i64} : (tensor<4x8xi32>, tensor<4x8xi32>) -> tensor<4x8xi32>
+  // CHECK: return %[[KEYS]], %[[VALUES]]
+  %0:2 = "xla_hlo.sort"(%arg0, %arg1) ( {
+  ^bb0(%a: tensor<f32>, %b: tensor<f32>, %c: tensor<i32>, %d: tensor<i32>):
+    %p = "xla_hlo.compare"(%a, %b) {comparison_direction = "LT"} : (tensor<f32>, tensor<f32>) -> tensor<i1>
+    "xla_hlo.return"(%p) : (tensor<i1>) -> ()
+  }) {dimension = 1 : i64, is_stable = true} : (tensor<4x8xf32>, tensor<4x8xi32>) -> (tensor<4x8xf32>, tensor<4x8xi32>)
+  return %0#0, %0#1 : tensor<4x8xf32>, tensor<4x8xi32>
+}
+
+// -----
+
+// Sorting along an outer dimension transposes it to be innermost. Swapped
+// comparator arguments sort descending.
+// CHECK-LABEL: func @sortOuterDimension
+func @sortOuterDimension(%arg0: tensor<8x4xi32>) -> tensor<8x4xi32> {
+  // CHECK: %[[TRANSPOSED:.+]] = "xla_hlo.transpose"(%arg0) {permutation = dense<[1, 0]> : tensor<2xi64>} : (tensor<8x4xi32>) -> tensor<4x8xi32>
+  // CHECK: %[[INDICES:.+]] = vmla.sort.pseudo "GT", %[[TRANSPOSED]] : (tensor<4x8xi32>) -> tensor<4x8xi32>
+  // CHECK: %[[SORTED:.+]] = "xla_hlo.torch_index_select"(%[[TRANSPOSED]], %[[INDICES]])
+  // CHECK: %[[RESULT:.+]] = "xla_hlo.transpose"(%[[SORTED]]) {permutation = dense<[1, 0]> : tensor<2xi64>} : (tensor<4x8xi32>) -> tensor<8x4xi32>
+  // CHECK: return %[[RESULT]]
+  %0 = "xla_hlo.sort"(%arg0) ( {
+  ^bb0(%a: tensor<i32>, %b: tensor<i32>):
+    %p = "xla_hlo.compare"(%b, %a) {comparison_direction = "LT"} : (tensor<i32>, tensor<i32>) -> tensor<i1>
+    "xla_hlo.return"(%p) : (tensor<i1>) -> ()
+  }) {dimension = 0 : i64} : (tensor<8x4xi32>) -> tensor<8x4xi32>
+  return %0 : tensor<8x4xi32>
+}
+
+// -----
+
+// Sorts only sliced down to their first K elements select those directly.
+// CHECK-LABEL: func @topK
+func @topK(%arg0: tensor<4x8xf32>, %arg1: tensor<4x8xi32>) -> (tensor<4x2xf32>, tensor<4x2xi32>, tensor<4x1xi32>) {
+  // CHECK: %[[INDICES:.+]] = vmla.topk.pseudo "GT", %arg0 : (tensor<4x8xf32>) -> tensor<4x2xi32>
+  // CHECK: %[[KEYS:.+]] = "xla_hlo.torch_index_select"(%arg0, %[[INDICES]]) {batch_dims = 1 : i64, dim = 1 : i64} : (tensor<4x8xf32>, tensor<4x2xi32>) -> tensor<4x2xf32>
+  // CHECK: %[[VALUES:.+]] = "xla_hlo.torch_index_select"(%arg1, %[[INDICES]]) {batch_dims = 1 : i64, dim = 1 : i64} : (tensor<4x8xi32>, tensor<4x2xi32>) -> tensor<4x2xi32>
+  // CHECK: %[[FIRST:.+]] = "xla_hlo.slice"(%[[VALUES]])
+  // CHECK: return %[[KEYS]], %[[VALUES]], %[[FIRST]]
+  %0:2 = "xla_hlo.sort"(%arg0, %arg1) ( {
+  ^bb0(%a: tensor<f32>, %b: tensor<f32>, %c: tensor<i32>, %d: tensor<i32>):
+    %p = "xla_hlo.compare"(%a, %b) {comparison_direction = "GT"} : (tensor<f32>, tensor<f32>) -> tensor<i1>
+    "xla_hlo.return"(%p) : (tensor<i1>) -> ()
+  }) {dimension = 1 : i64, is_stable = true} : (tensor<4x8xf32>, tensor<4x8xi32>) -> (tensor<4x8xf32>, tensor<4x8xi32>)
+  %1 = "xla_hlo.slice"(%0#0) {limit_indices = dense<[4, 2]> : tensor<2xi64>, start_indices = dense<0> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>} : (tensor<4x8xf32>) -> tensor<4x2xf32>
+  %2 = "xla_hlo.slice"(%0#1) {limit_indices = dense<[4, 2]> : tensor<2xi64>, start_indices = dense<0> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>} : (tensor<4x8xi32>) -> tensor<4x2xi32>
+  %3 = "xla_hlo.slice"(%0#1) {limit_indices = dense<[4, 1]> : tensor<2xi64>, start_indices = dense<0> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>} : (tensor<4x8xi32>) -> tensor<4x1xi32>
+  return %1, %2, %3 : tensor<4x2xf32>, tensor<4x2xi32>, tensor<4x1xi32>
+}
@@ -21,9 +21,10 @@ hal.interface @legacy_io attributes {sym_visibility = "private"} {
 // CHECK-NEXT:   %c16 = constant 16 : index
 // CHECK-NEXT:   %0 = vmla.interface.binding %arg0 {binding = 0 : i32, set = 0 : i32} : !vmla.buffer
 // CHECK-NEXT:   %1 = vmla.buffer.view %0[%c0], byte_length = %c16 : !vmla.buffer
-// CHECK-NEXT:   %2 = vmla.buffer.alloc byte_length = %c16 : !vmla.buffer
-// CHECK-NEXT:   vmla.add %1, %1, out %2 : f32
-// CHECK-NEXT:   %3 = vmla.interface.binding %arg0 {binding = 1 : i32, set = 0 : i32} : !vmla.buffer
-// CHECK-NEXT:   vmla.buffer.copy %2[%c0], out %3[%c0], byte_length = %c16
+// CHECK-NEXT:   %2 = vmla.buffer.scratch byte_length = %c16 : !vmla.buffer
+// CHECK-NEXT:   %3 = vmla.buffer.view %2[%c0], byte_length = %c16 : !vmla.buffer
+// CHECK-NEXT:   vmla.add %1, %1, out %3 : f32
+// CHECK-NEXT:   %4 = vmla.interface.binding %arg0 {binding = 1 : i32, set = 0 : i32} : !vmla.buffer
+// CHECK-NEXT:   vmla.buffer.copy %3[%c0], out %4[%c0], byte_length = %c16
 // CHECK-NEXT:   return
 // CHECK-NEXT: }
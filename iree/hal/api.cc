@@ -1414,6 +1414,21 @@ iree_hal_command_buffer_end(iree_hal_command_buffer_t* command_buffer) {
   return ToApiStatus(handle->End());
 }
 
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_command_buffer_update_binding_table(
+    iree_hal_command_buffer_t* command_buffer, iree_host_size_t buffer_count,
+    iree_hal_buffer_t** buffers) {
+  IREE_TRACE_SCOPE0("iree_hal_command_buffer_update_binding_table");
+  auto* handle = reinterpret_cast<CommandBuffer*>(command_buffer);
+  if (!handle) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  } else if (buffer_count && !buffers) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+  return ToApiStatus(handle->UpdateBindingTable(absl::MakeConstSpan(
+      reinterpret_cast<Buffer* const*>(buffers), buffer_count)));
+}
+
 IREE_API_EXPORT iree_status_t IREE_API_CALL
 iree_hal_command_buffer_execution_barrier(
     iree_hal_command_buffer_t* command_buffer,
@@ -193,6 +193,7 @@ typedef struct {
 
 // A bitfield specifying the mode of operation for a command buffer.
 enum iree_hal_command_buffer_mode_e {
+  IREE_HAL_COMMAND_BUFFER_MODE_NONE = 0u,
   // Command buffer will be submitted once and never used again.
   // This may enable in-place patching of command buffers that reduce overhead
   // when it's known that command buffers will not be reused.
@@ -928,6 +929,18 @@ iree_hal_command_buffer_begin(iree_hal_command_buffer_t* command_buffer);
 IREE_API_EXPORT iree_status_t IREE_API_CALL
 iree_hal_command_buffer_end(iree_hal_command_buffer_t* command_buffer);
 
+// Updates the binding table of a reusable command buffer.
+// When called while recording the buffers declare the table slots; when called
+// after recording has ended the slot contents are replaced so that the command
+// buffer can be submitted again without re-recording.
+//
+// Returns IREE_STATUS_FAILED_PRECONDITION or IREE_STATUS_UNIMPLEMENTED if the
+// command buffer must be re-recorded instead.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_command_buffer_update_binding_table(
+    iree_hal_command_buffer_t* command_buffer, iree_host_size_t buffer_count,
+    iree_hal_buffer_t** buffers);
+
 // Defines a memory dependency between commands recorded before and after the
 // barrier. One or more memory or buffer barriers can be specified to indicate
 // between which stages or buffers the dependencies exist.
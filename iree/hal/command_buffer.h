@@ -32,9 +32,14 @@ namespace hal {
 
 // A bitfield specifying the mode of operation for a command buffer.
 enum class CommandBufferMode : uint32_t {
+  kNone = 0,
+
   // Command buffer will be submitted once and never used again.
   // This may enable in-place patching of command buffers that reduce overhead
   // when it's known that command buffers will not be reused.
+  //
+  // Command buffers created without this bit may be submitted multiple times
+  // and may support rebinding buffers with CommandBuffer::UpdateBindingTable.
   kOneShot = 1 << 0,
 };
 IREE_BITFIELD(CommandBufferMode);
@@ -188,6 +193,24 @@ class CommandBuffer : public Resource {
   // This must be called prior to submitting the command buffer for execution.
   virtual Status End() = 0;
 
+  // Updates the binding table used to resolve buffer references when a
+  // reusable (non-kOneShot) command buffer is submitted.
+  //
+  // When called while recording the |buffers| declare the table: any command
+  // recorded afterward that references one of the buffers will instead
+  // reference its slot. When called after End the slot contents are replaced
+  // so that the same recorded commands can be submitted again against new
+  // buffers without re-recording. The table size must match the declaration.
+  //
+  // Returns FAILED_PRECONDITION if the new buffers cannot be bound without
+  // re-recording (such as when buffers that aliased during recording no longer
+  // alias) and UNIMPLEMENTED if the implementation does not support binding
+  // tables. In both cases the command buffer should be re-recorded.
+  virtual Status UpdateBindingTable(absl::Span<Buffer* const> buffers) {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Binding tables not supported by this command buffer";
+  }
+
   // TODO(benvanik): annotations for debugging and tracing:
   //  enter/exit
   //  stack frame manipulation
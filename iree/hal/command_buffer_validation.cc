@@ -38,6 +38,7 @@ class ValidatingCommandBuffer : public CommandBuffer {
 
   Status Begin() override;
   Status End() override;
+  Status UpdateBindingTable(absl::Span<Buffer* const> buffers) override;
 
   Status ExecutionBarrier(
       ExecutionStageBitfield source_stage_mask,
@@ -131,6 +132,23 @@ Status ValidatingCommandBuffer::End() {
   return impl_->End();
 }
 
+Status ValidatingCommandBuffer::UpdateBindingTable(
+    absl::Span<Buffer* const> buffers) {
+  DVLOG(3) << "CommandBuffer::UpdateBindingTable(" << buffers.size()
+           << " buffers)";
+  if (AllBitsSet(mode(), CommandBufferMode::kOneShot)) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "One-shot command buffers cannot be rebound";
+  }
+  for (auto* buffer : buffers) {
+    if (!buffer) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Binding table buffers must not be null";
+    }
+  }
+  return impl_->UpdateBindingTable(buffers);
+}
+
 Status ValidatingCommandBuffer::ValidateCategories(
     CommandCategoryBitfield required_categories) const {
   if (!AllBitsSet(command_categories(), required_categories)) {
@@ -0,0 +1,59 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/dylib/dylib_command_processor.h"
+
+#include "iree/base/tracing.h"
+#include "iree/hal/buffer.h"
+#include "iree/hal/dylib/dylib_executable.h"
+#include "iree/hal/host/host_buffer.h"
+
+namespace iree {
+namespace hal {
+namespace dylib {
+
+DyLibCommandProcessor::DyLibCommandProcessor(
+    Allocator* allocator, CommandBufferModeBitfield mode,
+    CommandCategoryBitfield command_categories)
+    : HostLocalCommandProcessor(allocator, mode, command_categories) {}
+
+DyLibCommandProcessor::~DyLibCommandProcessor() = default;
+
+Status DyLibCommandProcessor::DispatchInline(
+    Executable* executable, int32_t entry_point,
+    std::array<uint32_t, 3> workgroups, const PushConstantBlock& push_constants,
+    absl::Span<const absl::Span<const DescriptorSet::Binding>> set_bindings) {
+  IREE_TRACE_SCOPE0("DyLibCommandProcessor::DispatchInline");
+  auto* dylib_executable = static_cast<DyLibExecutable*>(executable);
+
+  // Executables share the calling convention of the JIT'ed LLVM executables.
+  // The invocation functions take the base pointer of each binding and build
+  // the memref descriptors themselves. Host buffers are always mapped so the
+  // pointers are taken directly from the allocations and the argument block
+  // is reused across dispatches.
+  binding_ptrs_.clear();
+  for (const auto& bindings : set_bindings) {
+    for (const auto& io_binding : bindings) {
+      auto* buffer = io_binding.buffer;
+      auto* data = static_cast<uint8_t*>(
+          static_cast<HostBuffer*>(buffer->allocated_buffer())->mutable_data());
+      binding_ptrs_.push_back(data + buffer->byte_offset() + io_binding.offset);
+    }
+  }
+  return dylib_executable->Invoke(entry_point, absl::MakeSpan(binding_ptrs_));
+}
+
+}  // namespace dylib
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,176 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/dylib/dylib_executable.h"
+
+#include <cstdlib>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "flatbuffers/flatbuffers.h"
+#include "iree/base/file_io.h"
+#include "iree/base/file_path.h"
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+#include "iree/schemas/dylib_executable_def_generated.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <unistd.h>
+
+#include <cerrno>
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_APPLE || IREE_PLATFORM_LINUX
+
+namespace iree {
+namespace hal {
+namespace dylib {
+
+namespace {
+
+using InvocationFunc = void (*)(void**);
+
+#if defined(IREE_PLATFORM_WINDOWS)
+constexpr const char kLibraryExtension[] = ".dll";
+#else
+constexpr const char kLibraryExtension[] = ".so";
+#endif  // IREE_PLATFORM_WINDOWS
+
+// Writes |contents| to a new file in the system temporary directory and
+// returns its path.
+//
+// The file is created exclusively and is only accessible by the current user
+// so that other users cannot substitute the library between it being written
+// and loaded.
+StatusOr<std::string> WriteTemporaryLibrary(absl::string_view contents) {
+  const char* temp_dir = std::getenv("TMPDIR");
+  if (!temp_dir || !temp_dir[0]) temp_dir = "/tmp";
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+  // mkstemps creates the file with O_EXCL and mode 0600.
+  std::string path = file_path::JoinPaths(
+      temp_dir, absl::StrCat("iree_dylib_XXXXXX", kLibraryExtension));
+  int fd = mkstemps(&path[0], sizeof(kLibraryExtension) - 1);
+  if (fd == -1) {
+    return ErrnoToCanonicalStatusBuilder(
+        errno, absl::StrCat("Failed to create temporary file '", path, "'"),
+        IREE_LOC);
+  }
+  while (!contents.empty()) {
+    ssize_t written = write(fd, contents.data(), contents.size());
+    if (written == -1) {
+      if (errno == EINTR) continue;
+      int error = errno;
+      close(fd);
+      file_io::DeleteFile(path).IgnoreError();
+      return ErrnoToCanonicalStatusBuilder(
+          error, absl::StrCat("Failed to write temporary file '", path, "'"),
+          IREE_LOC);
+    }
+    contents.remove_prefix(written);
+  }
+  if (close(fd) == -1) {
+    int error = errno;
+    file_io::DeleteFile(path).IgnoreError();
+    return ErrnoToCanonicalStatusBuilder(
+        error, absl::StrCat("Failed to close temporary file '", path, "'"),
+        IREE_LOC);
+  }
+  return path;
+#else
+  // The temporary directory is per-user on Windows.
+  std::string path = file_path::JoinPaths(
+      temp_dir, absl::StrCat("iree_dylib_", absl::ToUnixNanos(absl::Now()),
+                             kLibraryExtension));
+  RETURN_IF_ERROR(file_io::SetFileContents(path, std::string(contents)));
+  return path;
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_APPLE || IREE_PLATFORM_LINUX
+}
+
+}  // namespace
+
+// static
+StatusOr<ref_ptr<DyLibExecutable>> DyLibExecutable::Load(ExecutableSpec spec) {
+  IREE_TRACE_SCOPE0("DyLibExecutable::Load");
+  auto executable = make_ref<DyLibExecutable>();
+  RETURN_IF_ERROR(executable->Initialize(spec));
+  return executable;
+}
+
+DyLibExecutable::DyLibExecutable() = default;
+
+DyLibExecutable::~DyLibExecutable() {
+  IREE_TRACE_SCOPE0("DyLibExecutable::dtor");
+  // The library must be unloaded before the backing file can be removed.
+  executable_library_.reset();
+  if (!library_temp_path_.empty()) {
+    file_io::DeleteFile(library_temp_path_).IgnoreError();
+  }
+}
+
+Status DyLibExecutable::Initialize(ExecutableSpec spec) {
+  IREE_TRACE_SCOPE0("DyLibExecutable::Initialize");
+
+  auto dylib_executable_def =
+      ::flatbuffers::GetRoot<DyLibExecutableDef>(spec.executable_data.data());
+  if (!dylib_executable_def->entry_points() ||
+      dylib_executable_def->entry_points()->size() == 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "No entry points defined";
+  }
+  if (!dylib_executable_def->library_embedded() ||
+      dylib_executable_def->library_embedded()->size() == 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "No embedded library";
+  }
+
+  // System loaders can only load libraries from files so we write the
+  // embedded library out to a temporary file first.
+  const auto* library_embedded = dylib_executable_def->library_embedded();
+  ASSIGN_OR_RETURN(library_temp_path_,
+                   WriteTemporaryLibrary(absl::string_view(
+                       reinterpret_cast<const char*>(library_embedded->data()),
+                       library_embedded->size())));
+  ASSIGN_OR_RETURN(executable_library_,
+                   DynamicLibrary::Load(library_temp_path_.c_str()));
+
+  const auto& entry_points = *dylib_executable_def->entry_points();
+  entry_functions_.resize(entry_points.size());
+  for (int i = 0; i < entry_functions_.size(); ++i) {
+    auto symbol_name = absl::StrCat("invoke_", entry_points[i]->str());
+    void* symbol = executable_library_->GetSymbol(symbol_name.c_str());
+    if (!symbol) {
+      return NotFoundErrorBuilder(IREE_LOC)
+             << "Could not find symbol: " << symbol_name;
+    }
+    entry_functions_[i] = symbol;
+  }
+
+  return OkStatus();
+}
+
+Status DyLibExecutable::Invoke(int entry_point, absl::Span<void*> args) const {
+  if (entry_point < 0 || entry_point >= entry_functions_.size()) {
+    return OutOfRangeErrorBuilder(IREE_LOC)
+           << "Entry point " << entry_point << " out of range ("
+           << entry_functions_.size() << " defined)";
+  }
+  auto entry_function =
+      reinterpret_cast<InvocationFunc>(entry_functions_[entry_point]);
+  entry_function(args.data());
+  return OkStatus();
+}
+
+}  // namespace dylib
+}  // namespace hal
+}  // namespace iree
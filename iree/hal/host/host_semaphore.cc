@@ -14,8 +14,10 @@
 
 #include "iree/hal/host/host_semaphore.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <utility>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/synchronization/mutex.h"
@@ -27,7 +29,16 @@ namespace hal {
 
 HostSemaphore::HostSemaphore(uint64_t initial_value) : value_(initial_value) {}
 
-HostSemaphore::~HostSemaphore() = default;
+HostSemaphore::~HostSemaphore() {
+#if !defined(IREE_PLATFORM_WINDOWS)
+  // Wake anyone still polling on exported fds so they don't hang forever.
+  absl::MutexLock lock(&mutex_);
+  for (auto& value_event : value_events_) {
+    value_event.second->Set().IgnoreError();
+  }
+  value_events_.clear();
+#endif  // !IREE_PLATFORM_WINDOWS
+}
 
 StatusOr<uint64_t> HostSemaphore::Query() {
   absl::MutexLock lock(&mutex_);
@@ -42,10 +53,12 @@ Status HostSemaphore::Signal(uint64_t value) {
   if (!status_.ok()) {
     return status_;
   }
-  if (value_.exchange(value) >= value) {
+  if (value_.load(std::memory_order_acquire) >= value) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Semaphore values must be monotonically increasing";
   }
+  value_.store(value, std::memory_order_release);
+  NotifyLocked();
   return OkStatus();
 }
 
@@ -53,60 +66,152 @@ void HostSemaphore::Fail(Status status) {
   absl::MutexLock lock(&mutex_);
   status_ = status;
   value_.store(UINT64_MAX, std::memory_order_release);
+  NotifyLocked();
+}
+
+void HostSemaphore::NotifyLocked() {
+  for (auto* waiter : waiters_) {
+    absl::MutexLock waiter_lock(&waiter->mutex);
+    ++waiter->epoch;
+  }
+
+#if !defined(IREE_PLATFORM_WINDOWS)
+  uint64_t current_value = value_.load(std::memory_order_acquire);
+  for (int i = 0; i < value_events_.size();) {
+    if (value_events_[i].first <= current_value) {
+      value_events_[i].second->Set().IgnoreError();
+      std::swap(value_events_[i], value_events_.back());
+      value_events_.pop_back();
+    } else {
+      ++i;
+    }
+  }
+#endif  // !IREE_PLATFORM_WINDOWS
+}
+
+void HostSemaphore::RegisterWaiter(Waiter* waiter) {
+  absl::MutexLock lock(&mutex_);
+  waiters_.push_back(waiter);
+}
+
+void HostSemaphore::UnregisterWaiter(Waiter* waiter) {
+  absl::MutexLock lock(&mutex_);
+  auto it = std::find(waiters_.begin(), waiters_.end(), waiter);
+  if (it != waiters_.end()) waiters_.erase(it);
 }
 
 // static
 Status HostSemaphore::WaitForSemaphores(
     absl::Span<const SemaphoreValue> semaphores, bool wait_all,
-    absl::Time deadline) {
+    absl::Time deadline, int* out_signaled_index) {
   IREE_TRACE_SCOPE0("HostSemaphore::WaitForSemaphores");
+  if (out_signaled_index) *out_signaled_index = 0;
 
   // Some of the semaphores may already be signaled; we only need to wait for
   // those that are not yet at the expected value.
-  using HostSemaphoreValue = std::pair<HostSemaphore*, uint64_t>;
+  struct HostSemaphoreValue {
+    HostSemaphore* semaphore;
+    uint64_t value;
+    int index;
+  };
   absl::InlinedVector<HostSemaphoreValue, 4> waitable_semaphores;
   waitable_semaphores.reserve(semaphores.size());
-  for (auto& semaphore_value : semaphores) {
-    auto* semaphore =
-        reinterpret_cast<HostSemaphore*>(semaphore_value.semaphore);
+  for (int i = 0; i < semaphores.size(); ++i) {
+    auto* semaphore = reinterpret_cast<HostSemaphore*>(semaphores[i].semaphore);
     ASSIGN_OR_RETURN(uint64_t current_value, semaphore->Query());
-    if (current_value < semaphore_value.value) {
+    if (current_value < semaphores[i].value) {
       // Semaphore has not yet hit the required value; wait for it.
-      waitable_semaphores.push_back({semaphore, semaphore_value.value});
+      waitable_semaphores.push_back({semaphore, semaphores[i].value, i});
+    } else if (!wait_all) {
+      // Any one semaphore being signaled is enough.
+      if (out_signaled_index) *out_signaled_index = i;
+      return OkStatus();
     }
   }
+  if (waitable_semaphores.empty()) {
+    return OkStatus();
+  }
 
-  // TODO(benvanik): maybe sort semaphores by value in case we are waiting on
-  // multiple values from the same semaphore.
-
-  // Loop over the semaphores and wait for them to complete.
-  // TODO(b/140026716): add WaitHandle support for !wait_all (wait any).
+  // Register a single waiter with all semaphores so that any change to any of
+  // them wakes us. We read the epoch before checking values so that a signal
+  // racing with the check is never lost.
+  Waiter waiter;
   for (auto& semaphore_value : waitable_semaphores) {
-    auto* semaphore = semaphore_value.first;
-    absl::MutexLock lock(&semaphore->mutex_);
-    if (!semaphore->mutex_.AwaitWithDeadline(
+    semaphore_value.semaphore->RegisterWaiter(&waiter);
+  }
+
+  Status status = OkStatus();
+  while (true) {
+    uint64_t observed_epoch;
+    {
+      absl::MutexLock lock(&waiter.mutex);
+      observed_epoch = waiter.epoch;
+    }
+
+    // Drop all semaphores that have reached their values. Failed semaphores
+    // have their value set to UINT64_MAX and will be caught by Query.
+    bool any_signaled = false;
+    for (int i = 0; i < waitable_semaphores.size() && status.ok();) {
+      auto& semaphore_value = waitable_semaphores[i];
+      if (semaphore_value.semaphore->value_.load(std::memory_order_acquire) <
+          semaphore_value.value) {
+        ++i;
+        continue;
+      }
+      status = semaphore_value.semaphore->Query().status();
+      if (!any_signaled && out_signaled_index) {
+        *out_signaled_index = semaphore_value.index;
+      }
+      any_signaled = true;
+      semaphore_value.semaphore->UnregisterWaiter(&waiter);
+      std::swap(semaphore_value, waitable_semaphores.back());
+      waitable_semaphores.pop_back();
+    }
+    if (!status.ok() || waitable_semaphores.empty() ||
+        (!wait_all && any_signaled)) {
+      break;
+    }
+
+    // Block until some semaphore changes or the deadline elapses.
+    absl::MutexLock lock(&waiter.mutex);
+    std::pair<Waiter*, uint64_t> wait_state{&waiter, observed_epoch};
+    if (!waiter.mutex.AwaitWithDeadline(
             absl::Condition(
-                +[](HostSemaphoreValue* semaphore_value) {
-                  return semaphore_value->first->value_.load(
-                             std::memory_order_acquire) >=
-                         semaphore_value->second;
+                +[](std::pair<Waiter*, uint64_t>* wait_state) {
+                  return wait_state->first->epoch != wait_state->second;
                 },
-                &semaphore_value),
+                &wait_state),
             deadline)) {
-      return DeadlineExceededErrorBuilder(IREE_LOC)
-             << "Deadline exceeded waiting for semaphores";
-    }
-    if (!semaphore->status_.ok()) {
-      return semaphore->status_;
+      status = DeadlineExceededErrorBuilder(IREE_LOC)
+               << "Deadline exceeded waiting for semaphores";
+      break;
     }
   }
 
-  return OkStatus();
+  for (auto& semaphore_value : waitable_semaphores) {
+    semaphore_value.semaphore->UnregisterWaiter(&waiter);
+  }
+  return status;
 }
 
 Status HostSemaphore::Wait(uint64_t value, absl::Time deadline) {
   return WaitForSemaphores({{this, value}}, /*wait_all=*/true, deadline);
 }
 
+#if !defined(IREE_PLATFORM_WINDOWS)
+WaitHandle HostSemaphore::OnValue(uint64_t value) {
+  auto event = make_ref<ManualResetEvent>("host_semaphore");
+  WaitHandle wait_handle = event->OnSet();
+  absl::MutexLock lock(&mutex_);
+  if (value_.load(std::memory_order_acquire) >= value) {
+    // Already reached (or failed); the fd is immediately readable.
+    event->Set().IgnoreError();
+  } else {
+    value_events_.push_back({value, std::move(event)});
+  }
+  return wait_handle;
+}
+#endif  // !IREE_PLATFORM_WINDOWS
+
 }  // namespace hal
 }  // namespace iree
@@ -17,26 +17,44 @@
 
 #include <atomic>
 #include <cstdint>
+#include <utility>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "iree/base/status.h"
+#include "iree/base/target_platform.h"
 #include "iree/hal/semaphore.h"
 
+#if !defined(IREE_PLATFORM_WINDOWS)
+#include "iree/base/wait_handle.h"
+#endif  // !IREE_PLATFORM_WINDOWS
+
 namespace iree {
 namespace hal {
 
-// TODO(b/140026716): add WaitHandle support for better multi-wait.
-// Simple host-only semaphore semaphore implemented with a mutex.
+// Simple host-only semaphore implemented with a mutex.
+//
+// Blocking waits register a waiter with every semaphore they are waiting on
+// and are woken whenever any of those semaphores is signaled or fails. This
+// allows a single blocking call to wait for all or any of many semaphores
+// without polling or serializing the waits.
 //
 // Thread-safe (as instances may be imported and used by others).
 class HostSemaphore final : public Semaphore {
  public:
   // Waits for one or more (or all) semaphores to reach or exceed the given
-  // values.
+  // values. If |wait_all| is false the wait completes as soon as any single
+  // semaphore has reached its value.
+  //
+  // |out_signaled_index|, if provided, receives the index of a semaphore that
+  // was signaled when waiting for any.
+  //
+  // Returns the failure status of the first failed semaphore encountered.
   static Status WaitForSemaphores(absl::Span<const SemaphoreValue> semaphores,
-                                  bool wait_all, absl::Time deadline);
+                                  bool wait_all, absl::Time deadline,
+                                  int* out_signaled_index = nullptr);
 
   explicit HostSemaphore(uint64_t initial_value);
   ~HostSemaphore() override;
@@ -47,7 +65,30 @@ class HostSemaphore final : public Semaphore {
   void Fail(Status status) override;
   Status Wait(uint64_t value, absl::Time deadline) override;
 
+#if !defined(IREE_PLATFORM_WINDOWS)
+  // Returns a WaitHandle that is signaled when the semaphore reaches or exceeds
+  // |value| or fails. The handle is backed by an eventfd (or pipe) that can be
+  // acquired with WaitableObject::AcquireFdForWait and added to an external
+  // poll/epoll set. Query the semaphore after waking to check for failure.
+  WaitHandle OnValue(uint64_t value);
+#endif  // !IREE_PLATFORM_WINDOWS
+
  private:
+  // Wake state shared by all semaphores participating in a single
+  // WaitForSemaphores call. The epoch is bumped each time any of the
+  // semaphores changes so that the waiter can re-check its condition.
+  struct Waiter {
+    absl::Mutex mutex;
+    uint64_t epoch ABSL_GUARDED_BY(mutex) = 0;
+  };
+
+  void RegisterWaiter(Waiter* waiter);
+  void UnregisterWaiter(Waiter* waiter);
+
+  // Wakes all registered waiters and signals any exported events whose value
+  // has been reached.
+  void NotifyLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // The mutex is not required to query the value; this lets us quickly check if
   // a required value has been exceeded. The mutex is only used to update and
   // notify waiters.
@@ -57,6 +98,15 @@ class HostSemaphore final : public Semaphore {
   // changes.
   mutable absl::Mutex mutex_;
   Status status_ ABSL_GUARDED_BY(mutex_);
+
+  // Waiters currently blocked in WaitForSemaphores on this semaphore.
+  absl::InlinedVector<Waiter*, 4> waiters_ ABSL_GUARDED_BY(mutex_);
+
+#if !defined(IREE_PLATFORM_WINDOWS)
+  // Events exported with OnValue that have not yet been signaled.
+  absl::InlinedVector<std::pair<uint64_t, ref_ptr<ManualResetEvent>>, 2>
+      value_events_ ABSL_GUARDED_BY(mutex_);
+#endif  // !IREE_PLATFORM_WINDOWS
 };
 
 }  // namespace hal
@@ -139,6 +139,88 @@ TEST(HostSemaphoreTest, FailNotifies) {
   ASSERT_TRUE(got_failure);
 }
 
+// Tests waiting on any of several semaphores where one is already signaled.
+TEST(HostSemaphoreTest, WaitAnyAlreadySignaled) {
+  HostSemaphore a(0u);
+  HostSemaphore b(2u);
+  EXPECT_OK(HostSemaphore::WaitForSemaphores(
+      {{&a, 1u}, {&b, 2u}}, /*wait_all=*/false, absl::InfinitePast()));
+  EXPECT_TRUE(IsDeadlineExceeded(HostSemaphore::WaitForSemaphores(
+      {{&a, 1u}, {&b, 2u}}, /*wait_all=*/true, absl::InfinitePast())));
+}
+
+// Tests that a wait-any wakes when only one of the semaphores is signaled.
+TEST(HostSemaphoreTest, WaitAnyWakesOnSingleSignal) {
+  HostSemaphore a(0u);
+  HostSemaphore b(0u);
+  HostSemaphore c(0u);
+  std::thread thread([&]() { ASSERT_OK(b.Signal(1u)); });
+  int signaled_index = -1;
+  ASSERT_OK(HostSemaphore::WaitForSemaphores(
+      {{&a, 1u}, {&b, 1u}, {&c, 1u}}, /*wait_all=*/false,
+      absl::InfiniteFuture(), &signaled_index));
+  thread.join();
+  EXPECT_EQ(1, signaled_index);
+  EXPECT_EQ(0u, a.Query().value());
+  EXPECT_EQ(1u, b.Query().value());
+  EXPECT_EQ(0u, c.Query().value());
+}
+
+// Tests that a wait-all only completes once every semaphore is signaled.
+TEST(HostSemaphoreTest, WaitAllMultiple) {
+  HostSemaphore a(0u);
+  HostSemaphore b(0u);
+  std::thread thread([&]() {
+    ASSERT_OK(b.Signal(5u));
+    ASSERT_OK(a.Signal(1u));
+  });
+  ASSERT_OK(HostSemaphore::WaitForSemaphores(
+      {{&a, 1u}, {&b, 5u}}, /*wait_all=*/true, absl::InfiniteFuture()));
+  thread.join();
+  EXPECT_EQ(1u, a.Query().value());
+  EXPECT_EQ(5u, b.Query().value());
+}
+
+// Tests that a failure on any semaphore wakes a wait-all and propagates.
+TEST(HostSemaphoreTest, WaitAllFailNotifies) {
+  HostSemaphore a(0u);
+  HostSemaphore b(0u);
+  std::thread thread([&]() { b.Fail(UnknownErrorBuilder(IREE_LOC)); });
+  EXPECT_TRUE(IsUnknown(HostSemaphore::WaitForSemaphores(
+      {{&a, 1u}, {&b, 1u}}, /*wait_all=*/true, absl::InfiniteFuture())));
+  thread.join();
+}
+
+#if !defined(IREE_PLATFORM_WINDOWS)
+// Tests that exported wait handles are signaled when the value is reached.
+TEST(HostSemaphoreTest, OnValue) {
+  HostSemaphore semaphore(1u);
+  WaitHandle already_reached = semaphore.OnValue(1u);
+  ASSERT_OK_AND_ASSIGN(bool already_signaled, already_reached.TryWait());
+  EXPECT_TRUE(already_signaled);
+
+  WaitHandle pending = semaphore.OnValue(3u);
+  ASSERT_OK_AND_ASSIGN(bool pending_signaled, pending.TryWait());
+  EXPECT_FALSE(pending_signaled);
+  ASSERT_OK(semaphore.Signal(2u));
+  ASSERT_OK_AND_ASSIGN(pending_signaled, pending.TryWait());
+  EXPECT_FALSE(pending_signaled);
+
+  std::thread thread([&]() { ASSERT_OK(semaphore.Signal(3u)); });
+  ASSERT_OK(pending.Wait());
+  thread.join();
+}
+
+// Tests that exported wait handles are signaled when the semaphore fails.
+TEST(HostSemaphoreTest, OnValueFailure) {
+  HostSemaphore semaphore(0u);
+  WaitHandle wait_handle = semaphore.OnValue(1u);
+  semaphore.Fail(UnknownErrorBuilder(IREE_LOC));
+  ASSERT_OK(wait_handle.Wait());
+  EXPECT_TRUE(IsUnknown(semaphore.Query().status()));
+}
+#endif  // !IREE_PLATFORM_WINDOWS
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
@@ -14,6 +14,10 @@
 
 #include "iree/hal/host/inproc_command_buffer.h"
 
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/container/inlined_vector.h"
 #include "iree/base/tracing.h"
 
 namespace iree {
@@ -30,6 +34,10 @@ Status InProcCommandBuffer::Begin() {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::Begin");
   is_recording_ = true;
   Reset();
+  binding_table_.clear();
+  binding_aliases_.clear();
+  binding_lengths_.clear();
+  has_bound_descriptor_sets_ = false;
   return OkStatus();
 }
 
@@ -39,6 +47,109 @@ Status InProcCommandBuffer::End() {
   return OkStatus();
 }
 
+Status InProcCommandBuffer::UpdateBindingTable(
+    absl::Span<Buffer* const> buffers) {
+  IREE_TRACE_SCOPE0("InProcCommandBuffer::UpdateBindingTable");
+  if (is_recording_) {
+    if (current_cmd_list_.head || !binding_table_.empty()) {
+      return FailedPreconditionErrorBuilder(IREE_LOC)
+             << "Binding table must be declared prior to recording commands";
+    }
+    binding_table_.assign(buffers.begin(), buffers.end());
+    binding_aliases_.resize(buffers.size());
+    binding_lengths_.assign(buffers.size(), 0);
+    for (int i = 0; i < buffers.size(); ++i) {
+      binding_aliases_[i] = i;
+      for (int j = 0; j < i; ++j) {
+        if (buffers[j] == buffers[i]) {
+          binding_aliases_[i] = j;
+          break;
+        }
+      }
+    }
+    return OkStatus();
+  }
+
+  if (buffers.size() != binding_table_.size()) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "Binding table was declared with " << binding_table_.size()
+           << " slots but " << buffers.size() << " buffers were provided";
+  }
+  if (has_bound_descriptor_sets_) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "Descriptor sets bound with BindDescriptorSet cannot be rebound; "
+              "command buffer must be re-recorded";
+  }
+  for (int i = 0; i < buffers.size(); ++i) {
+    if (buffers[i] != buffers[binding_aliases_[i]]) {
+      return FailedPreconditionErrorBuilder(IREE_LOC)
+             << "Binding table slot " << i << " aliased slot "
+             << binding_aliases_[i]
+             << " when recorded; command buffer must be re-recorded";
+    }
+    device_size_t byte_length = buffers[i] ? buffers[i]->byte_length() : 0;
+    if (byte_length < binding_lengths_[i]) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Binding table slot " << i << " requires at least "
+             << binding_lengths_[i] << " bytes but the buffer provided has "
+             << byte_length;
+    }
+  }
+  std::copy(buffers.begin(), buffers.end(), binding_table_.begin());
+  return OkStatus();
+}
+
+// Slot references are tagged with the low bit set; real buffers are always at
+// least pointer-aligned and never have it set.
+Buffer* InProcCommandBuffer::EncodeBuffer(Buffer* buffer,
+                                          device_size_t offset,
+                                          device_size_t length) {
+  if (!buffer) return buffer;
+  for (int i = 0; i < binding_table_.size(); ++i) {
+    if (binding_table_[i] == buffer) {
+      device_size_t end =
+          length == kWholeBuffer ? buffer->byte_length() : offset + length;
+      binding_lengths_[i] = std::max(binding_lengths_[i], end);
+      return reinterpret_cast<Buffer*>((static_cast<uintptr_t>(i) << 1) | 1);
+    }
+  }
+  return buffer;
+}
+
+Buffer* InProcCommandBuffer::ResolveBuffer(Buffer* buffer) const {
+  auto value = reinterpret_cast<uintptr_t>(buffer);
+  if (value & 1) {
+    return binding_table_[value >> 1];
+  }
+  return buffer;
+}
+
+absl::Span<const BufferBarrier> InProcCommandBuffer::AppendBufferBarriers(
+    absl::Span<const BufferBarrier> buffer_barriers) {
+  auto* recorded_barriers = static_cast<BufferBarrier*>(
+      AppendCmdData(buffer_barriers.data(), 0,
+                    buffer_barriers.size() * sizeof(BufferBarrier)));
+  for (int i = 0; i < buffer_barriers.size(); ++i) {
+    auto& barrier = recorded_barriers[i];
+    barrier.buffer =
+        EncodeBuffer(barrier.buffer, barrier.offset, barrier.length);
+  }
+  return absl::MakeConstSpan(recorded_barriers, buffer_barriers.size());
+}
+
+absl::Span<const DescriptorSet::Binding> InProcCommandBuffer::AppendBindings(
+    absl::Span<const DescriptorSet::Binding> bindings) {
+  auto* recorded_bindings = static_cast<DescriptorSet::Binding*>(
+      AppendCmdData(bindings.data(), 0,
+                    bindings.size() * sizeof(DescriptorSet::Binding)));
+  for (int i = 0; i < bindings.size(); ++i) {
+    auto& binding = recorded_bindings[i];
+    binding.buffer =
+        EncodeBuffer(binding.buffer, binding.offset, binding.length);
+  }
+  return absl::MakeConstSpan(recorded_bindings, bindings.size());
+}
+
 Status InProcCommandBuffer::ExecutionBarrier(
     ExecutionStageBitfield source_stage_mask,
     ExecutionStageBitfield target_stage_mask,
@@ -49,7 +160,7 @@ Status InProcCommandBuffer::ExecutionBarrier(
   cmd->source_stage_mask = source_stage_mask;
   cmd->target_stage_mask = target_stage_mask;
   cmd->memory_barriers = AppendStructSpan(memory_barriers);
-  cmd->buffer_barriers = AppendStructSpan(buffer_barriers);
+  cmd->buffer_barriers = AppendBufferBarriers(buffer_barriers);
   return OkStatus();
 }
 
@@ -82,7 +193,7 @@ Status InProcCommandBuffer::WaitEvents(
   cmd->source_stage_mask = source_stage_mask;
   cmd->target_stage_mask = target_stage_mask;
   cmd->memory_barriers = AppendStructSpan(memory_barriers);
-  cmd->buffer_barriers = AppendStructSpan(buffer_barriers);
+  cmd->buffer_barriers = AppendBufferBarriers(buffer_barriers);
   return OkStatus();
 }
 
@@ -93,7 +204,7 @@ Status InProcCommandBuffer::FillBuffer(Buffer* target_buffer,
                                        size_t pattern_length) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::FillBuffer");
   ASSIGN_OR_RETURN(auto* cmd, AppendCmd<FillBufferCmd>());
-  cmd->target_buffer = target_buffer;
+  cmd->target_buffer = EncodeBuffer(target_buffer, target_offset, length);
   cmd->target_offset = target_offset;
   cmd->length = length;
   std::memcpy(cmd->pattern, pattern, pattern_length);
@@ -104,7 +215,7 @@ Status InProcCommandBuffer::FillBuffer(Buffer* target_buffer,
 Status InProcCommandBuffer::DiscardBuffer(Buffer* buffer) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::DiscardBuffer");
   ASSIGN_OR_RETURN(auto* cmd, AppendCmd<DiscardBufferCmd>());
-  cmd->buffer = buffer;
+  cmd->buffer = EncodeBuffer(buffer, 0, 0);
   return OkStatus();
 }
 
@@ -116,7 +227,7 @@ Status InProcCommandBuffer::UpdateBuffer(const void* source_buffer,
   IREE_TRACE_SCOPE0("InProcCommandBuffer::UpdateBuffer");
   ASSIGN_OR_RETURN(auto* cmd, AppendCmd<UpdateBufferCmd>());
   cmd->source_buffer = AppendCmdData(source_buffer, source_offset, length);
-  cmd->target_buffer = target_buffer;
+  cmd->target_buffer = EncodeBuffer(target_buffer, target_offset, length);
   cmd->target_offset = target_offset;
   cmd->length = length;
   return OkStatus();
@@ -129,9 +240,9 @@ Status InProcCommandBuffer::CopyBuffer(Buffer* source_buffer,
                                        device_size_t length) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::CopyBuffer");
   ASSIGN_OR_RETURN(auto* cmd, AppendCmd<CopyBufferCmd>());
-  cmd->source_buffer = source_buffer;
+  cmd->source_buffer = EncodeBuffer(source_buffer, source_offset, length);
   cmd->source_offset = source_offset;
-  cmd->target_buffer = target_buffer;
+  cmd->target_buffer = EncodeBuffer(target_buffer, target_offset, length);
   cmd->target_offset = target_offset;
   cmd->length = length;
   return OkStatus();
@@ -155,7 +266,7 @@ Status InProcCommandBuffer::PushDescriptorSet(
   ASSIGN_OR_RETURN(auto* cmd, AppendCmd<PushDescriptorSetCmd>());
   cmd->executable_layout = executable_layout;
   cmd->set = set;
-  cmd->bindings = AppendStructSpan(bindings);
+  cmd->bindings = AppendBindings(bindings);
   return OkStatus();
 }
 
@@ -168,6 +279,7 @@ Status InProcCommandBuffer::BindDescriptorSet(
   cmd->executable_layout = executable_layout;
   cmd->set = set;
   cmd->descriptor_set = descriptor_set;
+  has_bound_descriptor_sets_ = true;
   cmd->dynamic_offsets = AppendStructSpan(dynamic_offsets);
   return OkStatus();
 }
@@ -191,7 +303,8 @@ Status InProcCommandBuffer::DispatchIndirect(Executable* executable,
   ASSIGN_OR_RETURN(auto* cmd, AppendCmd<DispatchIndirectCmd>());
   cmd->executable = executable;
   cmd->entry_point = entry_point;
-  cmd->workgroups_buffer = workgroups_buffer;
+  cmd->workgroups_buffer = EncodeBuffer(
+      workgroups_buffer, workgroups_offset, sizeof(uint32_t) * 3);
   cmd->workgroups_offset = workgroups_offset;
   return OkStatus();
 }
@@ -254,12 +367,22 @@ Status InProcCommandBuffer::Process(CommandBuffer* command_processor) const {
 
 Status InProcCommandBuffer::ProcessCmd(CmdHeader* cmd_header,
                                        CommandBuffer* command_processor) const {
+  // Resolves slot references in recorded spans into real buffers.
+  auto resolve_barriers = [this](absl::Span<const BufferBarrier> barriers) {
+    absl::InlinedVector<BufferBarrier, 4> resolved(barriers.begin(),
+                                                   barriers.end());
+    for (auto& barrier : resolved) {
+      barrier.buffer = ResolveBuffer(barrier.buffer);
+    }
+    return resolved;
+  };
   switch (cmd_header->type) {
     case CmdType::kExecutionBarrier: {
       auto* cmd = reinterpret_cast<ExecutionBarrierCmd*>(cmd_header + 1);
+      auto buffer_barriers = resolve_barriers(cmd->buffer_barriers);
       return command_processor->ExecutionBarrier(
           cmd->source_stage_mask, cmd->target_stage_mask, cmd->memory_barriers,
-          cmd->buffer_barriers);
+          buffer_barriers);
     }
     case CmdType::kSignalEvent: {
       auto* cmd = reinterpret_cast<SignalEventCmd*>(cmd_header + 1);
@@ -271,31 +394,32 @@ Status InProcCommandBuffer::ProcessCmd(CmdHeader* cmd_header,
     }
     case CmdType::kWaitEvents: {
       auto* cmd = reinterpret_cast<WaitEventsCmd*>(cmd_header + 1);
+      auto buffer_barriers = resolve_barriers(cmd->buffer_barriers);
       return command_processor->WaitEvents(
           cmd->events, cmd->source_stage_mask, cmd->target_stage_mask,
-          cmd->memory_barriers, cmd->buffer_barriers);
+          cmd->memory_barriers, buffer_barriers);
     }
     case CmdType::kFillBuffer: {
       auto* cmd = reinterpret_cast<FillBufferCmd*>(cmd_header + 1);
-      return command_processor->FillBuffer(cmd->target_buffer,
+      return command_processor->FillBuffer(ResolveBuffer(cmd->target_buffer),
                                            cmd->target_offset, cmd->length,
                                            cmd->pattern, cmd->pattern_length);
     }
     case CmdType::kDiscardBuffer: {
       auto* cmd = reinterpret_cast<DiscardBufferCmd*>(cmd_header + 1);
-      return command_processor->DiscardBuffer(cmd->buffer);
+      return command_processor->DiscardBuffer(ResolveBuffer(cmd->buffer));
     }
     case CmdType::kUpdateBuffer: {
       auto* cmd = reinterpret_cast<UpdateBufferCmd*>(cmd_header + 1);
       return command_processor->UpdateBuffer(cmd->source_buffer, 0,
-                                             cmd->target_buffer,
+                                             ResolveBuffer(cmd->target_buffer),
                                              cmd->target_offset, cmd->length);
     }
     case CmdType::kCopyBuffer: {
       auto* cmd = reinterpret_cast<CopyBufferCmd*>(cmd_header + 1);
       return command_processor->CopyBuffer(
-          cmd->source_buffer, cmd->source_offset, cmd->target_buffer,
-          cmd->target_offset, cmd->length);
+          ResolveBuffer(cmd->source_buffer), cmd->source_offset,
+          ResolveBuffer(cmd->target_buffer), cmd->target_offset, cmd->length);
     }
     case CmdType::kPushConstants: {
       auto* cmd = reinterpret_cast<PushConstantsCmd*>(cmd_header + 1);
@@ -304,8 +428,13 @@ Status InProcCommandBuffer::ProcessCmd(CmdHeader* cmd_header,
     }
     case CmdType::kPushDescriptorSet: {
       auto* cmd = reinterpret_cast<PushDescriptorSetCmd*>(cmd_header + 1);
+      absl::InlinedVector<DescriptorSet::Binding, 8> bindings(
+          cmd->bindings.begin(), cmd->bindings.end());
+      for (auto& binding : bindings) {
+        binding.buffer = ResolveBuffer(binding.buffer);
+      }
       return command_processor->PushDescriptorSet(cmd->executable_layout,
-                                                  cmd->set, cmd->bindings);
+                                                  cmd->set, bindings);
     }
     case CmdType::kBindDescriptorSet: {
       auto* cmd = reinterpret_cast<BindDescriptorSetCmd*>(cmd_header + 1);
@@ -321,8 +450,8 @@ Status InProcCommandBuffer::ProcessCmd(CmdHeader* cmd_header,
     case CmdType::kDispatchIndirect: {
       auto* cmd = reinterpret_cast<DispatchIndirectCmd*>(cmd_header + 1);
       return command_processor->DispatchIndirect(
-          cmd->executable, cmd->entry_point, cmd->workgroups_buffer,
-          cmd->workgroups_offset);
+          cmd->executable, cmd->entry_point,
+          ResolveBuffer(cmd->workgroups_buffer), cmd->workgroups_offset);
     }
     default:
       return DataLossErrorBuilder(IREE_LOC)
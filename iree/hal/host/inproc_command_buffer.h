@@ -15,6 +15,7 @@
 #ifndef IREE_HAL_HOST_INPROC_COMMAND_BUFFER_H_
 #define IREE_HAL_HOST_INPROC_COMMAND_BUFFER_H_
 
+#include "absl/container/inlined_vector.h"
 #include "iree/base/arena.h"
 #include "iree/base/intrusive_list.h"
 #include "iree/base/status.h"
@@ -29,6 +30,15 @@ namespace hal {
 // implementation use Process to call each command method as it was originally
 // recorded.
 //
+// Command buffers not created with CommandBufferMode::kOneShot may be
+// processed any number of times. Buffers declared in the binding table with
+// UpdateBindingTable are recorded as slot references and resolved during
+// processing so that the commands can be replayed against new buffers without
+// re-recording. Replacement buffers must be at least as long as the ranges of
+// the original buffers used by the recorded commands. Command buffers that bind
+// descriptor sets with BindDescriptorSet cannot be rebound as the buffers
+// referenced by the sets are not part of the table.
+//
 // Thread-compatible (as with CommandBuffer itself).
 class InProcCommandBuffer final : public CommandBuffer {
  public:
@@ -41,6 +51,8 @@ class InProcCommandBuffer final : public CommandBuffer {
   Status Begin() override;
   Status End() override;
 
+  Status UpdateBindingTable(absl::Span<Buffer* const> buffers) override;
+
   Status ExecutionBarrier(
       ExecutionStageBitfield source_stage_mask,
       ExecutionStageBitfield target_stage_mask,
@@ -255,6 +267,22 @@ class InProcCommandBuffer final : public CommandBuffer {
   // Resets the command list.
   void Reset();
 
+  // Returns the value to record for |buffer|: either the buffer itself or a
+  // tagged slot reference if the buffer is present in the binding table.
+  // |offset| and |length| are the range of the buffer used by the command and
+  // extend the length required of buffers later rebound to the slot.
+  Buffer* EncodeBuffer(Buffer* buffer, device_size_t offset,
+                       device_size_t length);
+
+  // Resolves a value produced by EncodeBuffer against the binding table.
+  Buffer* ResolveBuffer(Buffer* buffer) const;
+
+  // Appends a span of barriers/bindings with their buffers encoded.
+  absl::Span<const BufferBarrier> AppendBufferBarriers(
+      absl::Span<const BufferBarrier> buffer_barriers);
+  absl::Span<const DescriptorSet::Binding> AppendBindings(
+      absl::Span<const DescriptorSet::Binding> bindings);
+
   // Allocates a command and appends it to the current command list.
   // The caller must populate the fields in the returned pointer.
   template <typename T>
@@ -290,6 +318,19 @@ class InProcCommandBuffer final : public CommandBuffer {
 
   // NOTE: not synchronized. Expected to be used from a single thread.
   CmdList current_cmd_list_;
+
+  // Buffers referenced by slot from the recorded commands.
+  absl::InlinedVector<Buffer*, 8> binding_table_;
+  // For each slot the first slot that held the same buffer when the table was
+  // declared. Recorded references always use the first slot so aliasing slots
+  // must continue to alias when the table is updated.
+  absl::InlinedVector<int, 8> binding_aliases_;
+  // For each slot the minimum byte length of buffers bound to it as required
+  // by the ranges used in the recorded commands.
+  absl::InlinedVector<device_size_t, 8> binding_lengths_;
+  // True if any descriptor set was bound with BindDescriptorSet, in which case
+  // the binding table cannot be updated.
+  bool has_bound_descriptor_sets_ = false;
 };
 
 }  // namespace hal
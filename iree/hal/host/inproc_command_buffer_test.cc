@@ -0,0 +1,164 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/inproc_command_buffer.h"
+
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/hal/testing/mock_command_buffer.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+using testing::MockCommandBuffer;
+
+ref_ptr<Buffer> AllocateBuffer() {
+  return HeapBuffer::Allocate(BufferUsage::kAll, 16);
+}
+
+// Tests that a command buffer can be processed multiple times.
+TEST(InProcCommandBufferTest, ProcessMultipleTimes) {
+  auto source = AllocateBuffer();
+  auto target = AllocateBuffer();
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kNone,
+                                     CommandCategory::kTransfer);
+  ASSERT_OK(command_buffer.Begin());
+  ASSERT_OK(command_buffer.CopyBuffer(source.get(), 0, target.get(), 4, 8));
+  ASSERT_OK(command_buffer.End());
+
+  MockCommandBuffer processor(nullptr, CommandBufferMode::kNone,
+                              CommandCategory::kTransfer);
+  EXPECT_CALL(processor, Begin()).Times(2).WillRepeatedly(Return(OkStatus()));
+  EXPECT_CALL(processor, CopyBuffer(source.get(), 0, target.get(), 4, 8))
+      .Times(2)
+      .WillRepeatedly(Return(OkStatus()));
+  EXPECT_CALL(processor, End()).Times(2).WillRepeatedly(Return(OkStatus()));
+  ASSERT_OK(command_buffer.Process(&processor));
+  ASSERT_OK(command_buffer.Process(&processor));
+}
+
+// Tests that buffers in the binding table are resolved at processing time.
+TEST(InProcCommandBufferTest, RebindBuffers) {
+  auto source0 = AllocateBuffer();
+  auto target0 = AllocateBuffer();
+  auto other = AllocateBuffer();
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kNone,
+                                     CommandCategory::kTransfer);
+  ASSERT_OK(command_buffer.Begin());
+  Buffer* declared_buffers[] = {source0.get(), target0.get()};
+  ASSERT_OK(command_buffer.UpdateBindingTable(declared_buffers));
+  ASSERT_OK(command_buffer.CopyBuffer(source0.get(), 0, target0.get(), 0, 8));
+  ASSERT_OK(command_buffer.CopyBuffer(other.get(), 0, target0.get(), 8, 8));
+  ASSERT_OK(command_buffer.End());
+
+  auto source1 = AllocateBuffer();
+  auto target1 = AllocateBuffer();
+  Buffer* rebound_buffers[] = {source1.get(), target1.get()};
+  ASSERT_OK(command_buffer.UpdateBindingTable(rebound_buffers));
+
+  MockCommandBuffer processor(nullptr, CommandBufferMode::kNone,
+                              CommandCategory::kTransfer);
+  EXPECT_CALL(processor, Begin()).WillOnce(Return(OkStatus()));
+  EXPECT_CALL(processor, CopyBuffer(source1.get(), 0, target1.get(), 0, 8))
+      .WillOnce(Return(OkStatus()));
+  EXPECT_CALL(processor, CopyBuffer(other.get(), 0, target1.get(), 8, 8))
+      .WillOnce(Return(OkStatus()));
+  EXPECT_CALL(processor, End()).WillOnce(Return(OkStatus()));
+  ASSERT_OK(command_buffer.Process(&processor));
+}
+
+// Tests that the binding table size must match the declaration.
+TEST(InProcCommandBufferTest, RebindSizeMismatch) {
+  auto buffer = AllocateBuffer();
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kNone,
+                                     CommandCategory::kTransfer);
+  ASSERT_OK(command_buffer.Begin());
+  Buffer* declared_buffers[] = {buffer.get()};
+  ASSERT_OK(command_buffer.UpdateBindingTable(declared_buffers));
+  ASSERT_OK(command_buffer.End());
+  Buffer* rebound_buffers[] = {buffer.get(), buffer.get()};
+  EXPECT_TRUE(IsFailedPrecondition(
+      command_buffer.UpdateBindingTable(rebound_buffers)));
+}
+
+// Tests that slots aliasing during recording must continue to alias.
+TEST(InProcCommandBufferTest, RebindBrokenAlias) {
+  auto buffer = AllocateBuffer();
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kNone,
+                                     CommandCategory::kTransfer);
+  ASSERT_OK(command_buffer.Begin());
+  Buffer* declared_buffers[] = {buffer.get(), buffer.get()};
+  ASSERT_OK(command_buffer.UpdateBindingTable(declared_buffers));
+  ASSERT_OK(command_buffer.End());
+
+  auto other = AllocateBuffer();
+  Buffer* aliased_buffers[] = {other.get(), other.get()};
+  EXPECT_OK(command_buffer.UpdateBindingTable(aliased_buffers));
+  Buffer* unaliased_buffers[] = {buffer.get(), other.get()};
+  EXPECT_TRUE(IsFailedPrecondition(
+      command_buffer.UpdateBindingTable(unaliased_buffers)));
+}
+
+// Tests that rebound buffers must cover the ranges used when recorded.
+TEST(InProcCommandBufferTest, RebindShorterBuffer) {
+  auto source = AllocateBuffer();
+  auto target = AllocateBuffer();
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kNone,
+                                     CommandCategory::kTransfer);
+  ASSERT_OK(command_buffer.Begin());
+  Buffer* declared_buffers[] = {source.get(), target.get()};
+  ASSERT_OK(command_buffer.UpdateBindingTable(declared_buffers));
+  ASSERT_OK(command_buffer.CopyBuffer(source.get(), 0, target.get(), 4, 8));
+  ASSERT_OK(command_buffer.End());
+
+  // The target range ends at byte 12 while the source range ends at byte 8.
+  auto exact_target = HeapBuffer::Allocate(BufferUsage::kAll, 12);
+  auto short_source = HeapBuffer::Allocate(BufferUsage::kAll, 4);
+  auto short_target = HeapBuffer::Allocate(BufferUsage::kAll, 8);
+  Buffer* exact_buffers[] = {source.get(), exact_target.get()};
+  EXPECT_OK(command_buffer.UpdateBindingTable(exact_buffers));
+  Buffer* short_source_buffers[] = {short_source.get(), target.get()};
+  EXPECT_TRUE(IsInvalidArgument(
+      command_buffer.UpdateBindingTable(short_source_buffers)));
+  Buffer* short_target_buffers[] = {source.get(), short_target.get()};
+  EXPECT_TRUE(IsInvalidArgument(
+      command_buffer.UpdateBindingTable(short_target_buffers)));
+}
+
+// Tests that command buffers binding descriptor sets cannot be rebound as the
+// buffers referenced by the sets are not part of the binding table.
+TEST(InProcCommandBufferTest, RebindBoundDescriptorSet) {
+  auto buffer = AllocateBuffer();
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kNone,
+                                     CommandCategory::kDispatch);
+  ASSERT_OK(command_buffer.Begin());
+  Buffer* declared_buffers[] = {buffer.get()};
+  ASSERT_OK(command_buffer.UpdateBindingTable(declared_buffers));
+  ASSERT_OK(command_buffer.BindDescriptorSet(/*executable_layout=*/nullptr,
+                                             /*set=*/0,
+                                             /*descriptor_set=*/nullptr, {}));
+  ASSERT_OK(command_buffer.End());
+  EXPECT_TRUE(IsFailedPrecondition(
+      command_buffer.UpdateBindingTable(declared_buffers)));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
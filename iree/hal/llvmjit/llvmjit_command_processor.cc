@@ -19,8 +19,8 @@
 
 #include "iree/base/tracing.h"
 #include "iree/hal/buffer.h"
+#include "iree/hal/host/host_buffer.h"
 #include "iree/hal/llvmjit/llvmjit_executable.h"
-#include "iree/hal/llvmjit/memref_runtime.h"
 
 namespace iree {
 namespace hal {
@@ -40,27 +40,20 @@ Status LLVMJITCommandProcessor::DispatchInline(
   IREE_TRACE_SCOPE0("LLVMJITCommandProcessor::DispatchInline");
   auto* llvmjit_executable = static_cast<LLVMJITExecutable*>(executable);
 
-  llvm::SmallVector<UnrankedMemRefType<uint32_t>*, 4> descriptors;
-  llvm::SmallVector<void*, 4> args;
-  for (size_t set = 0; set < set_bindings.size(); ++set) {
-    for (size_t binding = 0; binding < set_bindings[set].size(); ++binding) {
-      const auto& io_binding = set_bindings[set][binding];
-      ASSIGN_OR_RETURN(auto memory, io_binding.buffer->MapMemory<uint8_t>(
-                                        MemoryAccessBitfield::kWrite,
-                                        io_binding.offset, io_binding.length));
-      auto data = memory.mutable_data();
-      auto descriptor = allocUnrankedDescriptor<uint32_t>(data);
-      descriptors.push_back(descriptor);
-      args.push_back(&descriptor->descriptor);
+  // The invocation functions take the base pointer of each binding and build
+  // the memref descriptors themselves. Host buffers are always mapped so the
+  // pointers are taken directly from the allocations and the argument block
+  // is reused across dispatches.
+  binding_ptrs_.clear();
+  for (const auto& bindings : set_bindings) {
+    for (const auto& io_binding : bindings) {
+      auto* buffer = io_binding.buffer;
+      auto* data = static_cast<uint8_t*>(
+          static_cast<HostBuffer*>(buffer->allocated_buffer())->mutable_data());
+      binding_ptrs_.push_back(data + buffer->byte_offset() + io_binding.offset);
     }
   }
-  auto status = llvmjit_executable->Invoke(entry_point, args);
-
-  for (int i = 0; i < descriptors.size(); ++i) {
-    freeUnrankedDescriptor(descriptors[i]);
-  }
-
-  return status;
+  return llvmjit_executable->Invoke(entry_point, binding_ptrs_);
 }
 
 }  // namespace llvmjit
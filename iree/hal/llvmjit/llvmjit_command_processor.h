@@ -14,6 +14,9 @@
 //
 #ifndef IREE_HAL_LLVMJIT_LLVMJIT_COMMAND_PROCESSOR_H_
 #define IREE_HAL_LLVMJIT_LLVMJIT_COMMAND_PROCESSOR_H_
+
+#include <vector>
+
 #include "iree/hal/host/host_local_command_processor.h"
 
 namespace iree {
@@ -32,6 +35,11 @@ class LLVMJITCommandProcessor final : public HostLocalCommandProcessor {
       const PushConstantBlock& push_constants,
       absl::Span<const absl::Span<const DescriptorSet::Binding>> set_bindings)
       override;
+
+ private:
+  // Base pointers of the bindings of the current dispatch. Reused across
+  // dispatches to avoid allocations.
+  std::vector<void*> binding_ptrs_;
 };
 
 }  // namespace llvmjit
@@ -0,0 +1,37 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_LLVMJIT_LLVMJIT_COMPILE_OPTIONS_H_
+#define IREE_HAL_LLVMJIT_LLVMJIT_COMPILE_OPTIONS_H_
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+
+// Controls how executable modules are compiled by the JIT.
+struct LLVMJITCompileOptions {
+  // Compiles each entry point on its first invocation instead of compiling
+  // the whole module at load time. Ignored when an object cache is in use as
+  // cached objects always contain the whole module.
+  bool lazy_compilation = true;
+  // Number of threads used for compilation. With 0 compilation happens on
+  // the thread that loads the executable or first invokes an entry point.
+  int compile_threads = 0;
+};
+
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_LLVMJIT_LLVMJIT_COMPILE_OPTIONS_H_
@@ -96,8 +96,12 @@ class UnsynchronizedCommandQueue final : public CommandQueue {
 
 }  // namespace
 
-LLVMJITDevice::LLVMJITDevice(DeviceInfo device_info)
-    : Device(std::move(device_info)) {
+LLVMJITDevice::LLVMJITDevice(DeviceInfo device_info,
+                             LLVMJITCompileOptions compile_options,
+                             std::unique_ptr<LLVMJITObjectCache> object_cache)
+    : Device(std::move(device_info)),
+      compile_options_(compile_options),
+      object_cache_(std::move(object_cache)) {
   // We currently only expose a single command queue.
   auto command_queue = absl::make_unique<UnsynchronizedCommandQueue>(
       &allocator_, "cpu0",
@@ -111,8 +115,10 @@ LLVMJITDevice::LLVMJITDevice(DeviceInfo device_info)
 }
 
 StatusOr<ref_ptr<LLVMJITDevice>> LLVMJITDevice::CreateLLVMJITDevice(
-    DeviceInfo device_info) {
-  return make_ref<LLVMJITDevice>(device_info);
+    DeviceInfo device_info, LLVMJITCompileOptions compile_options,
+    std::unique_ptr<LLVMJITObjectCache> object_cache) {
+  return make_ref<LLVMJITDevice>(device_info, compile_options,
+                                 std::move(object_cache));
 }
 
 LLVMJITDevice::~LLVMJITDevice() = default;
@@ -125,7 +131,8 @@ std::string LLVMJITDevice::DebugString() const {
 
 ref_ptr<ExecutableCache> LLVMJITDevice::CreateExecutableCache() {
   IREE_TRACE_SCOPE0("LLVMJITDevice::CreateExecutableCache");
-  return make_ref<LLVMJITExecutableCache>(&allocator_);
+  return make_ref<LLVMJITExecutableCache>(&allocator_, compile_options_,
+                                          object_cache_.get());
 }
 
 StatusOr<ref_ptr<DescriptorSetLayout>> LLVMJITDevice::CreateDescriptorSetLayout(
@@ -177,8 +184,10 @@ Status LLVMJITDevice::WaitAllSemaphores(
 StatusOr<int> LLVMJITDevice::WaitAnySemaphore(
     absl::Span<const SemaphoreValue> semaphores, absl::Time deadline) {
   IREE_TRACE_SCOPE0("LLVMJITDevice::WaitAnySemaphore");
-  return HostSemaphore::WaitForSemaphores(semaphores, /*wait_all=*/false,
-                                          deadline);
+  int signaled_index = 0;
+  RETURN_IF_ERROR(HostSemaphore::WaitForSemaphores(
+      semaphores, /*wait_all=*/false, deadline, &signaled_index));
+  return signaled_index;
 }
 
 Status LLVMJITDevice::WaitIdle(absl::Time deadline) {
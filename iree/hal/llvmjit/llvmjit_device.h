@@ -20,6 +20,8 @@
 #include "iree/base/memory.h"
 #include "iree/hal/device.h"
 #include "iree/hal/host/host_local_allocator.h"
+#include "iree/hal/llvmjit/llvmjit_compile_options.h"
+#include "iree/hal/llvmjit/llvmjit_object_cache.h"
 
 namespace iree {
 namespace hal {
@@ -27,9 +29,13 @@ namespace llvmjit {
 
 class LLVMJITDevice final : public Device {
  public:
+  // |object_cache| is optional and shared by all executable caches created
+  // from the device.
   static StatusOr<ref_ptr<LLVMJITDevice>> CreateLLVMJITDevice(
-      DeviceInfo device_info);
-  explicit LLVMJITDevice(DeviceInfo device_info);
+      DeviceInfo device_info, LLVMJITCompileOptions compile_options = {},
+      std::unique_ptr<LLVMJITObjectCache> object_cache = nullptr);
+  LLVMJITDevice(DeviceInfo device_info, LLVMJITCompileOptions compile_options,
+                std::unique_ptr<LLVMJITObjectCache> object_cache);
   ~LLVMJITDevice() override;
 
   std::string DebugString() const override;
@@ -74,6 +80,8 @@ class LLVMJITDevice final : public Device {
 
  private:
   mutable HostLocalAllocator allocator_;
+  LLVMJITCompileOptions compile_options_;
+  std::unique_ptr<LLVMJITObjectCache> object_cache_;
   mutable absl::InlinedVector<std::unique_ptr<CommandQueue>, 1> command_queues_;
 };
 
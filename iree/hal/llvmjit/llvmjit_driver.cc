@@ -18,6 +18,7 @@
 
 #include "iree/hal/device_info.h"
 #include "iree/hal/llvmjit/llvmjit_device.h"
+#include "iree/hal/llvmjit/llvmjit_object_cache.h"
 
 namespace iree {
 namespace hal {
@@ -37,7 +38,8 @@ DeviceInfo GetDefaultDeviceInfo() {
 
 }  // namespace
 
-LLVMJITDriver::LLVMJITDriver() : Driver("llvmjit") {}
+LLVMJITDriver::LLVMJITDriver(Options options)
+    : Driver("llvmjit"), options_(std::move(options)) {}
 
 LLVMJITDriver::~LLVMJITDriver() = default;
 
@@ -53,7 +55,14 @@ StatusOr<ref_ptr<Device>> LLVMJITDriver::CreateDefaultDevice() {
 
 StatusOr<ref_ptr<Device>> LLVMJITDriver::CreateDevice(
     DriverDeviceID device_id) {
-  return LLVMJITDevice::CreateLLVMJITDevice(GetDefaultDeviceInfo());
+  std::unique_ptr<LLVMJITObjectCache> object_cache;
+  if (!options_.object_cache_path.empty()) {
+    ASSIGN_OR_RETURN(object_cache,
+                     LLVMJITObjectCache::Create(options_.object_cache_path));
+  }
+  return LLVMJITDevice::CreateLLVMJITDevice(GetDefaultDeviceInfo(),
+                                            options_.compile_options,
+                                            std::move(object_cache));
 }
 
 }  // namespace llvmjit
@@ -15,7 +15,10 @@
 #ifndef IREE_HAL_LLVMJIT_LLVMJIT_DRIVER_H_
 #define IREE_HAL_LLVMJIT_LLVMJIT_DRIVER_H_
 
+#include <string>
+
 #include "iree/hal/driver.h"
+#include "iree/hal/llvmjit/llvmjit_compile_options.h"
 
 namespace iree {
 namespace hal {
@@ -23,7 +26,16 @@ namespace llvmjit {
 
 class LLVMJITDriver final : public Driver {
  public:
-  LLVMJITDriver();
+  struct Options {
+    // Directory used to persist JIT-compiled executables across runs.
+    // Persistent caching is disabled if empty.
+    std::string object_cache_path;
+
+    // Controls how executables are compiled by devices of the driver.
+    LLVMJITCompileOptions compile_options;
+  };
+
+  explicit LLVMJITDriver(Options options);
   ~LLVMJITDriver() override;
 
   StatusOr<std::vector<DeviceInfo>> EnumerateAvailableDevices() override;
@@ -31,6 +43,9 @@ class LLVMJITDriver final : public Driver {
   StatusOr<ref_ptr<Device>> CreateDefaultDevice() override;
 
   StatusOr<ref_ptr<Device>> CreateDevice(DriverDeviceID device_id) override;
+
+ private:
+  Options options_;
 };
 
 }  // namespace llvmjit
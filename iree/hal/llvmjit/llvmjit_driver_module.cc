@@ -13,13 +13,24 @@
 // limitations under the License.
 
 #include <memory>
+#include <string>
 
+#include "absl/flags/flag.h"
 #include "iree/base/init.h"
 #include "iree/base/status.h"
 #include "iree/hal/driver_registry.h"
 #include "iree/hal/llvmjit/llvmjit_driver.h"
 #include "llvm/Support/TargetSelect.h"
 
+ABSL_FLAG(std::string, llvmjit_object_cache_path, "",
+          "Directory used to persist JIT-compiled executables across runs. "
+          "Persistent caching is disabled if empty.");
+ABSL_FLAG(bool, llvmjit_lazy_compilation, true,
+          "Compiles each entry point on its first invocation instead of "
+          "compiling whole executables at load time.");
+ABSL_FLAG(int, llvmjit_compile_threads, 0,
+          "Number of background threads used for JIT compilation.");
+
 namespace iree {
 namespace hal {
 namespace llvmjit {
@@ -27,7 +38,13 @@ namespace llvmjit {
 static StatusOr<ref_ptr<Driver>> CreateLLVMJITDriver() {
   llvm::InitializeNativeTarget();
   llvm::InitializeNativeTargetAsmPrinter();
-  return make_ref<LLVMJITDriver>();
+  LLVMJITDriver::Options options;
+  options.object_cache_path = absl::GetFlag(FLAGS_llvmjit_object_cache_path);
+  options.compile_options.lazy_compilation =
+      absl::GetFlag(FLAGS_llvmjit_lazy_compilation);
+  options.compile_options.compile_threads =
+      absl::GetFlag(FLAGS_llvmjit_compile_threads);
+  return make_ref<LLVMJITDriver>(std::move(options));
 }
 
 }  // namespace llvmjit
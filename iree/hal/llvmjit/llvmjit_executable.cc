@@ -18,14 +18,22 @@
 #include <memory>
 
 #include "flatbuffers/flatbuffers.h"
+#include "iree/base/tracing.h"
 #include "iree/hal/executable.h"
+#include "iree/hal/llvmjit/llvmjit_microkernels.h"
+#include "iree/hal/llvmjit/llvmjit_object_cache.h"
 #include "iree/schemas/llvmir_executable_def_generated.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
-#include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 
@@ -33,46 +41,175 @@ namespace iree {
 namespace hal {
 namespace llvmjit {
 
+namespace {
+
+// Parses |data| as either LLVM bitcode or textual IR.
+std::unique_ptr<llvm::Module> ParseModule(llvm::StringRef data,
+                                          llvm::LLVMContext* context) {
+  IREE_TRACE_SCOPE0("LLVMJITExecutable::ParseModule");
+  // Textual IR must be null terminated while bitcode can be read in-place.
+  std::unique_ptr<llvm::MemoryBuffer> mem_buffer;
+  if (llvm::isBitcode(data.bytes_begin(), data.bytes_end())) {
+    mem_buffer = llvm::MemoryBuffer::getMemBuffer(
+        data, "llvm-ir", /*RequiresNullTerminator=*/false);
+  } else {
+    mem_buffer = llvm::MemoryBuffer::getMemBufferCopy(data, "llvm-ir");
+  }
+  llvm::SMDiagnostic sm_diagnostic;
+  return llvm::parseIR(mem_buffer->getMemBufferRef(), sm_diagnostic, *context);
+}
+
+// Returns the module of |module_def| best suited to the host: the variant
+// requiring the most CPU features that are all supported by the host, or the
+// baseline module if there is none.
+const ::flatbuffers::Vector<int8_t>* SelectHostModule(
+    const LLVMIRExecutableDef* module_def) {
+  const auto* selected_module = module_def->llvmir_module();
+  if (!module_def->variants()) return selected_module;
+  llvm::StringMap<bool> host_features;
+  if (!llvm::sys::getHostCPUFeatures(host_features)) return selected_module;
+
+  int selected_feature_count = 0;
+  for (const auto* variant : *module_def->variants()) {
+    if (!variant->llvmir_module() || !variant->target_features()) continue;
+    llvm::SmallVector<llvm::StringRef, 8> features;
+    llvm::StringRef(variant->target_features()->c_str(),
+                    variant->target_features()->size())
+        .split(features, ',', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    bool is_supported = true;
+    int feature_count = 0;
+    for (auto feature : features) {
+      feature = feature.trim();
+      // Disabled ("-feature") features never prevent a variant from running.
+      if (!feature.consume_front("+")) continue;
+      ++feature_count;
+      if (!host_features.lookup(feature)) {
+        is_supported = false;
+        break;
+      }
+    }
+    if (is_supported && feature_count > selected_feature_count) {
+      selected_module = variant->llvmir_module();
+      selected_feature_count = feature_count;
+    }
+  }
+  return selected_module;
+}
+
+// Applies the options common to LLJIT and LLLazyJIT to |builder|.
+template <typename BuilderT>
+void ConfigureJITBuilder(BuilderT* builder,
+                         const LLVMJITCompileOptions& compile_options,
+                         LLVMJITObjectCache* object_cache) {
+  builder->setNumCompileThreads(compile_options.compile_threads);
+  if (object_cache) {
+    // Route compilation through the object cache so that compiled objects
+    // are persisted for future loads.
+    builder->setCompileFunctionCreator(
+        [object_cache](llvm::orc::JITTargetMachineBuilder jtmb)
+            -> llvm::Expected<
+                std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+          return std::make_unique<llvm::orc::ConcurrentIRCompiler>(
+              std::move(jtmb), object_cache);
+        });
+  }
+}
+
+}  // namespace
+
 // static
 StatusOr<ref_ptr<LLVMJITExecutable>> LLVMJITExecutable::Load(
-    hal::Allocator* allocator, ExecutableSpec spec, bool allow_aliasing_data) {
+    hal::Allocator* allocator, ExecutableSpec spec, bool allow_aliasing_data,
+    const LLVMJITCompileOptions& compile_options,
+    LLVMJITObjectCache* object_cache) {
+  IREE_TRACE_SCOPE0("LLVMJITExecutable::Load");
   auto module_def =
       ::flatbuffers::GetRoot<LLVMIRExecutableDef>(spec.executable_data.data());
-  auto data =
-      reinterpret_cast<const char*>(module_def->llvmir_module()->data());
-  const int size = module_def->llvmir_module()->size();
-  auto mem_buffer = llvm::MemoryBuffer::getMemBufferCopy(
-      llvm::StringRef(data, size), "llvm-ir");
-  auto llvm_context = std::make_unique<llvm::LLVMContext>();
-  llvm::SMDiagnostic sm_diagnostic;
-  auto module = llvm::parseAssembly(*mem_buffer, sm_diagnostic, *llvm_context);
-  if (!module)
-    return InvalidArgumentErrorBuilder(IREE_LOC) << "Can't parse LLVMIR Module";
-  auto dataLayout = module->getDataLayout();
+  const auto* host_module = SelectHostModule(module_def);
+  auto data = reinterpret_cast<const char*>(host_module->data());
+  const int size = host_module->size();
   const auto entry_points = module_def->entry_points();
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(module),
-                                                 std::move(llvm_context));
-  auto ll_jit = llvm::cantFail(llvm::orc::LLJITBuilder().create());
 
-  llvm::Error err = ll_jit->addIRModule(std::move(thread_safe_module));
-  if (err)
-    return InvalidArgumentErrorBuilder(IREE_LOC)
-           << "Can't add executable module to executable LLJIT"
-           << llvm::toString(std::move(err));
+  std::string cache_key;
+  std::unique_ptr<llvm::MemoryBuffer> cached_object;
+  if (object_cache) {
+    cache_key = LLVMJITObjectCache::ComputeKey(absl::MakeConstSpan(
+        reinterpret_cast<const uint8_t*>(data), static_cast<size_t>(size)));
+    cached_object = object_cache->Lookup(cache_key);
+  }
+
+  // Lazily compiled modules are split into per-function partitions which
+  // cannot be matched against whole-module objects in the cache.
+  const bool lazy_compilation =
+      compile_options.lazy_compilation && !object_cache;
+  std::unique_ptr<llvm::orc::LLJIT> ll_jit;
+  llvm::orc::LLLazyJIT* ll_lazy_jit = nullptr;
+  if (lazy_compilation) {
+    llvm::orc::LLLazyJITBuilder ll_lazy_jit_builder;
+    ConfigureJITBuilder(&ll_lazy_jit_builder, compile_options, object_cache);
+    auto ll_lazy_jit_or = ll_lazy_jit_builder.create();
+    if (!ll_lazy_jit_or) {
+      return UnavailableErrorBuilder(IREE_LOC)
+             << "Can't create executable LLLazyJIT: "
+             << llvm::toString(ll_lazy_jit_or.takeError());
+    }
+    ll_lazy_jit = ll_lazy_jit_or.get().get();
+    ll_jit = std::move(ll_lazy_jit_or.get());
+  } else {
+    llvm::orc::LLJITBuilder ll_jit_builder;
+    ConfigureJITBuilder(&ll_jit_builder, compile_options, object_cache);
+    auto ll_jit_or = ll_jit_builder.create();
+    if (!ll_jit_or) {
+      return UnavailableErrorBuilder(IREE_LOC)
+             << "Can't create executable LLJIT: "
+             << llvm::toString(ll_jit_or.takeError());
+    }
+    ll_jit = std::move(ll_jit_or.get());
+  }
+
+  if (cached_object) {
+    // Warm start: skip parsing and compilation entirely.
+    llvm::Error err = ll_jit->addObjectFile(std::move(cached_object));
+    if (err)
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Can't add cached object to executable LLJIT"
+             << llvm::toString(std::move(err));
+  } else {
+    auto llvm_context = std::make_unique<llvm::LLVMContext>();
+    auto module = ParseModule(llvm::StringRef(data, size), llvm_context.get());
+    if (!module)
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Can't parse LLVMIR Module";
+    // The object cache uses the module identifier as its key.
+    module->setModuleIdentifier(cache_key);
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(module),
+                                                   std::move(llvm_context));
+    llvm::Error err =
+        ll_lazy_jit
+            ? ll_lazy_jit->addLazyIRModule(std::move(thread_safe_module))
+            : ll_jit->addIRModule(std::move(thread_safe_module));
+    if (err)
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Can't add executable module to executable LLJIT"
+             << llvm::toString(std::move(err));
+  }
 
   auto dylib_serarch_generator =
       llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
-          dataLayout.getGlobalPrefix());
+          ll_jit->getDataLayout().getGlobalPrefix());
   if (!dylib_serarch_generator)
     return UnavailableErrorBuilder(IREE_LOC)
            << "Can't resolve symbols in current process";
 
   auto& main_jitdylib = ll_jit->getMainJITDylib();
   main_jitdylib.addGenerator(std::move(dylib_serarch_generator.get()));
+  RETURN_IF_ERROR(DefineMicrokernelSymbols(ll_jit.get()));
 
   auto executable = make_ref<LLVMJITExecutable>(
       allocator, spec, std::move(ll_jit), allow_aliasing_data);
 
+  // When compiling lazily the lookups only resolve to stubs that compile the
+  // entry point on first invocation.
   for (const auto func_name : *entry_points) {
     auto func_symbol =
         executable->ll_jit_->lookup("invoke_" + func_name->str());
@@ -22,6 +22,7 @@
 #include "iree/hal/allocator.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/executable_spec.h"
+#include "iree/hal/llvmjit/llvmjit_compile_options.h"
 #include "iree/schemas/llvmir_executable_def_generated.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
@@ -31,12 +32,17 @@ namespace hal {
 namespace llvmjit {
 
 struct MemrefType;
+class LLVMJITObjectCache;
 
 class LLVMJITExecutable final : public Executable {
  public:
-  static StatusOr<ref_ptr<LLVMJITExecutable>> Load(hal::Allocator* allocator,
-                                                   ExecutableSpec spec,
-                                                   bool allow_aliasing_data);
+  // Loads the executable described by |spec|. If |object_cache| is provided
+  // then previously compiled objects are reused and newly compiled ones are
+  // stored for future loads.
+  static StatusOr<ref_ptr<LLVMJITExecutable>> Load(
+      hal::Allocator* allocator, ExecutableSpec spec, bool allow_aliasing_data,
+      const LLVMJITCompileOptions& compile_options = {},
+      LLVMJITObjectCache* object_cache = nullptr);
   LLVMJITExecutable(hal::Allocator* allocator, ExecutableSpec spec,
                     std::unique_ptr<llvm::orc::LLJIT> ll_jit,
                     bool allow_aliasing_data);
@@ -44,7 +50,8 @@ class LLVMJITExecutable final : public Executable {
 
   bool supports_debugging() const override { return false; }
 
-  // Invokes jitted function with args.
+  // Invokes jitted function with |args| holding the base pointer of each
+  // binding of the dispatch.
   Status Invoke(int func_id, llvm::MutableArrayRef<void*> args);
 
   void InsertSymbol(llvm::JITEvaluatedSymbol symbol);
@@ -24,8 +24,12 @@ namespace iree {
 namespace hal {
 namespace llvmjit {
 
-LLVMJITExecutableCache::LLVMJITExecutableCache(hal::Allocator* allocator)
-    : allocator_(allocator) {}
+LLVMJITExecutableCache::LLVMJITExecutableCache(
+    hal::Allocator* allocator, LLVMJITCompileOptions compile_options,
+    LLVMJITObjectCache* object_cache)
+    : allocator_(allocator),
+      compile_options_(compile_options),
+      object_cache_(object_cache) {}
 
 LLVMJITExecutableCache::~LLVMJITExecutableCache() = default;
 
@@ -41,9 +45,15 @@ StatusOr<ref_ptr<Executable>> LLVMJITExecutableCache::PrepareExecutable(
   // Wrap the data (or copy it).
   bool allow_aliasing_data =
       AllBitsSet(mode, ExecutableCachingMode::kAliasProvidedData);
-  ASSIGN_OR_RETURN(
-      auto executable,
-      LLVMJITExecutable::Load(allocator_, spec, !allow_aliasing_data));
+  // Only consult the persistent object cache when the caller allows it.
+  auto* object_cache =
+      AllBitsSet(mode, ExecutableCachingMode::kAllowPersistentCaching)
+          ? object_cache_
+          : nullptr;
+  ASSIGN_OR_RETURN(auto executable,
+                   LLVMJITExecutable::Load(allocator_, spec,
+                                           !allow_aliasing_data,
+                                           compile_options_, object_cache));
 
   return executable;
 }
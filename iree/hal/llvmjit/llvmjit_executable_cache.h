@@ -18,6 +18,8 @@
 #include "iree/hal/allocator.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/executable_cache.h"
+#include "iree/hal/llvmjit/llvmjit_executable.h"
+#include "iree/hal/llvmjit/llvmjit_object_cache.h"
 
 namespace iree {
 namespace hal {
@@ -25,7 +27,13 @@ namespace llvmjit {
 
 class LLVMJITExecutableCache final : public ExecutableCache {
  public:
-  explicit LLVMJITExecutableCache(hal::Allocator* allocator);
+  // |object_cache| is optional and, if provided, is used to persist compiled
+  // objects for executables prepared with
+  // ExecutableCachingMode::kAllowPersistentCaching. It must remain valid for
+  // the lifetime of the cache.
+  LLVMJITExecutableCache(hal::Allocator* allocator,
+                         LLVMJITCompileOptions compile_options,
+                         LLVMJITObjectCache* object_cache);
   ~LLVMJITExecutableCache() override;
 
   bool CanPrepareFormat(ExecutableFormat format) const override;
@@ -36,6 +44,8 @@ class LLVMJITExecutableCache final : public ExecutableCache {
 
  private:
   hal::Allocator* allocator_;
+  LLVMJITCompileOptions compile_options_;
+  LLVMJITObjectCache* object_cache_;
 };
 
 }  // namespace llvmjit
@@ -0,0 +1,224 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/llvmjit/llvmjit_executable.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "iree/base/file_path.h"
+#include "iree/base/logging.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/llvmjit/llvmjit_object_cache.h"
+#include "iree/schemas/llvmir_executable_def_generated.h"
+#include "iree/testing/gtest.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+namespace {
+
+// Entry points in the form produced by the compiler: each takes the base
+// pointers of its bindings, here a float input and a float output.
+constexpr const char kModuleIR[] = R"(
+define void @invoke_double(i8** %bindings) {
+entry:
+  %in_ptr = getelementptr i8*, i8** %bindings, i64 0
+  %in_raw = load i8*, i8** %in_ptr
+  %in = bitcast i8* %in_raw to float*
+  %out_ptr = getelementptr i8*, i8** %bindings, i64 1
+  %out_raw = load i8*, i8** %out_ptr
+  %out = bitcast i8* %out_raw to float*
+  %value = load float, float* %in
+  %result = fmul float %value, 2.0
+  store float %result, float* %out
+  ret void
+}
+
+define void @invoke_increment(i8** %bindings) {
+entry:
+  %in_ptr = getelementptr i8*, i8** %bindings, i64 0
+  %in_raw = load i8*, i8** %in_ptr
+  %in = bitcast i8* %in_raw to float*
+  %out_ptr = getelementptr i8*, i8** %bindings, i64 1
+  %out_raw = load i8*, i8** %out_ptr
+  %out = bitcast i8* %out_raw to float*
+  %value = load float, float* %in
+  %result = fadd float %value, 1.0
+  store float %result, float* %out
+  ret void
+}
+)";
+
+std::string GetUniqueCachePath(absl::string_view unique_name) {
+  char* test_tmpdir = getenv("TEST_TMPDIR");
+  CHECK(test_tmpdir) << "TEST_TMPDIR not defined";
+  return file_path::JoinPaths(test_tmpdir,
+                              absl::StrCat(unique_name, "_object_cache"));
+}
+
+// Returns kModuleIR serialized as bitcode.
+std::string GetModuleBitcode() {
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic sm_diagnostic;
+  auto module = llvm::parseIR(
+      llvm::MemoryBuffer::getMemBuffer(kModuleIR)->getMemBufferRef(),
+      sm_diagnostic, context);
+  CHECK(module) << sm_diagnostic.getMessage().str();
+  std::string bitcode;
+  llvm::raw_string_ostream stream(bitcode);
+  llvm::WriteBitcodeToFile(*module, stream);
+  stream.flush();
+  return bitcode;
+}
+
+// Wraps |module_data| in an executable as the compiler would.
+std::vector<uint8_t> MakeExecutableData(const std::string& module_data) {
+  iree::LLVMIRExecutableDefT executable_def;
+  executable_def.entry_points = {"double", "increment"};
+  executable_def.llvmir_module.resize(module_data.size());
+  std::memcpy(executable_def.llvmir_module.data(), module_data.data(),
+              module_data.size());
+  ::flatbuffers::FlatBufferBuilder fbb;
+  iree::FinishLLVMIRExecutableDefBuffer(
+      fbb, iree::LLVMIRExecutableDef::Pack(fbb, &executable_def));
+  return std::vector<uint8_t>(fbb.GetBufferPointer(),
+                              fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+class LLVMJITExecutableTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  }
+
+  StatusOr<ref_ptr<LLVMJITExecutable>> Load(
+      const std::vector<uint8_t>& executable_data,
+      const LLVMJITCompileOptions& compile_options,
+      LLVMJITObjectCache* object_cache = nullptr) {
+    ExecutableSpec spec;
+    spec.executable_data = absl::MakeConstSpan(executable_data);
+    return LLVMJITExecutable::Load(/*allocator=*/nullptr, spec,
+                                   /*allow_aliasing_data=*/false,
+                                   compile_options, object_cache);
+  }
+
+  // Invokes each entry point of |executable|, in reverse order so that lazily
+  // compiled executables do not compile them in declaration order.
+  void CheckEntryPoints(LLVMJITExecutable* executable) {
+    float in = 3.0f;
+    float out = 0.0f;
+    std::vector<void*> bindings = {&in, &out};
+    ASSERT_OK(executable->Invoke(1, bindings));
+    EXPECT_EQ(4.0f, out);
+    ASSERT_OK(executable->Invoke(0, bindings));
+    EXPECT_EQ(6.0f, out);
+    // Invoking again reuses the compiled code.
+    in = 5.0f;
+    ASSERT_OK(executable->Invoke(1, bindings));
+    EXPECT_EQ(6.0f, out);
+  }
+};
+
+TEST_F(LLVMJITExecutableTest, LoadTextualIR) {
+  auto executable_data = MakeExecutableData(kModuleIR);
+  LLVMJITCompileOptions compile_options;
+  compile_options.lazy_compilation = false;
+  ASSERT_OK_AND_ASSIGN(auto executable,
+                       Load(executable_data, compile_options));
+  CheckEntryPoints(executable.get());
+}
+
+TEST_F(LLVMJITExecutableTest, LoadBitcode) {
+  auto executable_data = MakeExecutableData(GetModuleBitcode());
+  LLVMJITCompileOptions compile_options;
+  compile_options.lazy_compilation = false;
+  ASSERT_OK_AND_ASSIGN(auto executable,
+                       Load(executable_data, compile_options));
+  CheckEntryPoints(executable.get());
+}
+
+TEST_F(LLVMJITExecutableTest, LoadInvalidModule) {
+  auto executable_data = MakeExecutableData("not a module");
+  EXPECT_TRUE(IsInvalidArgument(
+      Load(executable_data, LLVMJITCompileOptions{}).status()));
+}
+
+TEST_F(LLVMJITExecutableTest, LazyCompilation) {
+  LLVMJITCompileOptions compile_options;
+  compile_options.lazy_compilation = true;
+  for (const auto& module_data : {std::string(kModuleIR), GetModuleBitcode()}) {
+    auto executable_data = MakeExecutableData(module_data);
+    ASSERT_OK_AND_ASSIGN(auto executable,
+                         Load(executable_data, compile_options));
+    CheckEntryPoints(executable.get());
+  }
+}
+
+TEST_F(LLVMJITExecutableTest, LazyCompilationWithCompileThreads) {
+  LLVMJITCompileOptions compile_options;
+  compile_options.lazy_compilation = true;
+  compile_options.compile_threads = 2;
+  auto executable_data = MakeExecutableData(GetModuleBitcode());
+  ASSERT_OK_AND_ASSIGN(auto executable,
+                       Load(executable_data, compile_options));
+  CheckEntryPoints(executable.get());
+}
+
+// Tests that lazy compilation falls back to compiling the whole module when
+// an object cache is used, and that the cached object is used on reload.
+TEST_F(LLVMJITExecutableTest, LazyCompilationWithObjectCache) {
+  LLVMJITCompileOptions compile_options;
+  compile_options.lazy_compilation = true;
+  ASSERT_OK_AND_ASSIGN(auto object_cache,
+                       LLVMJITObjectCache::Create(GetUniqueCachePath(
+                           "LazyCompilationWithObjectCache")));
+  auto module_data = GetModuleBitcode();
+  auto executable_data = MakeExecutableData(module_data);
+  auto key = LLVMJITObjectCache::ComputeKey(absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t*>(module_data.data()),
+      module_data.size()));
+  EXPECT_EQ(nullptr, object_cache->Lookup(key));
+
+  {
+    ASSERT_OK_AND_ASSIGN(
+        auto executable,
+        Load(executable_data, compile_options, object_cache.get()));
+    CheckEntryPoints(executable.get());
+  }
+  EXPECT_NE(nullptr, object_cache->Lookup(key));
+
+  ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      Load(executable_data, compile_options, object_cache.get()));
+  CheckEntryPoints(executable.get());
+}
+
+}  // namespace
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,204 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/llvmjit/llvmjit_microkernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/tracing.h"
+#include "iree/hal/llvmjit/memref_runtime.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "ruy/context.h"
+#include "ruy/ruy.h"
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+
+namespace {
+
+// Number of output pixels per im2col block of convolutions. Bounds the size of
+// the patch scratch buffer independent of the image size.
+constexpr int64_t kIm2ColBlockRows = 1024;
+
+// Ruy contexts hold the packing buffers and thread pool and must not be used
+// concurrently, so each thread executing dispatches gets its own.
+ruy::Context* GetThreadContext() {
+  thread_local ruy::Context context;
+  return &context;
+}
+
+// Computes |dst| (+)= |lhs| * |rhs| for row-major |m|x|k| and |k|x|n| matrices
+// with the given row strides. Ruy always overwrites its destination so
+// accumulation goes through a scratch buffer.
+void Sgemm(int64_t m, int64_t n, int64_t k, const float* lhs,
+           int64_t lhs_stride, const float* rhs, int64_t rhs_stride,
+           float* dst, int64_t dst_stride, bool accumulate) {
+  ruy::Matrix<float> lhs_matrix;
+  ruy::MakeSimpleLayout(m, k, ruy::Order::kRowMajor,
+                        lhs_matrix.mutable_layout());
+  lhs_matrix.mutable_layout()->set_stride(lhs_stride);
+  lhs_matrix.set_data(lhs);
+
+  ruy::Matrix<float> rhs_matrix;
+  ruy::MakeSimpleLayout(k, n, ruy::Order::kRowMajor,
+                        rhs_matrix.mutable_layout());
+  rhs_matrix.mutable_layout()->set_stride(rhs_stride);
+  rhs_matrix.set_data(rhs);
+
+  thread_local std::vector<float> scratch;
+  float* result = dst;
+  int64_t result_stride = dst_stride;
+  if (accumulate) {
+    scratch.resize(m * n);
+    result = scratch.data();
+    result_stride = n;
+  }
+  ruy::Matrix<float> dst_matrix;
+  ruy::MakeSimpleLayout(m, n, ruy::Order::kRowMajor,
+                        dst_matrix.mutable_layout());
+  dst_matrix.mutable_layout()->set_stride(result_stride);
+  dst_matrix.set_data(result);
+
+  ruy::MulParams<float, float> mul_params;
+  ruy::Mul(lhs_matrix, rhs_matrix, mul_params, GetThreadContext(),
+           &dst_matrix);
+
+  if (accumulate) {
+    for (int64_t i = 0; i < m; ++i) {
+      float* dst_row = dst + i * dst_stride;
+      const float* result_row = result + i * result_stride;
+      for (int64_t j = 0; j < n; ++j) dst_row[j] += result_row[j];
+    }
+  }
+}
+
+template <typename T, int N>
+T* GetData(StridedMemRefType<T, N>* memref) {
+  return memref->data + memref->offset;
+}
+
+// linalg.matmul: out[m, n] (+)= lhs[m, k] * rhs[k, n]
+void MatmulF32(StridedMemRefType<float, 2>* lhs,
+               StridedMemRefType<float, 2>* rhs,
+               StridedMemRefType<float, 2>* out, int32_t accumulate) {
+  IREE_TRACE_SCOPE0("iree_ukernel_matmul_f32");
+  Sgemm(lhs->sizes[0], rhs->sizes[1], lhs->sizes[1], GetData(lhs),
+        lhs->strides[0], GetData(rhs), rhs->strides[0], GetData(out),
+        out->strides[0], accumulate);
+}
+
+// linalg.batch_matmul: out[b, m, n] (+)= lhs[b, m, k] * rhs[b, k, n]
+void BatchMatmulF32(StridedMemRefType<float, 3>* lhs,
+                    StridedMemRefType<float, 3>* rhs,
+                    StridedMemRefType<float, 3>* out, int32_t accumulate) {
+  IREE_TRACE_SCOPE0("iree_ukernel_batch_matmul_f32");
+  for (int64_t b = 0; b < lhs->sizes[0]; ++b) {
+    Sgemm(lhs->sizes[1], rhs->sizes[2], lhs->sizes[2],
+          GetData(lhs) + b * lhs->strides[0], lhs->strides[1],
+          GetData(rhs) + b * rhs->strides[0], rhs->strides[1],
+          GetData(out) + b * out->strides[0], out->strides[1], accumulate);
+  }
+}
+
+// linalg.conv with an NHWC input, (KH, KW, C, F) filter and NHWC output,
+// computed as a GEMM of the output pixels and the flattened filter. 1x1
+// convolutions with unit strides use the input directly, others gather the
+// input patches of blocks of output pixels (im2col) first.
+void Conv2DF32(StridedMemRefType<float, 4>* filter,
+               StridedMemRefType<float, 4>* input,
+               StridedMemRefType<float, 4>* out, int64_t stride_h,
+               int64_t stride_w, int64_t dilation_h, int64_t dilation_w,
+               int32_t accumulate) {
+  IREE_TRACE_SCOPE0("iree_ukernel_conv2d_f32");
+  const int64_t kernel_h = filter->sizes[0];
+  const int64_t kernel_w = filter->sizes[1];
+  const int64_t channels = filter->sizes[2];
+  const int64_t filters = filter->sizes[3];
+  const int64_t batch = out->sizes[0];
+  const int64_t out_h = out->sizes[1];
+  const int64_t out_w = out->sizes[2];
+  const int64_t patch_size = kernel_h * kernel_w * channels;
+  const int64_t out_pixels = batch * out_h * out_w;
+
+  if (kernel_h == 1 && kernel_w == 1 && stride_h == 1 && stride_w == 1) {
+    Sgemm(out_pixels, filters, channels, GetData(input), input->strides[2],
+          GetData(filter), filter->strides[2], GetData(out), out->strides[2],
+          accumulate);
+    return;
+  }
+
+  thread_local std::vector<float> patches;
+  patches.resize(std::min(out_pixels, kIm2ColBlockRows) * patch_size);
+  for (int64_t block_begin = 0; block_begin < out_pixels;
+       block_begin += kIm2ColBlockRows) {
+    const int64_t block_rows =
+        std::min(kIm2ColBlockRows, out_pixels - block_begin);
+    for (int64_t row = 0; row < block_rows; ++row) {
+      const int64_t pixel = block_begin + row;
+      const int64_t n = pixel / (out_h * out_w);
+      const int64_t oh = (pixel / out_w) % out_h;
+      const int64_t ow = pixel % out_w;
+      float* patch = patches.data() + row * patch_size;
+      for (int64_t kh = 0; kh < kernel_h; ++kh) {
+        for (int64_t kw = 0; kw < kernel_w; ++kw) {
+          const float* src = GetData(input) + n * input->strides[0] +
+                             (oh * stride_h + kh * dilation_h) *
+                                 input->strides[1] +
+                             (ow * stride_w + kw * dilation_w) *
+                                 input->strides[2];
+          std::memcpy(patch, src, channels * sizeof(float));
+          patch += channels;
+        }
+      }
+    }
+    Sgemm(block_rows, filters, patch_size, patches.data(), patch_size,
+          GetData(filter), filter->strides[2],
+          GetData(out) + block_begin * out->strides[2], out->strides[2],
+          accumulate);
+  }
+}
+
+}  // namespace
+
+Status DefineMicrokernelSymbols(llvm::orc::LLJIT* ll_jit) {
+  auto define = [&](llvm::StringRef name, void* address) {
+    return std::make_pair(
+        ll_jit->mangleAndIntern(("_mlir_ciface_" + name).str()),
+        llvm::JITEvaluatedSymbol(llvm::pointerToJITTargetAddress(address),
+                                 llvm::JITSymbolFlags::Exported));
+  };
+  llvm::orc::SymbolMap symbols;
+  symbols.insert(define("iree_ukernel_matmul_f32",
+                        reinterpret_cast<void*>(&MatmulF32)));
+  symbols.insert(define("iree_ukernel_batch_matmul_f32",
+                        reinterpret_cast<void*>(&BatchMatmulF32)));
+  symbols.insert(define("iree_ukernel_conv2d_f32",
+                        reinterpret_cast<void*>(&Conv2DF32)));
+  if (auto err = ll_jit->getMainJITDylib().define(
+          llvm::orc::absoluteSymbols(std::move(symbols)))) {
+    return InternalErrorBuilder(IREE_LOC)
+           << "Can't define microkernel symbols: "
+           << llvm::toString(std::move(err));
+  }
+  return OkStatus();
+}
+
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
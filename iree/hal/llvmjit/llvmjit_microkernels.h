@@ -0,0 +1,38 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_LLVMJIT_LLVMJIT_MICROKERNELS_H_
+#define IREE_HAL_LLVMJIT_LLVMJIT_MICROKERNELS_H_
+
+#include "iree/base/status.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+
+// Defines the microkernels that generated code compiled with
+// -iree-llvm-use-microkernels calls for matmuls and convolutions in the main
+// JITDylib of |ll_jit|.
+//
+// Microkernels use the MLIR C interface: memrefs are passed as pointers to
+// their StridedMemRefType descriptors. See LinalgToMicrokernelCallsPass.cpp
+// in the compiler for the ABI.
+Status DefineMicrokernelSymbols(llvm::orc::LLJIT* ll_jit);
+
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_LLVMJIT_LLVMJIT_MICROKERNELS_H_
@@ -0,0 +1,298 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/llvmjit/llvmjit_microkernels.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "iree/base/status_matchers.h"
+#include "iree/hal/llvmjit/memref_runtime.h"
+#include "iree/testing/gtest.h"
+#include "llvm/Support/TargetSelect.h"
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+namespace {
+
+using MatmulFn = void (*)(StridedMemRefType<float, 2>*,
+                          StridedMemRefType<float, 2>*,
+                          StridedMemRefType<float, 2>*, int32_t);
+using BatchMatmulFn = void (*)(StridedMemRefType<float, 3>*,
+                               StridedMemRefType<float, 3>*,
+                               StridedMemRefType<float, 3>*, int32_t);
+using Conv2DFn = void (*)(StridedMemRefType<float, 4>*,
+                          StridedMemRefType<float, 4>*,
+                          StridedMemRefType<float, 4>*, int64_t, int64_t,
+                          int64_t, int64_t, int32_t);
+
+// Returns a descriptor of a view into |buffer| starting at element |offset|.
+template <int N>
+StridedMemRefType<float, N> MakeMemRef(std::vector<float>* buffer,
+                                       int64_t offset,
+                                       std::array<int64_t, N> sizes,
+                                       std::array<int64_t, N> strides) {
+  StridedMemRefType<float, N> memref;
+  memref.basePtr = buffer->data();
+  memref.data = buffer->data();
+  memref.offset = offset;
+  for (int i = 0; i < N; ++i) {
+    memref.sizes[i] = sizes[i];
+    memref.strides[i] = strides[i];
+  }
+  return memref;
+}
+
+// Returns the row-major strides of a contiguous memref of |sizes|.
+template <int N>
+std::array<int64_t, N> ContiguousStrides(std::array<int64_t, N> sizes) {
+  std::array<int64_t, N> strides;
+  strides[N - 1] = 1;
+  for (int i = N - 2; i >= 0; --i) strides[i] = strides[i + 1] * sizes[i + 1];
+  return strides;
+}
+
+// Returns |size| small integers so that results are exact in f32.
+std::vector<float> MakeValues(int64_t size, int seed) {
+  std::vector<float> values(size);
+  for (int64_t i = 0; i < size; ++i) {
+    values[i] = static_cast<float>((i * 7 + seed) % 11) - 5.0f;
+  }
+  return values;
+}
+
+float& At(StridedMemRefType<float, 2>& memref, int64_t i, int64_t j) {
+  return memref.data[memref.offset + i * memref.strides[0] +
+                     j * memref.strides[1]];
+}
+
+float& At(StridedMemRefType<float, 4>& memref, int64_t i, int64_t j,
+          int64_t k, int64_t l) {
+  return memref.data[memref.offset + i * memref.strides[0] +
+                     j * memref.strides[1] + k * memref.strides[2] +
+                     l * memref.strides[3]];
+}
+
+// out[m, n] (+)= lhs[m, k] * rhs[k, n]
+void ReferenceMatmul(StridedMemRefType<float, 2> lhs,
+                     StridedMemRefType<float, 2> rhs,
+                     StridedMemRefType<float, 2> out, bool accumulate) {
+  for (int64_t m = 0; m < out.sizes[0]; ++m) {
+    for (int64_t n = 0; n < out.sizes[1]; ++n) {
+      float sum = accumulate ? At(out, m, n) : 0.0f;
+      for (int64_t k = 0; k < lhs.sizes[1]; ++k) {
+        sum += At(lhs, m, k) * At(rhs, k, n);
+      }
+      At(out, m, n) = sum;
+    }
+  }
+}
+
+// NHWC conv with a (KH, KW, C, F) filter and no padding.
+void ReferenceConv2D(StridedMemRefType<float, 4> filter,
+                     StridedMemRefType<float, 4> input,
+                     StridedMemRefType<float, 4> out, int64_t stride_h,
+                     int64_t stride_w, int64_t dilation_h, int64_t dilation_w,
+                     bool accumulate) {
+  for (int64_t n = 0; n < out.sizes[0]; ++n) {
+    for (int64_t oh = 0; oh < out.sizes[1]; ++oh) {
+      for (int64_t ow = 0; ow < out.sizes[2]; ++ow) {
+        for (int64_t f = 0; f < out.sizes[3]; ++f) {
+          float sum = accumulate ? At(out, n, oh, ow, f) : 0.0f;
+          for (int64_t kh = 0; kh < filter.sizes[0]; ++kh) {
+            for (int64_t kw = 0; kw < filter.sizes[1]; ++kw) {
+              for (int64_t c = 0; c < filter.sizes[2]; ++c) {
+                sum += At(input, n, oh * stride_h + kh * dilation_h,
+                          ow * stride_w + kw * dilation_w, c) *
+                       At(filter, kh, kw, c, f);
+              }
+            }
+          }
+          At(out, n, oh, ow, f) = sum;
+        }
+      }
+    }
+  }
+}
+
+class LLVMJITMicrokernelsTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  }
+
+  void SetUp() override {
+    auto ll_jit = llvm::orc::LLJITBuilder().create();
+    ASSERT_TRUE(static_cast<bool>(ll_jit))
+        << llvm::toString(ll_jit.takeError());
+    ll_jit_ = std::move(ll_jit.get());
+    ASSERT_OK(DefineMicrokernelSymbols(ll_jit_.get()));
+  }
+
+  // Looks up the microkernel |name| as generated code calls it.
+  template <typename FnT>
+  FnT Lookup(const std::string& name) {
+    auto symbol = ll_jit_->lookup("_mlir_ciface_" + name);
+    if (!symbol) {
+      ADD_FAILURE() << llvm::toString(symbol.takeError());
+      return nullptr;
+    }
+    return reinterpret_cast<FnT>(symbol->getAddress());
+  }
+
+  // Runs the conv microkernel and the reference on contiguous memrefs of the
+  // given sizes and compares the results, with and without accumulation.
+  void CheckConv2D(std::array<int64_t, 4> filter_sizes,
+                   std::array<int64_t, 4> input_sizes, int64_t stride_h,
+                   int64_t stride_w, int64_t dilation_h, int64_t dilation_w) {
+    auto conv = Lookup<Conv2DFn>("iree_ukernel_conv2d_f32");
+    ASSERT_NE(conv, nullptr);
+    std::array<int64_t, 4> out_sizes = {
+        input_sizes[0],
+        (input_sizes[1] - (filter_sizes[0] - 1) * dilation_h - 1) / stride_h +
+            1,
+        (input_sizes[2] - (filter_sizes[1] - 1) * dilation_w - 1) / stride_w +
+            1,
+        filter_sizes[3]};
+    auto filter_data = MakeValues(
+        filter_sizes[0] * filter_sizes[1] * filter_sizes[2] * filter_sizes[3],
+        1);
+    auto input_data = MakeValues(
+        input_sizes[0] * input_sizes[1] * input_sizes[2] * input_sizes[3], 2);
+    auto out_init =
+        MakeValues(out_sizes[0] * out_sizes[1] * out_sizes[2] * out_sizes[3],
+                   3);
+    auto filter = MakeMemRef<4>(&filter_data, 0, filter_sizes,
+                                ContiguousStrides<4>(filter_sizes));
+    auto input = MakeMemRef<4>(&input_data, 0, input_sizes,
+                               ContiguousStrides<4>(input_sizes));
+    for (int32_t accumulate = 0; accumulate <= 1; ++accumulate) {
+      auto out_data = out_init;
+      auto expected_data = out_init;
+      auto out = MakeMemRef<4>(&out_data, 0, out_sizes,
+                               ContiguousStrides<4>(out_sizes));
+      auto expected = MakeMemRef<4>(&expected_data, 0, out_sizes,
+                                    ContiguousStrides<4>(out_sizes));
+      conv(&filter, &input, &out, stride_h, stride_w, dilation_h, dilation_w,
+           accumulate);
+      ReferenceConv2D(filter, input, expected, stride_h, stride_w, dilation_h,
+                      dilation_w, accumulate);
+      EXPECT_EQ(out_data, expected_data) << "accumulate=" << accumulate;
+    }
+  }
+
+  std::unique_ptr<llvm::orc::LLJIT> ll_jit_;
+};
+
+TEST_F(LLVMJITMicrokernelsTest, MatmulNonSquare) {
+  auto matmul = Lookup<MatmulFn>("iree_ukernel_matmul_f32");
+  ASSERT_NE(matmul, nullptr);
+  auto lhs_data = MakeValues(3 * 5, 1);
+  auto rhs_data = MakeValues(5 * 4, 2);
+  auto lhs = MakeMemRef<2>(&lhs_data, 0, {3, 5}, {5, 1});
+  auto rhs = MakeMemRef<2>(&rhs_data, 0, {5, 4}, {4, 1});
+  for (int32_t accumulate = 0; accumulate <= 1; ++accumulate) {
+    auto out_data = MakeValues(3 * 4, 3);
+    auto expected_data = out_data;
+    auto out = MakeMemRef<2>(&out_data, 0, {3, 4}, {4, 1});
+    auto expected = MakeMemRef<2>(&expected_data, 0, {3, 4}, {4, 1});
+    matmul(&lhs, &rhs, &out, accumulate);
+    ReferenceMatmul(lhs, rhs, expected, accumulate);
+    EXPECT_EQ(out_data, expected_data) << "accumulate=" << accumulate;
+  }
+}
+
+// Tests views with offsets and row strides larger than their rows, as
+// produced by tiling. Elements outside of the output view must be preserved.
+TEST_F(LLVMJITMicrokernelsTest, MatmulStrided) {
+  auto matmul = Lookup<MatmulFn>("iree_ukernel_matmul_f32");
+  ASSERT_NE(matmul, nullptr);
+  auto lhs_data = MakeValues(4 * 7, 1);
+  auto rhs_data = MakeValues(6 * 6, 2);
+  auto lhs = MakeMemRef<2>(&lhs_data, /*offset=*/8, {3, 5}, {7, 1});
+  auto rhs = MakeMemRef<2>(&rhs_data, /*offset=*/1, {5, 4}, {6, 1});
+  for (int32_t accumulate = 0; accumulate <= 1; ++accumulate) {
+    auto out_data = MakeValues(3 * 9, 3);
+    auto expected_data = out_data;
+    auto out = MakeMemRef<2>(&out_data, /*offset=*/2, {3, 4}, {9, 1});
+    auto expected = MakeMemRef<2>(&expected_data, /*offset=*/2, {3, 4}, {9, 1});
+    matmul(&lhs, &rhs, &out, accumulate);
+    ReferenceMatmul(lhs, rhs, expected, accumulate);
+    EXPECT_EQ(out_data, expected_data) << "accumulate=" << accumulate;
+  }
+}
+
+TEST_F(LLVMJITMicrokernelsTest, BatchMatmulStrided) {
+  auto batch_matmul = Lookup<BatchMatmulFn>("iree_ukernel_batch_matmul_f32");
+  ASSERT_NE(batch_matmul, nullptr);
+  // Each batch of the lhs and output is padded.
+  auto lhs_data = MakeValues(2 * 8, 1);
+  auto rhs_data = MakeValues(2 * 3 * 5, 2);
+  auto lhs = MakeMemRef<3>(&lhs_data, 0, {2, 2, 3}, {8, 3, 1});
+  auto rhs = MakeMemRef<3>(&rhs_data, 0, {2, 3, 5}, {15, 5, 1});
+  for (int32_t accumulate = 0; accumulate <= 1; ++accumulate) {
+    auto out_data = MakeValues(2 * 12, 3);
+    auto expected_data = out_data;
+    auto out = MakeMemRef<3>(&out_data, 0, {2, 2, 5}, {12, 5, 1});
+    batch_matmul(&lhs, &rhs, &out, accumulate);
+    for (int64_t b = 0; b < 2; ++b) {
+      ReferenceMatmul(MakeMemRef<2>(&lhs_data, b * 8, {2, 3}, {3, 1}),
+                      MakeMemRef<2>(&rhs_data, b * 15, {3, 5}, {5, 1}),
+                      MakeMemRef<2>(&expected_data, b * 12, {2, 5}, {5, 1}),
+                      accumulate);
+    }
+    EXPECT_EQ(out_data, expected_data) << "accumulate=" << accumulate;
+  }
+}
+
+TEST_F(LLVMJITMicrokernelsTest, Conv2DPointwise) {
+  CheckConv2D(/*filter_sizes=*/{1, 1, 4, 3}, /*input_sizes=*/{2, 2, 3, 4},
+              /*stride_h=*/1, /*stride_w=*/1, /*dilation_h=*/1,
+              /*dilation_w=*/1);
+}
+
+TEST_F(LLVMJITMicrokernelsTest, Conv2DNonSquare) {
+  CheckConv2D(/*filter_sizes=*/{2, 3, 3, 2}, /*input_sizes=*/{1, 5, 7, 3},
+              /*stride_h=*/1, /*stride_w=*/1, /*dilation_h=*/1,
+              /*dilation_w=*/1);
+}
+
+TEST_F(LLVMJITMicrokernelsTest, Conv2DStridedDilated) {
+  CheckConv2D(/*filter_sizes=*/{2, 3, 3, 2}, /*input_sizes=*/{2, 7, 6, 3},
+              /*stride_h=*/2, /*stride_w=*/1, /*dilation_h=*/1,
+              /*dilation_w=*/2);
+}
+
+TEST_F(LLVMJITMicrokernelsTest, Conv2DStridedPointwise) {
+  CheckConv2D(/*filter_sizes=*/{1, 1, 2, 3}, /*input_sizes=*/{1, 5, 4, 2},
+              /*stride_h=*/2, /*stride_w=*/3, /*dilation_h=*/1,
+              /*dilation_w=*/1);
+}
+
+// Tests convolutions with more output pixels than fit in one im2col block.
+TEST_F(LLVMJITMicrokernelsTest, Conv2DMultipleIm2ColBlocks) {
+  CheckConv2D(/*filter_sizes=*/{3, 3, 2, 2}, /*input_sizes=*/{1, 36, 36, 2},
+              /*stride_h=*/1, /*stride_w=*/1, /*dilation_h=*/1,
+              /*dilation_w=*/1);
+}
+
+}  // namespace
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,138 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/llvmjit/llvmjit_object_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "iree/base/file_io.h"
+#include "iree/base/file_path.h"
+#include "iree/base/logging.h"
+#include "iree/base/tracing.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SHA1.h"
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+
+namespace {
+
+// Returns the host CPU features as a sorted, comma-separated list of
+// "+feature"/"-feature" entries. CPUs sharing a name may still differ in the
+// features they enable (for example with AVX-512 disabled by the OS).
+std::string GetHostCPUFeatureString() {
+  llvm::StringMap<bool> host_features;
+  if (!llvm::sys::getHostCPUFeatures(host_features)) return "";
+  std::vector<std::string> features;
+  features.reserve(host_features.size());
+  for (const auto& feature : host_features) {
+    features.push_back(
+        absl::StrCat(feature.second ? "+" : "-", feature.first().str()));
+  }
+  std::sort(features.begin(), features.end());
+  return llvm::join(features, ",");
+}
+
+}  // namespace
+
+// static
+StatusOr<std::unique_ptr<LLVMJITObjectCache>> LLVMJITObjectCache::Create(
+    std::string cache_path) {
+  IREE_TRACE_SCOPE0("LLVMJITObjectCache::Create");
+  if (auto error = llvm::sys::fs::create_directories(cache_path)) {
+    return UnavailableErrorBuilder(IREE_LOC)
+           << "Unable to create object cache directory '" << cache_path
+           << "': " << error.message();
+  }
+  return std::make_unique<LLVMJITObjectCache>(std::move(cache_path));
+}
+
+// static
+std::string LLVMJITObjectCache::ComputeKey(
+    absl::Span<const uint8_t> module_data) {
+  llvm::SHA1 hasher;
+  hasher.update(
+      llvm::ArrayRef<uint8_t>(module_data.data(), module_data.size()));
+  // Objects are only valid for the target and compiler that produced them.
+  hasher.update(llvm::sys::getProcessTriple());
+  hasher.update(llvm::sys::getHostCPUName());
+  hasher.update(GetHostCPUFeatureString());
+  hasher.update(LLVM_VERSION_STRING);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+LLVMJITObjectCache::LLVMJITObjectCache(std::string cache_path)
+    : cache_path_(std::move(cache_path)) {}
+
+LLVMJITObjectCache::~LLVMJITObjectCache() = default;
+
+std::string LLVMJITObjectCache::GetObjectPath(absl::string_view key) const {
+  return file_path::JoinPaths(cache_path_, absl::StrCat(key, ".o"));
+}
+
+std::unique_ptr<llvm::MemoryBuffer> LLVMJITObjectCache::Lookup(
+    absl::string_view key) const {
+  IREE_TRACE_SCOPE0("LLVMJITObjectCache::Lookup");
+  auto object_or =
+      llvm::MemoryBuffer::getFile(GetObjectPath(key), /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!object_or) return nullptr;
+  return std::move(object_or.get());
+}
+
+void LLVMJITObjectCache::Insert(absl::string_view key,
+                                llvm::MemoryBufferRef object) {
+  IREE_TRACE_SCOPE0("LLVMJITObjectCache::Insert");
+  // Write to a process-unique temporary file and then move it into place so
+  // that concurrent readers never observe partially written objects.
+  auto object_path = GetObjectPath(key);
+  auto temp_path = absl::StrCat(object_path, ".tmp",
+                                llvm::sys::Process::getProcessId());
+  auto status = file_io::SetFileContents(
+      temp_path, std::string(object.getBufferStart(), object.getBufferSize()));
+  if (status.ok()) {
+    status = file_io::MoveFile(temp_path, object_path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to persist JIT object to " << object_path << ": "
+                 << status;
+    file_io::DeleteFile(temp_path).IgnoreError();
+  }
+}
+
+void LLVMJITObjectCache::notifyObjectCompiled(const llvm::Module* module,
+                                              llvm::MemoryBufferRef object) {
+  const auto& key = module->getModuleIdentifier();
+  if (key.empty()) return;
+  Insert(key, object);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> LLVMJITObjectCache::getObject(
+    const llvm::Module* module) {
+  const auto& key = module->getModuleIdentifier();
+  if (key.empty()) return nullptr;
+  return Lookup(key);
+}
+
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,78 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_LLVMJIT_LLVMJIT_OBJECT_CACHE_H_
+#define IREE_HAL_LLVMJIT_LLVMJIT_OBJECT_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+
+// Persistent cache of JIT-compiled object files stored in a directory on disk.
+//
+// Objects are keyed by the identifier of the module they were compiled from,
+// which LLVMJITExecutable sets to the result of ComputeKey. Keys include the
+// host target, CPU features, and LLVM version so a cache directory can be
+// shared between machines and releases without returning incompatible objects.
+//
+// Thread-safe; multiple processes may share the same cache directory.
+class LLVMJITObjectCache final : public llvm::ObjectCache {
+ public:
+  // Creates a cache rooted at |cache_path|, creating the directory if needed.
+  static StatusOr<std::unique_ptr<LLVMJITObjectCache>> Create(
+      std::string cache_path);
+
+  // Computes the cache key for an LLVM IR module with the given serialized
+  // contents compiled for the host.
+  static std::string ComputeKey(absl::Span<const uint8_t> module_data);
+
+  explicit LLVMJITObjectCache(std::string cache_path);
+  ~LLVMJITObjectCache() override;
+
+  const std::string& cache_path() const { return cache_path_; }
+
+  // Returns the object previously compiled for |key| or nullptr if not found.
+  std::unique_ptr<llvm::MemoryBuffer> Lookup(absl::string_view key) const;
+
+  // Stores |object| for |key|. Failures are logged and otherwise ignored as the
+  // cache is only an optimization.
+  void Insert(absl::string_view key, llvm::MemoryBufferRef object);
+
+  // llvm::ObjectCache:
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override;
+
+ private:
+  std::string GetObjectPath(absl::string_view key) const;
+
+  std::string cache_path_;
+};
+
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_LLVMJIT_LLVMJIT_OBJECT_CACHE_H_
@@ -0,0 +1,93 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/llvmjit/llvmjit_object_cache.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "iree/base/file_path.h"
+#include "iree/base/logging.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace llvmjit {
+namespace {
+
+std::string GetUniqueCachePath(absl::string_view unique_name) {
+  char* test_tmpdir = getenv("TEST_TMPDIR");
+  CHECK(test_tmpdir) << "TEST_TMPDIR not defined";
+  return file_path::JoinPaths(test_tmpdir,
+                              absl::StrCat(unique_name, "_object_cache"));
+}
+
+std::vector<uint8_t> MakeModuleData(absl::string_view contents) {
+  return std::vector<uint8_t>(contents.begin(), contents.end());
+}
+
+// Tests that keys are stable for identical modules and differ otherwise.
+TEST(LLVMJITObjectCacheTest, ComputeKeyStability) {
+  auto module_a = MakeModuleData("module a");
+  auto module_b = MakeModuleData("module b");
+  auto key_a = LLVMJITObjectCache::ComputeKey(module_a);
+  EXPECT_FALSE(key_a.empty());
+  EXPECT_EQ(key_a, LLVMJITObjectCache::ComputeKey(module_a));
+  EXPECT_EQ(key_a, LLVMJITObjectCache::ComputeKey(MakeModuleData("module a")));
+  EXPECT_NE(key_a, LLVMJITObjectCache::ComputeKey(module_b));
+  EXPECT_NE(key_a, LLVMJITObjectCache::ComputeKey({}));
+}
+
+// Tests that inserted objects can be looked up with their key.
+TEST(LLVMJITObjectCacheTest, InsertLookupRoundTrip) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache,
+      LLVMJITObjectCache::Create(GetUniqueCachePath("InsertLookupRoundTrip")));
+  auto key = LLVMJITObjectCache::ComputeKey(MakeModuleData("module"));
+  EXPECT_EQ(nullptr, cache->Lookup(key));
+
+  std::string object_data("object\0data", 11);
+  cache->Insert(key, llvm::MemoryBufferRef(object_data, "object"));
+  auto object = cache->Lookup(key);
+  ASSERT_NE(nullptr, object);
+  EXPECT_EQ(object_data, object->getBuffer().str());
+
+  // Inserting again replaces the previous object.
+  std::string new_object_data = "new object";
+  cache->Insert(key, llvm::MemoryBufferRef(new_object_data, "object"));
+  object = cache->Lookup(key);
+  ASSERT_NE(nullptr, object);
+  EXPECT_EQ(new_object_data, object->getBuffer().str());
+
+  // Objects persist across cache instances sharing the same directory.
+  LLVMJITObjectCache other_cache(cache->cache_path());
+  object = other_cache.Lookup(key);
+  ASSERT_NE(nullptr, object);
+  EXPECT_EQ(new_object_data, object->getBuffer().str());
+}
+
+// Tests that lookups of keys never inserted return nullptr.
+TEST(LLVMJITObjectCacheTest, LookupMissing) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache, LLVMJITObjectCache::Create(GetUniqueCachePath("Missing")));
+  EXPECT_EQ(nullptr, cache->Lookup(LLVMJITObjectCache::ComputeKey(
+                         MakeModuleData("never inserted"))));
+}
+
+}  // namespace
+}  // namespace llvmjit
+}  // namespace hal
+}  // namespace iree
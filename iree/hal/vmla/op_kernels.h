@@ -35,6 +35,7 @@
 #define IREE_HAL_VMLA_OP_KERNELS_H_
 
 #include <cstdint>
+#include <cstring>
 
 #include "absl/types/span.h"
 #include "iree/base/status.h"
@@ -47,6 +48,102 @@ namespace kernels {
 
 using ShapeSpan = absl::Span<const int32_t>;
 
+// IEEE 754 half-precision (f16) storage type. Values widen to float for all
+// arithmetic and round to nearest even when stored, so kernels instantiated
+// with this type load and store 16 bits per element but compute in f32.
+class Float16 {
+ public:
+  Float16() = default;
+  Float16(float value) : bits_(FromFloat(value)) {}  // NOLINT
+  operator float() const { return ToFloat(bits_); }  // NOLINT
+
+  uint16_t bits() const { return bits_; }
+
+ private:
+  static uint32_t AsBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+  static float AsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  static uint16_t FromFloat(float value) {
+    constexpr uint32_t kF32Infinity = 255u << 23;
+    constexpr uint32_t kF16Overflow = (127u + 16u) << 23;
+    constexpr uint32_t kF16MinNormal = 113u << 23;
+    constexpr uint32_t kDenormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+    uint32_t bits = AsBits(value);
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+    uint16_t result;
+    if (bits >= kF16Overflow) {
+      // Inf stays inf, NaN becomes a quiet NaN and the rest overflow to inf.
+      result = bits > kF32Infinity ? 0x7E00u : 0x7C00u;
+    } else if (bits < kF16MinNormal) {
+      // Subnormal or zero: let the FPU round the mantissa into place.
+      result = AsBits(AsFloat(bits) + AsFloat(kDenormMagic)) - kDenormMagic;
+    } else {
+      // Rebias the exponent and round the mantissa to nearest even.
+      const uint32_t mantissa_odd = (bits >> 13) & 1u;
+      bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + mantissa_odd;
+      result = bits >> 13;
+    }
+    return result | (sign >> 16);
+  }
+
+  static float ToFloat(uint16_t bits) {
+    constexpr uint32_t kExponentMask = 0x7C00u << 13;
+    uint32_t result = (bits & 0x7FFFu) << 13;
+    const uint32_t exponent = result & kExponentMask;
+    result += (127u - 15u) << 23;
+    if (exponent == kExponentMask) {
+      // Inf/NaN.
+      result += (128u - 16u) << 23;
+    } else if (exponent == 0) {
+      // Zero/subnormal: renormalize through the FPU.
+      result += 1u << 23;
+      result = AsBits(AsFloat(result) - AsFloat(113u << 23));
+    }
+    return AsFloat(result | (static_cast<uint32_t>(bits & 0x8000u) << 16));
+  }
+
+  uint16_t bits_;
+};
+
+// bfloat16 storage type: the upper 16 bits of an f32. Like Float16 values are
+// computed on as float and rounded to nearest even when stored.
+class BFloat16 {
+ public:
+  BFloat16() = default;
+  BFloat16(float value) : bits_(FromFloat(value)) {}  // NOLINT
+  operator float() const {  // NOLINT
+    const uint32_t bits = static_cast<uint32_t>(bits_) << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  uint16_t bits() const { return bits_; }
+
+ private:
+  static uint16_t FromFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+      // Keep NaNs NaN (and quiet) even if their payload is in the low bits.
+      return (bits >> 16) | 0x0040u;
+    }
+    bits += 0x7FFFu + ((bits >> 16) & 1u);
+    return bits >> 16;
+  }
+
+  uint16_t bits_;
+};
+
 inline size_t GetElementCount(ShapeSpan shape) {
   size_t count = 1;
   for (size_t i = 0; i < shape.size(); ++i) {
@@ -92,16 +189,6 @@ struct CompareGE {
                         absl::Span<uint8_t> dst_buffer);
 };
 
-struct Conv2D {
-  template <typename T>
-  static Status Execute(absl::Span<const T> input_buffer, ShapeSpan input_shape,
-                        absl::Span<const T> filter_buffer,
-                        ShapeSpan filter_shape, absl::Span<T> dst_buffer,
-                        ShapeSpan dst_shape, ShapeSpan strides, ShapeSpan pad_h,
-                        ShapeSpan pad_w, ShapeSpan dilation,
-                        const int32_t groups);
-};
-
 struct Copy {
   template <int element_size>
   static Status Execute(absl::Span<const uint8_t> src_buffer,
@@ -351,33 +438,115 @@ struct Convert {
                         absl::Span<DST> dst_buffer);
 };
 
+// Evaluates a fused chain of elementwise ops over equally sized buffers in a
+// single pass. The program is a sequence of fixed-size instructions:
+//   [opcode, a, b, c]
+// where a, b and c are register operands. Registers [0, N) hold the N source
+// buffers and register N + i holds the result of instruction i. kConstant
+// instead stores the bit pattern of its value in a. The result of the last
+// instruction is written to |dst_buffer|.
+//
+// NOTE: the opcodes must be kept in sync with the compiler
+// (iree/compiler/Dialect/VMLA/Transforms/FuseElementwiseOps.cpp).
+struct Elementwise {
+  enum class Opcode : int32_t {
+    kConstant = 0,
+    kAdd = 1,
+    kSub = 2,
+    kMul = 3,
+    kDiv = 4,
+    kMin = 5,
+    kMax = 6,
+    kPow = 7,
+    kNeg = 8,
+    kAbs = 9,
+    kExp = 10,
+    kLog = 11,
+    kSqrt = 12,
+    kRsqrt = 13,
+    kTanh = 14,
+    kClamp = 15,
+  };
+  static constexpr int kInstructionWords = 4;
+
+  template <typename T>
+  static Status Execute(absl::Span<const absl::Span<const T>> src_buffers,
+                        absl::Span<const int32_t> program,
+                        absl::Span<T> dst_buffer);
+};
+
 struct MatMul {
   struct RuntimeState;
 
   static std::unique_ptr<RuntimeState> CreateRuntimeState();
 
-  template <typename T, typename ACC>
+  // |T| is the lhs/rhs element type, |ACC| the accumulator type and |DST| the
+  // destination element type. Quantized int8 matmuls may either produce the
+  // raw int32 accumulators (DST = ACC) or requantize them to int8 with the
+  // fixed-point multipliers.
+  template <typename T, typename ACC, typename DST = T>
   struct Buffers {
     ShapeSpan lhs_shape;
     absl::Span<const T> lhs_buffer;
     ShapeSpan rhs_shape;
     absl::Span<const T> rhs_buffer;
     ShapeSpan dst_shape;
-    absl::Span<T> dst_buffer;
+    absl::Span<DST> dst_buffer;
 
     // Optional bias buffer.
     absl::Span<const ACC> bias_buffer;
 
-    // Fixed-point multiplier mantissa/exponent. May be a single value (for
-    // uniform quantization) or one element per row of the destination matrix
-    // for per-channel.
+    // Optional fixed-point multiplier mantissa/exponent. May be a single value
+    // (for uniform quantization) or one element per row of the destination
+    // matrix for per-channel. Must be empty when DST is ACC.
     absl::Span<const ACC> multiplier_mantissa_buffer;
     absl::Span<const int32_t> multiplier_exponent_buffer;
   };
 
-  template <typename T, typename ACC>
+  template <typename T, typename ACC, typename DST>
+  static Status Execute(RuntimeState* runtime_state,
+                        const Buffers<T, ACC, DST>& buffers);
+
+  // Half-precision matrices are widened to f32 one block of lhs rows and one
+  // panel of rhs columns at a time and each block of results is rounded back
+  // as it completes.
+  static Status Execute(RuntimeState* runtime_state,
+                        const Buffers<Float16, float, Float16>& buffers);
   static Status Execute(RuntimeState* runtime_state,
-                        const Buffers<T, ACC>& buffers);
+                        const Buffers<BFloat16, float, BFloat16>& buffers);
+};
+
+// Convolves a single HWC |input| with a (KH, KW, C, F) filter. 1x1 and
+// general convolutions are lowered to GEMMs through |mat_mul_state| and
+// depthwise convolutions use a direct kernel. Other cases fall back to the
+// reference implementation.
+//
+// Products are accumulated in and written as |ACC|, which allows int8 inputs
+// to produce int32 results.
+struct Conv2D {
+  // Returns true if Execute computes convolutions of the given shapes as GEMMs
+  // against the filter transposed by TransposeFilter.
+  static bool UsesTransposedFilter(ShapeSpan input_shape,
+                                   ShapeSpan filter_shape, ShapeSpan dst_shape,
+                                   ShapeSpan dilation, const int32_t groups);
+
+  // Transposes a (KH, KW, C, F) filter into the (F, KH * KW * C) |filter_t|.
+  template <typename T>
+  static void TransposeFilter(absl::Span<const T> filter_buffer,
+                              ShapeSpan filter_shape, absl::Span<T> filter_t);
+
+  // |filter_t| may hold the transposed filter when UsesTransposedFilter so
+  // that callers convolving several inputs with the same filter only
+  // transpose it once. Otherwise the filter is transposed as needed.
+  template <typename T, typename ACC = T>
+  static Status Execute(MatMul::RuntimeState* mat_mul_state,
+                        absl::Span<const T> input_buffer, ShapeSpan input_shape,
+                        absl::Span<const T> filter_buffer,
+                        ShapeSpan filter_shape, absl::Span<ACC> dst_buffer,
+                        ShapeSpan dst_shape, ShapeSpan strides, ShapeSpan pad_h,
+                        ShapeSpan pad_w, ShapeSpan dilation,
+                        const int32_t groups,
+                        absl::Span<const T> filter_t = {});
 };
 
 struct RuntimeState {
@@ -389,7 +558,8 @@ struct ReduceSum {
   template <typename T>
   static Status Execute(absl::Span<const T> src_buffer,
                         absl::Span<const T> init_buffer,
-                        absl::Span<T> dst_buffer, int32_t dimension,
+                        absl::Span<T> dst_buffer,
+                        absl::Span<const int32_t> dimensions,
                         ShapeSpan src_shape, ShapeSpan dst_shape);
 };
 
@@ -397,7 +567,8 @@ struct ReduceMin {
   template <typename T>
   static Status Execute(absl::Span<const T> src_buffer,
                         absl::Span<const T> init_buffer,
-                        absl::Span<T> dst_buffer, int32_t dimension,
+                        absl::Span<T> dst_buffer,
+                        absl::Span<const int32_t> dimensions,
                         ShapeSpan src_shape, ShapeSpan dst_shape);
 };
 
@@ -405,7 +576,8 @@ struct ReduceMax {
   template <typename T>
   static Status Execute(absl::Span<const T> src_buffer,
                         absl::Span<const T> init_buffer,
-                        absl::Span<T> dst_buffer, int32_t dimension,
+                        absl::Span<T> dst_buffer,
+                        absl::Span<const int32_t> dimensions,
                         ShapeSpan src_shape, ShapeSpan dst_shape);
 };
 
@@ -436,6 +608,26 @@ struct PoolingMax {
                         ShapeSpan strides, ShapeSpan pad_low);
 };
 
+// Writes the indices that stably sort each row along the innermost dimension
+// of |src_buffer| into |dst_buffer|. Floating-point keys are ordered by their
+// IEEE total order (-NaN < -inf < ... < +inf < +NaN) with -0 equal to +0.
+struct Sort {
+  template <typename T>
+  static Status Execute(absl::Span<const T> src_buffer,
+                        absl::Span<int32_t> dst_buffer, ShapeSpan src_shape,
+                        bool descending);
+};
+
+// Writes the indices of the first K elements of each stably sorted row into
+// |dst_buffer|, where K is the innermost dimension of |dst_shape|. Only the
+// selected elements are fully ordered.
+struct TopK {
+  template <typename T>
+  static Status Execute(absl::Span<const T> src_buffer,
+                        absl::Span<int32_t> dst_buffer, ShapeSpan src_shape,
+                        ShapeSpan dst_shape, bool descending);
+};
+
 }  // namespace kernels
 }  // namespace vmla
 }  // namespace hal
@@ -0,0 +1,587 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for the VMLA kernels. Throughput is reported in bytes
+// written to the destination buffer so that data movement and element-wise
+// kernels can be compared against memcpy bandwidth. Reductions, pooling, and
+// sorting instead report the bytes read from their source buffer as their
+// outputs are small. MatMul and Conv2D report FLOP/s with a multiply-add
+// counted as two operations.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "benchmark/benchmark.h"
+#include "iree/base/logging.h"
+#include "iree/hal/vmla/op_kernels.h"
+
+namespace iree {
+namespace hal {
+namespace vmla {
+namespace kernels {
+namespace {
+
+using Shape = absl::InlinedVector<int32_t, 6>;
+
+size_t GetShapeElementCount(const Shape& shape) {
+  size_t count = 1;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    count *= shape[i];
+  }
+  return count;
+}
+
+template <typename T>
+std::vector<T> MakeIota(size_t size) {
+  std::vector<T> v(size);
+  std::iota(v.begin(), v.end(), static_cast<T>(0));
+  return v;
+}
+
+// Returns a buffer with values cycling through [1, 8]. These are valid
+// operands for all kernels (including log, sqrt, division, and shifts) and
+// keep floating-point results finite.
+template <typename T>
+std::vector<T> MakeOperand(size_t size) {
+  std::vector<T> v(size);
+  for (size_t i = 0; i < size; ++i) {
+    v[i] = static_cast<T>(1 + i % 8);
+  }
+  return v;
+}
+
+// Returns a buffer of uniformly distributed integral values spanning the range
+// of |T|, limited to [-2^20, 2^20].
+template <typename T>
+std::vector<T> MakeRandom(size_t size) {
+  const int32_t limit = static_cast<int32_t>(
+      std::min<double>(std::numeric_limits<T>::max(), 1 << 20));
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int32_t> distribution(-limit, limit);
+  std::vector<T> v(size);
+  for (size_t i = 0; i < size; ++i) {
+    v[i] = static_cast<T>(distribution(generator));
+  }
+  return v;
+}
+
+template <typename T>
+void SetBytesWritten(benchmark::State& state, const std::vector<T>& dst) {
+  state.SetBytesProcessed(state.iterations() * dst.size() * sizeof(T));
+}
+
+template <typename T>
+void SetBytesRead(benchmark::State& state, const std::vector<T>& src) {
+  state.SetBytesProcessed(state.iterations() * src.size() * sizeof(T));
+}
+
+void SetFlops(benchmark::State& state, double flops_per_iteration) {
+  state.counters["FLOPS"] = benchmark::Counter(
+      flops_per_iteration * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+//===----------------------------------------------------------------------===//
+// Data movement
+//===----------------------------------------------------------------------===//
+
+// Copies a [rows, cols] region out of a [512, 512] f32 buffer.
+void BM_Copy(benchmark::State& state) {
+  Shape src_shape = {512, 512};
+  Shape lengths = {static_cast<int32_t>(state.range(0)),
+                   static_cast<int32_t>(state.range(1))};
+  Shape dst_shape = lengths;
+  Shape src_indices = {0, 0};
+  Shape dst_indices = {0, 0};
+  auto src_buffer = MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  auto src_bytes = absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t*>(src_buffer.data()),
+      src_buffer.size() * sizeof(float));
+  auto dst_bytes =
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(dst_buffer.data()),
+                     dst_buffer.size() * sizeof(float));
+  for (auto _ : state) {
+    CHECK_OK(Copy::Execute<sizeof(float)>(src_bytes, src_shape, src_indices,
+                                          dst_bytes, dst_shape, dst_indices,
+                                          lengths));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Copy)->Args({256, 512})->Args({256, 256})->Args({512, 4});
+
+// Pads the spatial dimensions of an NHWC image by one on each side, with the
+// given amount of interior padding.
+void BM_Pad(benchmark::State& state) {
+  const int32_t interior = state.range(0);
+  Shape src_shape = {1, 56, 56, 64};
+  Shape edge_padding_low = {0, 1, 1, 0};
+  Shape edge_padding_high = {0, 1, 1, 0};
+  Shape interior_padding = {0, interior, interior, 0};
+  Shape dst_shape = src_shape;
+  for (int i = 1; i <= 2; ++i) {
+    dst_shape[i] = (src_shape[i] - 1) * (interior + 1) + 1 +
+                   edge_padding_low[i] + edge_padding_high[i];
+  }
+  auto src_buffer = MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<float> padding_value = {0.0f};
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  for (auto _ : state) {
+    CHECK_OK(Pad::Execute<float>(src_buffer, padding_value,
+                                 absl::MakeSpan(dst_buffer), src_shape,
+                                 dst_shape, edge_padding_low,
+                                 edge_padding_high, interior_padding));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Pad)->Arg(0)->Arg(1);
+
+// Tiles a [64, 64] f32 buffer into [512, 512].
+void BM_Tile(benchmark::State& state) {
+  Shape src_shape = {64, 64};
+  Shape dst_shape = {512, 512};
+  auto src_buffer = MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  for (auto _ : state) {
+    CHECK_OK(Tile::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer),
+                                  src_shape, dst_shape));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Tile);
+
+void BM_Broadcast(benchmark::State& state) {
+  std::vector<float> src_buffer = {1.0f};
+  std::vector<float> dst_buffer(state.range(0));
+  for (auto _ : state) {
+    CHECK_OK(Broadcast::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Broadcast)->Arg(1 << 10)->Arg(1 << 20);
+
+// Gathers 512 rows of a [1024, 64] f32 table. With a run length of 1 every
+// index selects an unrelated row; longer runs select consecutive rows.
+void BM_Gather(benchmark::State& state) {
+  const int32_t run_length = state.range(0);
+  Shape src_shape = {1024, 64};
+  Shape indices_shape = {512};
+  Shape dst_shape = {512, 64};
+  auto src_buffer = MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> indices_buffer(indices_shape[0]);
+  for (int32_t i = 0; i < indices_shape[0]; ++i) {
+    indices_buffer[i] = (i / run_length * 37 * run_length + i % run_length) %
+                        src_shape[0];
+  }
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  for (auto _ : state) {
+    CHECK_OK(Gather::Execute<float>(src_buffer, indices_buffer,
+                                    absl::MakeSpan(dst_buffer), src_shape,
+                                    indices_shape, dst_shape, /*dim=*/0,
+                                    /*batch_dims=*/0));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Gather)->Arg(1)->Arg(16);
+
+// Transposes a [512, 512] matrix (perm 0) or an NHWC [1, 56, 56, 64] image to
+// NCHW (perm 1).
+void BM_Transpose(benchmark::State& state) {
+  Shape src_shape;
+  std::vector<int32_t> perm;
+  if (state.range(0) == 0) {
+    src_shape = {512, 512};
+    perm = {1, 0};
+  } else {
+    src_shape = {1, 56, 56, 64};
+    perm = {0, 3, 1, 2};
+  }
+  auto src_buffer = MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(Transpose::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer),
+                                       src_shape, perm));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Transpose)->Arg(0)->Arg(1);
+
+// Reverses a [512, 512] f32 buffer along the given dimension.
+void BM_Reverse(benchmark::State& state) {
+  Shape src_shape = {512, 512};
+  std::vector<int32_t> dimensions = {static_cast<int32_t>(state.range(0))};
+  auto src_buffer = MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(Reverse::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer),
+                                     src_shape, dimensions));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Reverse)->Arg(0)->Arg(1);
+
+void BM_Select(benchmark::State& state) {
+  std::vector<uint8_t> cond_buffer(state.range(0));
+  for (size_t i = 0; i < cond_buffer.size(); ++i) {
+    cond_buffer[i] = i % 3 == 0;
+  }
+  auto lhs_buffer = MakeOperand<float>(cond_buffer.size());
+  auto rhs_buffer = MakeIota<float>(cond_buffer.size());
+  std::vector<float> dst_buffer(cond_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(Select::Execute<float>(cond_buffer, lhs_buffer, rhs_buffer,
+                                    absl::MakeSpan(dst_buffer)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Select)->Arg(1 << 12)->Arg(1 << 20);
+
+//===----------------------------------------------------------------------===//
+// Element-wise
+//===----------------------------------------------------------------------===//
+
+// Buffer sizes are chosen to fit in L1 and to exceed the last level cache.
+#define ELEMENTWISE_SIZES ->Arg(1 << 12)->Arg(1 << 20)
+
+template <typename KERNEL, typename T>
+void BM_UnaryOp(benchmark::State& state) {
+  auto src_buffer = MakeOperand<T>(state.range(0));
+  std::vector<T> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<T>(src_buffer,
+                                         absl::MakeSpan(dst_buffer)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK_TEMPLATE(BM_UnaryOp, Not, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Abs, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Abs, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Neg, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Neg, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Exp, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Log, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Rsqrt, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Sqrt, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Cos, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Sin, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Tanh, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Floor, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_UnaryOp, Ceil, float) ELEMENTWISE_SIZES;
+
+template <typename KERNEL, typename T>
+void BM_BinaryOp(benchmark::State& state) {
+  auto lhs_buffer = MakeIota<T>(state.range(0));
+  auto rhs_buffer = MakeOperand<T>(lhs_buffer.size());
+  std::vector<T> dst_buffer(lhs_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<T>(lhs_buffer, rhs_buffer,
+                                         absl::MakeSpan(dst_buffer)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK_TEMPLATE(BM_BinaryOp, And, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Or, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Xor, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, ShiftLeft, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, ShiftRight, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Add, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Add, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Add, int8_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Sub, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Mul, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Mul, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Div, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Div, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Rem, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Rem, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Pow, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Atan2, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Min, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_BinaryOp, Max, float) ELEMENTWISE_SIZES;
+
+template <typename KERNEL, typename T>
+void BM_CompareOp(benchmark::State& state) {
+  auto lhs_buffer = MakeIota<T>(state.range(0));
+  auto rhs_buffer = MakeOperand<T>(lhs_buffer.size());
+  std::vector<uint8_t> dst_buffer(lhs_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<T>(lhs_buffer, rhs_buffer,
+                                         absl::MakeSpan(dst_buffer)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK_TEMPLATE(BM_CompareOp, CompareEQ, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_CompareOp, CompareNE, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_CompareOp, CompareLT, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_CompareOp, CompareLE, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_CompareOp, CompareGT, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_CompareOp, CompareGE, float) ELEMENTWISE_SIZES;
+
+void BM_Clamp(benchmark::State& state) {
+  auto src_buffer = MakeOperand<float>(state.range(0));
+  std::vector<float> min_buffer(src_buffer.size(), 2.0f);
+  std::vector<float> max_buffer(src_buffer.size(), 6.0f);
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(Clamp::Execute<float>(min_buffer, src_buffer, max_buffer,
+                                   absl::MakeSpan(dst_buffer)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Clamp) ELEMENTWISE_SIZES;
+
+template <typename SRC, typename DST>
+void BM_Convert(benchmark::State& state) {
+  auto src_buffer = MakeOperand<SRC>(state.range(0));
+  std::vector<DST> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK((Convert::Execute<SRC, DST>(src_buffer,
+                                         absl::MakeSpan(dst_buffer))));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK_TEMPLATE(BM_Convert, int8_t, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_Convert, int32_t, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_Convert, float, int32_t) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_Convert, float, Float16) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_Convert, Float16, float) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_Convert, float, BFloat16) ELEMENTWISE_SIZES;
+BENCHMARK_TEMPLATE(BM_Convert, BFloat16, float) ELEMENTWISE_SIZES;
+
+int32_t FloatBits(float value) {
+  int32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Evaluates the fused tanh(a * 0.5 + b) program in a single pass. Compare with
+// the sum of the individual Mul, Add, and Tanh benchmarks.
+void BM_Elementwise(benchmark::State& state) {
+  using Opcode = Elementwise::Opcode;
+  auto a_buffer = MakeOperand<float>(state.range(0));
+  auto b_buffer = MakeIota<float>(a_buffer.size());
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(Opcode::kConstant), FloatBits(0.5f), 0, 0,  // r2
+      static_cast<int32_t>(Opcode::kMul),      0, 2, 0,                // r3
+      static_cast<int32_t>(Opcode::kAdd),      3, 1, 0,                // r4
+      static_cast<int32_t>(Opcode::kTanh),     4, 0, 0,                // r5
+  };
+  std::vector<absl::Span<const float>> src_buffers = {a_buffer, b_buffer};
+  std::vector<float> dst_buffer(a_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(Elementwise::Execute<float>(src_buffers, program,
+                                         absl::MakeSpan(dst_buffer)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesWritten(state, dst_buffer);
+}
+BENCHMARK(BM_Elementwise) ELEMENTWISE_SIZES;
+
+#undef ELEMENTWISE_SIZES
+
+//===----------------------------------------------------------------------===//
+// Reductions and pooling
+//===----------------------------------------------------------------------===//
+
+// Reduces a [1024, 1024] buffer along the given dimension.
+template <typename KERNEL, typename T>
+void BM_Reduce(benchmark::State& state) {
+  Shape src_shape = {1024, 1024};
+  std::vector<int32_t> dimensions = {static_cast<int32_t>(state.range(0))};
+  Shape dst_shape = {src_shape[1 - dimensions[0]]};
+  auto src_buffer = MakeOperand<T>(GetShapeElementCount(src_shape));
+  std::vector<T> init_buffer = {static_cast<T>(0)};
+  std::vector<T> dst_buffer(GetShapeElementCount(dst_shape));
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<T>(src_buffer, init_buffer,
+                                         absl::MakeSpan(dst_buffer),
+                                         dimensions, src_shape, dst_shape));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesRead(state, src_buffer);
+}
+BENCHMARK_TEMPLATE(BM_Reduce, ReduceSum, float)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Reduce, ReduceSum, int32_t)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Reduce, ReduceMin, float)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Reduce, ReduceMax, float)->Arg(0)->Arg(1);
+
+// Pools an NHWC [1, 112, 112, 64] image with a KxK window and stride 2, padded
+// by one on each side when the window is 3x3 (as in ResNet stems).
+template <typename KERNEL>
+void BM_Pooling(benchmark::State& state) {
+  const int32_t window = state.range(0);
+  const int32_t pad = window / 2;
+  Shape src_shape = {1, 112, 112, 64};
+  Shape window_dimensions = {1, window, window, 1};
+  Shape strides = {1, 2, 2, 1};
+  Shape pad_low = {0, pad, pad, 0};
+  Shape dst_shape = src_shape;
+  for (int i = 1; i <= 2; ++i) {
+    dst_shape[i] = (src_shape[i] + 2 * pad - window) / strides[i] + 1;
+  }
+  auto src_buffer = MakeOperand<float>(GetShapeElementCount(src_shape));
+  std::vector<float> init_buffer = {0.0f};
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<float>(
+        src_buffer, init_buffer, absl::MakeSpan(dst_buffer), src_shape,
+        dst_shape, window_dimensions, strides, pad_low));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesRead(state, src_buffer);
+}
+BENCHMARK_TEMPLATE(BM_Pooling, PoolingSum)->Arg(2)->Arg(3);
+BENCHMARK_TEMPLATE(BM_Pooling, PoolingMin)->Arg(3);
+BENCHMARK_TEMPLATE(BM_Pooling, PoolingMax)->Arg(2)->Arg(3);
+
+//===----------------------------------------------------------------------===//
+// Sorting
+//===----------------------------------------------------------------------===//
+
+// Sorts 64K random keys split into rows of the given length. Short rows use a
+// comparison sort and long rows a radix sort.
+template <typename T>
+void BM_Sort(benchmark::State& state) {
+  const int32_t row_size = state.range(0);
+  Shape src_shape = {(1 << 16) / row_size, row_size};
+  auto src_buffer = MakeRandom<T>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    CHECK_OK(Sort::Execute<T>(src_buffer, absl::MakeSpan(dst_buffer),
+                              src_shape, /*descending=*/false));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesRead(state, src_buffer);
+}
+BENCHMARK_TEMPLATE(BM_Sort, float)->Arg(64)->Arg(4096)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Sort, int32_t)->Arg(64)->Arg(4096)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Sort, int8_t)->Arg(4096);
+
+// Selects the top k of 16 rows of 4096 random keys.
+void BM_TopK(benchmark::State& state) {
+  Shape src_shape = {16, 4096};
+  Shape dst_shape = {16, static_cast<int32_t>(state.range(0))};
+  auto src_buffer = MakeRandom<float>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> dst_buffer(GetShapeElementCount(dst_shape));
+  for (auto _ : state) {
+    CHECK_OK(TopK::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer),
+                                  src_shape, dst_shape, /*descending=*/true));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetBytesRead(state, src_buffer);
+}
+BENCHMARK(BM_TopK)->Arg(1)->Arg(16)->Arg(256);
+
+//===----------------------------------------------------------------------===//
+// MatMul and convolution
+//===----------------------------------------------------------------------===//
+
+// Multiplies square NxN matrices. Note that MatMul takes its rhs and produces
+// its result transposed.
+template <typename T, typename ACC, typename DST>
+void BM_MatMul(benchmark::State& state) {
+  const int32_t size = state.range(0);
+  Shape shape = {size, size};
+  auto lhs_buffer = MakeOperand<T>(GetShapeElementCount(shape));
+  auto rhs_buffer = MakeOperand<T>(GetShapeElementCount(shape));
+  std::vector<DST> dst_buffer(GetShapeElementCount(shape));
+  MatMul::Buffers<T, ACC, DST> buffers;
+  buffers.lhs_shape = shape;
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = shape;
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = shape;
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  for (auto _ : state) {
+    CHECK_OK(MatMul::Execute(mat_mul_state.get(), buffers));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetFlops(state, 2.0 * size * size * size);
+}
+BENCHMARK_TEMPLATE(BM_MatMul, float, float, float)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024);
+BENCHMARK_TEMPLATE(BM_MatMul, int8_t, int32_t, int32_t)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024);
+BENCHMARK_TEMPLATE(BM_MatMul, Float16, float, Float16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_MatMul, BFloat16, float, BFloat16)->Arg(256);
+
+// Convolves a HWC image with a KxK filter and unit strides (same padding).
+// The arguments are {image size, kernel size, input channels, output features,
+// groups}, covering the GEMM (pointwise and im2col) and depthwise paths.
+template <typename T, typename ACC>
+void BM_Conv2D(benchmark::State& state) {
+  const int32_t size = state.range(0);
+  const int32_t kernel = state.range(1);
+  const int32_t channels = state.range(2);
+  const int32_t features = state.range(3);
+  const int32_t groups = state.range(4);
+  const int32_t pad = kernel / 2;
+  Shape input_shape = {size, size, channels};
+  Shape filter_shape = {kernel, kernel, channels, features / groups};
+  Shape dst_shape = {size, size, features};
+  Shape strides = {1, 1};
+  Shape pad_h = {pad, pad};
+  Shape pad_w = {pad, pad};
+  Shape dilation = {1, 1};
+  auto input_buffer = MakeOperand<T>(GetShapeElementCount(input_shape));
+  auto filter_buffer = MakeOperand<T>(GetShapeElementCount(filter_shape));
+  std::vector<ACC> dst_buffer(GetShapeElementCount(dst_shape));
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  for (auto _ : state) {
+    CHECK_OK((Conv2D::Execute<T, ACC>(
+        mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+        filter_shape, absl::MakeSpan(dst_buffer), dst_shape, strides, pad_h,
+        pad_w, dilation, groups)));
+    benchmark::DoNotOptimize(dst_buffer.data());
+  }
+  SetFlops(state, 2.0 * size * size * features * kernel * kernel *
+                      (channels / groups));
+}
+BENCHMARK_TEMPLATE(BM_Conv2D, float, float)
+    ->Args({56, 1, 64, 256, 1})
+    ->Args({56, 3, 64, 64, 1})
+    ->Args({112, 3, 32, 32, 32});
+BENCHMARK_TEMPLATE(BM_Conv2D, int8_t, int32_t)
+    ->Args({56, 1, 64, 256, 1})
+    ->Args({56, 3, 64, 64, 1})
+    ->Args({112, 3, 32, 32, 32});
+
+}  // namespace
+}  // namespace kernels
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
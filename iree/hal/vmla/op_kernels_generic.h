@@ -15,6 +15,14 @@
 #ifndef IREE_HAL_VMLA_OP_KERNELS_GENERIC_H_
 #define IREE_HAL_VMLA_OP_KERNELS_GENERIC_H_
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
@@ -144,24 +152,59 @@ Status Copy::Execute(absl::Span<const uint8_t> src_buffer, ShapeSpan src_shape,
     return OkStatus();
   }
 
-  // TODO(gcmn) Maybe we can fast-path earlier if we detect contiguous memory
-  // across multiple rows.
-  auto src_strides = impl::ComputeCopyStrides(src_shape, element_size);
-  auto dst_strides = impl::ComputeCopyStrides(dst_shape, element_size);
-  DCHECK_EQ(src_strides.size(), lengths.size());
-  DCHECK_EQ(dst_strides.size(), lengths.size());
-  impl::CopyRegion(src_buffer, src_strides, src_indices, dst_buffer,
-                   dst_strides, dst_indices, lengths);
+  // Trailing dimensions that are copied in full in both buffers are
+  // contiguous and are folded into the last partially-copied dimension so that
+  // each memcpy moves as many rows as possible.
+  int rank = lengths.size();
+  int inner_rank = rank;
+  size_t inner_size = 1;
+  while (inner_rank > 1) {
+    int dim = inner_rank - 1;
+    if (lengths[dim] != src_shape[dim] || lengths[dim] != dst_shape[dim]) {
+      break;
+    }
+    inner_size *= lengths[dim];
+    --inner_rank;
+  }
+  absl::InlinedVector<int32_t, 8> collapsed_src_shape(
+      src_shape.begin(), src_shape.begin() + inner_rank);
+  absl::InlinedVector<int32_t, 8> collapsed_dst_shape(
+      dst_shape.begin(), dst_shape.begin() + inner_rank);
+  absl::InlinedVector<int32_t, 8> collapsed_src_indices(
+      src_indices.begin(), src_indices.begin() + inner_rank);
+  absl::InlinedVector<int32_t, 8> collapsed_dst_indices(
+      dst_indices.begin(), dst_indices.begin() + inner_rank);
+  absl::InlinedVector<int32_t, 8> collapsed_lengths(
+      lengths.begin(), lengths.begin() + inner_rank);
+  collapsed_src_shape.back() *= inner_size;
+  collapsed_dst_shape.back() *= inner_size;
+  collapsed_src_indices.back() *= inner_size;
+  collapsed_dst_indices.back() *= inner_size;
+  collapsed_lengths.back() *= inner_size;
+
+  auto src_strides =
+      impl::ComputeCopyStrides(collapsed_src_shape, element_size);
+  auto dst_strides =
+      impl::ComputeCopyStrides(collapsed_dst_shape, element_size);
+  impl::CopyRegion(src_buffer, src_strides, collapsed_src_indices, dst_buffer,
+                   dst_strides, collapsed_dst_indices, collapsed_lengths);
   return OkStatus();
 }
 
-template <typename T>
-Status Conv2D::Execute(absl::Span<const T> input_buffer, ShapeSpan input_shape,
-                       absl::Span<const T> filter_buffer,
-                       ShapeSpan filter_shape, absl::Span<T> dst_buffer,
-                       ShapeSpan dst_shape, ShapeSpan window_strides,
-                       ShapeSpan pad_h, ShapeSpan pad_w, ShapeSpan dilation,
-                       const int32_t groups) {
+namespace impl {
+
+// Number of output pixels gathered per im2col block. Bounds the size of the
+// patch scratch buffer independent of the image size.
+constexpr int kConv2DIm2ColBlockSize = 1024;
+
+// Direct 2d (grouped) convolution slow implementation. ref:
+// https://www.tensorflow.org/versions/r2.0/api_docs/python/tf/nn/convolution)
+template <typename T, typename ACC>
+void Conv2DReference(absl::Span<const T> input_buffer, ShapeSpan input_shape,
+                     absl::Span<const T> filter_buffer, ShapeSpan filter_shape,
+                     absl::Span<ACC> dst_buffer, ShapeSpan dst_shape,
+                     ShapeSpan window_strides, ShapeSpan pad_h, ShapeSpan pad_w,
+                     ShapeSpan dilation, const int32_t groups) {
   const std::array<int32_t, 3> input_strides = {input_shape[1] * input_shape[2],
                                                 input_shape[2], 1};
   const std::array<int32_t, 4> filter_strides = {
@@ -169,9 +212,6 @@ Status Conv2D::Execute(absl::Span<const T> input_buffer, ShapeSpan input_shape,
       filter_shape[2] * filter_shape[3], filter_shape[3], 1};
   const std::array<int32_t, 3> dst_strides = {dst_shape[1] * dst_shape[2],
                                               dst_shape[2], 1};
-  // Direct 2d (grouped) convolution slow implementation. ref:
-  // https://www.tensorflow.org/versions/r2.0/api_docs/python/tf/nn/convolution)
-  // TODO(ataei): Implement tiled GEMM based implementation.
   const int output_group_size = dst_shape[2] / groups;
   const int input_group_size = input_shape[2] / groups;
   for (int ho = 0; ho < dst_shape[0]; ho++) {
@@ -180,7 +220,7 @@ Status Conv2D::Execute(absl::Span<const T> input_buffer, ShapeSpan input_shape,
         for (int co = 0; co < output_group_size; co++) {
           const int cg_o = g * output_group_size + co;
           const int y_i = ho * dst_strides[0] + wo * dst_strides[1] + cg_o;
-          T dst_value = T(0);
+          ACC dst_value = ACC(0);
           for (int ci = 0; ci < input_group_size; ci++) {
             for (int kh = 0; kh < filter_shape[0]; kh++) {
               const int ih = ho * window_strides[0] + kh - pad_h[0];
@@ -196,7 +236,8 @@ Status Conv2D::Execute(absl::Span<const T> input_buffer, ShapeSpan input_shape,
                                 cg_i * filter_strides[2] + co;
                 const int x_i =
                     ih * input_strides[0] + iw * input_strides[1] + cg_i;
-                dst_value += input_buffer[x_i] * filter_buffer[w_i];
+                dst_value += static_cast<ACC>(input_buffer[x_i]) *
+                             static_cast<ACC>(filter_buffer[w_i]);
               }
             }
           }
@@ -205,6 +246,194 @@ Status Conv2D::Execute(absl::Span<const T> input_buffer, ShapeSpan input_shape,
       }
     }
   }
+}
+
+// Depthwise convolution where each input channel produces dst_shape[2] /
+// groups output channels. The bounds checks are hoisted out of the channel
+// loops, which run over contiguous memory.
+template <typename T, typename ACC>
+void Conv2DDepthwise(absl::Span<const T> input_buffer, ShapeSpan input_shape,
+                     absl::Span<const T> filter_buffer, ShapeSpan filter_shape,
+                     absl::Span<ACC> dst_buffer, ShapeSpan dst_shape,
+                     ShapeSpan window_strides, ShapeSpan pad_h, ShapeSpan pad_w,
+                     const int32_t groups) {
+  const int channels = input_shape[2];
+  const int multiplier = dst_shape[2] / groups;
+  const int filter_h_stride =
+      filter_shape[1] * filter_shape[2] * filter_shape[3];
+  const int filter_w_stride = filter_shape[2] * filter_shape[3];
+  const int filter_c_stride = filter_shape[3];
+  std::fill(dst_buffer.begin(), dst_buffer.end(), ACC(0));
+  for (int ho = 0; ho < dst_shape[0]; ++ho) {
+    for (int wo = 0; wo < dst_shape[1]; ++wo) {
+      ACC* dst = dst_buffer.data() + (ho * dst_shape[1] + wo) * dst_shape[2];
+      for (int kh = 0; kh < filter_shape[0]; ++kh) {
+        const int ih = ho * window_strides[0] + kh - pad_h[0];
+        if (ih < 0 || ih >= input_shape[0]) continue;
+        for (int kw = 0; kw < filter_shape[1]; ++kw) {
+          const int iw = wo * window_strides[1] + kw - pad_w[0];
+          if (iw < 0 || iw >= input_shape[1]) continue;
+          const T* input =
+              input_buffer.data() + (ih * input_shape[1] + iw) * channels;
+          const T* filter = filter_buffer.data() + kh * filter_h_stride +
+                            kw * filter_w_stride;
+          for (int c = 0; c < channels; ++c) {
+            const ACC value = static_cast<ACC>(input[c]);
+            const T* filter_c = filter + c * filter_c_stride;
+            ACC* dst_c = dst + c * multiplier;
+            for (int m = 0; m < multiplier; ++m) {
+              dst_c[m] += value * static_cast<ACC>(filter_c[m]);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Computes dst[P, F] = patches[P, K] * filter[K, F] with MatMul, which takes
+// its rhs and produces its result transposed. |filter_t| is the (F, K)
+// transposed filter.
+template <typename T, typename ACC>
+Status Conv2DGemm(MatMul::RuntimeState* mat_mul_state,
+                  absl::Span<const T> patches, absl::Span<const T> filter_t,
+                  absl::Span<ACC> dst, int32_t pixels, int32_t patch_size,
+                  int32_t filters) {
+  const std::array<int32_t, 2> lhs_shape = {filters, patch_size};
+  const std::array<int32_t, 2> rhs_shape = {pixels, patch_size};
+  const std::array<int32_t, 2> dst_shape = {pixels, filters};
+  MatMul::Buffers<T, ACC, ACC> buffers;
+  buffers.lhs_shape = lhs_shape;
+  buffers.lhs_buffer = filter_t;
+  buffers.rhs_shape = rhs_shape;
+  buffers.rhs_buffer = patches;
+  buffers.dst_shape = dst_shape;
+  buffers.dst_buffer = dst;
+  return MatMul::Execute(mat_mul_state, buffers);
+}
+
+// Convolution as GEMMs of the output pixels and the transposed filter
+// |filter_t|. 1x1 convolutions with unit strides and no padding use the input
+// directly and others gather the input patches of blocks of output pixels first
+// (im2col).
+template <typename T, typename ACC>
+Status Conv2DIm2Col(MatMul::RuntimeState* mat_mul_state,
+                    absl::Span<const T> input_buffer, ShapeSpan input_shape,
+                    absl::Span<const T> filter_t, ShapeSpan filter_shape,
+                    absl::Span<ACC> dst_buffer, ShapeSpan dst_shape,
+                    ShapeSpan window_strides, ShapeSpan pad_h,
+                    ShapeSpan pad_w) {
+  const int32_t kernel_h = filter_shape[0];
+  const int32_t kernel_w = filter_shape[1];
+  const int32_t channels = input_shape[2];
+  const int32_t filters = dst_shape[2];
+  const int32_t patch_size = kernel_h * kernel_w * channels;
+  const int32_t pixels = dst_shape[0] * dst_shape[1];
+
+  if (kernel_h == 1 && kernel_w == 1 && window_strides[0] == 1 &&
+      window_strides[1] == 1 && pad_h[0] == 0 && pad_w[0] == 0 &&
+      input_shape[0] == dst_shape[0] && input_shape[1] == dst_shape[1]) {
+    return Conv2DGemm(mat_mul_state, input_buffer, filter_t, dst_buffer,
+                      pixels, patch_size, filters);
+  }
+
+  std::vector<T> patches(std::min(pixels, kConv2DIm2ColBlockSize) *
+                         patch_size);
+  for (int block_begin = 0; block_begin < pixels;
+       block_begin += kConv2DIm2ColBlockSize) {
+    const int block_size =
+        std::min(kConv2DIm2ColBlockSize, pixels - block_begin);
+    for (int row = 0; row < block_size; ++row) {
+      const int ho = (block_begin + row) / dst_shape[1];
+      const int wo = (block_begin + row) % dst_shape[1];
+      T* patch = patches.data() + row * patch_size;
+      for (int kh = 0; kh < kernel_h; ++kh) {
+        const int ih = ho * window_strides[0] + kh - pad_h[0];
+        for (int kw = 0; kw < kernel_w; ++kw, patch += channels) {
+          const int iw = wo * window_strides[1] + kw - pad_w[0];
+          if (ih < 0 || ih >= input_shape[0] || iw < 0 ||
+              iw >= input_shape[1]) {
+            std::fill_n(patch, channels, T(0));
+            continue;
+          }
+          const T* input =
+              input_buffer.data() + (ih * input_shape[1] + iw) * channels;
+          std::memcpy(patch, input, channels * sizeof(T));
+        }
+      }
+    }
+    RETURN_IF_ERROR(Conv2DGemm(
+        mat_mul_state,
+        absl::MakeConstSpan(patches.data(), block_size * patch_size),
+        filter_t,
+        dst_buffer.subspan(block_begin * filters, block_size * filters),
+        block_size, patch_size, filters));
+  }
+  return OkStatus();
+}
+
+}  // namespace impl
+
+inline bool Conv2D::UsesTransposedFilter(ShapeSpan input_shape,
+                                         ShapeSpan filter_shape,
+                                         ShapeSpan dst_shape,
+                                         ShapeSpan dilation,
+                                         const int32_t groups) {
+  // The im2col and depthwise paths do not handle dilation; dilated
+  // convolutions always use the reference kernel.
+  return dilation[0] == 1 && dilation[1] == 1 && groups == 1 &&
+         filter_shape[2] == input_shape[2] && filter_shape[3] == dst_shape[2];
+}
+
+template <typename T>
+void Conv2D::TransposeFilter(absl::Span<const T> filter_buffer,
+                             ShapeSpan filter_shape, absl::Span<T> filter_t) {
+  const int32_t patch_size =
+      filter_shape[0] * filter_shape[1] * filter_shape[2];
+  const int32_t filters = filter_shape[3];
+  for (int k = 0; k < patch_size; ++k) {
+    for (int f = 0; f < filters; ++f) {
+      filter_t[f * patch_size + k] = filter_buffer[k * filters + f];
+    }
+  }
+}
+
+template <typename T, typename ACC>
+Status Conv2D::Execute(MatMul::RuntimeState* mat_mul_state,
+                       absl::Span<const T> input_buffer, ShapeSpan input_shape,
+                       absl::Span<const T> filter_buffer,
+                       ShapeSpan filter_shape, absl::Span<ACC> dst_buffer,
+                       ShapeSpan dst_shape, ShapeSpan window_strides,
+                       ShapeSpan pad_h, ShapeSpan pad_w, ShapeSpan dilation,
+                       const int32_t groups, absl::Span<const T> filter_t) {
+  if (UsesTransposedFilter(input_shape, filter_shape, dst_shape, dilation,
+                           groups)) {
+    std::vector<T> local_filter_t;
+    if (filter_t.empty()) {
+      local_filter_t.resize(filter_buffer.size());
+      TransposeFilter(filter_buffer, filter_shape,
+                      absl::MakeSpan(local_filter_t));
+      filter_t = local_filter_t;
+    }
+    return impl::Conv2DIm2Col(mat_mul_state, input_buffer, input_shape,
+                              filter_t, filter_shape, dst_buffer, dst_shape,
+                              window_strides, pad_h, pad_w);
+  }
+  if (dilation[0] != 1 || dilation[1] != 1) {
+    impl::Conv2DReference(input_buffer, input_shape, filter_buffer,
+                          filter_shape, dst_buffer, dst_shape, window_strides,
+                          pad_h, pad_w, dilation, groups);
+    return OkStatus();
+  }
+  if (groups == input_shape[2]) {
+    impl::Conv2DDepthwise(input_buffer, input_shape, filter_buffer,
+                          filter_shape, dst_buffer, dst_shape, window_strides,
+                          pad_h, pad_w, groups);
+    return OkStatus();
+  }
+  impl::Conv2DReference(input_buffer, input_shape, filter_buffer, filter_shape,
+                        dst_buffer, dst_shape, window_strides, pad_h, pad_w,
+                        dilation, groups);
   return OkStatus();
 }
 
@@ -219,31 +448,141 @@ Status Select::Execute(absl::Span<const uint8_t> cond_buffer,
   return OkStatus();
 }
 
+namespace impl {
+
+// Drops unit dimensions and merges runs of dimensions that stay adjacent and
+// in order under |perm|. The transpose of |shape| by |perm| is the same as that
+// of |src_shape| by |src_perm|.
+inline void CollapseTransposeDims(ShapeSpan src_shape,
+                                  absl::Span<const int32_t> src_perm,
+                                  absl::InlinedVector<int32_t, 8>* shape,
+                                  absl::InlinedVector<int32_t, 8>* perm) {
+  const int rank = src_shape.size();
+  absl::InlinedVector<int32_t, 8> kept_dims(rank, -1);
+  absl::InlinedVector<int32_t, 8> kept_shape;
+  for (int i = 0; i < rank; ++i) {
+    if (src_shape[i] == 1) continue;
+    kept_dims[i] = kept_shape.size();
+    kept_shape.push_back(src_shape[i]);
+  }
+
+  // Runs of source dimensions in destination order.
+  absl::InlinedVector<int32_t, 8> run_begin;
+  absl::InlinedVector<int32_t, 8> run_size;
+  int last_dim = -1;
+  for (int i = 0; i < rank; ++i) {
+    const int dim = kept_dims[src_perm[i]];
+    if (dim == -1) continue;
+    if (last_dim != -1 && dim == last_dim + 1) {
+      run_size.back() *= kept_shape[dim];
+    } else {
+      run_begin.push_back(dim);
+      run_size.push_back(kept_shape[dim]);
+    }
+    last_dim = dim;
+  }
+
+  const int run_count = run_begin.size();
+  shape->resize(run_count);
+  perm->resize(run_count);
+  for (int i = 0; i < run_count; ++i) {
+    int src_dim = 0;
+    for (int j = 0; j < run_count; ++j) {
+      if (run_begin[j] < run_begin[i]) ++src_dim;
+    }
+    (*shape)[src_dim] = run_size[i];
+    (*perm)[i] = src_dim;
+  }
+}
+
+// Transposes the row-major |rows|x|cols| matrix |src| into |dst| in tiles of
+// one cache line of elements per row so both sides stay cache resident.
+template <typename T>
+void Transpose2D(const T* src, T* dst, int rows, int cols) {
+  constexpr int kTileSize = 64 / sizeof(T) < 8 ? 8 : 64 / sizeof(T);
+  for (int row_begin = 0; row_begin < rows; row_begin += kTileSize) {
+    const int row_end = std::min(row_begin + kTileSize, rows);
+    for (int col_begin = 0; col_begin < cols; col_begin += kTileSize) {
+      const int col_end = std::min(col_begin + kTileSize, cols);
+      for (int col = col_begin; col < col_end; ++col) {
+        for (int row = row_begin; row < row_end; ++row) {
+          dst[col * rows + row] = src[row * cols + col];
+        }
+      }
+    }
+  }
+}
+
+// Walks the destination in order while incrementally tracking the source
+// offset, copying whole rows when the innermost dimension is preserved.
+template <typename T>
+void TransposeStrided(const T* src, T* dst, size_t dst_size, ShapeSpan shape,
+                      absl::Span<const int32_t> perm) {
+  const int rank = shape.size();
+  absl::InlinedVector<size_t, 8> src_strides(rank);
+  size_t src_stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    src_strides[i] = src_stride;
+    src_stride *= shape[i];
+  }
+  absl::InlinedVector<int32_t, 8> dst_shape(rank);
+  absl::InlinedVector<size_t, 8> dst_src_strides(rank);
+  for (int i = 0; i < rank; ++i) {
+    dst_shape[i] = shape[perm[i]];
+    dst_src_strides[i] = src_strides[perm[i]];
+  }
+
+  const size_t inner_size = dst_shape[rank - 1];
+  const size_t inner_stride = dst_src_strides[rank - 1];
+  absl::InlinedVector<int32_t, 8> indices(rank, 0);
+  size_t src_offset = 0;
+  for (size_t dst_offset = 0; dst_offset < dst_size;
+       dst_offset += inner_size) {
+    if (inner_stride == 1) {
+      std::memcpy(dst + dst_offset, src + src_offset, inner_size * sizeof(T));
+    } else {
+      for (size_t i = 0; i < inner_size; ++i) {
+        dst[dst_offset + i] = src[src_offset + i * inner_stride];
+      }
+    }
+    for (int i = rank - 2; i >= 0; --i) {
+      src_offset += dst_src_strides[i];
+      if (++indices[i] < dst_shape[i]) break;
+      src_offset -= dst_src_strides[i] * dst_shape[i];
+      indices[i] = 0;
+    }
+  }
+}
+
+}  // namespace impl
+
 template <typename T>
 Status Transpose::Execute(absl::Span<const T> src_buffer,
                           absl::Span<T> dst_buffer, ShapeSpan src_shape,
                           absl::Span<const int32_t> perm) {
-  // This implementation is .... not fast.
-  int rank = src_shape.size();
-  absl::InlinedVector<int, 8> src_strides(rank);
-  absl::InlinedVector<int, 8> dst_strides(rank);
-  size_t src_stride = 1;
-  size_t dst_stride = 1;
-  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
-    src_strides[dim_i] = src_stride;
-    dst_strides[dim_i] = dst_stride;
-    src_stride *= src_shape[dim_i];
-    dst_stride *= src_shape[perm[dim_i]];
-  }
-  for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
-    size_t src_i = 0;
-    size_t t = dst_i;
-    for (int dim_i = 0; dim_i < rank; ++dim_i) {
-      size_t ratio = t / dst_strides[dim_i];
-      t -= ratio * dst_strides[dim_i];
-      src_i += ratio * src_strides[perm[dim_i]];
+  if (dst_buffer.empty()) return OkStatus();
+  absl::InlinedVector<int32_t, 8> shape;
+  absl::InlinedVector<int32_t, 8> collapsed_perm;
+  impl::CollapseTransposeDims(src_shape, perm, &shape, &collapsed_perm);
+
+  const T* src = src_buffer.data();
+  T* dst = dst_buffer.data();
+  const int rank = shape.size();
+  if (rank <= 1) {
+    // Identity after collapsing.
+    std::memcpy(dst, src, dst_buffer.size() * sizeof(T));
+  } else if (rank == 2) {
+    // [A, B] -> [B, A]
+    impl::Transpose2D(src, dst, shape[0], shape[1]);
+  } else if (rank == 3 && collapsed_perm[0] == 0) {
+    // [N, A, B] -> [N, B, A], e.g. NHWC <-> NCHW.
+    const size_t batch_stride = shape[1] * shape[2];
+    for (int i = 0; i < shape[0]; ++i) {
+      impl::Transpose2D(src + i * batch_stride, dst + i * batch_stride,
+                        shape[1], shape[2]);
     }
-    dst_buffer[dst_i] = src_buffer[src_i];
+  } else {
+    impl::TransposeStrided(src, dst, dst_buffer.size(), shape, collapsed_perm);
   }
   return OkStatus();
 }
@@ -256,20 +595,26 @@ inline void IncrementShapeIndex(absl::Span<int32_t> indices, ShapeSpan shape) {
   }
 }
 
-inline bool IsPadding(absl::Span<const int32_t> indices, ShapeSpan shape,
-                      absl::Span<const int32_t> edge_padding_low,
-                      absl::Span<const int32_t> edge_padding_high,
-                      absl::Span<const int32_t> interior_padding) {
-  for (int i = 0; i < indices.size(); ++i) {
-    auto index = indices[i];
-    if (index < edge_padding_low[i] ||
-        index >= shape[i] - edge_padding_high[i] ||
-        (index - edge_padding_low[i]) % (interior_padding[i] + 1) != 0) {
-      return true;
-    }
+// Repeats the first |filled_length| elements of |data| until |total_length|
+// elements are populated. The copied region doubles each time so that the
+// copies stay large.
+template <typename T>
+inline void ReplicatePrefix(T* data, size_t filled_length,
+                            size_t total_length) {
+  while (filled_length < total_length) {
+    size_t length = std::min(filled_length, total_length - filled_length);
+    std::memcpy(data + filled_length, data, length * sizeof(T));
+    filled_length += length;
   }
+}
 
-  return false;
+// Returns the element strides of a row-major |shape|.
+inline absl::InlinedVector<size_t, 8> ComputeElementStrides(ShapeSpan shape) {
+  absl::InlinedVector<size_t, 8> strides(shape.size(), 1);
+  for (int i = static_cast<int>(shape.size()) - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * shape[i + 1];
+  }
+  return strides;
 }
 }  // namespace impl
 
@@ -281,37 +626,65 @@ Status Pad::Execute(absl::Span<const T> src_buffer,
                     absl::Span<const int32_t> edge_padding_low,
                     absl::Span<const int32_t> edge_padding_high,
                     absl::Span<const int32_t> interior_padding) {
-  // This implementation is not at all fast, as it iterates every index in the
-  // destination buffer individually. Potential improvements:
-  // 1. Fill the dst buffer with padded value initially. Only need to iterate
-  //    through source buffer and can exit early.
-  // 2. Use striding to advance through larger swaths of the buffer with a
-  //    memcpy from src and filling (or skipping) padded incides. Especially
-  //    useful when e.g. entire rows are padded.
-
-  // TODO(b/140836672) support negative padding
-
   if (padding_value_buffer.size() != 1) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Padding value buffer is larger than one element.";
   }
   auto padding_value = padding_value_buffer.front();
 
-  absl::InlinedVector<int, 8> dst_indices(src_shape.size(), 0);
-
-  const T* src_ptr = src_buffer.begin();
-  T* dst_ptr = dst_buffer.begin();
-  while (dst_ptr != dst_buffer.end()) {
-    if (impl::IsPadding(dst_indices, dst_shape, edge_padding_low,
-                        edge_padding_high, interior_padding)) {
-      *dst_ptr++ = padding_value;
+  // The destination is filled with the padding value and then each source row
+  // is copied into place, with the interior padding of the innermost dimension
+  // applied as a stride. Source elements that fall outside of the destination
+  // due to negative edge padding are dropped.
+  std::fill(dst_buffer.begin(), dst_buffer.end(), padding_value);
+  const int rank = src_shape.size();
+  if (rank == 0) {
+    dst_buffer[0] = src_buffer[0];
+    return OkStatus();
+  }
+  if (GetElementCount(src_shape) == 0) return OkStatus();
+
+  const int inner = rank - 1;
+  const int row_size = src_shape[inner];
+  const int row_low = edge_padding_low[inner];
+  const int row_step = interior_padding[inner] + 1;
+  const int row_begin = row_low < 0 ? (row_step - row_low - 1) / row_step : 0;
+  const int row_end =
+      dst_shape[inner] > row_low
+          ? std::min(row_size,
+                     (dst_shape[inner] - row_low + row_step - 1) / row_step)
+          : 0;
+  if (row_begin >= row_end) return OkStatus();
+
+  auto dst_strides = impl::ComputeElementStrides(dst_shape);
+  auto outer_shape = src_shape.subspan(0, inner);
+  absl::InlinedVector<int32_t, 8> src_indices(inner, 0);
+  const T* src_row = src_buffer.data();
+  for (size_t i = 0, e = GetElementCount(outer_shape); i < e;
+       ++i, src_row += row_size) {
+    bool in_bounds = true;
+    size_t dst_offset = 0;
+    for (int j = 0; j < inner; ++j) {
+      int index =
+          edge_padding_low[j] + src_indices[j] * (interior_padding[j] + 1);
+      if (index < 0 || index >= dst_shape[j]) {
+        in_bounds = false;
+        break;
+      }
+      dst_offset += index * dst_strides[j];
+    }
+    impl::IncrementShapeIndex(absl::MakeSpan(src_indices), outer_shape);
+    if (!in_bounds) continue;
+    T* dst_row = dst_buffer.data() + dst_offset;
+    if (row_step == 1) {
+      std::memcpy(dst_row + row_low + row_begin, src_row + row_begin,
+                  (row_end - row_begin) * sizeof(T));
     } else {
-      DCHECK(src_ptr != src_buffer.end());
-      *dst_ptr++ = *src_ptr++;
+      for (int k = row_begin; k < row_end; ++k) {
+        dst_row[row_low + k * row_step] = src_row[k];
+      }
     }
-    impl::IncrementShapeIndex(absl::MakeSpan(dst_indices), dst_shape);
   }
-
   return OkStatus();
 }
 
@@ -336,9 +709,9 @@ Status Gather::Execute(absl::Span<const T> src_buffer,
   for (size_t i = 0; i < dim; ++i) {
     outer_size *= src_shape[i];
   }
-  // stride for batch outer dims.
+  // Number of outer slices sharing the indices of each batch.
   size_t batch_stride = 1;
-  for (size_t i = batch_dims; i > 0; --i) {
+  for (size_t i = batch_dims; i < dim; ++i) {
     batch_stride *= src_shape[i];
   }
   const size_t input_stride =
@@ -356,17 +729,27 @@ Status Gather::Execute(absl::Span<const T> src_buffer,
   // src[d_0,...,d_{dim-1},indices[d_0,...,d_1, i_B,...,i_{M-1}, d_{dim+1},...,d_{N-1}]
   // clang-format on
   // see:https://www.tensorflow.org/api_docs/python/tf/gather
-  // TODO(ataei): Shrink inner loop by scanning indices_buffer for
-  // contiguous indices and collide the copy of these slices.
   for (size_t i = 0; i < outer_size; ++i) {
     const int batch_offset =
-        batch_dims == 0 ? 0 : (i / batch_stride) * indices_strides[batch_dims];
-    for (size_t j = 0; j < indices_size; ++j) {
+        batch_dims == 0
+            ? 0
+            : (i / batch_stride) * indices_strides[batch_dims - 1];
+    const int32_t* indices = indices_buffer.data() + batch_offset;
+    for (size_t j = 0; j < indices_size;) {
+      // Runs of consecutive indices select contiguous slices and are copied
+      // together.
+      size_t run_length = 1;
+      while (j + run_length < indices_size &&
+             indices[j + run_length] ==
+                 indices[j] + static_cast<int32_t>(run_length)) {
+        ++run_length;
+      }
       const size_t dst_offset = i * output_stride + j * slize_size;
-      const size_t src_offset =
-          i * input_stride + indices_buffer[batch_offset + j] * slize_size;
+      const size_t src_offset = i * input_stride + indices[j] * slize_size;
       std::memcpy(dst_buffer.data() + dst_offset,
-                  src_buffer.data() + src_offset, sizeof(T) * slize_size);
+                  src_buffer.data() + src_offset,
+                  sizeof(T) * slize_size * run_length);
+      j += run_length;
     }
   }
   return OkStatus();
@@ -403,35 +786,55 @@ Status Reverse::Execute(absl::Span<const T> src_buffer,
 template <typename T>
 Status Broadcast::Execute(absl::Span<const T> src_buffer,
                           absl::Span<T> dst_buffer) {
-  for (size_t i = 0; i < dst_buffer.size(); ++i) {
-    dst_buffer[i] = src_buffer[0];
-  }
+  std::fill(dst_buffer.begin(), dst_buffer.end(), src_buffer[0]);
   return OkStatus();
 }
 
 template <typename T>
 Status Tile::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer,
                      ShapeSpan src_shape, ShapeSpan dst_shape) {
-  // This implementation is .... not fast.
-  int rank = dst_shape.size();
-  absl::InlinedVector<int, 8> src_strides(rank);
-  absl::InlinedVector<int, 8> dst_strides(rank);
-  size_t src_stride = 1;
-  size_t dst_stride = 1;
-  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
-    src_strides[dim_i] = src_stride;
-    dst_strides[dim_i] = dst_stride;
-    src_stride *= src_shape[dim_i];
-    dst_stride *= dst_shape[dim_i];
+  // Each source row is copied into place and repeated along the innermost
+  // dimension. The populated blocks are then repeated along each outer
+  // dimension in turn, so every copy is a large memcpy.
+  const int rank = dst_shape.size();
+  if (dst_buffer.empty()) return OkStatus();
+  if (rank == 0) {
+    dst_buffer[0] = src_buffer[0];
+    return OkStatus();
   }
-  for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
-    size_t src_i = 0;
-    size_t t = dst_i;
-    for (int dim_i = 0; dim_i < rank; ++dim_i) {
-      src_i += t / dst_strides[dim_i] % src_shape[dim_i] * src_strides[dim_i];
-      t %= dst_strides[dim_i];
+  if (GetElementCount(src_shape) == 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Cannot tile an empty source buffer";
+  }
+
+  auto dst_strides = impl::ComputeElementStrides(dst_shape);
+  const int inner = rank - 1;
+  const size_t row_size = src_shape[inner];
+  absl::InlinedVector<int32_t, 8> indices(inner, 0);
+  const T* src_row = src_buffer.data();
+  for (size_t i = 0, e = GetElementCount(src_shape.subspan(0, inner)); i < e;
+       ++i, src_row += row_size) {
+    size_t dst_offset = 0;
+    for (int j = 0; j < inner; ++j) dst_offset += indices[j] * dst_strides[j];
+    T* dst_row = dst_buffer.data() + dst_offset;
+    std::memcpy(dst_row, src_row, row_size * sizeof(T));
+    impl::ReplicatePrefix(dst_row, row_size, dst_shape[inner]);
+    impl::IncrementShapeIndex(absl::MakeSpan(indices),
+                              src_shape.subspan(0, inner));
+  }
+  for (int dim = inner - 1; dim >= 0; --dim) {
+    auto outer_shape = src_shape.subspan(0, dim);
+    absl::InlinedVector<int32_t, 8> outer_indices(dim, 0);
+    for (size_t i = 0, e = GetElementCount(outer_shape); i < e; ++i) {
+      size_t dst_offset = 0;
+      for (int j = 0; j < dim; ++j) {
+        dst_offset += outer_indices[j] * dst_strides[j];
+      }
+      impl::ReplicatePrefix(dst_buffer.data() + dst_offset,
+                            src_shape[dim] * dst_strides[dim],
+                            dst_shape[dim] * dst_strides[dim]);
+      impl::IncrementShapeIndex(absl::MakeSpan(outer_indices), outer_shape);
     }
-    dst_buffer[dst_i] = src_buffer[src_i];
   }
   return OkStatus();
 }
@@ -689,6 +1092,152 @@ Status Convert::Execute(absl::Span<const SRC> src_buffer,
 
 namespace impl {
 
+// Number of elements evaluated per instruction before moving on to the next
+// one. Intermediate registers of a tile stay resident in L1.
+constexpr size_t kElementwiseTileSize = 256;
+
+// Evaluates a single elementwise instruction over |size| elements.
+template <typename T>
+inline void EvaluateElementwiseInstruction(Elementwise::Opcode opcode,
+                                           const T* a, const T* b, const T* c,
+                                           T* dst, size_t size) {
+  using Opcode = Elementwise::Opcode;
+  switch (opcode) {
+    case Opcode::kConstant:
+      break;
+    case Opcode::kAdd:
+      for (size_t i = 0; i < size; ++i) dst[i] = a[i] + b[i];
+      break;
+    case Opcode::kSub:
+      for (size_t i = 0; i < size; ++i) dst[i] = a[i] - b[i];
+      break;
+    case Opcode::kMul:
+      for (size_t i = 0; i < size; ++i) dst[i] = a[i] * b[i];
+      break;
+    case Opcode::kDiv:
+      for (size_t i = 0; i < size; ++i) dst[i] = a[i] / b[i];
+      break;
+    case Opcode::kMin:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::min(a[i], b[i]);
+      break;
+    case Opcode::kMax:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::max(a[i], b[i]);
+      break;
+    case Opcode::kPow:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::pow(a[i], b[i]);
+      break;
+    case Opcode::kNeg:
+      for (size_t i = 0; i < size; ++i) dst[i] = -a[i];
+      break;
+    case Opcode::kAbs:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::abs(a[i]);
+      break;
+    case Opcode::kExp:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::exp(a[i]);
+      break;
+    case Opcode::kLog:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::log(a[i]);
+      break;
+    case Opcode::kSqrt:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::sqrt(a[i]);
+      break;
+    case Opcode::kRsqrt:
+      for (size_t i = 0; i < size; ++i) dst[i] = 1.0 / std::sqrt(a[i]);
+      break;
+    case Opcode::kTanh:
+      for (size_t i = 0; i < size; ++i) dst[i] = std::tanh(a[i]);
+      break;
+    case Opcode::kClamp:
+      // clamp(min, src, max)
+      for (size_t i = 0; i < size; ++i) {
+        dst[i] = b[i] <= a[i] ? a[i] : b[i] >= c[i] ? c[i] : b[i];
+      }
+      break;
+  }
+}
+
+}  // namespace impl
+
+template <typename T>
+Status Elementwise::Execute(absl::Span<const absl::Span<const T>> src_buffers,
+                            absl::Span<const int32_t> program,
+                            absl::Span<T> dst_buffer) {
+  const size_t src_count = src_buffers.size();
+  const size_t instruction_count = program.size() / kInstructionWords;
+  if (instruction_count == 0 || program.size() % kInstructionWords != 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Malformed elementwise program of " << program.size()
+           << " words";
+  }
+  for (const auto& src_buffer : src_buffers) {
+    if (src_buffer.size() != dst_buffer.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Elementwise source has " << src_buffer.size()
+             << " elements but the destination has " << dst_buffer.size();
+    }
+  }
+  for (size_t i = 0; i < instruction_count; ++i) {
+    const int32_t* instruction = &program[i * kInstructionWords];
+    if (instruction[0] < static_cast<int32_t>(Opcode::kConstant) ||
+        instruction[0] > static_cast<int32_t>(Opcode::kClamp)) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Unknown elementwise opcode " << instruction[0];
+    }
+    if (static_cast<Opcode>(instruction[0]) == Opcode::kConstant) continue;
+    for (int j = 1; j < kInstructionWords; ++j) {
+      if (instruction[j] < 0 ||
+          static_cast<size_t>(instruction[j]) >= src_count + i) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Elementwise instruction " << i << " reads register "
+               << instruction[j] << " before it is defined";
+      }
+    }
+  }
+
+  // Registers point at the current tile of each source and of each
+  // instruction result. Intermediate results live in |scratch|; the last
+  // instruction writes directly to the destination. Constants are splatted
+  // into their scratch tile once up front.
+  std::vector<T> scratch(instruction_count * impl::kElementwiseTileSize);
+  absl::InlinedVector<const T*, 16> registers(src_count + instruction_count);
+  for (size_t i = 0; i < instruction_count; ++i) {
+    const int32_t* instruction = &program[i * kInstructionWords];
+    if (static_cast<Opcode>(instruction[0]) != Opcode::kConstant) continue;
+    float value;
+    std::memcpy(&value, &instruction[1], sizeof(value));
+    std::fill_n(&scratch[i * impl::kElementwiseTileSize],
+                impl::kElementwiseTileSize, static_cast<T>(value));
+  }
+
+  for (size_t tile_begin = 0; tile_begin < dst_buffer.size();
+       tile_begin += impl::kElementwiseTileSize) {
+    const size_t tile_size =
+        std::min(impl::kElementwiseTileSize, dst_buffer.size() - tile_begin);
+    for (size_t i = 0; i < src_count; ++i) {
+      registers[i] = src_buffers[i].data() + tile_begin;
+    }
+    for (size_t i = 0; i < instruction_count; ++i) {
+      const int32_t* instruction = &program[i * kInstructionWords];
+      auto opcode = static_cast<Opcode>(instruction[0]);
+      T* result = &scratch[i * impl::kElementwiseTileSize];
+      if (i + 1 == instruction_count) {
+        // Only constants need copying; everything else writes in place.
+        T* dst = dst_buffer.data() + tile_begin;
+        if (opcode == Opcode::kConstant) std::copy_n(result, tile_size, dst);
+        result = dst;
+      }
+      registers[src_count + i] = result;
+      if (opcode == Opcode::kConstant) continue;
+      impl::EvaluateElementwiseInstruction(
+          opcode, registers[instruction[1]], registers[instruction[2]],
+          registers[instruction[3]], result, tile_size);
+    }
+  }
+  return OkStatus();
+}
+
+namespace impl {
+
 struct SumKernel {
   template <typename T>
   inline void operator()(T* value0, const T value1) {
@@ -710,97 +1259,120 @@ struct MaxKernel {
   }
 };
 
+// Number of independent accumulators used when reducing contiguous rows.
+// Splitting the dependency chain lets the compiler vectorize the inner loop
+// and keeps multiple reductions in flight.
+constexpr size_t kReduceRowLanes = 8;
+
+// Reduces the |size| contiguous elements of |src| into |*dst|.
 template <typename T, typename KernelImpl>
-inline void ReduceDimension(absl::Span<const T> src_buffer,
-                            absl::Span<T> dst_buffer, ShapeSpan src_shape,
-                            absl::Span<const int32_t> reduce_dims,
-                            absl::Span<const int> dst_strides, int dim,
-                            absl::Span<int> src_indices, size_t flat_src_i,
-                            size_t src_stride) {
-  if (dim < 0) {
-    // Base case of the recursion - figure out which elements should be acted
-    // upon and apply the reduction kernel to them.
-
-    // Derive destination indices from source indices.
-    // For example,
-    //     reduce_dims: [1, 2]
-    //     src_indices: [2, 1, 3, 0]
-    //                      ^  ^
-    //                      |  |
-    //                      |----- remove these dimensions
-    //     dst_indices: [2, 0]
-    //
-    // TODO(scotttodd): Clean this up somehow, share across recursion levels?
-    size_t dst_size = src_shape.size() - reduce_dims.size();
-    absl::InlinedVector<int, 8> dst_indices;
-    for (size_t i = 0; i < src_indices.size(); ++i) {
-      if (std::find(std::begin(reduce_dims), std::end(reduce_dims), i) ==
-          std::end(reduce_dims)) {
-        dst_indices.push_back(src_indices[i]);
+inline void ReduceRow(const T* src, size_t size, T* dst) {
+  size_t i = 0;
+  if (size >= kReduceRowLanes) {
+    T lanes[kReduceRowLanes];
+    std::copy_n(src, kReduceRowLanes, lanes);
+    for (i = kReduceRowLanes; i + kReduceRowLanes <= size;
+         i += kReduceRowLanes) {
+      for (size_t j = 0; j < kReduceRowLanes; ++j) {
+        KernelImpl()(&lanes[j], src[i + j]);
       }
     }
-    // Compute the flattened index into dst_buffer at [dst_indices].
-    size_t dst_i = 0;
-    for (size_t i = 0; i < dst_indices.size(); ++i) {
-      dst_i += dst_indices[i] * dst_strides[dst_size - 1 - i];
+    for (size_t j = 0; j < kReduceRowLanes; ++j) {
+      KernelImpl()(dst, lanes[j]);
     }
+  }
+  for (; i < size; ++i) {
+    KernelImpl()(dst, src[i]);
+  }
+}
 
-    // Flattened src and dst indices have been computed, invoke the kernel.
-    KernelImpl()(&dst_buffer[dst_i], src_buffer[flat_src_i]);
-    return;
+// Reduces the |size| contiguous elements of |src| elementwise into |dst|.
+template <typename T, typename KernelImpl>
+inline void ReduceElementwise(const T* src, size_t size, T* dst) {
+  for (size_t i = 0; i < size; ++i) {
+    KernelImpl()(&dst[i], src[i]);
   }
+}
 
-  // Iterate through the current dimension in the source shape, recursing
-  // down one dimension at a time.
-  //
-  // This touches each element in the source buffer once, tracking complete
-  // dimensions within the shaped source buffer and using them to compute
-  // the corresponding indices (shaped and flattened) within the destination
-  // buffer. Each element in the destination buffer will be touched multiple
-  // times.
-  //
-  // Note that cache coherency isn't considered here, and some computations
-  // are redundant, so this could be optimized substantially.
-  for (size_t dim_i = 0; dim_i < src_shape[dim]; ++dim_i) {
-    src_indices[dim] = dim_i;
+// A run of adjacent source dimensions that are either all reduced or all kept.
+struct ReduceRun {
+  size_t size;
+  bool reduced;
+};
 
-    // Recurse down to the next dimension (e.g. 2 -> 1 -> 0 -> base case)
-    //   * Add the current stride to flat_src_i
-    //   * Multiply src_stride by this dimension's shape
-    ReduceDimension<T, KernelImpl>(src_buffer, dst_buffer, src_shape,
-                                   reduce_dims, dst_strides, dim - 1,
-                                   src_indices, flat_src_i + dim_i * src_stride,
-                                   src_stride * src_shape[dim]);
+// Collapses |src_shape| into alternating runs of reduced and kept dimensions,
+// dropping unit dimensions. For example, reducing dimensions [1, 2] of
+// [4, 5, 6, 1, 7] yields [(4, kept), (30, reduced), (7, kept)].
+inline absl::InlinedVector<ReduceRun, 8> CollapseReduceDims(
+    ShapeSpan src_shape, absl::Span<const int32_t> dimensions) {
+  absl::InlinedVector<bool, 8> reduced(src_shape.size(), false);
+  for (int32_t dim : dimensions) reduced[dim] = true;
+  absl::InlinedVector<ReduceRun, 8> runs;
+  for (size_t i = 0; i < src_shape.size(); ++i) {
+    if (src_shape[i] == 1) continue;
+    if (!runs.empty() && runs.back().reduced == reduced[i]) {
+      runs.back().size *= src_shape[i];
+    } else {
+      runs.push_back({static_cast<size_t>(src_shape[i]), reduced[i]});
+    }
   }
+  if (runs.empty()) runs.push_back({1, false});
+  return runs;
 }
 
 template <typename T, typename KernelImpl>
 Status GenericReduce(absl::Span<const T> src_buffer,
                      absl::Span<const T> init_buffer, absl::Span<T> dst_buffer,
-                     int32_t dimension, ShapeSpan src_shape,
+                     absl::Span<const int32_t> dimensions, ShapeSpan src_shape,
                      ShapeSpan dst_shape) {
+  for (int32_t dim : dimensions) {
+    if (dim < 0 || dim >= static_cast<int32_t>(src_shape.size())) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Reduction dimension " << dim << " out of range for rank "
+             << src_shape.size();
+    }
+  }
+
   // Initialize using init_buffer, which is expected to be a scalar.
   std::fill_n(dst_buffer.data(), dst_buffer.size(), init_buffer[0]);
-
-  // Precompute destination strides.
-  int dst_rank = dst_shape.size();
-  absl::InlinedVector<int, 8> dst_strides;
-  size_t dst_stride = 1;
-  for (int dim_i = dst_rank - 1; dim_i >= 0; --dim_i) {
-    dst_strides.push_back(dst_stride);
-    dst_stride *= dst_shape[dim_i];
+  if (src_buffer.empty()) return OkStatus();
+
+  // Walk the source once in order as (outer..., inner) where the innermost run
+  // is contiguous in the source. Each outer step either reduces a whole row
+  // into a single destination element (innermost run reduced) or accumulates a
+  // row elementwise into a destination row (innermost run kept).
+  auto runs = CollapseReduceDims(src_shape, dimensions);
+  const ReduceRun inner = runs.back();
+  runs.pop_back();
+
+  // Destination strides of the outer runs; reduced runs do not advance it.
+  absl::InlinedVector<size_t, 8> dst_strides(runs.size(), 0);
+  size_t dst_stride = inner.reduced ? 1 : inner.size;
+  for (int i = static_cast<int>(runs.size()) - 1; i >= 0; --i) {
+    if (runs[i].reduced) continue;
+    dst_strides[i] = dst_stride;
+    dst_stride *= runs[i].size;
   }
 
-  // Call the helper (recursive) function, starting with:
-  //   * source index [0, 0, ..., 0]
-  //   * the innermost dimension (last in the shape)
-  //   * flat_src_i of 0 (corresponds to [0, 0, ..., 0] above)
-  //   * source stride 1
-  absl::InlinedVector<int, 8> src_indices(src_shape.size(), 0);
-  ReduceDimension<T, KernelImpl>(src_buffer, dst_buffer, src_shape, {dimension},
-                                 absl::MakeSpan(dst_strides),
-                                 src_shape.size() - 1,
-                                 absl::MakeSpan(src_indices), 0, 1);
+  absl::InlinedVector<size_t, 8> indices(runs.size(), 0);
+  const size_t outer_count = src_buffer.size() / inner.size;
+  const T* src_ptr = src_buffer.data();
+  size_t dst_offset = 0;
+  for (size_t outer = 0; outer < outer_count; ++outer) {
+    if (inner.reduced) {
+      ReduceRow<T, KernelImpl>(src_ptr, inner.size, &dst_buffer[dst_offset]);
+    } else {
+      ReduceElementwise<T, KernelImpl>(src_ptr, inner.size,
+                                       &dst_buffer[dst_offset]);
+    }
+    src_ptr += inner.size;
+    for (int i = static_cast<int>(runs.size()) - 1; i >= 0; --i) {
+      dst_offset += dst_strides[i];
+      if (++indices[i] < runs[i].size) break;
+      dst_offset -= dst_strides[i] * runs[i].size;
+      indices[i] = 0;
+    }
+  }
 
   return OkStatus();
 }
@@ -810,75 +1382,242 @@ Status GenericReduce(absl::Span<const T> src_buffer,
 template <typename T>
 Status ReduceSum::Execute(absl::Span<const T> src_buffer,
                           absl::Span<const T> init_buffer,
-                          absl::Span<T> dst_buffer, int32_t dimension,
+                          absl::Span<T> dst_buffer,
+                          absl::Span<const int32_t> dimensions,
                           ShapeSpan src_shape, ShapeSpan dst_shape) {
   return impl::GenericReduce<T, impl::SumKernel>(
-      src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
+      src_buffer, init_buffer, dst_buffer, dimensions, src_shape, dst_shape);
 }
 
 template <typename T>
 Status ReduceMin::Execute(absl::Span<const T> src_buffer,
                           absl::Span<const T> init_buffer,
-                          absl::Span<T> dst_buffer, int32_t dimension,
+                          absl::Span<T> dst_buffer,
+                          absl::Span<const int32_t> dimensions,
                           ShapeSpan src_shape, ShapeSpan dst_shape) {
   return impl::GenericReduce<T, impl::MinKernel>(
-      src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
+      src_buffer, init_buffer, dst_buffer, dimensions, src_shape, dst_shape);
 }
 
 template <typename T>
 Status ReduceMax::Execute(absl::Span<const T> src_buffer,
                           absl::Span<const T> init_buffer,
-                          absl::Span<T> dst_buffer, int32_t dimension,
+                          absl::Span<T> dst_buffer,
+                          absl::Span<const int32_t> dimensions,
                           ShapeSpan src_shape, ShapeSpan dst_shape) {
   return impl::GenericReduce<T, impl::MaxKernel>(
-      src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
+      src_buffer, init_buffer, dst_buffer, dimensions, src_shape, dst_shape);
 }
 
 namespace impl {
 
+// Minimum window size for which pooling along an axis with unit stride slides
+// the window instead of reducing every window from scratch.
+constexpr int kSlidingPoolingMinWindow = 4;
+
+// A 1-D pooling pass along the middle axis of a buffer viewed as
+// [outer, src_size, inner], producing [outer, dst_size, inner]. Rows of |inner|
+// contiguous elements are processed together so that the inner loops vectorize
+// along the trailing (usually channel) dimensions.
+struct PoolingAxis {
+  size_t outer;
+  size_t inner;
+  int src_size;
+  int dst_size;
+  int window;
+  int stride;
+  int pad_low;
+
+  // Returns the [begin, end) source range of output |i| clipped to the source.
+  // |end| may be less than |begin| if the window is entirely padding.
+  std::pair<int, int> ClipWindow(int i) const {
+    int start = i * stride - pad_low;
+    return {std::max(start, 0), std::min(start + window, src_size)};
+  }
+};
+
+// Pools |axis| by reducing each clipped window into a row initialized to
+// |pad_value|. Padding elements are not visited as |pad_value| is either the
+// identity (sums) or idempotent (min/max).
 template <typename T, typename KernelImpl>
-Status ComputePoolingWindow(absl::Span<const T> src_buffer,
-                            absl::Span<const int> src_indices,
-                            ShapeSpan src_shape, T init_value,
-                            ShapeSpan window_dimensions, T* dst_value) {
-  int rank = src_shape.size();
-  absl::InlinedVector<int, 8> window_indices(rank, 0);
-  auto getSrcValue = [&]() -> T {
-    int flat_idx = 0;
-    for (int i = 0; i < rank; ++i) {
-      int idx = src_indices[i] + window_indices[i];
-      if (idx < 0 || idx >= src_shape[i]) return init_value;
-      flat_idx = flat_idx * src_shape[i] + idx;
-    }
-    return src_buffer[flat_idx];
-  };
+void PoolAxisDirect(const T* src, T* dst, const PoolingAxis& axis,
+                    T pad_value) {
+  for (size_t o = 0; o < axis.outer; ++o) {
+    const T* src_plane = src + o * axis.src_size * axis.inner;
+    T* dst_row = dst + o * axis.dst_size * axis.inner;
+    for (int i = 0; i < axis.dst_size; ++i, dst_row += axis.inner) {
+      std::fill_n(dst_row, axis.inner, pad_value);
+      auto range = axis.ClipWindow(i);
+      for (int k = range.first; k < range.second; ++k) {
+        ReduceElementwise<T, KernelImpl>(src_plane + k * axis.inner,
+                                         axis.inner, dst_row);
+      }
+    }
+  }
+}
 
-  *dst_value = init_value;
-  for (int i = 0, e = GetElementCount(window_dimensions); i < e; ++i) {
-    KernelImpl()(dst_value, getSrcValue());
-    IncrementShapeIndex(absl::MakeSpan(window_indices), window_dimensions);
+// Pools a unit-stride |axis| with a running sum: each window is derived from
+// the previous one by adding the row entering it and subtracting the row
+// leaving it.
+template <typename T>
+void PoolAxisRunningSum(const T* src, T* dst, const PoolingAxis& axis) {
+  for (size_t o = 0; o < axis.outer; ++o) {
+    const T* src_plane = src + o * axis.src_size * axis.inner;
+    T* dst_plane = dst + o * axis.dst_size * axis.inner;
+    PoolingAxis first_axis = axis;
+    first_axis.outer = 1;
+    first_axis.dst_size = std::min(axis.dst_size, 1);
+    PoolAxisDirect<T, SumKernel>(src_plane, dst_plane, first_axis, T(0));
+    for (int i = 1; i < axis.dst_size; ++i) {
+      T* dst_row = dst_plane + i * axis.inner;
+      std::copy_n(dst_row - axis.inner, axis.inner, dst_row);
+      int leaving = i - 1 - axis.pad_low;
+      int entering = leaving + axis.window;
+      if (entering >= 0 && entering < axis.src_size) {
+        const T* row = src_plane + entering * axis.inner;
+        for (size_t j = 0; j < axis.inner; ++j) dst_row[j] += row[j];
+      }
+      if (leaving >= 0 && leaving < axis.src_size) {
+        const T* row = src_plane + leaving * axis.inner;
+        for (size_t j = 0; j < axis.inner; ++j) dst_row[j] -= row[j];
+      }
+    }
+  }
+}
+
+// Pools a unit-stride |axis| using the van Herk/Gil-Werman algorithm: the
+// padded source is split into blocks of |window| rows and each window is the
+// combination of a block suffix and the following block prefix, making the
+// cost independent of the window size.
+template <typename T, typename KernelImpl>
+void PoolAxisSlidingWindow(const T* src, T* dst, const PoolingAxis& axis,
+                           T pad_value) {
+  const size_t inner = axis.inner;
+  const int window = axis.window;
+  const int length = axis.dst_size + window - 1;
+  std::vector<T> pad_row(inner, pad_value);
+  std::vector<T> prefix(length * inner);
+  std::vector<T> suffix(length * inner);
+  for (size_t o = 0; o < axis.outer; ++o) {
+    const T* src_plane = src + o * axis.src_size * inner;
+    auto src_row = [&](int e) {
+      int k = e - axis.pad_low;
+      return k >= 0 && k < axis.src_size ? src_plane + k * inner
+                                         : pad_row.data();
+    };
+    for (int e = 0; e < length; ++e) {
+      T* row = &prefix[e * inner];
+      if (e % window == 0) {
+        std::copy_n(src_row(e), inner, row);
+      } else {
+        std::copy_n(row - inner, inner, row);
+        ReduceElementwise<T, KernelImpl>(src_row(e), inner, row);
+      }
+    }
+    for (int e = length - 1; e >= 0; --e) {
+      T* row = &suffix[e * inner];
+      if (e % window == window - 1 || e == length - 1) {
+        std::copy_n(src_row(e), inner, row);
+      } else {
+        std::copy_n(row + inner, inner, row);
+        ReduceElementwise<T, KernelImpl>(src_row(e), inner, row);
+      }
+    }
+    T* dst_row = dst + o * axis.dst_size * inner;
+    for (int i = 0; i < axis.dst_size; ++i, dst_row += inner) {
+      std::copy_n(pad_row.data(), inner, dst_row);
+      ReduceElementwise<T, KernelImpl>(&suffix[i * inner], inner, dst_row);
+      ReduceElementwise<T, KernelImpl>(&prefix[(i + window - 1) * inner],
+                                       inner, dst_row);
+    }
   }
-  return OkStatus();
 }
 
+template <typename T, typename KernelImpl>
+void PoolAxis(const T* src, T* dst, const PoolingAxis& axis, T pad_value) {
+  if (axis.stride != 1 || axis.window < kSlidingPoolingMinWindow) {
+    PoolAxisDirect<T, KernelImpl>(src, dst, axis, pad_value);
+  } else if (std::is_same<KernelImpl, SumKernel>::value) {
+    PoolAxisRunningSum<T>(src, dst, axis);
+  } else {
+    PoolAxisSlidingWindow<T, KernelImpl>(src, dst, axis, pad_value);
+  }
+}
+
+// Pools a window that is a box over the source by pooling each windowed
+// dimension in turn. Sums are computed with a zero padding value and then
+// corrected for the initial value, which the reference semantics add once per
+// output and once per padding element in the window. Min and max are
+// idempotent so the initial value can be used as the padding value directly.
 template <typename T, typename KernelImpl>
 Status GenericPooling(absl::Span<const T> src_buffer,
                       absl::Span<const T> init_buffer, absl::Span<T> dst_buffer,
                       ShapeSpan src_shape, ShapeSpan dst_shape,
                       ShapeSpan window_dimensions, ShapeSpan strides,
                       ShapeSpan pad_low) {
-  int rank = src_shape.size();
-  absl::InlinedVector<int, 8> src_indices(rank, 0);
-  absl::InlinedVector<int, 8> dst_indices(rank, 0);
-  for (int i = 0, e = GetElementCount(dst_shape); i < e; ++i) {
-    for (int j = 0; j < rank; ++j) {
-      src_indices[j] = dst_indices[j] * strides[j] - pad_low[j];
+  const int rank = src_shape.size();
+  if (dst_shape.size() != src_shape.size() ||
+      window_dimensions.size() != src_shape.size() ||
+      strides.size() != src_shape.size() ||
+      pad_low.size() != src_shape.size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Pooling shapes must all have rank " << rank;
+  }
+  constexpr bool kIsSum = std::is_same<KernelImpl, SumKernel>::value;
+  const T init_value = init_buffer[0];
+  const T pad_value = kIsSum ? T(0) : init_value;
+  if (rank == 0) {
+    dst_buffer[0] = init_value;
+    KernelImpl()(&dst_buffer[0], src_buffer[0]);
+    return OkStatus();
+  }
+
+  absl::InlinedVector<int, 8> axes;
+  for (int i = 0; i < rank; ++i) {
+    if (window_dimensions[i] != 1 || strides[i] != 1 || pad_low[i] != 0 ||
+        src_shape[i] != dst_shape[i]) {
+      axes.push_back(i);
+    }
+  }
+  // Always run at least one pass so that the initial value is applied.
+  if (axes.empty()) axes.push_back(rank - 1);
+
+  absl::InlinedVector<int32_t, 8> shape(src_shape.begin(), src_shape.end());
+  std::vector<T> temps[2];
+  const T* src = src_buffer.data();
+  for (size_t a = 0; a < axes.size(); ++a) {
+    int dim = axes[a];
+    PoolingAxis axis;
+    axis.outer = GetElementCount(ShapeSpan(shape).subspan(0, dim));
+    axis.inner = GetElementCount(ShapeSpan(shape).subspan(dim + 1));
+    axis.src_size = shape[dim];
+    axis.dst_size = dst_shape[dim];
+    axis.window = window_dimensions[dim];
+    axis.stride = strides[dim];
+    axis.pad_low = pad_low[dim];
+    shape[dim] = dst_shape[dim];
+    T* dst = dst_buffer.data();
+    if (a + 1 != axes.size()) {
+      temps[a % 2].resize(GetElementCount(shape));
+      dst = temps[a % 2].data();
+    }
+    PoolAxis<T, KernelImpl>(src, dst, axis, pad_value);
+    src = dst;
+  }
+
+  if (kIsSum && init_value != T(0)) {
+    const int window_count = GetElementCount(window_dimensions);
+    absl::InlinedVector<int32_t, 8> dst_indices(rank, 0);
+    for (size_t i = 0, e = GetElementCount(dst_shape); i < e; ++i) {
+      int valid_count = 1;
+      for (int j = 0; j < rank; ++j) {
+        int start = dst_indices[j] * strides[j] - pad_low[j];
+        int end = std::min(start + window_dimensions[j], src_shape[j]);
+        valid_count *= std::max(end - std::max(start, 0), 0);
+      }
+      dst_buffer[i] += init_value * T(1 + window_count - valid_count);
+      IncrementShapeIndex(absl::MakeSpan(dst_indices), dst_shape);
     }
-    auto status = ComputePoolingWindow<T, KernelImpl>(
-        src_buffer, src_indices, src_shape, init_buffer[0], window_dimensions,
-        &dst_buffer[i]);
-    RETURN_IF_ERROR(status);
-    IncrementShapeIndex(absl::MakeSpan(dst_indices), dst_shape);
   }
   return OkStatus();
 }
@@ -918,6 +1657,167 @@ Status PoolingMax::Execute(absl::Span<const T> src_buffer,
       window_dimensions, strides, pad_low);
 }
 
+namespace impl {
+
+// Rows shorter than this are sorted with a comparison sort as the histogram
+// passes of the radix sort don't pay for themselves.
+constexpr size_t kRadixSortMinRowSize = 256;
+
+template <typename T>
+using RadixKey = typename std::conditional<
+    sizeof(T) == 1, uint8_t,
+    typename std::conditional<sizeof(T) == 2, uint16_t,
+                              uint32_t>::type>::type;
+
+// Maps |value| to an unsigned key whose natural order is the ascending (or
+// descending) order of |T|. Floats are ordered by their IEEE total order
+// except that -0 and +0 are equal.
+template <typename T>
+RadixKey<T> ToRadixKey(T value, bool descending) {
+  using U = RadixKey<T>;
+  constexpr U kSignBit = static_cast<U>(U(1) << (sizeof(U) * 8 - 1));
+  U bits = 0;
+  if (value != T(0)) std::memcpy(&bits, &value, sizeof(bits));
+  if (std::is_floating_point<T>::value && (bits & kSignBit)) {
+    bits = static_cast<U>(~bits);
+  } else {
+    bits = static_cast<U>(bits ^ kSignBit);
+  }
+  return descending ? static_cast<U>(~bits) : bits;
+}
+
+// Packs a key and its index such that comparing packed values orders by key
+// and then by index, making any comparison sort over them stable.
+template <typename T>
+uint64_t PackSortEntry(T value, bool descending, int32_t index) {
+  return (static_cast<uint64_t>(ToRadixKey(value, descending)) << 32) |
+         static_cast<uint32_t>(index);
+}
+
+// Sorts rows of keys reusing its scratch storage across rows.
+template <typename T>
+class RowSorter {
+ public:
+  // Writes the indices that stably sort |src|[0, |size|) into |dst|.
+  void Sort(const T* src, size_t size, bool descending, int32_t* dst) {
+    if (size < kRadixSortMinRowSize) {
+      entries_.resize(size);
+      for (size_t i = 0; i < size; ++i) {
+        entries_[i] = PackSortEntry(src[i], descending, i);
+      }
+      std::sort(entries_.begin(), entries_.end());
+      for (size_t i = 0; i < size; ++i) {
+        dst[i] = static_cast<int32_t>(entries_[i]);
+      }
+      return;
+    }
+
+    // LSD radix sort over 8-bit digits moving (key, index) pairs between the
+    // two sets of buffers. Each pass is stable so equal keys keep their
+    // original order. All digit histograms are gathered in a single pass.
+    constexpr int kDigitCount = sizeof(U);
+    keys_.resize(size);
+    scratch_keys_.resize(size);
+    scratch_indices_.resize(size);
+    std::array<std::array<size_t, 256>, kDigitCount> counts = {};
+    for (size_t i = 0; i < size; ++i) {
+      U key = ToRadixKey(src[i], descending);
+      keys_[i] = key;
+      dst[i] = static_cast<int32_t>(i);
+      for (int d = 0; d < kDigitCount; ++d) {
+        ++counts[d][(key >> (d * 8)) & 0xFF];
+      }
+    }
+    U* keys = keys_.data();
+    int32_t* indices = dst;
+    U* next_keys = scratch_keys_.data();
+    int32_t* next_indices = scratch_indices_.data();
+    for (int d = 0; d < kDigitCount; ++d) {
+      const int shift = d * 8;
+      auto& offsets = counts[d];
+      // Every key shares this digit so the pass would not move anything.
+      if (offsets[(keys[0] >> shift) & 0xFF] == size) continue;
+      size_t offset = 0;
+      for (auto& count : offsets) {
+        size_t digit_count = count;
+        count = offset;
+        offset += digit_count;
+      }
+      for (size_t i = 0; i < size; ++i) {
+        size_t j = offsets[(keys[i] >> shift) & 0xFF]++;
+        next_keys[j] = keys[i];
+        next_indices[j] = indices[i];
+      }
+      std::swap(keys, next_keys);
+      std::swap(indices, next_indices);
+    }
+    if (indices != dst) {
+      std::copy(indices, indices + size, dst);
+    }
+  }
+
+  // Writes the indices of the first |k| elements of the stably sorted
+  // |src|[0, |size|) into |dst|.
+  void TopK(const T* src, size_t size, size_t k, bool descending,
+            int32_t* dst) {
+    entries_.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      entries_[i] = PackSortEntry(src[i], descending, i);
+    }
+    auto selected_end = entries_.begin() + k;
+    if (k < size) {
+      std::nth_element(entries_.begin(), selected_end, entries_.end());
+    }
+    std::sort(entries_.begin(), selected_end);
+    for (size_t i = 0; i < k; ++i) {
+      dst[i] = static_cast<int32_t>(entries_[i]);
+    }
+  }
+
+ private:
+  using U = RadixKey<T>;
+
+  std::vector<uint64_t> entries_;
+  std::vector<U> keys_;
+  std::vector<U> scratch_keys_;
+  std::vector<int32_t> scratch_indices_;
+};
+
+}  // namespace impl
+
+template <typename T>
+Status Sort::Execute(absl::Span<const T> src_buffer,
+                     absl::Span<int32_t> dst_buffer, ShapeSpan src_shape,
+                     bool descending) {
+  const size_t row_size = src_shape.empty() ? 1 : src_shape.back();
+  if (row_size == 0) return OkStatus();
+  impl::RowSorter<T> sorter;
+  for (size_t offset = 0; offset < src_buffer.size(); offset += row_size) {
+    sorter.Sort(src_buffer.data() + offset, row_size, descending,
+                dst_buffer.data() + offset);
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status TopK::Execute(absl::Span<const T> src_buffer,
+                     absl::Span<int32_t> dst_buffer, ShapeSpan src_shape,
+                     ShapeSpan dst_shape, bool descending) {
+  const size_t row_size = src_shape.empty() ? 1 : src_shape.back();
+  const size_t k = dst_shape.empty() ? 1 : dst_shape.back();
+  if (k > row_size) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Cannot select " << k << " elements from rows of " << row_size;
+  }
+  if (k == 0) return OkStatus();
+  impl::RowSorter<T> sorter;
+  for (size_t row = 0; row * k < dst_buffer.size(); ++row) {
+    sorter.TopK(src_buffer.data() + row * row_size, row_size, k, descending,
+                dst_buffer.data() + row * k);
+  }
+  return OkStatus();
+}
+
 }  // namespace kernels
 }  // namespace vmla
 }  // namespace hal
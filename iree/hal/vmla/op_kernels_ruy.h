@@ -15,6 +15,10 @@
 #ifndef IREE_HAL_VMLA_OP_KERNELS_RUY_H_
 #define IREE_HAL_VMLA_OP_KERNELS_RUY_H_
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/memory/memory.h"
 #include "iree/base/status.h"
@@ -37,9 +41,9 @@ inline std::unique_ptr<MatMul::RuntimeState> MatMul::CreateRuntimeState() {
   return absl::make_unique<RuntimeState>();
 }
 
-template <typename T, typename ACC>
+template <typename T, typename ACC, typename DST>
 Status MatMul::Execute(RuntimeState* runtime_state,
-                       const Buffers<T, ACC>& buffers) {
+                       const Buffers<T, ACC, DST>& buffers) {
   ruy::Matrix<T> lhs;
   lhs.set_data(buffers.lhs_buffer.data());
   ruy::MakeSimpleLayout(buffers.lhs_shape[0], buffers.lhs_shape[1],
@@ -50,18 +54,21 @@ Status MatMul::Execute(RuntimeState* runtime_state,
   ruy::MakeSimpleLayout(buffers.rhs_shape[1], buffers.rhs_shape[0],
                         ruy::Order::kColMajor, rhs.mutable_layout());
 
-  ruy::Matrix<T> dst;
+  ruy::Matrix<DST> dst;
   dst.set_data(buffers.dst_buffer.data());
   ruy::MakeSimpleLayout(buffers.dst_shape[1], buffers.dst_shape[0],
                         ruy::Order::kColMajor, dst.mutable_layout());
 
-  ruy::MulParams<ACC, T> mul_params;
-  mul_params.set_bias(buffers.bias_buffer.data());
+  ruy::MulParams<ACC, DST> mul_params;
+  if (!buffers.bias_buffer.empty()) {
+    mul_params.set_bias(buffers.bias_buffer.data());
+  }
 
+  // Raw accumulator (and float) outputs must not have multipliers set.
   if (buffers.multiplier_mantissa_buffer.size() == 1) {
     mul_params.set_multiplier_fixedpoint(buffers.multiplier_mantissa_buffer[0]);
     mul_params.set_multiplier_exponent(buffers.multiplier_exponent_buffer[0]);
-  } else {
+  } else if (!buffers.multiplier_mantissa_buffer.empty()) {
     mul_params.set_multiplier_fixedpoint_perchannel(
         buffers.multiplier_mantissa_buffer.data());
     mul_params.set_multiplier_exponent_perchannel(
@@ -73,6 +80,75 @@ Status MatMul::Execute(RuntimeState* runtime_state,
   return OkStatus();
 }
 
+namespace impl {
+
+// Number of lhs rows and rhs columns widened to f32 per MatMul of
+// half-precision matrices. Bounds the size of the f32 blocks independent of
+// the problem.
+constexpr int32_t kHalfMatMulPanelSize = 64;
+
+template <typename T>
+Status HalfMatMul(MatMul::RuntimeState* runtime_state,
+                  const MatMul::Buffers<T, float, T>& buffers) {
+  const int32_t cols = buffers.rhs_shape[0];
+  const int32_t depth = buffers.rhs_shape[1];
+  const int32_t rows = buffers.dst_shape[1];
+  const int32_t block_size = std::min(rows, kHalfMatMulPanelSize);
+  const int32_t panel_size = std::min(cols, kHalfMatMulPanelSize);
+  std::vector<float> lhs_block(block_size * depth);
+  std::vector<float> rhs_panel(panel_size * depth);
+  std::vector<float> dst_panel(panel_size * block_size);
+  for (int32_t row = 0; row < rows; row += block_size) {
+    const int32_t block_rows = std::min(block_size, rows - row);
+    // lhs is row-major so each block of rows is contiguous.
+    std::copy_n(buffers.lhs_buffer.data() + row * depth, block_rows * depth,
+                lhs_block.begin());
+    const std::array<int32_t, 2> lhs_shape = {block_rows, depth};
+    for (int32_t col = 0; col < cols; col += panel_size) {
+      const int32_t panel_cols = std::min(panel_size, cols - col);
+      // rhs is column-major so each panel of columns is contiguous.
+      std::copy_n(buffers.rhs_buffer.data() + col * depth, panel_cols * depth,
+                  rhs_panel.begin());
+      const std::array<int32_t, 2> rhs_shape = {panel_cols, depth};
+      const std::array<int32_t, 2> dst_shape = {panel_cols, block_rows};
+      MatMul::Buffers<float, float, float> panel;
+      panel.lhs_shape = lhs_shape;
+      panel.lhs_buffer =
+          absl::MakeConstSpan(lhs_block.data(), block_rows * depth);
+      panel.rhs_shape = rhs_shape;
+      panel.rhs_buffer =
+          absl::MakeConstSpan(rhs_panel.data(), panel_cols * depth);
+      panel.dst_shape = dst_shape;
+      panel.dst_buffer =
+          absl::MakeSpan(dst_panel.data(), panel_cols * block_rows);
+      if (!buffers.bias_buffer.empty()) {
+        panel.bias_buffer = buffers.bias_buffer.subspan(row, block_rows);
+      }
+      RETURN_IF_ERROR(MatMul::Execute(runtime_state, panel));
+      // dst is column-major so each result column is scattered back.
+      for (int32_t i = 0; i < panel_cols; ++i) {
+        std::copy_n(dst_panel.begin() + i * block_rows, block_rows,
+                    buffers.dst_buffer.data() + (col + i) * rows + row);
+      }
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace impl
+
+inline Status MatMul::Execute(
+    RuntimeState* runtime_state,
+    const Buffers<Float16, float, Float16>& buffers) {
+  return impl::HalfMatMul(runtime_state, buffers);
+}
+
+inline Status MatMul::Execute(
+    RuntimeState* runtime_state,
+    const Buffers<BFloat16, float, BFloat16>& buffers) {
+  return impl::HalfMatMul(runtime_state, buffers);
+}
+
 }  // namespace kernels
 }  // namespace vmla
 }  // namespace hal
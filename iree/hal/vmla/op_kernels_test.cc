@@ -14,6 +14,12 @@
 
 #include "iree/hal/vmla/op_kernels.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
 #include "absl/container/inlined_vector.h"
 #include "iree/base/memory.h"
 #include "iree/base/status_matchers.h"
@@ -377,9 +383,295 @@ TEST(Pad, HighRank) {
   EXPECT_EQ(dst_buffer, expected_dst);
 }
 
+TEST(Pad, NegativeEdgeWithInteriorPadding) {
+  Shape src_shape = {3, 4};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  std::vector<uint16_t> pad_value_buffer = {0};
+  std::vector<int32_t> edge_padding_low = {-1, -2};
+  std::vector<int32_t> edge_padding_high = {0, -1};
+  std::vector<int32_t> interior_padding = {1, 1};
+  Shape dst_shape = {4, 4};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(dst_shape), UINT16_MAX);
+  // The first row and first column of source elements are cropped along with
+  // the interior padding around them.
+  // clang-format off
+  std::vector<uint16_t> expected_dst = { 0, 0,  0, 0,
+                                         6, 0,  7, 0,
+                                         0, 0,  0, 0,
+                                        10, 0, 11, 0};
+  // clang-format on
+
+  EXPECT_OK(Pad::Execute<uint16_t>(
+      src_buffer, pad_value_buffer, absl::MakeSpan(dst_buffer), src_shape,
+      dst_shape, edge_padding_low, edge_padding_high, interior_padding));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Pad, MixedNegativeEdgeWithInteriorPadding) {
+  Shape src_shape = {3, 4};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  std::vector<uint16_t> pad_value_buffer = {0};
+  std::vector<int32_t> edge_padding_low = {1, -1};
+  std::vector<int32_t> edge_padding_high = {-1, 2};
+  std::vector<int32_t> interior_padding = {0, 2};
+  Shape dst_shape = {3, 11};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(dst_shape), UINT16_MAX);
+  // The last source row and the first source column are cropped.
+  // clang-format off
+  std::vector<uint16_t> expected_dst = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                        0, 0, 2, 0, 0, 3, 0, 0, 4, 0, 0,
+                                        0, 0, 6, 0, 0, 7, 0, 0, 8, 0, 0};
+  // clang-format on
+
+  EXPECT_OK(Pad::Execute<uint16_t>(
+      src_buffer, pad_value_buffer, absl::MakeSpan(dst_buffer), src_shape,
+      dst_shape, edge_padding_low, edge_padding_high, interior_padding));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Broadcast, Scalar) {
+  std::vector<uint32_t> src_buffer = {42};
+  std::vector<uint32_t> dst_buffer(1, 0);
+  std::vector<uint32_t> expected_dst = {42};
+
+  EXPECT_OK(Broadcast::Execute<uint32_t>(src_buffer,
+                                         absl::MakeSpan(dst_buffer)));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Broadcast, Rows) {
+  Shape dst_shape = {2, 3};
+  std::vector<uint8_t> src_buffer = {7};
+  std::vector<uint8_t> dst_buffer(GetShapeElementCount(dst_shape), 0);
+  std::vector<uint8_t> expected_dst(GetShapeElementCount(dst_shape), 7);
+
+  EXPECT_OK(Broadcast::Execute<uint8_t>(src_buffer,
+                                        absl::MakeSpan(dst_buffer)));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Tile, MultipleAxes) {
+  Shape src_shape = {2, 3};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  Shape dst_shape = {4, 6};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(dst_shape), UINT16_MAX);
+  // clang-format off
+  std::vector<uint16_t> expected_dst = {1, 2, 3, 1, 2, 3,
+                                        4, 5, 6, 4, 5, 6,
+                                        1, 2, 3, 1, 2, 3,
+                                        4, 5, 6, 4, 5, 6};
+  // clang-format on
+
+  EXPECT_OK(Tile::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                    src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Tile, DegenerateDimension) {
+  Shape src_shape = {2, 1, 3};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  Shape dst_shape = {2, 3, 6};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(dst_shape), UINT16_MAX);
+  // clang-format off
+  std::vector<uint16_t> expected_dst = {1, 2, 3, 1, 2, 3,
+                                        1, 2, 3, 1, 2, 3,
+                                        1, 2, 3, 1, 2, 3,
+
+                                        4, 5, 6, 4, 5, 6,
+                                        4, 5, 6, 4, 5, 6,
+                                        4, 5, 6, 4, 5, 6};
+  // clang-format on
+
+  EXPECT_OK(Tile::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                    src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Tile, DegenerateInnermostDimension) {
+  Shape src_shape = {2, 1};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  Shape dst_shape = {2, 4};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(dst_shape), UINT16_MAX);
+  std::vector<uint16_t> expected_dst = {1, 1, 1, 1, 2, 2, 2, 2};
+
+  EXPECT_OK(Tile::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                    src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Transpose, TwoDimensions) {
+  Shape src_shape = {2, 3};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> perm = {1, 0};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(src_shape), UINT16_MAX);
+  std::vector<uint16_t> expected_dst = {1, 4, 2, 5, 3, 6};
+
+  EXPECT_OK(Transpose::Execute<uint16_t>(
+      src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Transpose, UnitDimensions) {
+  Shape src_shape = {1, 2, 1, 3};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> perm = {3, 2, 0, 1};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(src_shape), UINT16_MAX);
+  std::vector<uint16_t> expected_dst = {1, 4, 2, 5, 3, 6};
+
+  EXPECT_OK(Transpose::Execute<uint16_t>(
+      src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Transpose, Batched) {
+  Shape src_shape = {2, 2, 3};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> perm = {0, 2, 1};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(src_shape), UINT16_MAX);
+  std::vector<uint16_t> expected_dst = {1, 4, 2, 5, 3, 6, 7, 10, 8, 11, 9, 12};
+
+  EXPECT_OK(Transpose::Execute<uint16_t>(
+      src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Transpose, InnermostPreserved) {
+  Shape src_shape = {2, 3, 2};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> perm = {1, 0, 2};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(src_shape), UINT16_MAX);
+  std::vector<uint16_t> expected_dst = {1, 2, 7, 8, 3, 4, 9, 10, 5, 6, 11, 12};
+
+  EXPECT_OK(Transpose::Execute<uint16_t>(
+      src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Transpose, HighRank) {
+  Shape src_shape = {2, 3, 4};
+  auto src_buffer = MakeIota<uint16_t>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> perm = {2, 0, 1};
+  std::vector<uint16_t> dst_buffer(GetShapeElementCount(src_shape), UINT16_MAX);
+  // clang-format off
+  std::vector<uint16_t> expected_dst = {1, 5,  9, 13, 17, 21,
+                                        2, 6, 10, 14, 18, 22,
+                                        3, 7, 11, 15, 19, 23,
+                                        4, 8, 12, 16, 20, 24};
+  // clang-format on
+
+  EXPECT_OK(Transpose::Execute<uint16_t>(
+      src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+int32_t FloatBits(float value) {
+  int32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+TEST(Elementwise, FusedChain) {
+  // tanh(a * 0.5 + b) over more than one tile.
+  constexpr int kSize = 1000;
+  using Opcode = Elementwise::Opcode;
+  std::vector<float> a_buffer(kSize);
+  std::vector<float> b_buffer(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    a_buffer[i] = (i % 17) * 0.25f - 2.0f;
+    b_buffer[i] = (i % 5) * -0.125f;
+  }
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(Opcode::kConstant), FloatBits(0.5f), 0, 0,  // r2
+      static_cast<int32_t>(Opcode::kMul),      0, 2, 0,                // r3
+      static_cast<int32_t>(Opcode::kAdd),      3, 1, 0,                // r4
+      static_cast<int32_t>(Opcode::kTanh),     4, 0, 0,                // r5
+  };
+  std::vector<absl::Span<const float>> src_buffers = {a_buffer, b_buffer};
+  std::vector<float> dst_buffer(kSize, 0.0f);
+
+  EXPECT_OK(Elementwise::Execute<float>(src_buffers, program,
+                                        absl::MakeSpan(dst_buffer)));
+
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_NEAR(std::tanh(a_buffer[i] * 0.5f + b_buffer[i]), dst_buffer[i],
+                kEpsilon);
+  }
+}
+
+TEST(Elementwise, Clamp) {
+  using Opcode = Elementwise::Opcode;
+  std::vector<float> src_buffer = {-3.0f, -1.0f, 0.5f, 2.0f, 7.0f};
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(Opcode::kConstant), FloatBits(-1.5f), 0, 0,  // r1
+      static_cast<int32_t>(Opcode::kConstant), FloatBits(6.0f),  0, 0,  // r2
+      static_cast<int32_t>(Opcode::kClamp),    1, 0, 2,                 // r3
+  };
+  std::vector<absl::Span<const float>> src_buffers = {src_buffer};
+  std::vector<float> dst_buffer(src_buffer.size(), 0.0f);
+  std::vector<float> expected_dst = {-1.5f, -1.0f, 0.5f, 2.0f, 6.0f};
+
+  EXPECT_OK(Elementwise::Execute<float>(src_buffers, program,
+                                        absl::MakeSpan(dst_buffer)));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Elementwise, UndefinedRegister) {
+  using Opcode = Elementwise::Opcode;
+  std::vector<float> src_buffer = {1.0f, 2.0f};
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(Opcode::kAdd), 0, 1, 0,
+  };
+  std::vector<absl::Span<const float>> src_buffers = {src_buffer};
+  std::vector<float> dst_buffer(src_buffer.size(), 0.0f);
+
+  EXPECT_FALSE(Elementwise::Execute<float>(src_buffers, program,
+                                           absl::MakeSpan(dst_buffer))
+                   .ok());
+}
+
+TEST(Convert, Float16RoundTrip) {
+  // Exactly representable, halfway between 1 and the next f16 (rounds to
+  // even), subnormal, overflowing, and infinite values.
+  std::vector<float> src_buffer = {1.0f,     -2.5f,  1.0f + 1.0f / 2048,
+                                   5.96046448e-8f, 1e10f, -INFINITY};
+  std::vector<Float16> half_buffer(src_buffer.size());
+  std::vector<float> dst_buffer(src_buffer.size());
+  std::vector<uint16_t> expected_bits = {0x3C00, 0xC100, 0x3C00,
+                                         0x0001, 0x7C00, 0xFC00};
+  std::vector<float> expected_dst = {1.0f,     -2.5f,    1.0f,
+                                     5.96046448e-8f, INFINITY, -INFINITY};
+
+  EXPECT_OK((Convert::Execute<float, Float16>(src_buffer,
+                                              absl::MakeSpan(half_buffer))));
+  for (size_t i = 0; i < half_buffer.size(); ++i) {
+    EXPECT_EQ(expected_bits[i], half_buffer[i].bits());
+  }
+  EXPECT_OK((Convert::Execute<Float16, float>(half_buffer,
+                                              absl::MakeSpan(dst_buffer))));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Convert, BFloat16RoundTrip) {
+  std::vector<float> src_buffer = {1.0f, -2.5f, 1.0f + 1.0f / 256, 3.0e38f};
+  std::vector<BFloat16> half_buffer(src_buffer.size());
+  std::vector<float> dst_buffer(src_buffer.size());
+  std::vector<uint16_t> expected_bits = {0x3F80, 0xC020, 0x3F80, 0x7F62};
+
+  EXPECT_OK((Convert::Execute<float, BFloat16>(src_buffer,
+                                               absl::MakeSpan(half_buffer))));
+  for (size_t i = 0; i < half_buffer.size(); ++i) {
+    EXPECT_EQ(expected_bits[i], half_buffer[i].bits());
+  }
+  EXPECT_OK((Convert::Execute<BFloat16, float>(half_buffer,
+                                               absl::MakeSpan(dst_buffer))));
+  EXPECT_FLOAT_EQ(1.0f, dst_buffer[0]);
+  EXPECT_FLOAT_EQ(-2.5f, dst_buffer[1]);
+  EXPECT_FLOAT_EQ(1.0f, dst_buffer[2]);
+}
+
 TEST(ReduceSum, Scalar) {
   Shape src_shape = {5};
-  int32_t dimension = 0;
+  std::vector<int32_t> dimensions = {0};
   Shape dst_shape = {1};
   std::vector<float> src_buffer = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
   std::vector<float> init_buffer = {0.0f};
@@ -387,7 +679,7 @@ TEST(ReduceSum, Scalar) {
   std::vector<float> expected_dst = {5.0f};
 
   EXPECT_OK(ReduceSum::Execute<float>(src_buffer, init_buffer,
-                                      absl::MakeSpan(dst_buffer), dimension,
+                                      absl::MakeSpan(dst_buffer), dimensions,
                                       src_shape, dst_shape));
 
   for (int i = 0; i < dst_buffer.size(); ++i) {
@@ -397,7 +689,7 @@ TEST(ReduceSum, Scalar) {
 
 TEST(ReduceMin, TwoDimensionsToOne) {
   Shape src_shape = {3, 3};
-  int32_t dimension = 0;
+  std::vector<int32_t> dimensions = {0};
   Shape dst_shape = {3};
   std::vector<float> src_buffer =
       MakeIota<float>(GetShapeElementCount(src_shape));
@@ -406,7 +698,7 @@ TEST(ReduceMin, TwoDimensionsToOne) {
   std::vector<float> expected_dst = {1.0f, 2.0f, 3.0f};
 
   EXPECT_OK(ReduceMin::Execute<float>(src_buffer, init_buffer,
-                                      absl::MakeSpan(dst_buffer), dimension,
+                                      absl::MakeSpan(dst_buffer), dimensions,
                                       src_shape, dst_shape));
 
   for (int i = 0; i < dst_buffer.size(); ++i) {
@@ -414,6 +706,41 @@ TEST(ReduceMin, TwoDimensionsToOne) {
   }
 }
 
+TEST(ReduceSum, MultipleDimensions) {
+  Shape src_shape = {2, 3, 4};
+  std::vector<int32_t> dimensions = {0, 2};
+  Shape dst_shape = {3};
+  std::vector<float> src_buffer =
+      MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<float> init_buffer = {0.0f};
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape), 0.0f);
+  std::vector<float> expected_dst = {68.0f, 100.0f, 132.0f};
+
+  EXPECT_OK(ReduceSum::Execute<float>(src_buffer, init_buffer,
+                                      absl::MakeSpan(dst_buffer), dimensions,
+                                      src_shape, dst_shape));
+
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+TEST(ReduceMax, InnermostContiguous) {
+  Shape src_shape = {2, 20};
+  std::vector<int32_t> dimensions = {1};
+  Shape dst_shape = {2};
+  std::vector<int32_t> src_buffer =
+      MakeIota<int32_t>(GetShapeElementCount(src_shape));
+  std::vector<int32_t> init_buffer = {std::numeric_limits<int32_t>::min()};
+  std::vector<int32_t> dst_buffer(GetShapeElementCount(dst_shape), 0);
+  std::vector<int32_t> expected_dst = {20, 40};
+
+  EXPECT_OK(ReduceMax::Execute<int32_t>(src_buffer, init_buffer,
+                                        absl::MakeSpan(dst_buffer), dimensions,
+                                        src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
 TEST(PoolingMax, NoOverlapping) {
   Shape src_shape = {1, 4, 6, 1};
   Shape dst_shape = {1, 2, 2, 1};
@@ -472,6 +799,45 @@ TEST(PoolingSum, Overlapping) {
   }
 }
 
+TEST(PoolingMax, SlidingWindow) {
+  Shape src_shape = {1, 8, 2};
+  Shape dst_shape = {1, 8, 2};
+  Shape window_sizes = {1, 5, 1};
+  Shape strides = {1, 1, 1};
+  Shape pad_low = {0, 2, 0};
+  std::vector<int> src_buffer = MakeIota<int>(GetShapeElementCount(src_shape));
+  std::vector<int> init_buffer(1, -100);
+  std::vector<int> dst_buffer(GetShapeElementCount(dst_shape), 0);
+  std::vector<int> expected_dst = {5,  6,  7,  8,  9,  10, 11, 12,
+                                   13, 14, 15, 16, 15, 16, 15, 16};
+
+  EXPECT_OK(PoolingMax::Execute<int>(
+      src_buffer, init_buffer, absl::MakeSpan(dst_buffer), src_shape, dst_shape,
+      window_sizes, strides, pad_low));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(PoolingSum, SlidingWindowPaddingWithInit) {
+  // The initial value is added once per output and once per padding element.
+  Shape src_shape = {6};
+  Shape dst_shape = {4};
+  Shape window_sizes = {4};
+  Shape strides = {1};
+  Shape pad_low = {1};
+  std::vector<float> src_buffer =
+      MakeIota<float>(GetShapeElementCount(src_shape));
+  std::vector<float> init_buffer(1, 1.0f);
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape), 0.0f);
+  std::vector<float> expected_dst = {8, 11, 15, 19};
+
+  EXPECT_OK(PoolingSum::Execute<float>(
+      src_buffer, init_buffer, absl::MakeSpan(dst_buffer), src_shape, dst_shape,
+      window_sizes, strides, pad_low));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
 TEST(Conv2d, NoDilation) {
   Shape input_shape = {4, 5, 2};
   Shape filter_shape = {3, 2, 2, 1};
@@ -492,10 +858,104 @@ TEST(Conv2d, NoDilation) {
   }
   std::vector<float> dst_buffer(GetShapeElementCount(dst_shape), 0.0f);
 
-  EXPECT_OK(Conv2D::Execute<float>(input_buffer, input_shape, filter_buffer,
-                                   filter_shape, absl::MakeSpan(dst_buffer),
-                                   dst_shape, strides, pad_h, pad_w, dilation,
-                                   1));
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  EXPECT_OK(Conv2D::Execute<float>(
+      mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, strides, pad_h,
+      pad_w, dilation, 1));
+
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+TEST(Conv2d, Pointwise) {
+  Shape input_shape = {2, 2, 3};
+  Shape filter_shape = {1, 1, 3, 2};
+  Shape dst_shape = {2, 2, 2};
+  Shape strides = {1, 1};
+  Shape pad_h = {0, 0};
+  Shape pad_w = {0, 0};
+  Shape dilation = {1, 1};
+  std::vector<float> input_buffer(GetShapeElementCount(input_shape));
+  std::vector<float> filter_buffer(GetShapeElementCount(filter_shape));
+  std::vector<float> expected_dst = {22, 28, 49, 64, 76, 100, 103, 136};
+  for (int i = 0; i < GetShapeElementCount(input_shape); ++i) {
+    input_buffer[i] = i + 1;
+    if (i < GetShapeElementCount(filter_shape)) {
+      filter_buffer[i] = i + 1;
+    }
+  }
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape), 0.0f);
+
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  EXPECT_OK(Conv2D::Execute<float>(
+      mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, strides, pad_h,
+      pad_w, dilation, 1));
+
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+TEST(Conv2d, PaddedStrided) {
+  Shape input_shape = {3, 3, 1};
+  Shape filter_shape = {3, 3, 1, 1};
+  Shape dst_shape = {2, 2, 1};
+  Shape strides = {2, 2};
+  Shape pad_h = {1, 1};
+  Shape pad_w = {1, 1};
+  Shape dilation = {1, 1};
+  std::vector<float> input_buffer(GetShapeElementCount(input_shape));
+  std::vector<float> filter_buffer(GetShapeElementCount(filter_shape));
+  std::vector<float> expected_dst = {94, 106, 106, 94};
+  for (int i = 0; i < GetShapeElementCount(input_shape); ++i) {
+    input_buffer[i] = i + 1;
+    filter_buffer[i] = i + 1;
+  }
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape), 0.0f);
+
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  EXPECT_OK(Conv2D::Execute<float>(
+      mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, strides, pad_h,
+      pad_w, dilation, 1));
+
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+TEST(Conv2d, PretransposedFilter) {
+  Shape input_shape = {3, 3, 2};
+  Shape filter_shape = {2, 2, 2, 3};
+  Shape dst_shape = {2, 2, 3};
+  Shape strides = {1, 1};
+  Shape pad_h = {0, 0};
+  Shape pad_w = {0, 0};
+  Shape dilation = {1, 1};
+  ASSERT_TRUE(Conv2D::UsesTransposedFilter(input_shape, filter_shape,
+                                           dst_shape, dilation, 1));
+  std::vector<float> input_buffer(GetShapeElementCount(input_shape));
+  std::vector<float> filter_buffer(GetShapeElementCount(filter_shape));
+  std::iota(input_buffer.begin(), input_buffer.end(), 1.0f);
+  std::iota(filter_buffer.begin(), filter_buffer.end(), -12.0f);
+  std::vector<float> filter_t(filter_buffer.size());
+  Conv2D::TransposeFilter<float>(filter_buffer, filter_shape,
+                                 absl::MakeSpan(filter_t));
+  std::vector<float> expected_dst(GetShapeElementCount(dst_shape), 0.0f);
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape), 0.0f);
+
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  EXPECT_OK(Conv2D::Execute<float>(
+      mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(expected_dst), dst_shape, strides, pad_h,
+      pad_w, dilation, 1));
+  EXPECT_OK(Conv2D::Execute<float>(
+      mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, strides, pad_h,
+      pad_w, dilation, 1, filter_t));
 
   for (int i = 0; i < dst_buffer.size(); ++i) {
     EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
@@ -524,16 +984,283 @@ TEST(Conv2d, DepthwiseConv) {
   }
   std::vector<float> dst_buffer(GetShapeElementCount(dst_shape), 0.0f);
 
-  EXPECT_OK(Conv2D::Execute<float>(input_buffer, input_shape, filter_buffer,
-                                   filter_shape, absl::MakeSpan(dst_buffer),
-                                   dst_shape, strides, pad_h, pad_w, dilation,
-                                   2));
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  EXPECT_OK(Conv2D::Execute<float>(
+      mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, strides, pad_h,
+      pad_w, dilation, 2));
 
   for (int i = 0; i < dst_buffer.size(); ++i) {
     EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
   }
 }
 
+// Runs the int8 Conv2D with i32 accumulation and expects it to match the f32
+// Conv2D on the same values, which computes them exactly for small filters.
+void ExpectConv2DInt8MatchesFloat(absl::Span<const int8_t> input_buffer,
+                                  const Shape& input_shape,
+                                  absl::Span<const int8_t> filter_buffer,
+                                  const Shape& filter_shape,
+                                  const Shape& dst_shape, int32_t groups) {
+  Shape strides = {1, 1};
+  Shape pad_h = {0, 0};
+  Shape pad_w = {0, 0};
+  Shape dilation = {1, 1};
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+
+  std::vector<int32_t> dst_buffer(GetShapeElementCount(dst_shape), 0);
+  EXPECT_OK((Conv2D::Execute<int8_t, int32_t>(
+      mat_mul_state.get(), input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, strides, pad_h,
+      pad_w, dilation, groups)));
+
+  std::vector<float> input_f32(input_buffer.begin(), input_buffer.end());
+  std::vector<float> filter_f32(filter_buffer.begin(), filter_buffer.end());
+  std::vector<float> dst_f32(GetShapeElementCount(dst_shape), 0.0f);
+  EXPECT_OK(Conv2D::Execute<float>(
+      mat_mul_state.get(), input_f32, input_shape, filter_f32, filter_shape,
+      absl::MakeSpan(dst_f32), dst_shape, strides, pad_h, pad_w, dilation,
+      groups));
+
+  std::vector<int32_t> expected_dst(dst_f32.begin(), dst_f32.end());
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+// Returns |size| int8 values cycling through the extremes and small values of
+// both signs.
+std::vector<int8_t> MakeInt8Values(int size, int offset) {
+  static const std::array<int8_t, 9> kValues = {-128, 127, -1, 0, 1,
+                                                 -127, 64,  -65, 3};
+  std::vector<int8_t> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = kValues[(i + offset) % kValues.size()];
+  }
+  return values;
+}
+
+TEST(Conv2d, PointwiseInt8) {
+  Shape input_shape = {2, 2, 3};
+  Shape filter_shape = {1, 1, 3, 2};
+  Shape dst_shape = {2, 2, 2};
+  auto input_buffer = MakeInt8Values(GetShapeElementCount(input_shape), 0);
+  auto filter_buffer = MakeInt8Values(GetShapeElementCount(filter_shape), 4);
+  ExpectConv2DInt8MatchesFloat(input_buffer, input_shape, filter_buffer,
+                               filter_shape, dst_shape, 1);
+}
+
+TEST(Conv2d, Im2ColInt8) {
+  Shape input_shape = {4, 5, 3};
+  Shape filter_shape = {3, 2, 3, 4};
+  Shape dst_shape = {2, 4, 4};
+  auto input_buffer = MakeInt8Values(GetShapeElementCount(input_shape), 1);
+  auto filter_buffer = MakeInt8Values(GetShapeElementCount(filter_shape), 2);
+  ExpectConv2DInt8MatchesFloat(input_buffer, input_shape, filter_buffer,
+                               filter_shape, dst_shape, 1);
+}
+
+TEST(Conv2d, DepthwiseConvInt8) {
+  Shape input_shape = {4, 5, 2};
+  Shape filter_shape = {3, 2, 2, 2};
+  Shape dst_shape = {2, 4, 4};
+  auto input_buffer = MakeInt8Values(GetShapeElementCount(input_shape), 3);
+  auto filter_buffer = MakeInt8Values(GetShapeElementCount(filter_shape), 5);
+  ExpectConv2DInt8MatchesFloat(input_buffer, input_shape, filter_buffer,
+                               filter_shape, dst_shape, 2);
+}
+
+// Products of the i8 extremes summed over a patch overflow i16 and must be
+// accumulated in i32.
+TEST(Conv2d, ExtremesInt8) {
+  Shape input_shape = {3, 3, 8};
+  Shape filter_shape = {3, 3, 8, 2};
+  Shape dst_shape = {1, 1, 2};
+  std::vector<int8_t> input_buffer(GetShapeElementCount(input_shape), -128);
+  std::vector<int8_t> filter_buffer(GetShapeElementCount(filter_shape));
+  for (int i = 0; i < filter_buffer.size(); ++i) {
+    filter_buffer[i] = i % 2 == 0 ? -128 : 127;
+  }
+  ExpectConv2DInt8MatchesFloat(input_buffer, input_shape, filter_buffer,
+                               filter_shape, dst_shape, 1);
+
+  Shape depthwise_filter_shape = {3, 3, 8, 1};
+  std::vector<int8_t> depthwise_filter_buffer(
+      GetShapeElementCount(depthwise_filter_shape), -128);
+  ExpectConv2DInt8MatchesFloat(input_buffer, input_shape,
+                               depthwise_filter_buffer, depthwise_filter_shape,
+                               Shape{1, 1, 8}, 8);
+}
+
+TEST(MatMul, Int8MatchesFloat) {
+  // lhs is (M, K) row-major and rhs is (N, K) as MatMul takes it transposed.
+  const int32_t m = 5, k = 70, n = 3;
+  auto lhs = MakeInt8Values(m * k, 0);
+  auto rhs = MakeInt8Values(n * k, 7);
+  // One column of the extremes accumulates to 70 * 128 * 128.
+  std::fill_n(lhs.begin(), k, -128);
+  std::fill_n(rhs.begin(), k, -128);
+  const std::array<int32_t, 2> lhs_shape = {m, k};
+  const std::array<int32_t, 2> rhs_shape = {n, k};
+  const std::array<int32_t, 2> dst_shape = {n, m};
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+
+  std::vector<int32_t> dst(n * m);
+  MatMul::Buffers<int8_t, int32_t, int32_t> buffers;
+  buffers.lhs_shape = lhs_shape;
+  buffers.lhs_buffer = lhs;
+  buffers.rhs_shape = rhs_shape;
+  buffers.rhs_buffer = rhs;
+  buffers.dst_shape = dst_shape;
+  buffers.dst_buffer = absl::MakeSpan(dst);
+  EXPECT_OK(MatMul::Execute(mat_mul_state.get(), buffers));
+
+  std::vector<float> lhs_f32(lhs.begin(), lhs.end());
+  std::vector<float> rhs_f32(rhs.begin(), rhs.end());
+  std::vector<float> dst_f32(n * m);
+  MatMul::Buffers<float, float, float> buffers_f32;
+  buffers_f32.lhs_shape = lhs_shape;
+  buffers_f32.lhs_buffer = lhs_f32;
+  buffers_f32.rhs_shape = rhs_shape;
+  buffers_f32.rhs_buffer = rhs_f32;
+  buffers_f32.dst_shape = dst_shape;
+  buffers_f32.dst_buffer = absl::MakeSpan(dst_f32);
+  EXPECT_OK(MatMul::Execute(mat_mul_state.get(), buffers_f32));
+
+  std::vector<int32_t> expected_dst(dst_f32.begin(), dst_f32.end());
+  EXPECT_EQ(dst, expected_dst);
+  EXPECT_EQ(dst[0], 70 * 128 * 128);
+}
+
+TEST(Gather, BatchDims) {
+  Shape shape = {2, 3};
+  std::vector<float> src_buffer = {10, 11, 12, 20, 21, 22};
+  std::vector<int32_t> indices_buffer = {2, 0, 1, 1, 1, 0};
+  std::vector<float> dst_buffer(GetShapeElementCount(shape));
+  std::vector<float> expected_dst = {12, 10, 11, 21, 21, 20};
+
+  EXPECT_OK(Gather::Execute<float>(src_buffer, indices_buffer,
+                                   absl::MakeSpan(dst_buffer), shape, shape,
+                                   shape, /*dim=*/1, /*batch_dims=*/1));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Gather, ConsecutiveIndices) {
+  Shape src_shape = {5, 2};
+  std::vector<float> src_buffer = {0, 1, 10, 11, 20, 21, 30, 31, 40, 41};
+  Shape indices_shape = {5};
+  // Copied as the runs [1, 2, 3] and [0, 1].
+  std::vector<int32_t> indices_buffer = {1, 2, 3, 0, 1};
+  Shape dst_shape = {5, 2};
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  std::vector<float> expected_dst = {10, 11, 20, 21, 30, 31, 0, 1, 10, 11};
+
+  EXPECT_OK(Gather::Execute<float>(
+      src_buffer, indices_buffer, absl::MakeSpan(dst_buffer), src_shape,
+      indices_shape, dst_shape, /*dim=*/0, /*batch_dims=*/0));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Gather, NonConsecutiveIndices) {
+  Shape src_shape = {5, 2};
+  std::vector<float> src_buffer = {0, 1, 10, 11, 20, 21, 30, 31, 40, 41};
+  Shape indices_shape = {5};
+  std::vector<int32_t> indices_buffer = {4, 2, 0, 3, 2};
+  Shape dst_shape = {5, 2};
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  std::vector<float> expected_dst = {40, 41, 20, 21, 0, 1, 30, 31, 20, 21};
+
+  EXPECT_OK(Gather::Execute<float>(
+      src_buffer, indices_buffer, absl::MakeSpan(dst_buffer), src_shape,
+      indices_shape, dst_shape, /*dim=*/0, /*batch_dims=*/0));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Gather, InnerDimensionIndices) {
+  Shape src_shape = {2, 4};
+  std::vector<float> src_buffer = {0, 1, 2, 3, 10, 11, 12, 13};
+  Shape indices_shape = {3};
+  // Every row shares the indices, copied as the runs [1, 2] and [0].
+  std::vector<int32_t> indices_buffer = {1, 2, 0};
+  Shape dst_shape = {2, 3};
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  std::vector<float> expected_dst = {1, 2, 0, 11, 12, 10};
+
+  EXPECT_OK(Gather::Execute<float>(
+      src_buffer, indices_buffer, absl::MakeSpan(dst_buffer), src_shape,
+      indices_shape, dst_shape, /*dim=*/1, /*batch_dims=*/0));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Gather, BatchDimsConsecutiveIndices) {
+  Shape src_shape = {2, 4, 2};
+  // clang-format off
+  std::vector<float> src_buffer = {  0,   1,  10,  11,  20,  21,  30,  31,
+                                   100, 101, 110, 111, 120, 121, 130, 131};
+  // clang-format on
+  Shape indices_shape = {2, 3};
+  // The first batch is a single run and the second the runs [2] and [0, 1].
+  std::vector<int32_t> indices_buffer = {1, 2, 3, 2, 0, 1};
+  Shape dst_shape = {2, 3, 2};
+  std::vector<float> dst_buffer(GetShapeElementCount(dst_shape));
+  // clang-format off
+  std::vector<float> expected_dst = { 10,  11,  20,  21,  30,  31,
+                                     120, 121, 100, 101, 110, 111};
+  // clang-format on
+
+  EXPECT_OK(Gather::Execute<float>(
+      src_buffer, indices_buffer, absl::MakeSpan(dst_buffer), src_shape,
+      indices_shape, dst_shape, /*dim=*/1, /*batch_dims=*/1));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Sort, Rows) {
+  Shape src_shape = {2, 4};
+  std::vector<float> src_buffer = {3, -1, 3, 0, 2, -0.0f, 0, NAN};
+  std::vector<int32_t> dst_buffer(GetShapeElementCount(src_shape));
+  // Equal keys keep their order, -0 equals +0 and NaN sorts last.
+  std::vector<int32_t> expected_ascending = {1, 3, 0, 2, 1, 2, 0, 3};
+  std::vector<int32_t> expected_descending = {0, 2, 3, 1, 3, 0, 1, 2};
+
+  EXPECT_OK(Sort::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer),
+                                 src_shape, /*descending=*/false));
+  EXPECT_EQ(dst_buffer, expected_ascending);
+  EXPECT_OK(Sort::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer),
+                                 src_shape, /*descending=*/true));
+  EXPECT_EQ(dst_buffer, expected_descending);
+}
+
+TEST(Sort, LongRows) {
+  // Long enough rows to take the radix sort path.
+  constexpr int kSize = 1000;
+  Shape src_shape = {kSize};
+  std::vector<int32_t> src_buffer(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    src_buffer[i] = (i * 7919) % 101 - 50;
+  }
+  std::vector<int32_t> dst_buffer(kSize);
+  std::vector<int32_t> expected_dst(kSize);
+  std::iota(expected_dst.begin(), expected_dst.end(), 0);
+  std::stable_sort(expected_dst.begin(), expected_dst.end(),
+                   [&](int32_t lhs, int32_t rhs) {
+                     return src_buffer[lhs] < src_buffer[rhs];
+                   });
+
+  EXPECT_OK(Sort::Execute<int32_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                   src_shape, /*descending=*/false));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(TopK, Rows) {
+  Shape src_shape = {2, 5};
+  Shape dst_shape = {2, 2};
+  std::vector<int8_t> src_buffer = {1, 5, 3, 5, 2, -4, -3, -2, -1, -5};
+  std::vector<int32_t> dst_buffer(GetShapeElementCount(dst_shape));
+  std::vector<int32_t> expected_dst = {1, 3, 3, 2};
+
+  EXPECT_OK(TopK::Execute<int8_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                  src_shape, dst_shape, /*descending=*/true));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
 }  // namespace
 }  // namespace kernels
 }  // namespace vmla
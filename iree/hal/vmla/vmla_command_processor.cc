@@ -34,19 +34,13 @@ VMLACommandProcessor::VMLACommandProcessor(
 
 VMLACommandProcessor::~VMLACommandProcessor() = default;
 
-Status VMLACommandProcessor::DispatchInline(
-    Executable* executable, int32_t entry_point,
-    std::array<uint32_t, 3> workgroups, const PushConstantBlock& push_constants,
-    absl::Span<const absl::Span<const DescriptorSet::Binding>> set_bindings) {
-  IREE_TRACE_SCOPE0("VMLACommandProcessor::DispatchInline");
-
-  auto* vmla_executable = static_cast<VMLAExecutable*>(executable);
-  if (entry_point >= vmla_executable->entry_functions().size()) {
-    return InvalidArgumentErrorBuilder(IREE_LOC)
-           << "Invalid entry point ordinal " << entry_point;
-  }
+namespace {
 
-  auto interface = vmla_executable->interface();
+Status InvokeDispatch(
+    VMLAExecutable::DispatchState* dispatch_state,
+    iree_vm_function_t entry_function, const PushConstantBlock& push_constants,
+    absl::Span<const absl::Span<const DescriptorSet::Binding>> set_bindings) {
+  auto* interface = dispatch_state->interface;
   RETURN_IF_ERROR(interface->SetConstants(push_constants.values));
 
   for (int set_ordinal = 0; set_ordinal < set_bindings.size(); ++set_ordinal) {
@@ -65,13 +59,37 @@ Status VMLACommandProcessor::DispatchInline(
   }
 
   return FromApiStatus(
-      iree_vm_invoke(vmla_executable->context(),
-                     vmla_executable->entry_functions()[entry_point],
-                     /*policy=*/nullptr, vmla_executable->interface_inputs(),
+      iree_vm_invoke(dispatch_state->context, entry_function,
+                     /*policy=*/nullptr, dispatch_state->interface_inputs,
                      /*outputs=*/nullptr, IREE_ALLOCATOR_SYSTEM),
       IREE_LOC);
 }
 
+}  // namespace
+
+Status VMLACommandProcessor::DispatchInline(
+    Executable* executable, int32_t entry_point,
+    std::array<uint32_t, 3> workgroups, const PushConstantBlock& push_constants,
+    absl::Span<const absl::Span<const DescriptorSet::Binding>> set_bindings) {
+  IREE_TRACE_SCOPE0("VMLACommandProcessor::DispatchInline");
+
+  auto* vmla_executable = static_cast<VMLAExecutable*>(executable);
+  if (entry_point >= vmla_executable->entry_functions().size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid entry point ordinal " << entry_point;
+  }
+
+  // Each dispatch gets its own context (and interface) so that the same
+  // executable can be dispatched concurrently from other queues or threads.
+  ASSIGN_OR_RETURN(auto* dispatch_state,
+                   vmla_executable->AcquireDispatchState());
+  auto status = InvokeDispatch(
+      dispatch_state, vmla_executable->entry_functions()[entry_point],
+      push_constants, set_bindings);
+  vmla_executable->ReleaseDispatchState(dispatch_state);
+  return status;
+}
+
 }  // namespace vmla
 }  // namespace hal
 }  // namespace iree
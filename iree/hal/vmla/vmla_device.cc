@@ -181,8 +181,10 @@ Status VMLADevice::WaitAllSemaphores(
 StatusOr<int> VMLADevice::WaitAnySemaphore(
     absl::Span<const SemaphoreValue> semaphores, absl::Time deadline) {
   IREE_TRACE_SCOPE0("VMLADevice::WaitAnySemaphore");
-  return HostSemaphore::WaitForSemaphores(semaphores, /*wait_all=*/false,
-                                          deadline);
+  int signaled_index = 0;
+  RETURN_IF_ERROR(HostSemaphore::WaitForSemaphores(
+      semaphores, /*wait_all=*/false, deadline, &signaled_index));
+  return signaled_index;
 }
 
 Status VMLADevice::WaitIdle(absl::Time deadline) {
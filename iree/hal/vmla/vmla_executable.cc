@@ -50,9 +50,19 @@ VMLAExecutable::VMLAExecutable(ExecutableSpec spec, bool allow_aliasing_data)
 
 VMLAExecutable::~VMLAExecutable() {
   IREE_TRACE_SCOPE0("VMLAExecutable::dtor");
-  iree_vm_variant_list_free(interface_inputs_);
-  iree_vm_context_release(context_);
-  context_ = nullptr;
+  {
+    absl::MutexLock lock(&dispatch_state_mutex_);
+    free_dispatch_states_.clear();
+    dispatch_states_.clear();
+  }
+  iree_vm_module_release(bytecode_module_);
+  iree_vm_module_release(vmla_module_);
+  iree_vm_instance_release(instance_);
+}
+
+VMLAExecutable::DispatchState::~DispatchState() {
+  iree_vm_variant_list_free(interface_inputs);
+  iree_vm_context_release(context);
 }
 
 Status VMLAExecutable::Initialize(iree_vm_instance_t* instance,
@@ -75,57 +85,106 @@ Status VMLAExecutable::Initialize(iree_vm_instance_t* instance,
            << "Failed getting root from flatbuffer data";
   }
 
-  // Load bytecode module from the executable spec.
-  iree_vm_module_t* bytecode_module = nullptr;
+  instance_ = instance;
+  iree_vm_instance_retain(instance_);
+  vmla_module_ = vmla_module;
+  iree_vm_module_retain(vmla_module_);
+
+  // Load bytecode module from the executable spec. It is retained so that
+  // additional contexts can be created as dispatch concurrency grows.
   RETURN_IF_ERROR(FromApiStatus(
       iree_vm_bytecode_module_create(
           iree_const_byte_span_t{reinterpret_cast<const uint8_t*>(
                                      executable_def->bytecode_module()->data()),
                                  executable_def->bytecode_module()->size()},
-          IREE_ALLOCATOR_NULL, IREE_ALLOCATOR_SYSTEM, &bytecode_module),
+          IREE_ALLOCATOR_NULL, IREE_ALLOCATOR_SYSTEM, &bytecode_module_),
       IREE_LOC))
       << "Failed to load executable bytecode module";
 
   entry_functions_.resize(
-      iree_vm_module_signature(bytecode_module).export_function_count);
+      iree_vm_module_signature(bytecode_module_).export_function_count);
   for (int i = 0; i < entry_functions_.size(); ++i) {
     RETURN_IF_ERROR(
         FromApiStatus(iree_vm_module_lookup_function_by_ordinal(
-                          bytecode_module, IREE_VM_FUNCTION_LINKAGE_EXPORT, i,
+                          bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT, i,
                           &entry_functions_[i], nullptr),
                       IREE_LOC));
   }
 
-  // Create context and initialize shared state. Note that each executable here
-  // has its own context (and thus its own vmla.interface instance).
-  std::array<iree_vm_module_t*, 2> modules = {vmla_module, bytecode_module};
-  auto result = FromApiStatus(iree_vm_context_create_with_modules(
-                                  instance, modules.data(), modules.size(),
-                                  IREE_ALLOCATOR_SYSTEM, &context_),
-                              IREE_LOC)
-                << "Failed resolving imports for executable module";
-  iree_vm_module_release(bytecode_module);
-  RETURN_IF_ERROR(result);
+  // Eagerly create the first context so that import resolution failures are
+  // reported at load time and single-threaded dispatch never creates one.
+  ASSIGN_OR_RETURN(auto dispatch_state, CreateDispatchState());
+  absl::MutexLock lock(&dispatch_state_mutex_);
+  free_dispatch_states_.push_back(dispatch_state.get());
+  dispatch_states_.push_back(std::move(dispatch_state));
+
+  return OkStatus();
+}
+
+StatusOr<std::unique_ptr<VMLAExecutable::DispatchState>>
+VMLAExecutable::CreateDispatchState() {
+  IREE_TRACE_SCOPE0("VMLAExecutable::CreateDispatchState");
+
+  // Create context and initialize shared state. Note that each context has its
+  // own vmla.interface instance.
+  auto dispatch_state = std::make_unique<DispatchState>();
+  std::array<iree_vm_module_t*, 2> modules = {vmla_module_, bytecode_module_};
+  RETURN_IF_ERROR(FromApiStatus(iree_vm_context_create_with_modules(
+                                    instance_, modules.data(), modules.size(),
+                                    IREE_ALLOCATOR_SYSTEM,
+                                    &dispatch_state->context),
+                                IREE_LOC))
+      << "Failed resolving imports for executable module";
 
   // Query the Interface block we'll use to set bindings during invocation.
   iree_vm_module_state_t* module_state = nullptr;
-  RETURN_IF_ERROR(FromApiStatus(iree_vm_context_resolve_module_state(
-                                    context(), vmla_module, &module_state),
-                                IREE_LOC));
-  interface_ = ModuleStateInterface(module_state);
+  RETURN_IF_ERROR(
+      FromApiStatus(iree_vm_context_resolve_module_state(
+                        dispatch_state->context, vmla_module_, &module_state),
+                    IREE_LOC));
+  dispatch_state->interface = ModuleStateInterface(module_state);
 
   // Preallocate the variant list we'll use to pass the interface into
   // executables. This makes dispatches zero-allocation (well, on the outside
   // anyway!).
   RETURN_IF_ERROR(FromApiStatus(
-      iree_vm_variant_list_alloc(1, IREE_ALLOCATOR_SYSTEM, &interface_inputs_),
-      IREE_LOC));
-  auto interface_ref = Interface_retain_ref(interface_);
-  RETURN_IF_ERROR(FromApiStatus(
-      iree_vm_variant_list_append_ref_move(interface_inputs_, &interface_ref),
+      iree_vm_variant_list_alloc(1, IREE_ALLOCATOR_SYSTEM,
+                                 &dispatch_state->interface_inputs),
       IREE_LOC));
+  auto interface_ref = Interface_retain_ref(dispatch_state->interface);
+  RETURN_IF_ERROR(
+      FromApiStatus(iree_vm_variant_list_append_ref_move(
+                        dispatch_state->interface_inputs, &interface_ref),
+                    IREE_LOC));
 
-  return OkStatus();
+  return dispatch_state;
+}
+
+StatusOr<VMLAExecutable::DispatchState*>
+VMLAExecutable::AcquireDispatchState() {
+  {
+    absl::MutexLock lock(&dispatch_state_mutex_);
+    if (!free_dispatch_states_.empty()) {
+      auto* dispatch_state = free_dispatch_states_.back();
+      free_dispatch_states_.pop_back();
+      return dispatch_state;
+    }
+  }
+
+  // All contexts are in use; create a new one outside of the lock as it is
+  // comparatively expensive. It joins the pool when released.
+  ASSIGN_OR_RETURN(auto dispatch_state, CreateDispatchState());
+  auto* dispatch_state_ptr = dispatch_state.get();
+  absl::MutexLock lock(&dispatch_state_mutex_);
+  dispatch_states_.push_back(std::move(dispatch_state));
+  return dispatch_state_ptr;
+}
+
+void VMLAExecutable::ReleaseDispatchState(DispatchState* dispatch_state) {
+  // Drop the bindings so that buffers are not kept alive by idle contexts.
+  dispatch_state->interface->Reset();
+  absl::MutexLock lock(&dispatch_state_mutex_);
+  free_dispatch_states_.push_back(dispatch_state);
 }
 
 }  // namespace vmla
@@ -15,9 +15,11 @@
 #ifndef IREE_HAL_VMLA_VMLA_EXECUTABLE_H_
 #define IREE_HAL_VMLA_VMLA_EXECUTABLE_H_
 
+#include <memory>
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "iree/base/status.h"
 #include "iree/hal/allocator.h"
@@ -34,6 +36,15 @@ namespace vmla {
 
 class Interface;
 
+// A loaded VMLA executable that may be dispatched concurrently.
+//
+// VM contexts hold per-invocation state (the vmla.interface bindings, scratch
+// buffers, and kernel state) and as such cannot be invoked concurrently. Each
+// executable keeps a pool of contexts and every dispatch in flight acquires its
+// own for the duration of its invocation; the pool grows to the maximum
+// observed dispatch concurrency and contexts are then reused.
+//
+// Thread-safe.
 class VMLAExecutable final : public Executable {
  public:
   static StatusOr<ref_ptr<VMLAExecutable>> Load(iree_vm_instance_t* instance,
@@ -51,31 +62,53 @@ class VMLAExecutable final : public Executable {
     return spec_.executable_data;
   }
 
-  // VM context containing the loaded executable module.
-  iree_vm_context_t* context() const { return context_; }
-
   // Entry point functions in export order.
   absl::Span<const iree_vm_function_t> entry_functions() const {
     return absl::MakeConstSpan(entry_functions_);
   }
 
-  // ABI vmla.interface binding block.
-  Interface* interface() const { return interface_; }
+  // State exclusively owned by a single dispatch while it is executing.
+  struct DispatchState {
+    ~DispatchState();
+
+    // VM context containing the loaded executable module.
+    iree_vm_context_t* context = nullptr;
+    // ABI vmla.interface binding block of the context.
+    Interface* interface = nullptr;
+    // Entry point inputs list of the single vmla.interface.
+    iree_vm_variant_list_t* interface_inputs = nullptr;
+  };
 
-  // Entry point inputs list of a single vmla.interface.
-  iree_vm_variant_list_t* interface_inputs() const { return interface_inputs_; }
+  // Acquires dispatch state for exclusive use by the caller, creating a new
+  // context if all existing ones are in use by other dispatches. The state
+  // must be returned with ReleaseDispatchState once the invocation completes.
+  StatusOr<DispatchState*> AcquireDispatchState();
+
+  // Returns dispatch state acquired with AcquireDispatchState to the pool.
+  void ReleaseDispatchState(DispatchState* dispatch_state);
 
  private:
   Status Initialize(iree_vm_instance_t* instance,
                     iree_vm_module_t* vmla_module);
 
+  StatusOr<std::unique_ptr<DispatchState>> CreateDispatchState();
+
   ExecutableSpec spec_;
   std::vector<uint8_t> cloned_executable_data_;
 
-  iree_vm_context_t* context_ = nullptr;
+  // Retained for creating additional contexts as dispatch concurrency grows.
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_module_t* vmla_module_ = nullptr;
+  iree_vm_module_t* bytecode_module_ = nullptr;
   absl::InlinedVector<iree_vm_function_t, 4> entry_functions_;
-  Interface* interface_ = nullptr;
-  iree_vm_variant_list_t* interface_inputs_ = nullptr;
+
+  // The mutex only guards the pool bookkeeping and is never held across an
+  // invocation or while creating contexts.
+  absl::Mutex dispatch_state_mutex_;
+  std::vector<std::unique_ptr<DispatchState>> dispatch_states_
+      ABSL_GUARDED_BY(dispatch_state_mutex_);
+  std::vector<DispatchState*> free_dispatch_states_
+      ABSL_GUARDED_BY(dispatch_state_mutex_);
 };
 
 }  // namespace vmla
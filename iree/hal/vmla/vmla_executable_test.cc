@@ -0,0 +1,200 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests dispatching VMLA executables concurrently.
+//
+// vmla_executable_test.mlir contains the entry points used here. We avoid
+// compiling the executable as part of the test so that we can run this test on
+// platforms that we can't run the full MLIR compiler stack on.
+
+#include "iree/hal/vmla/vmla_executable.h"
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "iree/base/api_util.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/vmla/vmla_executable_test_module.h"
+#include "iree/hal/vmla/vmla_module.h"
+#include "iree/schemas/vmla_executable_def_generated.h"
+#include "iree/testing/gtest.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/invocation.h"
+
+namespace iree {
+namespace hal {
+namespace vmla {
+namespace {
+
+constexpr int kM = 4;
+constexpr int kK = 8;
+constexpr int kN = 4;
+
+class VMLAExecutableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_vm_instance_create(IREE_ALLOCATOR_SYSTEM, &instance_));
+    ASSERT_OK(ModuleRegisterTypes());
+    ASSERT_OK(ModuleCreate(IREE_ALLOCATOR_SYSTEM, &vmla_module_));
+
+    // Wrap the bytecode module in an executable as the compiler would.
+    const auto* module_file_toc = vmla_executable_test_module_create();
+    ::flatbuffers::FlatBufferBuilder fbb;
+    iree::VMLAExecutableDefT executable_def;
+    executable_def.bytecode_module.resize(module_file_toc->size);
+    std::memcpy(executable_def.bytecode_module.data(), module_file_toc->data,
+                module_file_toc->size);
+    iree::FinishVMLAExecutableDefBuffer(
+        fbb, iree::VMLAExecutableDef::Pack(fbb, &executable_def));
+    executable_data_.resize(fbb.GetSize());
+    std::memcpy(executable_data_.data(), fbb.GetBufferPointer(),
+                executable_data_.size());
+
+    ExecutableSpec spec;
+    spec.executable_data = absl::MakeConstSpan(executable_data_);
+    ASSERT_OK_AND_ASSIGN(executable_,
+                         VMLAExecutable::Load(instance_, vmla_module_, spec,
+                                              /*allow_aliasing_data=*/false));
+  }
+
+  void TearDown() override {
+    executable_.reset();
+    iree_vm_module_release(vmla_module_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Dispatches the matmul entry point with the given bindings in the same way
+  // as VMLACommandProcessor and returns the dispatch state that was used.
+  StatusOr<VMLAExecutable::DispatchState*> DispatchMatMul(
+      absl::Span<float> lhs, absl::Span<float> rhs, absl::Span<float> dst) {
+    ASSIGN_OR_RETURN(auto* dispatch_state,
+                     executable_->AcquireDispatchState());
+    auto status = [&]() -> Status {
+      auto* interface = dispatch_state->interface;
+      int32_t binding = 0;
+      for (auto span : {lhs, rhs, dst}) {
+        ASSIGN_OR_RETURN(auto buffer,
+                         Buffer::WrapMutable(span.data(),
+                                             span.size() * sizeof(float),
+                                             IREE_ALLOCATOR_NULL));
+        RETURN_IF_ERROR(
+            interface->SetBinding(/*set=*/0, binding++, {std::move(buffer)}));
+      }
+      return FromApiStatus(
+          iree_vm_invoke(dispatch_state->context,
+                         executable_->entry_functions()[0],
+                         /*policy=*/nullptr, dispatch_state->interface_inputs,
+                         /*outputs=*/nullptr, IREE_ALLOCATOR_SYSTEM),
+          IREE_LOC);
+    }();
+    executable_->ReleaseDispatchState(dispatch_state);
+    RETURN_IF_ERROR(status);
+    return dispatch_state;
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_module_t* vmla_module_ = nullptr;
+  std::vector<uint8_t> executable_data_;
+  ref_ptr<VMLAExecutable> executable_;
+};
+
+// Returns the (N, M) result of the (M, K) lhs and the (N, K) rhs.
+std::vector<float> ReferenceMatMul(absl::Span<const float> lhs,
+                                   absl::Span<const float> rhs) {
+  std::vector<float> dst(kN * kM, 0.0f);
+  for (int n = 0; n < kN; ++n) {
+    for (int m = 0; m < kM; ++m) {
+      for (int k = 0; k < kK; ++k) {
+        dst[n * kM + m] += lhs[m * kK + k] * rhs[n * kK + k];
+      }
+    }
+  }
+  return dst;
+}
+
+// Tests that released dispatch states do not retain their bindings.
+TEST_F(VMLAExecutableTest, ReleaseResetsBindings) {
+  std::vector<float> lhs(kM * kK, 1.0f);
+  std::vector<float> rhs(kN * kK, 2.0f);
+  std::vector<float> dst(kN * kM, 0.0f);
+  ASSERT_OK_AND_ASSIGN(
+      auto* dispatch_state,
+      DispatchMatMul(absl::MakeSpan(lhs), absl::MakeSpan(rhs),
+                     absl::MakeSpan(dst)));
+  EXPECT_EQ(dst, ReferenceMatMul(lhs, rhs));
+  for (int32_t binding = 0; binding < 3; ++binding) {
+    ASSERT_OK_AND_ASSIGN(auto value,
+                         dispatch_state->interface->GetBinding(0, binding));
+    EXPECT_FALSE(value.buffer);
+  }
+
+  // Sequential dispatches reuse the same state.
+  ASSERT_OK_AND_ASSIGN(
+      auto* next_dispatch_state,
+      DispatchMatMul(absl::MakeSpan(lhs), absl::MakeSpan(rhs),
+                     absl::MakeSpan(dst)));
+  EXPECT_EQ(dispatch_state, next_dispatch_state);
+}
+
+// Tests that one executable can be dispatched from multiple threads at once,
+// each with its own bindings, and that dispatch states are reused.
+TEST_F(VMLAExecutableTest, ConcurrentDispatch) {
+  constexpr int kThreadCount = 8;
+  constexpr int kDispatchesPerThread = 32;
+
+  absl::Mutex mutex;
+  std::set<VMLAExecutable::DispatchState*> dispatch_states;
+  std::vector<Status> statuses(kThreadCount);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&, t]() {
+      statuses[t] = [&]() -> Status {
+        for (int i = 0; i < kDispatchesPerThread; ++i) {
+          // Values are distinct per thread and dispatch so that any binding
+          // leaking across dispatches produces a wrong result.
+          std::vector<float> lhs(kM * kK);
+          std::vector<float> rhs(kN * kK);
+          for (int j = 0; j < kM * kK; ++j) lhs[j] = t + j % 5;
+          for (int j = 0; j < kN * kK; ++j) rhs[j] = i - j % 3;
+          std::vector<float> dst(kN * kM, -1.0f);
+          ASSIGN_OR_RETURN(
+              auto* dispatch_state,
+              DispatchMatMul(absl::MakeSpan(lhs), absl::MakeSpan(rhs),
+                             absl::MakeSpan(dst)));
+          if (dst != ReferenceMatMul(lhs, rhs)) {
+            return InternalErrorBuilder(IREE_LOC)
+                   << "Wrong result on thread " << t << " dispatch " << i;
+          }
+          absl::MutexLock lock(&mutex);
+          dispatch_states.insert(dispatch_state);
+        }
+        return OkStatus();
+      }();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (const auto& status : statuses) EXPECT_OK(status);
+
+  // The pool never grows beyond the number of dispatches in flight.
+  EXPECT_FALSE(dispatch_states.empty());
+  EXPECT_LE(dispatch_states.size(), static_cast<size_t>(kThreadCount));
+}
+
+}  // namespace
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,33 @@
+// Entry points dispatched by vmla_executable_test.cc. These are written
+// against the vmla imports directly so that the test does not depend on the
+// compiler lowering of any particular op.
+vm.module @vmla_executable_test {
+  vm.import @vmla.interface.binding(
+    %interface : !vm.ref<!vmla.interface>,
+    %set : i32,
+    %binding : i32
+  ) -> !vm.ref<!vmla.buffer>
+  attributes {nosideeffects}
+
+  vm.import @vmla.batch.matmul.f32f32.f32(
+    %lhs : !vm.ref<!vmla.buffer>, %lhs_shape : i32 ...,
+    %rhs : !vm.ref<!vmla.buffer>, %rhs_shape : i32 ...,
+    %dst : !vm.ref<!vmla.buffer>, %dst_shape : i32 ...
+  )
+
+  // Multiplies the 4x8 lhs in binding 0 by the 4x8 (transposed) rhs in
+  // binding 1 into the 4x4 (transposed) dst in binding 2.
+  vm.export @matmul
+  vm.func @matmul(%interface : !vm.ref<!vmla.interface>) {
+    %c0 = vm.const.i32.zero : i32
+    %c1 = vm.const.i32 1 : i32
+    %c2 = vm.const.i32 2 : i32
+    %c4 = vm.const.i32 4 : i32
+    %c8 = vm.const.i32 8 : i32
+    %lhs = vm.call @vmla.interface.binding(%interface, %c0, %c0) : (!vm.ref<!vmla.interface>, i32, i32) -> !vm.ref<!vmla.buffer>
+    %rhs = vm.call @vmla.interface.binding(%interface, %c0, %c1) : (!vm.ref<!vmla.interface>, i32, i32) -> !vm.ref<!vmla.buffer>
+    %dst = vm.call @vmla.interface.binding(%interface, %c0, %c2) : (!vm.ref<!vmla.interface>, i32, i32) -> !vm.ref<!vmla.buffer>
+    vm.call.variadic @vmla.batch.matmul.f32f32.f32(%lhs, [%c1, %c4, %c8], %rhs, [%c1, %c4, %c8], %dst, [%c1, %c4, %c4]) : (!vm.ref<!vmla.buffer>, i32 ..., !vm.ref<!vmla.buffer>, i32 ..., !vm.ref<!vmla.buffer>, i32 ...)
+    vm.return
+  }
+}
@@ -14,8 +14,12 @@
 
 #include "iree/hal/vmla/vmla_module.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/vmla/op_kernels.h"
@@ -182,19 +186,51 @@ Status Interface::SetBinding(int32_t set, int32_t binding, Binding value) {
 
 namespace {
 
-// Per-executable VMLA module state.
+// Returns |src| as |CT| values, widening them into |storage| if needed.
+template <typename CT>
+absl::Span<const CT> WidenSpan(absl::Span<const CT> src, std::vector<CT>*) {
+  return src;
+}
+template <typename CT, typename T>
+absl::Span<const CT> WidenSpan(absl::Span<const T> src,
+                               std::vector<CT>* storage) {
+  storage->assign(src.begin(), src.end());
+  return *storage;
+}
+
+// Returns a span of |CT| values to compute |dst| into, using |storage| if
+// needed. Results must then be written back with NarrowSpan.
+template <typename CT>
+absl::Span<CT> ComputeSpan(absl::Span<CT> dst, std::vector<CT>*) {
+  return dst;
+}
+template <typename CT, typename T>
+absl::Span<CT> ComputeSpan(absl::Span<T> dst, std::vector<CT>* storage) {
+  storage->resize(dst.size());
+  return absl::MakeSpan(*storage);
+}
+
+// Writes the |CT| values computed for |dst| by ComputeSpan to |dst|.
+template <typename CT>
+void NarrowSpan(absl::Span<CT>, absl::Span<CT>) {}
+template <typename CT, typename T>
+void NarrowSpan(absl::Span<CT> src, absl::Span<T> dst) {
+  std::copy(src.begin(), src.end(), dst.begin());
+}
+
+// Per-context VMLA module state.
 // This provides the exported kernel functions to the VM and is instantiated
-// one or more times per executable used within a device. Any state here can be
+// once per context. Executables create one context for each dispatch that may
+// be in flight concurrently (see VMLAExecutable) so any state here can be
 // treated as workgroup-local memory.
 //
 // Thread-compatible.
 class VMLAModuleState final {
  public:
-  VMLAModuleState(iree_allocator_t allocator,
-                  kernels::RuntimeState* kernel_state)
+  explicit VMLAModuleState(iree_allocator_t allocator)
       : allocator_(allocator),
         interface_(vm::assign_ref(new Interface())),
-        kernel_state_(kernel_state) {}
+        kernel_state_(std::make_unique<kernels::RuntimeState>()) {}
 
   ~VMLAModuleState() = default;
 
@@ -243,6 +279,17 @@ class VMLAModuleState final {
     return Buffer::Allocate(byte_length, allocator_);
   }
 
+  StatusOr<vm::ref<Buffer>> BufferScratch(iree_vmla_size_t byte_length) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BufferScratch");
+    // The scratch block is only grown, never shrunk, so that steady-state
+    // invocations perform no allocations. Views handed out from a previous
+    // (smaller) block keep that block alive until they are released.
+    if (!scratch_ || scratch_->size() < byte_length) {
+      ASSIGN_OR_RETURN(scratch_, Buffer::Allocate(byte_length, allocator_));
+    }
+    return vm::retain_ref(scratch_);
+  }
+
   StatusOr<vm::ref<Buffer>> BufferClone(vm::ref<Buffer> src) {
     IREE_TRACE_SCOPE0("VMLAModuleState::BufferClone");
     ASSIGN_OR_RETURN(auto dst, Buffer::Allocate(src->size(), allocator_));
@@ -407,6 +454,8 @@ class VMLAModuleState final {
   IREE_VMLA_COMPARE_OP(CmpI16, int16_t);
   IREE_VMLA_COMPARE_OP(CmpI32, int32_t);
   IREE_VMLA_COMPARE_OP(CmpF32, float);
+  IREE_VMLA_COMPARE_OP(CmpF16, kernels::Float16);
+  IREE_VMLA_COMPARE_OP(CmpBF16, kernels::BFloat16);
 
 #define IREE_VMLA_SELECT_OP(name, type)                                       \
   Status name(vm::ref<Buffer> cond, vm::ref<Buffer> lhs, vm::ref<Buffer> rhs, \
@@ -549,22 +598,32 @@ class VMLAModuleState final {
   IREE_VMLA_BINARY_OP(AddI16, kernels::Add, int16_t);
   IREE_VMLA_BINARY_OP(AddI32, kernels::Add, int32_t);
   IREE_VMLA_BINARY_OP(AddF32, kernels::Add, float);
+  IREE_VMLA_BINARY_OP(AddF16, kernels::Add, kernels::Float16);
+  IREE_VMLA_BINARY_OP(AddBF16, kernels::Add, kernels::BFloat16);
   IREE_VMLA_BINARY_OP(SubI8, kernels::Sub, int8_t);
   IREE_VMLA_BINARY_OP(SubI16, kernels::Sub, int16_t);
   IREE_VMLA_BINARY_OP(SubI32, kernels::Sub, int32_t);
   IREE_VMLA_BINARY_OP(SubF32, kernels::Sub, float);
+  IREE_VMLA_BINARY_OP(SubF16, kernels::Sub, kernels::Float16);
+  IREE_VMLA_BINARY_OP(SubBF16, kernels::Sub, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(AbsI8, kernels::Abs, int8_t);
   IREE_VMLA_UNARY_OP(AbsI16, kernels::Abs, int16_t);
   IREE_VMLA_UNARY_OP(AbsI32, kernels::Abs, int32_t);
   IREE_VMLA_UNARY_OP(AbsF32, kernels::Abs, float);
+  IREE_VMLA_UNARY_OP(AbsF16, kernels::Abs, kernels::Float16);
+  IREE_VMLA_UNARY_OP(AbsBF16, kernels::Abs, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(NegI8, kernels::Neg, int8_t);
   IREE_VMLA_UNARY_OP(NegI16, kernels::Neg, int16_t);
   IREE_VMLA_UNARY_OP(NegI32, kernels::Neg, int32_t);
   IREE_VMLA_UNARY_OP(NegF32, kernels::Neg, float);
+  IREE_VMLA_UNARY_OP(NegF16, kernels::Neg, kernels::Float16);
+  IREE_VMLA_UNARY_OP(NegBF16, kernels::Neg, kernels::BFloat16);
   IREE_VMLA_BINARY_OP(MulI8, kernels::Mul, int8_t);
   IREE_VMLA_BINARY_OP(MulI16, kernels::Mul, int16_t);
   IREE_VMLA_BINARY_OP(MulI32, kernels::Mul, int32_t);
   IREE_VMLA_BINARY_OP(MulF32, kernels::Mul, float);
+  IREE_VMLA_BINARY_OP(MulF16, kernels::Mul, kernels::Float16);
+  IREE_VMLA_BINARY_OP(MulBF16, kernels::Mul, kernels::BFloat16);
   IREE_VMLA_BINARY_OP(DivI8, kernels::Div, int8_t);
   IREE_VMLA_BINARY_OP(DivI16, kernels::Div, int16_t);
   IREE_VMLA_BINARY_OP(DivI32, kernels::Div, int32_t);
@@ -572,6 +631,8 @@ class VMLAModuleState final {
   IREE_VMLA_BINARY_OP(DivU16, kernels::Div, uint16_t);
   IREE_VMLA_BINARY_OP(DivU32, kernels::Div, uint32_t);
   IREE_VMLA_BINARY_OP(DivF32, kernels::Div, float);
+  IREE_VMLA_BINARY_OP(DivF16, kernels::Div, kernels::Float16);
+  IREE_VMLA_BINARY_OP(DivBF16, kernels::Div, kernels::BFloat16);
   IREE_VMLA_BINARY_OP(RemI8, kernels::Rem, int8_t);
   IREE_VMLA_BINARY_OP(RemI16, kernels::Rem, int16_t);
   IREE_VMLA_BINARY_OP(RemI32, kernels::Rem, int32_t);
@@ -580,29 +641,70 @@ class VMLAModuleState final {
   IREE_VMLA_BINARY_OP(RemU32, kernels::Rem, uint32_t);
   IREE_VMLA_BINARY_OP(RemF32, kernels::Rem, float);
   IREE_VMLA_BINARY_OP(PowF32, kernels::Pow, float);
+  IREE_VMLA_BINARY_OP(PowF16, kernels::Pow, kernels::Float16);
+  IREE_VMLA_BINARY_OP(PowBF16, kernels::Pow, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(ExpF32, kernels::Exp, float);
+  IREE_VMLA_UNARY_OP(ExpF16, kernels::Exp, kernels::Float16);
+  IREE_VMLA_UNARY_OP(ExpBF16, kernels::Exp, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(LogF32, kernels::Log, float);
+  IREE_VMLA_UNARY_OP(LogF16, kernels::Log, kernels::Float16);
+  IREE_VMLA_UNARY_OP(LogBF16, kernels::Log, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(RsqrtF32, kernels::Rsqrt, float);
+  IREE_VMLA_UNARY_OP(RsqrtF16, kernels::Rsqrt, kernels::Float16);
+  IREE_VMLA_UNARY_OP(RsqrtBF16, kernels::Rsqrt, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(SqrtF32, kernels::Sqrt, float);
+  IREE_VMLA_UNARY_OP(SqrtF16, kernels::Sqrt, kernels::Float16);
+  IREE_VMLA_UNARY_OP(SqrtBF16, kernels::Sqrt, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(CosF32, kernels::Cos, float);
+  IREE_VMLA_UNARY_OP(CosF16, kernels::Cos, kernels::Float16);
+  IREE_VMLA_UNARY_OP(CosBF16, kernels::Cos, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(SinF32, kernels::Sin, float);
+  IREE_VMLA_UNARY_OP(SinF16, kernels::Sin, kernels::Float16);
+  IREE_VMLA_UNARY_OP(SinBF16, kernels::Sin, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(TanhF32, kernels::Tanh, float);
+  IREE_VMLA_UNARY_OP(TanhF16, kernels::Tanh, kernels::Float16);
+  IREE_VMLA_UNARY_OP(TanhBF16, kernels::Tanh, kernels::BFloat16);
   IREE_VMLA_BINARY_OP(Atan2F32, kernels::Atan2, float);
+  IREE_VMLA_BINARY_OP(Atan2F16, kernels::Atan2, kernels::Float16);
+  IREE_VMLA_BINARY_OP(Atan2BF16, kernels::Atan2, kernels::BFloat16);
 
   IREE_VMLA_BINARY_OP(MinI8, kernels::Min, int8_t);
   IREE_VMLA_BINARY_OP(MinI16, kernels::Min, int16_t);
   IREE_VMLA_BINARY_OP(MinI32, kernels::Min, int32_t);
   IREE_VMLA_BINARY_OP(MinF32, kernels::Min, float);
+  IREE_VMLA_BINARY_OP(MinF16, kernels::Min, kernels::Float16);
+  IREE_VMLA_BINARY_OP(MinBF16, kernels::Min, kernels::BFloat16);
   IREE_VMLA_BINARY_OP(MaxI8, kernels::Max, int8_t);
   IREE_VMLA_BINARY_OP(MaxI16, kernels::Max, int16_t);
   IREE_VMLA_BINARY_OP(MaxI32, kernels::Max, int32_t);
   IREE_VMLA_BINARY_OP(MaxF32, kernels::Max, float);
+  IREE_VMLA_BINARY_OP(MaxF16, kernels::Max, kernels::Float16);
+  IREE_VMLA_BINARY_OP(MaxBF16, kernels::Max, kernels::BFloat16);
   IREE_VMLA_TERNARY_OP(ClampI8, kernels::Clamp, int8_t);
   IREE_VMLA_TERNARY_OP(ClampI16, kernels::Clamp, int16_t);
   IREE_VMLA_TERNARY_OP(ClampI32, kernels::Clamp, int32_t);
   IREE_VMLA_TERNARY_OP(ClampF32, kernels::Clamp, float);
+  IREE_VMLA_TERNARY_OP(ClampF16, kernels::Clamp, kernels::Float16);
+  IREE_VMLA_TERNARY_OP(ClampBF16, kernels::Clamp, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(FloorF32, kernels::Floor, float);
+  IREE_VMLA_UNARY_OP(FloorF16, kernels::Floor, kernels::Float16);
+  IREE_VMLA_UNARY_OP(FloorBF16, kernels::Floor, kernels::BFloat16);
   IREE_VMLA_UNARY_OP(CeilF32, kernels::Ceil, float);
+  IREE_VMLA_UNARY_OP(CeilF16, kernels::Ceil, kernels::Float16);
+  IREE_VMLA_UNARY_OP(CeilBF16, kernels::Ceil, kernels::BFloat16);
+
+  Status ElementwiseF32(absl::Span<const vm::ref<Buffer>> srcs,
+                        vm::ref<Buffer> dst,
+                        absl::Span<const int32_t> program) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::ElementwiseF32");
+    absl::InlinedVector<absl::Span<const float>, 8> src_buffers;
+    src_buffers.reserve(srcs.size());
+    for (const auto& src : srcs) {
+      src_buffers.push_back(src->As<float>());
+    }
+    return kernels::Elementwise::Execute<float>(src_buffers, program,
+                                                dst->As<float>());
+  }
 
   //===--------------------------------------------------------------------===//
   // VMLA Ops: conversion
@@ -626,21 +728,26 @@ class VMLAModuleState final {
   IREE_VMLA_CONVERSION_OP(ConvertF32I8, float, int8_t);
   IREE_VMLA_CONVERSION_OP(ConvertF32I16, float, int16_t);
   IREE_VMLA_CONVERSION_OP(ConvertF32I32, float, int32_t);
+  IREE_VMLA_CONVERSION_OP(ConvertF16F32, kernels::Float16, float);
+  IREE_VMLA_CONVERSION_OP(ConvertF32F16, float, kernels::Float16);
+  IREE_VMLA_CONVERSION_OP(ConvertBF16F32, kernels::BFloat16, float);
+  IREE_VMLA_CONVERSION_OP(ConvertF32BF16, float, kernels::BFloat16);
 
   //===--------------------------------------------------------------------===//
   // VMLA Ops: Convolution
   //===--------------------------------------------------------------------===//
 
-  Status ConvF32F32F32(vm::ref<Buffer> input, iree_vmla_shape_t input_shape,
-                       vm::ref<Buffer> filter, iree_vmla_shape_t filter_shape,
-                       vm::ref<Buffer> dst, iree_vmla_shape_t dst_shape,
-                       absl::Span<const int32_t> window_strides,
-                       absl::Span<const int32_t> padding,
-                       absl::Span<const int32_t> lhs_dilation,
-                       absl::Span<const int32_t> rhs_dilation,
-                       const int32_t feature_group_count,
-                       const int32_t batch_group_count) {
-    IREE_TRACE_SCOPE0("VMLAModuleState::ConvF32F32F32");
+  // Convolves |T| inputs and filters into |ACC| results computed as |CT| and
+  // |CACC|. When these differ the filter is widened once and each example of
+  // the batch is widened and its results narrowed as it is convolved.
+  template <typename T, typename ACC, typename CT = T, typename CACC = ACC>
+  Status Conv(absl::Span<const T> input, iree_vmla_shape_t input_shape,
+              absl::Span<const T> filter, iree_vmla_shape_t filter_shape,
+              absl::Span<ACC> dst, iree_vmla_shape_t dst_shape,
+              absl::Span<const int32_t> window_strides,
+              absl::Span<const int32_t> padding,
+              absl::Span<const int32_t> lhs_dilation,
+              const int32_t feature_group_count) {
     if (input_shape.size() != 4 || filter_shape.size() != 4 ||
         dst_shape.size() != 4) {
       return InvalidArgumentErrorBuilder(IREE_LOC)
@@ -656,37 +763,125 @@ class VMLAModuleState final {
     const auto pad_w = padding.subspan(2, 2);
     const auto window_strides_2d = window_strides.subspan(0, 2);
 
-    const float* raw_inputs_data = input->As<float>().data();
-    const float* raw_filter_data = filter->As<float>().data();
-    float* raw_dst_data = dst->As<float>().data();
-    auto filter_buffer = absl::MakeConstSpan(
-        raw_filter_data, kernels::GetElementCount(filter_shape_4d));
+    const T* raw_inputs_data = input.data();
+    const T* raw_filter_data = filter.data();
+    ACC* raw_dst_data = dst.data();
+    std::vector<CT> filter_storage;
+    auto filter_buffer = WidenSpan(
+        absl::MakeConstSpan(raw_filter_data,
+                            kernels::GetElementCount(filter_shape_4d)),
+        &filter_storage);
 
     const size_t input_stride = kernels::GetElementCount(input_example_shape);
     const size_t output_stride = kernels::GetElementCount(output_example_shape);
 
+    // Transpose the filter once for all examples in the batch.
+    std::vector<CT> filter_t;
+    if (kernels::Conv2D::UsesTransposedFilter(
+            input_example_shape, filter_shape_4d, output_example_shape,
+            dilation, feature_group_count)) {
+      filter_t.resize(filter_buffer.size());
+      kernels::Conv2D::TransposeFilter(filter_buffer, filter_shape_4d,
+                                       absl::MakeSpan(filter_t));
+    }
+
+    std::vector<CT> input_storage;
+    std::vector<CACC> output_storage;
     for (int i = 0; i < batch_size; ++i) {
-      auto input_example =
-          absl::MakeConstSpan(raw_inputs_data + i * input_stride, input_stride);
-      auto output_example =
+      auto input_example = WidenSpan(
+          absl::MakeConstSpan(raw_inputs_data + i * input_stride, input_stride),
+          &input_storage);
+      auto dst_example =
           absl::MakeSpan(raw_dst_data + i * output_stride, output_stride);
+      auto output_example = ComputeSpan(dst_example, &output_storage);
       RETURN_IF_ERROR(kernels::Conv2D::Execute(
-          input_example, input_example_shape, filter_buffer, filter_shape_4d,
-          output_example, output_example_shape, window_strides_2d, pad_h, pad_w,
-          dilation, feature_group_count));
+          kernel_state_->mat_mul_state.get(), input_example,
+          input_example_shape, filter_buffer, filter_shape_4d, output_example,
+          output_example_shape, window_strides_2d, pad_h, pad_w, dilation,
+          feature_group_count, absl::MakeConstSpan(filter_t)));
+      NarrowSpan(output_example, dst_example);
     }
     return OkStatus();
   }
 
+  Status ConvF32F32F32(vm::ref<Buffer> input, iree_vmla_shape_t input_shape,
+                       vm::ref<Buffer> filter, iree_vmla_shape_t filter_shape,
+                       vm::ref<Buffer> dst, iree_vmla_shape_t dst_shape,
+                       absl::Span<const int32_t> window_strides,
+                       absl::Span<const int32_t> padding,
+                       absl::Span<const int32_t> lhs_dilation,
+                       absl::Span<const int32_t> rhs_dilation,
+                       const int32_t feature_group_count,
+                       const int32_t batch_group_count) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::ConvF32F32F32");
+    return Conv<float, float>(input->As<float>(), input_shape,
+                              filter->As<float>(), filter_shape,
+                              dst->As<float>(), dst_shape, window_strides,
+                              padding, lhs_dilation, feature_group_count);
+  }
+
+  Status ConvF16F16F16(vm::ref<Buffer> input, iree_vmla_shape_t input_shape,
+                       vm::ref<Buffer> filter, iree_vmla_shape_t filter_shape,
+                       vm::ref<Buffer> dst, iree_vmla_shape_t dst_shape,
+                       absl::Span<const int32_t> window_strides,
+                       absl::Span<const int32_t> padding,
+                       absl::Span<const int32_t> lhs_dilation,
+                       absl::Span<const int32_t> rhs_dilation,
+                       const int32_t feature_group_count,
+                       const int32_t batch_group_count) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::ConvF16F16F16");
+    // Half-precision tensors are convolved in f32.
+    return Conv<kernels::Float16, kernels::Float16, float, float>(
+        input->As<kernels::Float16>(), input_shape,
+        filter->As<kernels::Float16>(), filter_shape,
+        dst->As<kernels::Float16>(), dst_shape, window_strides, padding,
+        lhs_dilation, feature_group_count);
+  }
+
+  Status ConvBF16BF16BF16(vm::ref<Buffer> input, iree_vmla_shape_t input_shape,
+                          vm::ref<Buffer> filter,
+                          iree_vmla_shape_t filter_shape, vm::ref<Buffer> dst,
+                          iree_vmla_shape_t dst_shape,
+                          absl::Span<const int32_t> window_strides,
+                          absl::Span<const int32_t> padding,
+                          absl::Span<const int32_t> lhs_dilation,
+                          absl::Span<const int32_t> rhs_dilation,
+                          const int32_t feature_group_count,
+                          const int32_t batch_group_count) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::ConvBF16BF16BF16");
+    // Half-precision tensors are convolved in f32.
+    return Conv<kernels::BFloat16, kernels::BFloat16, float, float>(
+        input->As<kernels::BFloat16>(), input_shape,
+        filter->As<kernels::BFloat16>(), filter_shape,
+        dst->As<kernels::BFloat16>(), dst_shape, window_strides, padding,
+        lhs_dilation, feature_group_count);
+  }
+
+  Status ConvI8I8I32(vm::ref<Buffer> input, iree_vmla_shape_t input_shape,
+                     vm::ref<Buffer> filter, iree_vmla_shape_t filter_shape,
+                     vm::ref<Buffer> dst, iree_vmla_shape_t dst_shape,
+                     absl::Span<const int32_t> window_strides,
+                     absl::Span<const int32_t> padding,
+                     absl::Span<const int32_t> lhs_dilation,
+                     absl::Span<const int32_t> rhs_dilation,
+                     const int32_t feature_group_count,
+                     const int32_t batch_group_count) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::ConvI8I8I32");
+    return Conv<int8_t, int32_t>(input->As<int8_t>(), input_shape,
+                                 filter->As<int8_t>(), filter_shape,
+                                 dst->As<int32_t>(), dst_shape, window_strides,
+                                 padding, lhs_dilation, feature_group_count);
+  }
+
   //===--------------------------------------------------------------------===//
   // VMLA Ops: GEMM/GEMV
   //===--------------------------------------------------------------------===//
 
-  Status BatchMatMulF32F32F32(vm::ref<Buffer> lhs, iree_vmla_shape_t lhs_shape,
-                              vm::ref<Buffer> rhs, iree_vmla_shape_t rhs_shape,
-                              vm::ref<Buffer> dst,
-                              iree_vmla_shape_t dst_shape) {
-    IREE_TRACE_SCOPE0("VMLAModuleState::BatchMatMulF32F32F32");
+  // Multiplies |T| matrices accumulating in |ACC| into |DST| results.
+  template <typename T, typename ACC, typename DST>
+  Status BatchMatMul(vm::ref<Buffer> lhs, iree_vmla_shape_t lhs_shape,
+                     vm::ref<Buffer> rhs, iree_vmla_shape_t rhs_shape,
+                     vm::ref<Buffer> dst, iree_vmla_shape_t dst_shape) {
     // Compiler guarantees. Here for documentation purposes.
     assert(lhs_shape.size() == 3 && rhs_shape.size() == 3 &&
            dst_shape.size() == 3);
@@ -701,12 +896,12 @@ class VMLAModuleState final {
     size_t lhs_batch_stride = kernels::GetElementCount(lhs_batch_element_shape);
     size_t rhs_batch_stride = kernels::GetElementCount(rhs_batch_element_shape);
     size_t dst_batch_stride = kernels::GetElementCount(dst_batch_element_shape);
-    float* lhs_batch_base = lhs->As<float>().data();
-    float* rhs_batch_base = rhs->As<float>().data();
-    float* dst_batch_base = dst->As<float>().data();
+    T* lhs_batch_base = lhs->As<T>().data();
+    T* rhs_batch_base = rhs->As<T>().data();
+    DST* dst_batch_base = dst->As<DST>().data();
     int32_t batch_dim = lhs_shape[0];
     for (int i = 0; i < batch_dim; i++) {
-      kernels::MatMul::Buffers<float, float> buffers;
+      kernels::MatMul::Buffers<T, ACC, DST> buffers;
       buffers.lhs_buffer = absl::MakeSpan(lhs_batch_base + i * lhs_batch_stride,
                                           lhs_batch_stride);
       buffers.lhs_shape = lhs_batch_element_shape2;
@@ -723,19 +918,60 @@ class VMLAModuleState final {
     return OkStatus();
   }
 
+  Status BatchMatMulF32F32F32(vm::ref<Buffer> lhs, iree_vmla_shape_t lhs_shape,
+                              vm::ref<Buffer> rhs, iree_vmla_shape_t rhs_shape,
+                              vm::ref<Buffer> dst,
+                              iree_vmla_shape_t dst_shape) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BatchMatMulF32F32F32");
+    return BatchMatMul<float, float, float>(std::move(lhs), lhs_shape,
+                                            std::move(rhs), rhs_shape,
+                                            std::move(dst), dst_shape);
+  }
+
+  Status BatchMatMulF16F16F16(vm::ref<Buffer> lhs, iree_vmla_shape_t lhs_shape,
+                              vm::ref<Buffer> rhs, iree_vmla_shape_t rhs_shape,
+                              vm::ref<Buffer> dst,
+                              iree_vmla_shape_t dst_shape) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BatchMatMulF16F16F16");
+    return BatchMatMul<kernels::Float16, float, kernels::Float16>(
+        std::move(lhs), lhs_shape, std::move(rhs), rhs_shape, std::move(dst),
+        dst_shape);
+  }
+
+  Status BatchMatMulBF16BF16BF16(vm::ref<Buffer> lhs,
+                                 iree_vmla_shape_t lhs_shape,
+                                 vm::ref<Buffer> rhs,
+                                 iree_vmla_shape_t rhs_shape,
+                                 vm::ref<Buffer> dst,
+                                 iree_vmla_shape_t dst_shape) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BatchMatMulBF16BF16BF16");
+    return BatchMatMul<kernels::BFloat16, float, kernels::BFloat16>(
+        std::move(lhs), lhs_shape, std::move(rhs), rhs_shape, std::move(dst),
+        dst_shape);
+  }
+
+  Status BatchMatMulI8I8I32(vm::ref<Buffer> lhs, iree_vmla_shape_t lhs_shape,
+                            vm::ref<Buffer> rhs, iree_vmla_shape_t rhs_shape,
+                            vm::ref<Buffer> dst, iree_vmla_shape_t dst_shape) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BatchMatMulI8I8I32");
+    return BatchMatMul<int8_t, int32_t, int32_t>(std::move(lhs), lhs_shape,
+                                                 std::move(rhs), rhs_shape,
+                                                 std::move(dst), dst_shape);
+  }
+
   //===--------------------------------------------------------------------===//
   // VMLA Ops: reduction
   //===--------------------------------------------------------------------===//
 
-#define IREE_VMLA_REDUCTION_OP(name, kernel, type)                      \
-  Status name(vm::ref<Buffer> src, iree_vmla_shape_t src_shape,         \
-              vm::ref<Buffer> init, iree_vmla_shape_t init_shape,       \
-              int32_t dimension, vm::ref<Buffer> dst,                   \
-              iree_vmla_shape_t dst_shape) {                            \
-    IREE_TRACE_SCOPE0("VMLAModuleState::" #name);                       \
-    return kernel::Execute<type>(src->As<type>(), init->As<type>(),     \
-                                 dst->As<type>(), dimension, src_shape, \
-                                 dst_shape);                            \
+#define IREE_VMLA_REDUCTION_OP(name, kernel, type)                       \
+  Status name(vm::ref<Buffer> src, iree_vmla_shape_t src_shape,          \
+              vm::ref<Buffer> init, iree_vmla_shape_t init_shape,        \
+              absl::Span<const int32_t> dimensions, vm::ref<Buffer> dst, \
+              iree_vmla_shape_t dst_shape) {                             \
+    IREE_TRACE_SCOPE0("VMLAModuleState::" #name);                        \
+    return kernel::Execute<type>(src->As<type>(), init->As<type>(),      \
+                                 dst->As<type>(), dimensions, src_shape, \
+                                 dst_shape);                             \
   }
   IREE_VMLA_REDUCTION_OP(ReduceSumI8, kernels::ReduceSum, int8_t);
   IREE_VMLA_REDUCTION_OP(ReduceSumI16, kernels::ReduceSum, int16_t);
@@ -774,6 +1010,53 @@ class VMLAModuleState final {
   IREE_VMLA_POOLING_OP(PoolingMaxI32, kernels::PoolingMax, int32_t);
   IREE_VMLA_POOLING_OP(PoolingMaxF32, kernels::PoolingMax, float);
 
+  //===--------------------------------------------------------------------===//
+  // VMLA Ops: sorting
+  //===--------------------------------------------------------------------===//
+
+  // Sorts are ascending for LT and descending for GT.
+  static StatusOr<bool> IsDescendingSort(int32_t predicate) {
+    switch (static_cast<CmpPredicate>(predicate)) {
+      case CmpPredicate::kLT:
+        return false;
+      case CmpPredicate::kGT:
+        return true;
+      default:
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Unsupported sort predicate " << predicate;
+    }
+  }
+
+#define IREE_VMLA_SORT_OP(name, type)                                  \
+  Status name(int32_t predicate, vm::ref<Buffer> src,                  \
+              iree_vmla_shape_t src_shape, vm::ref<Buffer> dst,        \
+              iree_vmla_shape_t dst_shape) {                           \
+    IREE_TRACE_SCOPE0("VMLAModuleState::" #name);                      \
+    ASSIGN_OR_RETURN(bool descending, IsDescendingSort(predicate));    \
+    return kernels::Sort::Execute<type>(src->As<type>(),               \
+                                        dst->As<int32_t>(), src_shape, \
+                                        descending);                   \
+  }
+  IREE_VMLA_SORT_OP(SortI8, int8_t);
+  IREE_VMLA_SORT_OP(SortI16, int16_t);
+  IREE_VMLA_SORT_OP(SortI32, int32_t);
+  IREE_VMLA_SORT_OP(SortF32, float);
+
+#define IREE_VMLA_TOPK_OP(name, type)                                  \
+  Status name(int32_t predicate, vm::ref<Buffer> src,                  \
+              iree_vmla_shape_t src_shape, vm::ref<Buffer> dst,        \
+              iree_vmla_shape_t dst_shape) {                           \
+    IREE_TRACE_SCOPE0("VMLAModuleState::" #name);                      \
+    ASSIGN_OR_RETURN(bool descending, IsDescendingSort(predicate));    \
+    return kernels::TopK::Execute<type>(src->As<type>(),               \
+                                        dst->As<int32_t>(), src_shape, \
+                                        dst_shape, descending);        \
+  }
+  IREE_VMLA_TOPK_OP(TopKI8, int8_t);
+  IREE_VMLA_TOPK_OP(TopKI16, int16_t);
+  IREE_VMLA_TOPK_OP(TopKI32, int32_t);
+  IREE_VMLA_TOPK_OP(TopKF32, float);
+
  private:
   iree_allocator_t allocator_;
 
@@ -781,11 +1064,14 @@ class VMLAModuleState final {
   // execution.
   vm::ref<Interface> interface_;
 
-  // NOTE: kernel state must be externally synchronized as it is shared across
-  // all contexts using the VMLA module. This is fine in our current design as
-  // we only ever execute a single context at a time but if we start to allow
-  // concurrency across contexts we'll need to introduce locks.
-  kernels::RuntimeState* kernel_state_ = nullptr;
+  // Scratch block the compiler packs intermediate buffers into (see
+  // vmla.buffer.scratch). Reused across invocations; as with the interface
+  // this relies on invocations within a context being serialized.
+  vm::ref<Buffer> scratch_;
+
+  // Kernel state (such as the matmul backend context) owned by this context so
+  // that dispatches running concurrently in other contexts never share it.
+  std::unique_ptr<kernels::RuntimeState> kernel_state_;
 };
 
 //===----------------------------------------------------------------------===//
@@ -801,6 +1087,7 @@ static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
 
     vm::MakeNativeFunction("buffer.const", &VMLAModuleState::BufferConst),
     vm::MakeNativeFunction("buffer.alloc", &VMLAModuleState::BufferAlloc),
+    vm::MakeNativeFunction("buffer.scratch", &VMLAModuleState::BufferScratch),
     vm::MakeNativeFunction("buffer.clone", &VMLAModuleState::BufferClone),
     vm::MakeNativeFunction("buffer.view", &VMLAModuleState::BufferView),
     vm::MakeNativeFunction("buffer.copy", &VMLAModuleState::BufferCopy),
@@ -811,6 +1098,8 @@ static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
     vm::MakeNativeFunction("cmp.i16", &VMLAModuleState::CmpI16),
     vm::MakeNativeFunction("cmp.i32", &VMLAModuleState::CmpI32),
     vm::MakeNativeFunction("cmp.f32", &VMLAModuleState::CmpF32),
+    vm::MakeNativeFunction("cmp.f16", &VMLAModuleState::CmpF16),
+    vm::MakeNativeFunction("cmp.bf16", &VMLAModuleState::CmpBF16),
     vm::MakeNativeFunction("select.x8", &VMLAModuleState::SelectX8),
     vm::MakeNativeFunction("select.x16", &VMLAModuleState::SelectX16),
     vm::MakeNativeFunction("select.x32", &VMLAModuleState::SelectX32),
@@ -863,22 +1152,32 @@ static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
     vm::MakeNativeFunction("add.i16", &VMLAModuleState::AddI16),
     vm::MakeNativeFunction("add.i32", &VMLAModuleState::AddI32),
     vm::MakeNativeFunction("add.f32", &VMLAModuleState::AddF32),
+    vm::MakeNativeFunction("add.f16", &VMLAModuleState::AddF16),
+    vm::MakeNativeFunction("add.bf16", &VMLAModuleState::AddBF16),
     vm::MakeNativeFunction("sub.i8", &VMLAModuleState::SubI8),
     vm::MakeNativeFunction("sub.i16", &VMLAModuleState::SubI16),
     vm::MakeNativeFunction("sub.i32", &VMLAModuleState::SubI32),
     vm::MakeNativeFunction("sub.f32", &VMLAModuleState::SubF32),
+    vm::MakeNativeFunction("sub.f16", &VMLAModuleState::SubF16),
+    vm::MakeNativeFunction("sub.bf16", &VMLAModuleState::SubBF16),
     vm::MakeNativeFunction("abs.i8", &VMLAModuleState::AbsI8),
     vm::MakeNativeFunction("abs.i16", &VMLAModuleState::AbsI16),
     vm::MakeNativeFunction("abs.i32", &VMLAModuleState::AbsI32),
     vm::MakeNativeFunction("abs.f32", &VMLAModuleState::AbsF32),
+    vm::MakeNativeFunction("abs.f16", &VMLAModuleState::AbsF16),
+    vm::MakeNativeFunction("abs.bf16", &VMLAModuleState::AbsBF16),
     vm::MakeNativeFunction("neg.i8", &VMLAModuleState::NegI8),
     vm::MakeNativeFunction("neg.i16", &VMLAModuleState::NegI16),
     vm::MakeNativeFunction("neg.i32", &VMLAModuleState::NegI32),
     vm::MakeNativeFunction("neg.f32", &VMLAModuleState::NegF32),
+    vm::MakeNativeFunction("neg.f16", &VMLAModuleState::NegF16),
+    vm::MakeNativeFunction("neg.bf16", &VMLAModuleState::NegBF16),
     vm::MakeNativeFunction("mul.i8", &VMLAModuleState::MulI8),
     vm::MakeNativeFunction("mul.i16", &VMLAModuleState::MulI16),
     vm::MakeNativeFunction("mul.i32", &VMLAModuleState::MulI32),
     vm::MakeNativeFunction("mul.f32", &VMLAModuleState::MulF32),
+    vm::MakeNativeFunction("mul.f16", &VMLAModuleState::MulF16),
+    vm::MakeNativeFunction("mul.bf16", &VMLAModuleState::MulBF16),
     vm::MakeNativeFunction("div.i8", &VMLAModuleState::DivI8),
     vm::MakeNativeFunction("div.i16", &VMLAModuleState::DivI16),
     vm::MakeNativeFunction("div.i32", &VMLAModuleState::DivI32),
@@ -886,6 +1185,8 @@ static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
     vm::MakeNativeFunction("div.u16", &VMLAModuleState::DivU16),
     vm::MakeNativeFunction("div.u32", &VMLAModuleState::DivU32),
     vm::MakeNativeFunction("div.f32", &VMLAModuleState::DivF32),
+    vm::MakeNativeFunction("div.f16", &VMLAModuleState::DivF16),
+    vm::MakeNativeFunction("div.bf16", &VMLAModuleState::DivBF16),
     vm::MakeNativeFunction("rem.i8", &VMLAModuleState::RemI8),
     vm::MakeNativeFunction("rem.i16", &VMLAModuleState::RemI16),
     vm::MakeNativeFunction("rem.i32", &VMLAModuleState::RemI32),
@@ -894,29 +1195,59 @@ static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
     vm::MakeNativeFunction("rem.u32", &VMLAModuleState::RemU32),
     vm::MakeNativeFunction("rem.f32", &VMLAModuleState::RemF32),
     vm::MakeNativeFunction("pow.f32", &VMLAModuleState::PowF32),
+    vm::MakeNativeFunction("pow.f16", &VMLAModuleState::PowF16),
+    vm::MakeNativeFunction("pow.bf16", &VMLAModuleState::PowBF16),
     vm::MakeNativeFunction("exp.f32", &VMLAModuleState::ExpF32),
+    vm::MakeNativeFunction("exp.f16", &VMLAModuleState::ExpF16),
+    vm::MakeNativeFunction("exp.bf16", &VMLAModuleState::ExpBF16),
     vm::MakeNativeFunction("log.f32", &VMLAModuleState::LogF32),
+    vm::MakeNativeFunction("log.f16", &VMLAModuleState::LogF16),
+    vm::MakeNativeFunction("log.bf16", &VMLAModuleState::LogBF16),
     vm::MakeNativeFunction("rsqrt.f32", &VMLAModuleState::RsqrtF32),
+    vm::MakeNativeFunction("rsqrt.f16", &VMLAModuleState::RsqrtF16),
+    vm::MakeNativeFunction("rsqrt.bf16", &VMLAModuleState::RsqrtBF16),
     vm::MakeNativeFunction("sqrt.f32", &VMLAModuleState::SqrtF32),
+    vm::MakeNativeFunction("sqrt.f16", &VMLAModuleState::SqrtF16),
+    vm::MakeNativeFunction("sqrt.bf16", &VMLAModuleState::SqrtBF16),
     vm::MakeNativeFunction("cos.f32", &VMLAModuleState::CosF32),
+    vm::MakeNativeFunction("cos.f16", &VMLAModuleState::CosF16),
+    vm::MakeNativeFunction("cos.bf16", &VMLAModuleState::CosBF16),
     vm::MakeNativeFunction("sin.f32", &VMLAModuleState::SinF32),
+    vm::MakeNativeFunction("sin.f16", &VMLAModuleState::SinF16),
+    vm::MakeNativeFunction("sin.bf16", &VMLAModuleState::SinBF16),
     vm::MakeNativeFunction("tanh.f32", &VMLAModuleState::TanhF32),
+    vm::MakeNativeFunction("tanh.f16", &VMLAModuleState::TanhF16),
+    vm::MakeNativeFunction("tanh.bf16", &VMLAModuleState::TanhBF16),
     vm::MakeNativeFunction("atan2.f32", &VMLAModuleState::Atan2F32),
+    vm::MakeNativeFunction("atan2.f16", &VMLAModuleState::Atan2F16),
+    vm::MakeNativeFunction("atan2.bf16", &VMLAModuleState::Atan2BF16),
 
     vm::MakeNativeFunction("min.i8", &VMLAModuleState::MinI8),
     vm::MakeNativeFunction("min.i16", &VMLAModuleState::MinI16),
     vm::MakeNativeFunction("min.i32", &VMLAModuleState::MinI32),
     vm::MakeNativeFunction("min.f32", &VMLAModuleState::MinF32),
+    vm::MakeNativeFunction("min.f16", &VMLAModuleState::MinF16),
+    vm::MakeNativeFunction("min.bf16", &VMLAModuleState::MinBF16),
     vm::MakeNativeFunction("max.i8", &VMLAModuleState::MaxI8),
     vm::MakeNativeFunction("max.i16", &VMLAModuleState::MaxI16),
     vm::MakeNativeFunction("max.i32", &VMLAModuleState::MaxI32),
     vm::MakeNativeFunction("max.f32", &VMLAModuleState::MaxF32),
+    vm::MakeNativeFunction("max.f16", &VMLAModuleState::MaxF16),
+    vm::MakeNativeFunction("max.bf16", &VMLAModuleState::MaxBF16),
     vm::MakeNativeFunction("clamp.i8", &VMLAModuleState::ClampI8),
     vm::MakeNativeFunction("clamp.i16", &VMLAModuleState::ClampI16),
     vm::MakeNativeFunction("clamp.i32", &VMLAModuleState::ClampI32),
     vm::MakeNativeFunction("clamp.f32", &VMLAModuleState::ClampF32),
+    vm::MakeNativeFunction("clamp.f16", &VMLAModuleState::ClampF16),
+    vm::MakeNativeFunction("clamp.bf16", &VMLAModuleState::ClampBF16),
     vm::MakeNativeFunction("floor.f32", &VMLAModuleState::FloorF32),
+    vm::MakeNativeFunction("floor.f16", &VMLAModuleState::FloorF16),
+    vm::MakeNativeFunction("floor.bf16", &VMLAModuleState::FloorBF16),
     vm::MakeNativeFunction("ceil.f32", &VMLAModuleState::CeilF32),
+    vm::MakeNativeFunction("ceil.f16", &VMLAModuleState::CeilF16),
+    vm::MakeNativeFunction("ceil.bf16", &VMLAModuleState::CeilBF16),
+    vm::MakeNativeFunction("elementwise.f32",
+                           &VMLAModuleState::ElementwiseF32),
 
     vm::MakeNativeFunction("convert.i8.i16", &VMLAModuleState::ConvertI8I16),
     vm::MakeNativeFunction("convert.i8.i32", &VMLAModuleState::ConvertI8I32),
@@ -930,6 +1261,12 @@ static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
     vm::MakeNativeFunction("convert.f32.i8", &VMLAModuleState::ConvertF32I8),
     vm::MakeNativeFunction("convert.f32.i16", &VMLAModuleState::ConvertF32I16),
     vm::MakeNativeFunction("convert.f32.i32", &VMLAModuleState::ConvertF32I32),
+    vm::MakeNativeFunction("convert.f16.f32", &VMLAModuleState::ConvertF16F32),
+    vm::MakeNativeFunction("convert.f32.f16", &VMLAModuleState::ConvertF32F16),
+    vm::MakeNativeFunction("convert.bf16.f32",
+                           &VMLAModuleState::ConvertBF16F32),
+    vm::MakeNativeFunction("convert.f32.bf16",
+                           &VMLAModuleState::ConvertF32BF16),
 
     vm::MakeNativeFunction("reduce.sum.i8", &VMLAModuleState::ReduceSumI8),
     vm::MakeNativeFunction("reduce.sum.i16", &VMLAModuleState::ReduceSumI16),
@@ -957,10 +1294,29 @@ static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
     vm::MakeNativeFunction("pooling.max.i32", &VMLAModuleState::PoolingMaxI32),
     vm::MakeNativeFunction("pooling.max.f32", &VMLAModuleState::PoolingMaxF32),
 
+    vm::MakeNativeFunction("sort.i8", &VMLAModuleState::SortI8),
+    vm::MakeNativeFunction("sort.i16", &VMLAModuleState::SortI16),
+    vm::MakeNativeFunction("sort.i32", &VMLAModuleState::SortI32),
+    vm::MakeNativeFunction("sort.f32", &VMLAModuleState::SortF32),
+    vm::MakeNativeFunction("topk.i8", &VMLAModuleState::TopKI8),
+    vm::MakeNativeFunction("topk.i16", &VMLAModuleState::TopKI16),
+    vm::MakeNativeFunction("topk.i32", &VMLAModuleState::TopKI32),
+    vm::MakeNativeFunction("topk.f32", &VMLAModuleState::TopKF32),
+
     vm::MakeNativeFunction("batch.matmul.f32f32.f32",
                            &VMLAModuleState::BatchMatMulF32F32F32),
-
-    vm::MakeNativeFunction("conv.f32f32.f32", &VMLAModuleState::ConvF32F32F32)};
+    vm::MakeNativeFunction("batch.matmul.f16f16.f16",
+                           &VMLAModuleState::BatchMatMulF16F16F16),
+    vm::MakeNativeFunction("batch.matmul.bf16bf16.bf16",
+                           &VMLAModuleState::BatchMatMulBF16BF16BF16),
+    vm::MakeNativeFunction("batch.matmul.i8i8.i32",
+                           &VMLAModuleState::BatchMatMulI8I8I32),
+
+    vm::MakeNativeFunction("conv.f32f32.f32", &VMLAModuleState::ConvF32F32F32),
+    vm::MakeNativeFunction("conv.f16f16.f16", &VMLAModuleState::ConvF16F16F16),
+    vm::MakeNativeFunction("conv.bf16bf16.bf16",
+                           &VMLAModuleState::ConvBF16BF16BF16),
+    vm::MakeNativeFunction("conv.i8i8.i32", &VMLAModuleState::ConvI8I8I32)};
 
 // Per-device VMLA module.
 // One of these will be created per device and be shared across all executables
@@ -984,14 +1340,9 @@ class VMLAModule final : public vm::NativeModule<VMLAModuleState> {
   StatusOr<std::unique_ptr<VMLAModuleState>> CreateState(
       iree_allocator_t allocator) override {
     IREE_TRACE_SCOPE0("VMLAModule::CreateState");
-    auto state = std::make_unique<VMLAModuleState>(allocator, &kernel_state_);
+    auto state = std::make_unique<VMLAModuleState>(allocator);
     return state;
   }
-
- private:
-  // NOTE: shared across all contexts with the VMLA module loaded. See
-  // VMLAModuleState::kernel_state_ for more information.
-  kernels::RuntimeState kernel_state_;
 };
 
 }  // namespace
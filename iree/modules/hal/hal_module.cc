@@ -109,10 +109,14 @@ class HALModuleState final {
       : allocator_(allocator), shared_device_(std::move(shared_device)) {}
 
   ~HALModuleState() {
-    for (auto& ref : deferred_releases_) {
-      iree_vm_ref_release(&ref);
+    // Resources may still be in use by submissions that were never waited on.
+    // Errors are ignored as there is no one left to report them to.
+    if (timeline_semaphore_) {
+      iree_hal_semaphore_wait_with_deadline(
+          timeline_semaphore_.get(), timeline_value_,
+          IREE_TIME_INFINITE_FUTURE);
     }
-    deferred_releases_.clear();
+    ReleaseDeferred();
   }
 
   //===--------------------------------------------------------------------===//
@@ -134,44 +138,80 @@ class HALModuleState final {
     return OkStatus();
   }
 
-  Status ExSubmitAndWait(vm::ref<iree_hal_device_t> device,
-                         vm::ref<iree_hal_command_buffer_t> command_buffer) {
-    IREE_TRACE_SCOPE0("HALModuleState::ExSubmitAndWait");
-
-    vm::ref<iree_hal_semaphore_t> semaphore;
-    RETURN_IF_ERROR(FromApiStatus(
-        iree_hal_semaphore_create(device.get(), 0ull, IREE_ALLOCATOR_SYSTEM,
-                                  &semaphore),
-        IREE_LOC));
+  // Submits |command_buffer| for execution without waiting for it to complete.
+  // Submissions are ordered on the module timeline semaphore such that each
+  // begins only after all prior ones have completed. The command buffer and any
+  // deferred releases are held until the next ExWaitIdle.
+  Status ExSubmit(vm::ref<iree_hal_device_t> device,
+                  vm::ref<iree_hal_command_buffer_t> command_buffer) {
+    IREE_TRACE_SCOPE0("HALModuleState::ExSubmit");
+
+    if (!timeline_semaphore_) {
+      RETURN_IF_ERROR(FromApiStatus(
+          iree_hal_semaphore_create(device.get(), 0ull, allocator_,
+                                    &timeline_semaphore_),
+          IREE_LOC));
+      timeline_device_ = device.get();
+    } else if (timeline_device_ != device.get()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Submissions must all be made to the same device";
+    }
 
     iree_hal_submission_batch_t batch;
     memset(&batch, 0, sizeof(batch));
     batch.command_buffer_count = 1;
     iree_hal_command_buffer_t* command_buffer_ptrs[] = {command_buffer.get()};
     batch.command_buffers = command_buffer_ptrs;
+    iree_hal_semaphore_t* semaphore_ptrs[] = {timeline_semaphore_.get()};
+    uint64_t wait_value = timeline_value_;
+    if (wait_value > 0) {
+      batch.wait_semaphores.count = 1;
+      batch.wait_semaphores.semaphores = semaphore_ptrs;
+      batch.wait_semaphores.payload_values = &wait_value;
+    }
+    uint64_t signal_value = timeline_value_ + 1;
     batch.signal_semaphores.count = 1;
-    iree_hal_semaphore_t* semaphore_ptrs[] = {semaphore.get()};
     batch.signal_semaphores.semaphores = semaphore_ptrs;
-    uint64_t signal_value = 1ull;
     batch.signal_semaphores.payload_values = &signal_value;
     RETURN_IF_ERROR(FromApiStatus(
         iree_hal_device_queue_submit(
             device.get(), IREE_HAL_COMMAND_CATEGORY_ANY, 0, 1, &batch),
         IREE_LOC));
+    timeline_value_ = signal_value;
 
-    RETURN_IF_ERROR(
-        FromApiStatus(iree_hal_semaphore_wait_with_deadline(
-                          semaphore.get(), 1ull, IREE_TIME_INFINITE_FUTURE),
-                      IREE_LOC));
+    // Queues do not retain the command buffers they execute so we keep them
+    // alive until the submission has been waited on.
+    deferred_releases_.push_back(
+        iree_hal_command_buffer_move_ref(command_buffer.release()));
 
-    for (auto& ref : deferred_releases_) {
-      iree_vm_ref_release(&ref);
+    return OkStatus();
+  }
+
+  // Blocks until all prior submissions have completed and then releases all
+  // deferred resources. Asynchronous submission failures are returned here.
+  Status ExWaitIdle(vm::ref<iree_hal_device_t> device) {
+    IREE_TRACE_SCOPE0("HALModuleState::ExWaitIdle");
+
+    if (timeline_semaphore_) {
+      RETURN_IF_ERROR(FromApiStatus(
+          iree_hal_semaphore_wait_with_deadline(timeline_semaphore_.get(),
+                                                timeline_value_,
+                                                IREE_TIME_INFINITE_FUTURE),
+          IREE_LOC));
     }
-    deferred_releases_.clear();
+    ReleaseDeferred();
 
     return OkStatus();
   }
 
+  Status ExSubmitAndWait(vm::ref<iree_hal_device_t> device,
+                         vm::ref<iree_hal_command_buffer_t> command_buffer) {
+    IREE_TRACE_SCOPE0("HALModuleState::ExSubmitAndWait");
+    RETURN_IF_ERROR(ExSubmit(vm::retain_ref(device.get()),
+                             std::move(command_buffer)));
+    return ExWaitIdle(std::move(device));
+  }
+
   //===--------------------------------------------------------------------===//
   // iree::hal::Allocator
   //===--------------------------------------------------------------------===//
@@ -277,7 +317,13 @@ class HALModuleState final {
       vm::ref<iree_hal_buffer_t> source_buffer, int32_t source_offset,
       int32_t length) {
     IREE_TRACE_SCOPE0("HALModuleState::BufferSubspan");
-    return UnimplementedErrorBuilder(IREE_LOC) << "BufferSubspan";
+    vm::ref<iree_hal_buffer_t> target_buffer;
+    RETURN_IF_ERROR(
+        FromApiStatus(iree_hal_buffer_subspan(source_buffer.get(),
+                                              source_offset, length, allocator_,
+                                              &target_buffer),
+                      IREE_LOC));
+    return std::move(target_buffer);
   }
 
   Status BufferFill(vm::ref<iree_hal_buffer_t> target_buffer,
@@ -491,6 +537,31 @@ class HALModuleState final {
     return OkStatus();
   }
 
+  // Replaces the binding table of a reusable command buffer with |buffers|.
+  // Returns 1 if the command buffer can be submitted as-is and 0 if it must be
+  // re-recorded (including when |command_buffer| is null).
+  StatusOr<int32_t> CommandBufferUpdateBindingTable(
+      absl::optional<vm::ref<iree_hal_command_buffer_t>> command_buffer,
+      absl::Span<const vm::ref<iree_hal_buffer_t>> buffers) {
+    IREE_TRACE_SCOPE0("HALModuleState::CommandBufferUpdateBindingTable");
+    if (!command_buffer.has_value() || !command_buffer.value()) {
+      return 0;
+    }
+    absl::InlinedVector<iree_hal_buffer_t*, 8> buffer_ptrs(buffers.size());
+    for (int i = 0; i < buffers.size(); ++i) {
+      buffer_ptrs[i] = buffers[i].get();
+    }
+    iree_status_t status = iree_hal_command_buffer_update_binding_table(
+        command_buffer.value().get(), buffer_ptrs.size(), buffer_ptrs.data());
+    if (iree_status_is_failed_precondition(status) ||
+        iree_status_is_unimplemented(status)) {
+      return 0;
+    }
+    RETURN_IF_ERROR(FromApiStatus(status, IREE_LOC))
+        << "Failed to update command buffer binding table";
+    return 1;
+  }
+
   Status CommandBufferExecutionBarrier(
       vm::ref<iree_hal_command_buffer_t> command_buffer,
       iree_hal_execution_stage_t source_stage_mask,
@@ -816,9 +887,23 @@ class HALModuleState final {
   }
 
  private:
+  // Releases all resources deferred by ExDeferRelease.
+  void ReleaseDeferred() {
+    for (auto& ref : deferred_releases_) {
+      iree_vm_ref_release(&ref);
+    }
+    deferred_releases_.clear();
+  }
+
   iree_allocator_t allocator_;
   ref_ptr<Device> shared_device_;
 
+  // Timeline semaphore signaled by each ExSubmit in order. |timeline_value_|
+  // is the value that will be reached once all prior submissions complete.
+  iree_hal_device_t* timeline_device_ = nullptr;
+  vm::ref<iree_hal_semaphore_t> timeline_semaphore_;
+  uint64_t timeline_value_ = 0;
+
   std::vector<iree_vm_ref_t> deferred_releases_;
 };
 
@@ -829,6 +914,8 @@ class HALModuleState final {
 static const vm::NativeFunction<HALModuleState> kHALModuleFunctions[] = {
     vm::MakeNativeFunction("ex.shared_device", &HALModuleState::ExSharedDevice),
     vm::MakeNativeFunction("ex.defer_release", &HALModuleState::ExDeferRelease),
+    vm::MakeNativeFunction("ex.submit", &HALModuleState::ExSubmit),
+    vm::MakeNativeFunction("ex.wait_idle", &HALModuleState::ExWaitIdle),
     vm::MakeNativeFunction("ex.submit_and_wait",
                            &HALModuleState::ExSubmitAndWait),
 
@@ -883,6 +970,8 @@ static const vm::NativeFunction<HALModuleState> kHALModuleFunctions[] = {
                            &HALModuleState::CommandBufferBegin),
     vm::MakeNativeFunction("command_buffer.end",
                            &HALModuleState::CommandBufferEnd),
+    vm::MakeNativeFunction("command_buffer.update_binding_table",
+                           &HALModuleState::CommandBufferUpdateBindingTable),
     vm::MakeNativeFunction("command_buffer.execution_barrier",
                            &HALModuleState::CommandBufferExecutionBarrier),
     vm::MakeNativeFunction("command_buffer.fill_buffer",
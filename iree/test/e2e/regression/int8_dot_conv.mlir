@@ -0,0 +1,116 @@
+// RUN: iree-run-mlir %s -iree-hal-target-backends=vmla -input-value="2x4xi8=[-128 -128 -128 -128][127 -128 127 -128]" -input-value="4x3xi8=[-128 127 1][-128 127 -1][-128 127 2][-128 127 -2]" -input-value="1x3x3x4xi8=[[[-128 127 -128 127][-128 -128 -128 -128][127 127 127 127]][[127 -128 127 -128][-128 -128 -128 -128][1 -1 2 -2]][[-128 -128 -128 -128][127 127 127 127][0 -128 0 127]]]" -input-value="2x2x4x2xi8=[[[-128 127][-128 -128][-128 127][-128 -128]][[-128 -1][-128 1][-128 -1][-128 1]]][[[-128 127][-128 127][-128 127][-128 127]][[-128 -128][-128 0][-128 127][-128 5]]]" -input-value="2x2x1x4xi8=[[[-128 127 -128 127]][[-128 -128 -128 -128]]][[[127 1 -1 0]][[-128 127 -128 127]]]" | IreeFileCheck %s
+
+// Dots and convolutions of i8 values widened to i32 run natively with i32
+// accumulators. Each function returns the native result and its difference
+// from the same computation on the values converted to f32, which is exact for
+// these sizes. The i8 extremes produce sums that do not fit in i16.
+
+// CHECK-LABEL: EXEC @dot
+func @dot(%lhs: tensor<2x4xi8>, %rhs: tensor<4x3xi8>,
+          %input: tensor<1x3x3x4xi8>, %filter: tensor<2x2x4x2xi8>,
+          %depthwise_filter: tensor<2x2x1x4xi8>)
+    -> (tensor<2x3xi32>, tensor<2x3xi32>) {
+  %lhs_i32 = "xla_hlo.convert"(%lhs) : (tensor<2x4xi8>) -> tensor<2x4xi32>
+  %rhs_i32 = "xla_hlo.convert"(%rhs) : (tensor<4x3xi8>) -> tensor<4x3xi32>
+  %res = "xla_hlo.dot"(%lhs_i32, %rhs_i32) : (tensor<2x4xi32>, tensor<4x3xi32>) -> tensor<2x3xi32>
+  %lhs_f32 = "xla_hlo.convert"(%lhs) : (tensor<2x4xi8>) -> tensor<2x4xf32>
+  %rhs_f32 = "xla_hlo.convert"(%rhs) : (tensor<4x3xi8>) -> tensor<4x3xf32>
+  %ref_f32 = "xla_hlo.dot"(%lhs_f32, %rhs_f32) : (tensor<2x4xf32>, tensor<4x3xf32>) -> tensor<2x3xf32>
+  %ref = "xla_hlo.convert"(%ref_f32) : (tensor<2x3xf32>) -> tensor<2x3xi32>
+  %diff = xla_hlo.subtract %res, %ref : tensor<2x3xi32>
+  return %res, %diff : tensor<2x3xi32>, tensor<2x3xi32>
+}
+// CHECK: 2x3xi32=[65536 -65024 0][256 -254 765]
+// CHECK: 2x3xi32=[0 0 0][0 0 0]
+
+// CHECK-LABEL: EXEC @conv
+func @conv(%lhs: tensor<2x4xi8>, %rhs: tensor<4x3xi8>,
+           %input: tensor<1x3x3x4xi8>, %filter: tensor<2x2x4x2xi8>,
+           %depthwise_filter: tensor<2x2x1x4xi8>)
+    -> (tensor<1x2x2x2xi32>, tensor<1x2x2x2xi32>) {
+  %input_i32 = "xla_hlo.convert"(%input) : (tensor<1x3x3x4xi8>) -> tensor<1x3x3x4xi32>
+  %filter_i32 = "xla_hlo.convert"(%filter) : (tensor<2x2x4x2xi8>) -> tensor<2x2x4x2xi32>
+  %res = "xla_hlo.convolution"(%input_i32, %filter_i32) {
+        batch_group_count = 1 : i64,
+        dimension_numbers = {
+          input_batch_dimension = 0 : i64,
+          input_feature_dimension = 3 : i64,
+          input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>,
+          kernel_input_feature_dimension = 2 : i64,
+          kernel_output_feature_dimension = 3 : i64,
+          kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>,
+          output_batch_dimension = 0 : i64,
+          output_feature_dimension = 3 : i64,
+          output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>},
+        feature_group_count = 1 : i64,
+        rhs_dilation = dense<1> : tensor<2xi64>,
+        window_strides = dense<1> : tensor<2xi64>} : (tensor<1x3x3x4xi32>, tensor<2x2x4x2xi32>) -> tensor<1x2x2x2xi32>
+  %input_f32 = "xla_hlo.convert"(%input) : (tensor<1x3x3x4xi8>) -> tensor<1x3x3x4xf32>
+  %filter_f32 = "xla_hlo.convert"(%filter) : (tensor<2x2x4x2xi8>) -> tensor<2x2x4x2xf32>
+  %ref_f32 = "xla_hlo.convolution"(%input_f32, %filter_f32) {
+        batch_group_count = 1 : i64,
+        dimension_numbers = {
+          input_batch_dimension = 0 : i64,
+          input_feature_dimension = 3 : i64,
+          input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>,
+          kernel_input_feature_dimension = 2 : i64,
+          kernel_output_feature_dimension = 3 : i64,
+          kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>,
+          output_batch_dimension = 0 : i64,
+          output_feature_dimension = 3 : i64,
+          output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>},
+        feature_group_count = 1 : i64,
+        rhs_dilation = dense<1> : tensor<2xi64>,
+        window_strides = dense<1> : tensor<2xi64>} : (tensor<1x3x3x4xf32>, tensor<2x2x4x2xf32>) -> tensor<1x2x2x2xf32>
+  %ref = "xla_hlo.convert"(%ref_f32) : (tensor<1x2x2x2xf32>) -> tensor<1x2x2x2xi32>
+  %diff = xla_hlo.subtract %res, %ref : tensor<1x2x2x2xi32>
+  return %res, %diff : tensor<1x2x2x2xi32>, tensor<1x2x2x2xi32>
+}
+// CHECK: 1x2x2x2xi32=[[[131584 -65790][66048 -64652]][[66304 510][640 65401]]]
+// CHECK: 1x2x2x2xi32=[[[0 0][0 0]][[0 0][0 0]]]
+
+// CHECK-LABEL: EXEC @depthwise_conv
+func @depthwise_conv(%lhs: tensor<2x4xi8>, %rhs: tensor<4x3xi8>,
+                     %input: tensor<1x3x3x4xi8>, %filter: tensor<2x2x4x2xi8>,
+                     %depthwise_filter: tensor<2x2x1x4xi8>)
+    -> (tensor<1x2x2x4xi32>, tensor<1x2x2x4xi32>) {
+  %input_i32 = "xla_hlo.convert"(%input) : (tensor<1x3x3x4xi8>) -> tensor<1x3x3x4xi32>
+  %filter_i32 = "xla_hlo.convert"(%depthwise_filter) : (tensor<2x2x1x4xi8>) -> tensor<2x2x1x4xi32>
+  %res = "xla_hlo.convolution"(%input_i32, %filter_i32) {
+        batch_group_count = 1 : i64,
+        dimension_numbers = {
+          input_batch_dimension = 0 : i64,
+          input_feature_dimension = 3 : i64,
+          input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>,
+          kernel_input_feature_dimension = 2 : i64,
+          kernel_output_feature_dimension = 3 : i64,
+          kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>,
+          output_batch_dimension = 0 : i64,
+          output_feature_dimension = 3 : i64,
+          output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>},
+        feature_group_count = 4 : i64,
+        rhs_dilation = dense<1> : tensor<2xi64>,
+        window_strides = dense<1> : tensor<2xi64>} : (tensor<1x3x3x4xi32>, tensor<2x2x1x4xi32>) -> tensor<1x2x2x4xi32>
+  %input_f32 = "xla_hlo.convert"(%input) : (tensor<1x3x3x4xi8>) -> tensor<1x3x3x4xf32>
+  %filter_f32 = "xla_hlo.convert"(%depthwise_filter) : (tensor<2x2x1x4xi8>) -> tensor<2x2x1x4xf32>
+  %ref_f32 = "xla_hlo.convolution"(%input_f32, %filter_f32) {
+        batch_group_count = 1 : i64,
+        dimension_numbers = {
+          input_batch_dimension = 0 : i64,
+          input_feature_dimension = 3 : i64,
+          input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>,
+          kernel_input_feature_dimension = 2 : i64,
+          kernel_output_feature_dimension = 3 : i64,
+          kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>,
+          output_batch_dimension = 0 : i64,
+          output_feature_dimension = 3 : i64,
+          output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>},
+        feature_group_count = 4 : i64,
+        rhs_dilation = dense<1> : tensor<2xi64>,
+        window_strides = dense<1> : tensor<2xi64>} : (tensor<1x3x3x4xf32>, tensor<2x2x1x4xf32>) -> tensor<1x2x2x4xf32>
+  %ref = "xla_hlo.convert"(%ref_f32) : (tensor<1x2x2x4xf32>) -> tensor<1x2x2x4xi32>
+  %diff = xla_hlo.subtract %res, %ref : tensor<1x2x2x4xi32>
+  return %res, %diff : tensor<1x2x2x4xi32>, tensor<1x2x2x4xi32>
+}
+// CHECK: 1x2x2x4xi32=[[[65281 16129 49025 16257][-16256 -32767 0 -32766]][[-32384 16129 -16000 16257][32385 -32257 16001 129]]]
+// CHECK: 1x2x2x4xi32=[[[0 0 0 0][0 0 0 0]][[0 0 0 0][0 0 0 0]]]
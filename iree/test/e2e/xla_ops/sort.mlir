@@ -0,0 +1,49 @@
+func @sort1D() attributes { iree.module.export } {
+  %input = iree.unfoldable_constant dense<[3, 2, 1, 4]> : tensor<4xi32>
+  %sort = "xla_hlo.sort"(%input) ( {
+  ^bb0(%arg1: tensor<i32>, %arg2: tensor<i32>):  // no predecessors
+    %compare = "xla_hlo.compare"(%arg1, %arg2) {comparison_direction = "LT"} : (tensor<i32>, tensor<i32>) -> tensor<i1>
+    "xla_hlo.return"(%compare) : (tensor<i1>) -> ()
+  }) {dimension = 0 : i64, is_stable = false} : (tensor<4xi32>) -> tensor<4xi32>
+  check.expect_eq_const(%sort, dense<[1, 2, 3, 4]> : tensor<4xi32>) : tensor<4xi32>
+  return
+}
+
+func @sortKeyValue() attributes { iree.module.export } {
+  %keys = iree.unfoldable_constant dense<[[1.0, 3.0, 2.0, 3.0], [0.5, -1.0, 4.0, 2.0]]> : tensor<2x4xf32>
+  %values = iree.unfoldable_constant dense<[[0, 1, 2, 3], [4, 5, 6, 7]]> : tensor<2x4xi32>
+  %sort:2 = "xla_hlo.sort"(%keys, %values) ( {
+  ^bb0(%arg1: tensor<f32>, %arg2: tensor<f32>, %arg3: tensor<i32>, %arg4: tensor<i32>):  // no predecessors
+    %compare = "xla_hlo.compare"(%arg1, %arg2) {comparison_direction = "GT"} : (tensor<f32>, tensor<f32>) -> tensor<i1>
+    "xla_hlo.return"(%compare) : (tensor<i1>) -> ()
+  }) {dimension = 1 : i64, is_stable = true} : (tensor<2x4xf32>, tensor<2x4xi32>) -> (tensor<2x4xf32>, tensor<2x4xi32>)
+  check.expect_almost_eq_const(%sort#0, dense<[[3.0, 3.0, 2.0, 1.0], [4.0, 2.0, 0.5, -1.0]]> : tensor<2x4xf32>) : tensor<2x4xf32>
+  check.expect_eq_const(%sort#1, dense<[[1, 3, 2, 0], [6, 7, 4, 5]]> : tensor<2x4xi32>) : tensor<2x4xi32>
+  return
+}
+
+func @sortOuterDimension() attributes { iree.module.export } {
+  %input = iree.unfoldable_constant dense<[[3, 0], [1, 2], [2, 1]]> : tensor<3x2xi32>
+  %sort = "xla_hlo.sort"(%input) ( {
+  ^bb0(%arg1: tensor<i32>, %arg2: tensor<i32>):  // no predecessors
+    %compare = "xla_hlo.compare"(%arg1, %arg2) {comparison_direction = "LT"} : (tensor<i32>, tensor<i32>) -> tensor<i1>
+    "xla_hlo.return"(%compare) : (tensor<i1>) -> ()
+  }) {dimension = 0 : i64, is_stable = true} : (tensor<3x2xi32>) -> tensor<3x2xi32>
+  check.expect_eq_const(%sort, dense<[[1, 0], [2, 1], [3, 2]]> : tensor<3x2xi32>) : tensor<3x2xi32>
+  return
+}
+
+func @topK() attributes { iree.module.export } {
+  %input = iree.unfoldable_constant dense<[[1.0, 5.0, 3.0, 5.0, 2.0], [-4.0, -3.0, -2.0, -1.0, -5.0]]> : tensor<2x5xf32>
+  %iota = iree.unfoldable_constant dense<[[0, 1, 2, 3, 4], [0, 1, 2, 3, 4]]> : tensor<2x5xi32>
+  %sort:2 = "xla_hlo.sort"(%input, %iota) ( {
+  ^bb0(%arg1: tensor<f32>, %arg2: tensor<f32>, %arg3: tensor<i32>, %arg4: tensor<i32>):  // no predecessors
+    %compare = "xla_hlo.compare"(%arg1, %arg2) {comparison_direction = "GT"} : (tensor<f32>, tensor<f32>) -> tensor<i1>
+    "xla_hlo.return"(%compare) : (tensor<i1>) -> ()
+  }) {dimension = 1 : i64, is_stable = true} : (tensor<2x5xf32>, tensor<2x5xi32>) -> (tensor<2x5xf32>, tensor<2x5xi32>)
+  %values = "xla_hlo.slice"(%sort#0) {limit_indices = dense<[2, 2]> : tensor<2xi64>, start_indices = dense<0> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>} : (tensor<2x5xf32>) -> tensor<2x2xf32>
+  %indices = "xla_hlo.slice"(%sort#1) {limit_indices = dense<[2, 2]> : tensor<2xi64>, start_indices = dense<0> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>} : (tensor<2x5xi32>) -> tensor<2x2xi32>
+  check.expect_almost_eq_const(%values, dense<[[5.0, 5.0], [-1.0, -2.0]]> : tensor<2x2xf32>) : tensor<2x2xf32>
+  check.expect_eq_const(%indices, dense<[[1, 3], [3, 2]]> : tensor<2x2xi32>) : tensor<2x2xi32>
+  return
+}